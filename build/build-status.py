@@ -0,0 +1,8 @@
+#! /usr/bin/env python3
+
+# Programs that are runnable.
+ns3_runnable_programs = ['build/src/applications/examples/ns3.35-three-gpp-http-example-debug', 'build/src/bridge/examples/ns3.35-csma-bridge-debug', 'build/src/bridge/examples/ns3.35-csma-bridge-one-hop-debug', 'build/src/config-store/examples/ns3.35-config-store-save-debug', 'build/src/core/examples/ns3.35-main-callback-debug', 'build/src/core/examples/ns3.35-sample-simulator-debug', 'build/src/core/examples/ns3.35-main-ptr-debug', 'build/src/core/examples/ns3.35-main-random-variable-stream-debug', 'build/src/core/examples/ns3.35-sample-random-variable-debug', 'build/src/core/examples/ns3.35-sample-random-variable-stream-debug', 'build/src/core/examples/ns3.35-command-line-example-debug', 'build/src/core/examples/ns3.35-hash-example-debug', 'build/src/core/examples/ns3.35-sample-log-time-format-debug', 'build/src/core/examples/ns3.35-test-string-value-formatting-debug', 'build/src/core/examples/ns3.35-sample-show-progress-debug', 'build/src/core/examples/ns3.35-empirical-random-variable-example-debug', 'build/src/core/examples/ns3.35-system-path-examples-debug', 'build/src/core/examples/ns3.35-fatal-example-debug', 'build/src/core/examples/ns3.35-main-test-sync-debug', 'build/src/core/examples/ns3.35-length-example-debug', 'build/src/csma/examples/ns3.35-csma-one-subnet-debug', 'build/src/csma/examples/ns3.35-csma-broadcast-debug', 'build/src/csma/examples/ns3.35-csma-packet-socket-debug', 'build/src/csma/examples/ns3.35-csma-multicast-debug', 'build/src/internet/examples/ns3.35-main-simple-debug', 'build/src/network/examples/ns3.35-main-packet-header-debug', 'build/src/network/examples/ns3.35-main-packet-tag-debug', 'build/src/network/examples/ns3.35-packet-socket-apps-debug', 'build/src/network/examples/ns3.35-lollipop-comparisions-debug', 'build/src/network/examples/ns3.35-bit-serializer-debug', 'build/src/point-to-point/examples/ns3.35-main-attribute-value-debug', 'build/src/stats/examples/ns3.35-gnuplot-example-debug', 'build/src/stats/examples/ns3.35-double-probe-example-debug', 'build/src/stats/examples/ns3.35-time-probe-example-debug', 'build/src/stats/examples/ns3.35-gnuplot-aggregator-example-debug', 'build/src/stats/examples/ns3.35-gnuplot-helper-example-debug', 'build/src/stats/examples/ns3.35-file-aggregator-example-debug', 'build/src/stats/examples/ns3.35-file-helper-example-debug', 'build/src/traffic-control/examples/ns3.35-red-tests-debug', 'build/src/traffic-control/examples/ns3.35-adaptive-red-tests-debug', 'build/src/traffic-control/examples/ns3.35-codel-vs-pfifo-basic-test-debug', 'build/src/traffic-control/examples/ns3.35-codel-vs-pfifo-asymmetric-debug', 'build/src/traffic-control/examples/ns3.35-pie-example-debug', 'build/examples/tcp/ns3.35-tcp-large-transfer-debug', 'build/examples/tcp/ns3.35-tcp-nsc-lfn-debug', 'build/examples/tcp/ns3.35-tcp-nsc-zoo-debug', 'build/examples/tcp/ns3.35-tcp-star-server-debug', 'build/examples/tcp/ns3.35-tcp-bulk-send-debug', 'build/examples/tcp/ns3.35-tcp-pcap-nanosec-example-debug', 'build/examples/tcp/ns3.35-tcp-nsc-comparison-debug', 'build/examples/tcp/ns3.35-tcp-variants-comparison-debug', 'build/examples/tcp/ns3.35-tcp-pacing-debug', 'build/examples/tcp/ns3.35-dctcp-example-debug', 'build/examples/tcp/ns3.35-tcp-linux-reno-debug', 'build/examples/tcp/ns3.35-tcp-fluid-background-debug', 'build/examples/routing/ns3.35-dynamic-global-routing-debug', 'build/examples/routing/ns3.35-static-routing-slash32-debug', 'build/examples/routing/ns3.35-global-routing-slash32-debug', 'build/examples/routing/ns3.35-global-injection-slash32-debug', 'build/examples/routing/ns3.35-simple-global-routing-debug', 'build/examples/routing/ns3.35-simple-alternate-routing-debug', 'build/examples/routing/ns3.35-mixed-global-routing-debug', 'build/examples/routing/ns3.35-global-routing-multi-switch-plus-router-debug', 'build/examples/routing/ns3.35-simple-multicast-flooding-debug', 'build/examples/udp-client-server/ns3.35-udp-client-server-debug', 'build/examples/udp-client-server/ns3.35-udp-trace-client-server-debug', 'build/examples/error-model/ns3.35-simple-error-model-debug', 'build/examples/tutorial/ns3.35-hello-simulator-debug', 'build/examples/tutorial/ns3.35-first-debug', 'build/examples/tutorial/ns3.35-second-debug', 'build/examples/tutorial/ns3.35-fourth-debug', 'build/examples/tutorial/ns3.35-fifth-debug', 'build/examples/tutorial/ns3.35-sixth-debug', 'build/examples/tutorial/ns3.35-seventh-debug', 'build/examples/udp/ns3.35-udp-echo-debug', 'build/examples/socket/ns3.35-socket-bound-static-routing-debug', 'build/examples/socket/ns3.35-socket-bound-tcp-static-routing-debug', 'build/examples/socket/ns3.35-socket-options-ipv4-debug', 'build/examples/socket/ns3.35-socket-options-ipv6-debug', 'build/examples/realtime/ns3.35-realtime-udp-echo-debug', 'build/examples/naming/ns3.35-object-names-debug', 'build/examples/ipv6/ns3.35-test-ipv6-debug', 'build/examples/traffic-control/ns3.35-traffic-control-debug', 'build/examples/traffic-control/ns3.35-tbf-example-debug', 'build/examples/traffic-control/ns3.35-cobalt-vs-codel-debug', 'build/scratch/subdir/ns3.35-subdir-debug', 'build/scratch/ns3.35-scratch-simulator-debug']
+
+# Scripts that are runnable.
+ns3_runnable_scripts = ['csma-bridge.py', 'sample-simulator.py', 'first.py', 'second.py', 'realtime-udp-echo.py']
+
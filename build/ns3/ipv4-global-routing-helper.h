@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2008 INRIA
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
+ */
+#ifndef IPV4_GLOBAL_ROUTING_HELPER_H
+#define IPV4_GLOBAL_ROUTING_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/object-factory.h"
+
+namespace ns3 {
+
+class Ipv4GlobalRouting;
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that adds ns3::Ipv4GlobalRouting objects
+ */
+class Ipv4GlobalRoutingHelper  : public Ipv4RoutingHelper
+{
+public:
+  /**
+   * \brief Construct a GlobalRoutingHelper to make life easier for managing
+   * global routing tasks.
+   */
+  Ipv4GlobalRoutingHelper ();
+
+  /**
+   * \brief Construct a GlobalRoutingHelper from another previously initialized
+   * instance (Copy Constructor).
+   * \param o object to be copied
+   */
+  Ipv4GlobalRoutingHelper (const Ipv4GlobalRoutingHelper &o);
+
+  /**
+   * \returns pointer to clone of this Ipv4GlobalRoutingHelper
+   *
+   * This method is mainly for internal use by the other helpers;
+   * clients are expected to free the dynamic memory allocated by this method
+   */
+  Ipv4GlobalRoutingHelper* Copy (void) const;
+
+  /**
+   * \param node the node on which the routing protocol will run
+   * \returns a newly-created routing protocol
+   *
+   * This method will be called by ns3::InternetStackHelper::Install
+   */
+  virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
+
+  /**
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set.
+   *
+   * This method controls the attributes of ns3::Ipv4GlobalRouting, e.g.,
+   * its "EcmpMode".
+   */
+  void Set (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Set the weight of the equal-cost routes through a device.
+   *
+   * \param device the device, which must have an IPv4 interface on a node
+   * with global routing
+   * \param weight the weight
+   *
+   * \see Ipv4GlobalRouting::SetEcmpWeight
+   */
+  static void SetEcmpWeight (Ptr<NetDevice> device, uint16_t weight);
+
+  /**
+   * \param device the device, which must have an IPv4 interface on a node
+   * with global routing
+   * \returns the number of packets routed through the device after a choice
+   * among several equal-cost routes
+   *
+   * \see Ipv4GlobalRouting::GetEcmpSelections
+   */
+  static uint64_t GetEcmpSelections (Ptr<NetDevice> device);
+
+  /**
+   * \brief Build a routing database and initialize the routing tables of
+   * the nodes in the simulation.  Makes all nodes in the simulation into
+   * routers.
+   *
+   * All this function does is call the functions
+   * BuildGlobalRoutingDatabase () and  InitializeRoutes ().
+   *
+   */
+  static void PopulateRoutingTables (void);
+  /**
+   * \brief Remove all routes that were previously installed in a prior call
+   * to either PopulateRoutingTables() or RecomputeRoutingTables(), and 
+   * add a new set of routes.
+   * 
+   * This method does not change the set of nodes
+   * over which GlobalRouting is being used, but it will dynamically update
+   * its representation of the global topology before recomputing routes.
+   * Users must first call PopulateRoutingTables() and then may subsequently
+   * call RecomputeRoutingTables() at any later time in the simulation.
+   *
+   * Only the routes of the routers whose shortest path tree may have
+   * been changed by the topology changes are recomputed, the other
+   * routers keep their routes.  The SPF calculations can be spread over
+   * several threads with the "GlobalRoutingThreads" global value.
+   *
+   */
+  static void RecomputeRoutingTables (void);
+private:
+  /**
+   * \brief Assignment operator declared private and not implemented to disallow
+   * assignment and prevent the compiler from happily inserting its own.
+   * \return
+   */
+  Ipv4GlobalRoutingHelper &operator = (const Ipv4GlobalRoutingHelper &);
+
+  /**
+   * \brief Get the global routing of a device, and the index of its interface.
+   * \param device the device
+   * \param interface the index of the IPv4 interface of the device
+   * \returns the global routing of the node of the device
+   */
+  static Ptr<Ipv4GlobalRouting> GetGlobalRouting (Ptr<NetDevice> device, uint32_t &interface);
+
+  ObjectFactory m_factory; //!< Factory of the Ipv4GlobalRouting objects
+};
+
+} // namespace ns3
+
+#endif /* IPV4_GLOBAL_ROUTING_HELPER_H */
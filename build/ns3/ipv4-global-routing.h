@@ -0,0 +1,444 @@
+// -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*-
+//
+// Copyright (c) 2008 University of Washington
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//
+
+#ifndef IPV4_GLOBAL_ROUTING_H
+#define IPV4_GLOBAL_ROUTING_H
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
+
+namespace ns3 {
+
+class Packet;
+class NetDevice;
+class Ipv4Interface;
+class Ipv4Address;
+class Ipv4Header;
+class Ipv4RoutingTableEntry;
+class Ipv4MulticastRoutingTableEntry;
+class Node;
+
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Global routing protocol for IPv4 stacks.
+ *
+ * In ns-3 we have the concept of a pluggable routing protocol.  Routing
+ * protocols are added to a list maintained by the Ipv4L3Protocol.  Every 
+ * stack gets one routing protocol for free -- the Ipv4StaticRouting routing
+ * protocol is added in the constructor of the Ipv4L3Protocol (this is the 
+ * piece of code that implements the functionality of the IP layer).
+ *
+ * As an option to running a dynamic routing protocol, a GlobalRouteManager
+ * object has been created to allow users to build routes for all participating
+ * nodes.  One can think of this object as a "routing oracle"; it has
+ * an omniscient view of the topology, and can construct shortest path
+ * routes between all pairs of nodes.  These routes must be stored 
+ * somewhere in the node, so therefore this class Ipv4GlobalRouting
+ * is used as one of the pluggable routing protocols.  It is kept distinct
+ * from Ipv4StaticRouting because these routes may be dynamically cleared
+ * and rebuilt in the middle of the simulation, while manually entered
+ * routes into the Ipv4StaticRouting may need to be kept distinct.
+ *
+ * This class deals with Ipv4 unicast routes only.
+ *
+ * When several routes of equal cost lead to a destination, the route of a
+ * packet is chosen according to the "EcmpMode" attribute: always the first
+ * route, by a hash of the 5-tuple of the packet (so that the packets of a
+ * flow follow the same path), or by flowlet switching, where a flow moves to
+ * another route, chosen at random, when it has been idle for "FlowletGap".
+ * The routes are weighted by the ECMP weight of their output interface (see
+ * SetEcmpWeight); in the first route mode, the routes of weight 0 are
+ * skipped. "RandomEcmpRouting", which chooses a route at random for each
+ * packet, takes precedence over "EcmpMode".  The packets sent by the node
+ * itself are hashed with their ports when they are given to RouteOutput
+ * with their transport header, as by TcpL4Protocol and UdpSocketImpl.
+ *
+ * \see Ipv4RoutingProtocol
+ * \see GlobalRouteManager
+ */
+class Ipv4GlobalRouting : public Ipv4RoutingProtocol
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Selection of a route among equal-cost multipath (ECMP) routes
+   */
+  enum EcmpMode
+  {
+    ECMP_FIRST,     //!< The first route, always
+    ECMP_FLOW_HASH, //!< By a hash of the 5-tuple of the packet
+    ECMP_FLOWLET    //!< At random, for each flowlet of a flow
+  };
+
+  /**
+   * \brief Construct an empty Ipv4GlobalRouting routing protocol,
+   *
+   * The Ipv4GlobalRouting class supports host and network unicast routes.
+   * This method initializes the lists containing these routes to empty.
+   *
+   * \see Ipv4GlobalRouting
+   */
+  Ipv4GlobalRouting ();
+  virtual ~Ipv4GlobalRouting ();
+
+  // These methods inherited from base class
+  virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
+
+  virtual bool RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
+                            UnicastForwardCallback ucb, MulticastForwardCallback mcb,
+                            LocalDeliverCallback lcb, ErrorCallback ecb);
+  virtual void NotifyInterfaceUp (uint32_t interface);
+  virtual void NotifyInterfaceDown (uint32_t interface);
+  virtual void NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
+  virtual void SetIpv4 (Ptr<Ipv4> ipv4);
+  virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteInputVersion (void) const;
+
+  /**
+   * \brief Add a host route to the global routing table.
+   *
+   * \param dest The Ipv4Address destination for this route.
+   * \param nextHop The Ipv4Address of the next hop in the route.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddHostRouteTo (Ipv4Address dest, 
+                       Ipv4Address nextHop, 
+                       uint32_t interface);
+  /**
+   * \brief Add a host route to the global routing table.
+   *
+   * \param dest The Ipv4Address destination for this route.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddHostRouteTo (Ipv4Address dest, 
+                       uint32_t interface);
+
+  /**
+   * \brief Add a network route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop in the route to the destination network.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddNetworkRouteTo (Ipv4Address network, 
+                          Ipv4Mask networkMask, 
+                          Ipv4Address nextHop, 
+                          uint32_t interface);
+
+  /**
+   * \brief Add a network route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   *
+   * \see Ipv4Address
+   */
+  void AddNetworkRouteTo (Ipv4Address network, 
+                          Ipv4Mask networkMask, 
+                          uint32_t interface);
+
+  /**
+   * \brief Add an external route to the global routing table.
+   *
+   * \param network The Ipv4Address network for this route.
+   * \param networkMask The Ipv4Mask to extract the network.
+   * \param nextHop The next hop Ipv4Address
+   * \param interface The network interface index used to send packets to the
+   * destination.
+   */
+  void AddASExternalRouteTo (Ipv4Address network,
+                             Ipv4Mask networkMask,
+                             Ipv4Address nextHop,
+                             uint32_t interface);
+
+  /**
+   * \brief Get the number of individual unicast routes that have been added
+   * to the routing table.
+   *
+   * \warning The default route counts as one of the routes.
+   * \returns the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Get a route from the global unicast routing table.
+   *
+   * Externally, the unicast global routing table appears simply as a table with
+   * n entries.  The one subtlety of note is that if a default route has been set
+   * it will appear as the zeroth entry in the table.  This means that if you
+   * add only a default route, the table will have one entry that can be accessed
+   * either by explicitly calling GetDefaultRoute () or by calling GetRoute (0).
+   *
+   * Similarly, if the default route has been set, calling RemoveRoute (0) will
+   * remove the default route.
+   *
+   * \param i The index (into the routing table) of the route to retrieve.  If
+   * the default route has been set, it will occupy index zero.
+   * \return If route is set, a pointer to that Ipv4RoutingTableEntry is returned, otherwise
+   * a zero pointer is returned.
+   *
+   * \see Ipv4RoutingTableEntry
+   * \see Ipv4GlobalRouting::RemoveRoute
+   */
+  Ipv4RoutingTableEntry *GetRoute (uint32_t i) const;
+
+  /**
+   * \brief Remove a route from the global unicast routing table.
+   *
+   * Externally, the unicast global routing table appears simply as a table with
+   * n entries.  The one subtlety of note is that if a default route has been set
+   * it will appear as the zeroth entry in the table.  This means that if the
+   * default route has been set, calling RemoveRoute (0) will remove the
+   * default route.
+   *
+   * \param i The index (into the routing table) of the route to remove.  If
+   * the default route has been set, it will occupy index zero.
+   *
+   * \see Ipv4RoutingTableEntry
+   * \see Ipv4GlobalRouting::GetRoute
+   * \see Ipv4GlobalRouting::AddRoute
+   */
+  void RemoveRoute (uint32_t i);
+
+  /**
+   * \brief Set the weight of the routes through an interface among
+   * equal-cost routes.
+   *
+   * The share of the flows, flowlets or packets routed through an interface
+   * is proportional to its weight.  An interface of weight 0 is only used if
+   * all the equal-cost routes have weight 0.  In the first route mode, the
+   * first route of non-zero weight is used.
+   *
+   * \param interface the interface index
+   * \param weight the weight (1 by default)
+   */
+  void SetEcmpWeight (uint32_t interface, uint16_t weight);
+
+  /**
+   * \param interface the interface index
+   * \returns the weight of the routes through the interface among
+   * equal-cost routes
+   */
+  uint16_t GetEcmpWeight (uint32_t interface) const;
+
+  /**
+   * \param interface the interface index
+   * \returns the number of packets routed through the interface after a
+   * choice among several equal-cost routes
+   */
+  uint64_t GetEcmpSelections (uint32_t interface) const;
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  void DoDispose (void);
+
+private:
+  /// Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently
+  bool m_randomEcmpRouting;
+  /// Set to true if this interface should respond to interface events by globallly recomputing routes 
+  bool m_respondToInterfaceEvents;
+  /// A uniform random number generator for randomly routing packets among ECMP 
+  Ptr<UniformRandomVariable> m_rand;
+  EcmpMode m_ecmpMode;          //!< Selection of the route among ECMP routes
+  uint32_t m_ecmpHashSeed;      //!< Seed of the flow hash
+  Time m_flowletGap;            //!< Idle time after which a flow may change route
+  uint32_t m_flowletTableSize;  //!< Number of entries of the flowlet table
+
+  /// ECMP state of an interface
+  struct EcmpInterface
+  {
+    uint16_t weight;     //!< Weight among the equal-cost routes
+    uint64_t selections; //!< Number of packets routed through the interface after a choice
+  };
+  std::vector<EcmpInterface> m_ecmpInterfaces; //!< ECMP state, by interface index
+
+  /// Entry of the flowlet table
+  struct Flowlet
+  {
+    int64_t lastSeen;   //!< Time step of the last packet, negative if none
+    uint32_t interface; //!< Output interface of the flowlet
+  };
+  /// Flowlet table, by flow hash; the flows of the same slot share their flowlets, as in switches
+  std::vector<Flowlet> m_flowlets;
+
+  /// container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator HostRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to hosts)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator HostRoutesI;
+
+  /// container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *> NetworkRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator NetworkRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to networks)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator NetworkRoutesI;
+
+  /// container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *> ASExternalRoutes;
+  /// const iterator of container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *>::const_iterator ASExternalRoutesCI;
+  /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
+  typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
+
+  /// container of the routes to a destination
+  typedef std::vector<Ipv4RoutingTableEntry *> RouteVec;
+
+  /// a route and its insertion number, which orders the routes of the index as in the lists
+  typedef std::pair<uint64_t, Ipv4RoutingTableEntry *> IndexedRoute;
+
+  /// index of the routes to networks, by destination network
+  typedef PrefixTrie<IndexedRoute, 4> NetworkRouteIndex;
+
+  /**
+   * \brief Add a route to a network or external AS to an index.
+   * \param index the index
+   * \param route the route
+   */
+  void IndexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove a route to a network or external AS from an index.
+   * \param index the index
+   * \param route the route
+   */
+  void UnindexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Get the key of a route to a network in the indices.
+   * \param route the route
+   * \param key the destination network, in network byte order
+   * \param length the length of the network mask
+   * \return false if the network mask is not a prefix, so that the route can not be indexed
+   */
+  static bool GetIndexKey (const Ipv4RoutingTableEntry *route, uint8_t key[4], uint8_t &length);
+
+  /**
+   * \brief Find the routes to a destination with the indices.
+   *
+   * The routes are the same, and in the same order, as those found by
+   * scanning the lists.
+   *
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the routes found
+   */
+  void LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif, RouteVec &routes);
+
+  /**
+   * \brief Hash the flow of a packet.
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, starting with its transport header,
+   * or 0 if the ports are not known
+   * \return the hash of the 5-tuple, or of the addresses and protocol if the
+   * ports are not known
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const;
+
+  /**
+   * \brief Get the sum of the ECMP weights of routes.
+   * \param routes the routes
+   * \return the sum of the weights, or the number of routes if they all
+   * have weight 0, in which case they are all used
+   */
+  uint32_t GetTotalWeight (const RouteVec &routes) const;
+
+  /**
+   * \brief Choose a route among weighted routes.
+   * \param routes the routes
+   * \param value a value in [0, GetTotalWeight (routes))
+   * \return the index of the route
+   */
+  uint32_t SelectWeighted (const RouteVec &routes, uint32_t value) const;
+
+  /**
+   * \brief Choose the route of a packet among equal-cost routes.
+   * \param routes the routes, not empty
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, or 0 if the ports are not known
+   * \return the index of the route
+   */
+  uint32_t SelectRoute (const RouteVec &routes, const Ipv4Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Lookup in the forwarding table for destination.
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, or 0 if the ports are not known
+   * \param oif output interface if any (put 0 otherwise)
+   * \return Ipv4Route to route the packet to reach dest address
+   */
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif = 0);
+
+  HostRoutes m_hostRoutes;             //!< Routes to hosts
+  NetworkRoutes m_networkRoutes;       //!< Routes to networks
+  ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+
+  /// Routes to hosts, by destination, in the order of m_hostRoutes
+  std::unordered_map<Ipv4Address, RouteVec, Ipv4AddressHash> m_hostRouteIndex;
+  NetworkRouteIndex m_networkRouteIndex;    //!< Routes to networks, by destination network
+  NetworkRouteIndex m_ASexternalRouteIndex; //!< External routes, by destination network
+  uint64_t m_nIndexedRoutes;  //!< Number of routes added to the indices so far
+  uint32_t m_nonPrefixRoutes; //!< Number of routes whose network mask is not a prefix; lookups scan the lists if any
+  uint32_t m_routeInputVersion; //!< Version of the routes, see GetRouteInputVersion
+
+  Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
+};
+
+} // Namespace ns3
+
+#endif /* IPV4_GLOBAL_ROUTING_H */
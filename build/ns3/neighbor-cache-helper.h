@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NEIGHBOR_CACHE_HELPER_H
+#define NEIGHBOR_CACHE_HELPER_H
+
+#include <vector>
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/ipv6-interface-container.h"
+
+namespace ns3 {
+
+class Ipv4Interface;
+class Ipv6Interface;
+
+/**
+ * \ingroup internet
+ *
+ * \brief Helper to fill the ARP and NDISC caches before the simulation
+ *
+ * The neighbor caches of the IPv4 and IPv6 interfaces are filled with
+ * permanent entries for all the addresses of the interfaces reachable at
+ * layer 2, i.e., on the same channel or through BridgeNetDevices, so that
+ * no address resolution takes place during the simulation. This removes the
+ * ARP and Neighbor Discovery warm-up from large L2 topologies, e.g. CSMA
+ * LANs or bridged data centers.
+ *
+ * The caches must be populated once the addresses are assigned. As with
+ * static entries, the populated entries are removed when a cache is
+ * flushed, e.g. when the link of a device changes.
+ */
+class NeighborCacheHelper
+{
+public:
+  NeighborCacheHelper ();
+
+  /**
+   * \brief Populate the neighbor caches of all the interfaces of all the nodes
+   */
+  void PopulateNeighborCache (void) const;
+
+  /**
+   * \brief Populate the neighbor caches of the interfaces attached to a channel
+   * \param channel the channel
+   */
+  void PopulateNeighborCache (Ptr<Channel> channel) const;
+
+  /**
+   * \brief Populate the neighbor caches of some IPv4 interfaces
+   * \param c the interfaces
+   */
+  void PopulateNeighborCache (const Ipv4InterfaceContainer &c) const;
+
+  /**
+   * \brief Populate the neighbor caches of some IPv6 interfaces
+   * \param c the interfaces
+   */
+  void PopulateNeighborCache (const Ipv6InterfaceContainer &c) const;
+
+private:
+  /**
+   * \brief Populate the neighbor caches of the interfaces of a device
+   * \param device the device
+   */
+  void PopulateDevice (Ptr<NetDevice> device) const;
+
+  /**
+   * \brief Populate the ARP cache of an IPv4 interface
+   * \param interface the interface
+   */
+  void PopulateArpCache (Ptr<Ipv4Interface> interface) const;
+
+  /**
+   * \brief Populate the NDISC cache of an IPv6 interface
+   * \param interface the interface
+   */
+  void PopulateNdiscCache (Ptr<Ipv6Interface> interface) const;
+
+  /**
+   * \brief Get the devices reachable at layer 2 from a device
+   *
+   * The ports of the bridges are replaced by their BridgeNetDevice.
+   *
+   * \param device the device
+   * \returns the reachable devices
+   */
+  std::vector<Ptr<NetDevice> > GetNeighbors (Ptr<NetDevice> device) const;
+};
+
+} // namespace ns3
+
+#endif /* NEIGHBOR_CACHE_HELPER_H */
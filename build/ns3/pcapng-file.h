@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \brief A class representing a pcapng (pcap next generation) file
+ *
+ * Unlike the classic pcap format, a pcapng file can hold packets captured
+ * on many interfaces, each described by its own Interface Description
+ * Block (IDB) with its own data link type and snap length.  This allows a
+ * whole simulation to be captured in a single file, instead of one file
+ * (and one open file descriptor) per traced device.
+ *
+ * The file is always written in host byte order, with a single section and
+ * nanosecond timestamp resolution on every interface.  Blocks are staged in
+ * an internal buffer and written out in large chunks, optionally through a
+ * gzip or zstd streaming compressor when ns-3 was configured with zlib or
+ * libzstd.
+ *
+ * See https://www.ietf.org/archive/id/draft-tuexen-opsawg-pcapng-05.html
+ */
+class PcapNgFile
+{
+public:
+  /**
+   * Streaming compression applied to the output file.
+   */
+  enum Compression
+  {
+    COMPRESSION_NONE = 0, //!< Plain pcapng
+    COMPRESSION_GZIP,     //!< gzip stream (requires zlib)
+    COMPRESSION_ZSTD      //!< zstd stream (requires libzstd)
+  };
+
+  static const uint32_t SNAPLEN_DEFAULT = 65535; /**< Default value for maximum octets to save per packet */
+  static const uint32_t BUFFER_SIZE = 65536;     /**< Size of the staging buffer, in bytes */
+
+  PcapNgFile ();
+  ~PcapNgFile ();
+
+  /**
+   * \param compression the compression method
+   * \returns true if this build of ns-3 supports the compression method
+   */
+  static bool IsCompressionSupported (Compression compression);
+
+  /**
+   * \return true if the last operation on the underlying file failed, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file and write its Section Header Block.  Any
+   * existing file with the same name is truncated.
+   *
+   * \param filename String containing the name of the file.
+   * \param compression Streaming compression applied to the file.
+   */
+  void Open (std::string const &filename, Compression compression = COMPRESSION_NONE);
+
+  /**
+   * Flush any staged blocks and close the underlying file.
+   */
+  void Close (void);
+
+  /**
+   * Write any staged blocks to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Append an Interface Description Block to the file.
+   *
+   * \param dataLinkType Data link type of the interface, as in classic pcap.
+   * \param snapLen Maximum number of octets saved per packet on this interface.
+   * \param name Interface name (stored in the if_name option), may be empty.
+   * \returns the interface identifier to pass to Write
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen = SNAPLEN_DEFAULT,
+                         std::string const &name = "");
+
+  /**
+   * \returns the number of interfaces declared in this file
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \param interfaceId an interface identifier returned by AddInterface
+   * \returns the data link type of the interface
+   */
+  uint32_t GetDataLinkType (uint32_t interfaceId) const;
+
+  /**
+   * \param interfaceId an interface identifier returned by AddInterface
+   * \returns the snap length of the interface
+   */
+  uint32_t GetSnapLen (uint32_t interfaceId) const;
+
+  /**
+   * \brief Stage a complete Enhanced Packet Block and return the space
+   * reserved for its packet data.
+   *
+   * This lets callers serialize packet contents straight into the staging
+   * buffer, without an intermediate copy.  The returned pointer is only
+   * valid until the next call on this object.
+   *
+   * \param interfaceId interface identifier returned by AddInterface
+   * \param timestamp packet timestamp, in nanoseconds
+   * \param totalLen original length of the packet
+   * \param [out] inclLen number of octets the caller must write (at most
+   * the snap length of the interface)
+   * \returns a pointer to inclLen writable octets
+   */
+  uint8_t * ReservePacket (uint32_t interfaceId, uint64_t timestamp, uint32_t totalLen,
+                           uint32_t &inclLen);
+
+  /**
+   * \brief Write a packet in a single Enhanced Packet Block
+   *
+   * \param interfaceId interface identifier returned by AddInterface
+   * \param timestamp packet timestamp, in nanoseconds
+   * \param data data buffer
+   * \param totalLen total packet length
+   */
+  void Write (uint32_t interfaceId, uint64_t timestamp, uint8_t const *data, uint32_t totalLen);
+
+private:
+  /**
+   * \brief Stage raw bytes in the output buffer.
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void Append (void const *data, uint32_t size);
+  /**
+   * \brief Stage a 32-bit word in the output buffer.
+   * \param value the value to write, in host byte order
+   */
+  void AppendU32 (uint32_t value);
+  /**
+   * \brief Stage zero bytes up to the next 32-bit boundary.
+   * \param length length of the preceding variable-size field
+   */
+  void AppendPadding (uint32_t length);
+  /**
+   * \brief Hand the staged bytes to the file or compressor.
+   * \param data the bytes
+   * \param size the number of bytes
+   */
+  void Emit (uint8_t const *data, uint32_t size);
+
+  /**
+   * \brief A stream buffer which closes the file when it is synchronized.
+   *
+   * The stream which uses it is registered with FatalImpl, so that the
+   * staged blocks are written, and the compressed streams terminated,
+   * before the simulation aborts on a fatal error.
+   */
+  class FatalErrorBuf : public std::streambuf
+  {
+  public:
+    /**
+     * \param file the file to close on a fatal error
+     */
+    FatalErrorBuf (PcapNgFile *file);
+
+  private:
+    /**
+     * \brief Close the file
+     * \return 0
+     */
+    virtual int sync (void);
+
+    PcapNgFile *m_pcapNgFile; //!< The file to close
+  };
+
+  /// Per-interface parameters
+  struct Interface
+  {
+    uint32_t dataLinkType; //!< Data link type
+    uint32_t snapLen;      //!< Maximum captured length
+  };
+
+  std::ofstream m_file;                  //!< Output file (plain and zstd modes)
+  void *m_gzFile;                        //!< zlib gzFile handle, if compressing with gzip
+  void *m_zstdStream;                    //!< ZSTD_CCtx, if compressing with zstd
+  std::vector<uint8_t> m_zstdOut;        //!< zstd output buffer
+  Compression m_compression;             //!< Compression in use
+  bool m_fail;                           //!< Error state
+  std::vector<uint8_t> m_buffer;         //!< Staging buffer
+  std::vector<Interface> m_interfaces;   //!< Declared interfaces
+  FatalErrorBuf m_fatalErrorBuf;         //!< Closes the file on a fatal error
+  std::ostream m_fatalErrorStream;       //!< Stream registered with FatalImpl
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
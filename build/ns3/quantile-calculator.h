@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUANTILE_CALCULATOR_H
+#define QUANTILE_CALCULATOR_H
+
+#include "data-calculator.h"
+#include "data-output-interface.h"
+#include "quantile-sketch.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Calculates the quantiles of a stream of values, in constant memory.
+ *
+ * Besides the moments reported by MinMaxAvgTotalCalculator, this
+ * calculator estimates any quantile of the values with a QuantileSketch,
+ * and outputs the 50th, 90th, 99th and 99.9th percentiles as the
+ * singletons "<key>-p50", "<key>-p90", "<key>-p99" and "<key>-p999".
+ *
+ * Values can be given to Update (), or traced from the "Output" trace
+ * source of a DoubleProbe or a TimeProbe, with TraceSinkDouble ().
+ * Calculators of independent runs can be combined with Merge ().
+ */
+class QuantileCalculator : public DataCalculator,
+                           public StatisticalSummary
+{
+public:
+  QuantileCalculator ();
+  virtual ~QuantileCalculator ();
+
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * Updates the calculator with a value
+   * \param i the value
+   */
+  void Update (const double i);
+  /**
+   * Updates the calculator with the new value of a traced double,
+   * e.g., the output of a probe
+   * \param oldValue the previous value, ignored
+   * \param newValue the value
+   */
+  void TraceSinkDouble (double oldValue, double newValue);
+  /**
+   * Adds the values of another calculator to this one.
+   *
+   * Both calculators must have the same relative accuracy.
+   *
+   * \param other the calculator to merge
+   */
+  void Merge (Ptr<const QuantileCalculator> other);
+  /**
+   * Reinitializes the calculator
+   */
+  void Reset ();
+
+  /**
+   * Estimates a quantile of the values
+   * \param q the quantile, in [0, 1], e.g., 0.99 for the 99th percentile
+   * \return the estimated quantile
+   */
+  double GetQuantile (double q) const;
+  /**
+   * \return the underlying sketch
+   */
+  const QuantileSketch & GetSketch (void) const;
+
+  /**
+   * Outputs the data based on the provided callback
+   * \param callback
+   */
+  virtual void Output (DataOutputCallback &callback) const;
+
+  /**
+   * Returns the count
+   * \return Count
+   */
+  long getCount () const;
+  /**
+   * Returns the sum
+   * \return Total
+   */
+  double getSum () const;
+  /**
+   * Returns the minimum value
+   * \return Min
+   */
+  double getMin () const;
+  /**
+   * Returns the maximum value
+   * \return Max
+   */
+  double getMax () const;
+  /**
+   * Returns the mean value
+   * \return Mean
+   */
+  double getMean () const;
+  /**
+   * Returns the standard deviation
+   * \return Standard deviation
+   */
+  double getStddev () const;
+  /**
+   * Returns the current variance
+   * \return Variance
+   */
+  double getVariance () const;
+  /**
+   * Returns the sum of squares
+   * \return Sum of squares
+   */
+  double getSqrSum () const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * Sets the relative accuracy of the quantiles; the calculator must be empty
+   * \param relativeAccuracy the relative accuracy
+   */
+  void SetRelativeAccuracy (double relativeAccuracy);
+  /**
+   * \return the relative accuracy of the quantiles
+   */
+  double GetRelativeAccuracy (void) const;
+  /**
+   * Sets the maximum number of bins of the sketch; the calculator must be empty
+   * \param maxBins the maximum number of bins
+   */
+  void SetMaxBins (uint32_t maxBins);
+  /**
+   * \return the maximum number of bins of the sketch
+   */
+  uint32_t GetMaxBins (void) const;
+
+  QuantileSketch m_sketch; //!< the quantiles, count, sum, min and max
+  double m_squareTotal;    //!< the sum of squares
+  double m_mean;           //!< the current mean
+  double m_s;              //!< the current sum of squared differences from the mean
+};
+
+} // namespace ns3
+
+#endif /* QUANTILE_CALCULATOR_H */
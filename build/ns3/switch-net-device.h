@@ -0,0 +1,410 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SWITCH_NET_DEVICE_H
+#define SWITCH_NET_DEVICE_H
+
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/queue-item.h"
+#include "ns3/bridge-channel.h"
+#include <stdint.h>
+#include <bitset>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SwitchNetDevice declaration.
+ */
+
+namespace ns3 {
+
+class Node;
+class QueueDisc;
+
+/**
+ * \ingroup bridge
+ * \brief The item a SwitchNetDevice stores in the queue disc of a port
+ *
+ * Besides the destination address and the protocol number, the item stores
+ * the source address and the VLAN of the frame, since frames are forwarded
+ * by calling SendFrom on the port.
+ */
+class SwitchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * \brief Create a switch queue disc item.
+   * \param p the frame included in the created item.
+   * \param source the source MAC address
+   * \param dest the destination MAC address
+   * \param protocol the protocol number
+   * \param vlan the VLAN of the frame
+   */
+  SwitchQueueDiscItem (Ptr<Packet> p, Mac48Address source, Mac48Address dest,
+                       uint16_t protocol, uint16_t vlan);
+
+  virtual ~SwitchQueueDiscItem ();
+
+  /**
+   * \return the source MAC address of the frame
+   */
+  Mac48Address GetSource (void) const;
+
+  /**
+   * \return the VLAN of the frame
+   */
+  uint16_t GetVlan (void) const;
+
+  /**
+   * \brief Do nothing, the frame has no header to add
+   */
+  virtual void AddHeader (void);
+
+  /**
+   * \brief Frames cannot be marked
+   * \return false
+   */
+  virtual bool Mark (void);
+
+  /**
+   * \brief Computes the hash of the addresses and of the VLAN of the frame
+   * \param perturbation hash perturbation value
+   * \return the hash of the addresses and of the VLAN of the frame
+   */
+  virtual uint32_t Hash (uint32_t perturbation = 0) const;
+
+private:
+  Mac48Address m_source;   //!< The source MAC address
+  uint16_t m_vlan;         //!< The VLAN of the frame
+};
+
+/**
+ * \ingroup bridge
+ * \brief a virtual net device that switches frames among many ports
+ *
+ * The SwitchNetDevice is a learning switch, like the BridgeNetDevice,
+ * designed to scale to a large number of ports:
+ *
+ * - the forwarding database is a hash table keyed on the VLAN and the MAC
+ *   address, and the expired entries are removed by a timer wheel of
+ *   AgingSlots slots, rather than when they are looked up;
+ * - each port is an access port of a single VLAN (the port VLAN, 1 by default)
+ *   and may be a tagged member of other VLANs. Frames are only forwarded to the
+ *   ports which are members of their VLAN, and broadcast, multicast and unknown
+ *   unicast frames are flooded to the member ports of their VLAN only. Frames
+ *   sent through a port which is a tagged member of their VLAN carry a VlanTag;
+ * - a QueueDisc may be installed on each port, in which case frames are
+ *   enqueued in the queue disc, which is woken up when the port device queue
+ *   is restarted, as done by the TrafficControlLayer for the devices of an
+ *   IP node;
+ * - a fixed forwarding latency (Latency attribute) may be added to every frame,
+ *   to model the latency of a cut-through switching fabric.
+ *
+ * The frames sent and received by the switch device itself belong to VLAN 1.
+ *
+ * \attention As for the BridgeNetDevice, the Spanning Tree Protocol is not
+ * implemented, hence bridging loops must be avoided.
+ *
+ * \attention Frames are only delivered by the port devices once they have
+ * been fully received, therefore the switch cannot start forwarding a frame
+ * before the end of its reception, as a cut-through switch does. The Latency
+ * attribute only models the delay from the reception of a frame to its
+ * transmission.
+ */
+class SwitchNetDevice : public NetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  SwitchNetDevice ();
+  virtual ~SwitchNetDevice ();
+
+  /// The default VLAN of the ports and the VLAN of the switch device itself
+  static constexpr uint16_t DEFAULT_VLAN = 1;
+
+  /**
+   * \brief Add a port to the switch
+   * \param switchPort the NetDevice to add
+   * \return the index of the port
+   *
+   * The port is an access port of VLAN 1.
+   *
+   * \attention The netdevice that is being added as switch port must
+   * _not_ have an IP address, nor a root queue disc installed by the
+   * TrafficControlHelper. Use SetPortQueueDisc instead.
+   */
+  uint32_t AddSwitchPort (Ptr<NetDevice> switchPort);
+
+  /**
+   * \return the number of ports
+   */
+  uint32_t GetNSwitchPorts (void) const;
+
+  /**
+   * \param n the port index
+   * \return the NetDevice of the n-th port
+   */
+  Ptr<NetDevice> GetSwitchPort (uint32_t n) const;
+
+  /**
+   * \brief Set the VLAN of the untagged frames of a port
+   * \param n the port index
+   * \param vlan the VLAN identifier, from 1 to 4094
+   */
+  void SetPortVlan (uint32_t n, uint16_t vlan);
+
+  /**
+   * \param n the port index
+   * \return the VLAN of the untagged frames of the n-th port
+   */
+  uint16_t GetPortVlan (uint32_t n) const;
+
+  /**
+   * \brief Make a port a tagged member of a VLAN
+   * \param n the port index
+   * \param vlan the VLAN identifier, from 1 to 4094
+   */
+  void AddPortTaggedVlan (uint32_t n, uint16_t vlan);
+
+  /**
+   * \brief Install a queue disc on a port
+   * \param n the port index
+   * \param qdisc the queue disc
+   *
+   * The port device must have a single transmission queue. The queue disc
+   * is initialized along with the switch device.
+   */
+  void SetPortQueueDisc (uint32_t n, Ptr<QueueDisc> qdisc);
+
+  /**
+   * \param n the port index
+   * \return the queue disc installed on the n-th port, if any
+   */
+  Ptr<QueueDisc> GetPortQueueDisc (uint32_t n) const;
+
+  /**
+   * \brief Get the port a MAC address has been learned on
+   * \param address the MAC address
+   * \param vlan the VLAN identifier
+   * \return the NetDevice of the port, or null if the address is not known
+   */
+  Ptr<NetDevice> GetLearnedPort (Mac48Address address, uint16_t vlan = DEFAULT_VLAN) const;
+
+  /**
+   * \return the number of entries of the forwarding database, including the
+   * expired entries which have not been removed by the timer wheel yet
+   */
+  uint32_t GetNFdbEntries (void) const;
+
+  // inherited from NetDevice base class.
+  virtual void SetIfIndex (const uint32_t index);
+  virtual uint32_t GetIfIndex (void) const;
+  virtual Ptr<Channel> GetChannel (void) const;
+  virtual void SetAddress (Address address);
+  virtual Address GetAddress (void) const;
+  virtual bool SetMtu (const uint16_t mtu);
+  virtual uint16_t GetMtu (void) const;
+  virtual bool IsLinkUp (void) const;
+  virtual void AddLinkChangeCallback (Callback<void> callback);
+  virtual bool IsBroadcast (void) const;
+  virtual Address GetBroadcast (void) const;
+  virtual bool IsMulticast (void) const;
+  virtual Address GetMulticast (Ipv4Address multicastGroup) const;
+  virtual bool IsPointToPoint (void) const;
+  virtual bool IsBridge (void) const;
+  virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
+  virtual bool SendFrom (Ptr<Packet> packet, const Address& source, const Address& dest, uint16_t protocolNumber);
+  virtual Ptr<Node> GetNode (void) const;
+  virtual void SetNode (Ptr<Node> node);
+  virtual bool NeedsArp (void) const;
+  virtual void SetReceiveCallback (NetDevice::ReceiveCallback cb);
+  virtual void SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb);
+  virtual bool SupportsSendFrom () const;
+  virtual Address GetMulticast (Ipv6Address addr) const;
+
+protected:
+  virtual void DoDispose (void);
+  virtual void DoInitialize (void);
+
+  /**
+   * \brief Receives a frame from a port.
+   * \param device the originating port
+   * \param packet the received frame
+   * \param protocol the frame protocol (e.g., Ethertype)
+   * \param source the frame source
+   * \param destination the frame destination
+   * \param packetType the frame type (e.g., host, broadcast, etc.)
+   */
+  void ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                          Address const &source, Address const &destination, PacketType packetType);
+
+private:
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   */
+  SwitchNetDevice (const SwitchNetDevice &);
+
+  /**
+   * \brief Copy constructor
+   *
+   * Defined and unimplemented to avoid misuse
+   * \returns
+   */
+  SwitchNetDevice &operator = (const SwitchNetDevice &);
+
+  /// The state of a port
+  struct Port
+  {
+    Ptr<NetDevice> device;          //!< the port device
+    uint16_t vlan;                  //!< the VLAN of the untagged frames
+    std::bitset<4096> tagged;       //!< the VLANs the port is a tagged member of
+    Ptr<QueueDisc> qdisc;           //!< the queue disc of the port, if any
+  };
+
+  /// An entry of the forwarding database
+  struct FdbEntry
+  {
+    uint32_t port;                  //!< the port the address was learned on
+    Time expirationTime;            //!< the time the entry expires
+  };
+
+  /**
+   * \param address the MAC address
+   * \param vlan the VLAN identifier
+   * \return the key of the forwarding database entry
+   */
+  static uint64_t FdbKey (Mac48Address address, uint16_t vlan);
+
+  /**
+   * \brief Add a port to the member list of a VLAN, if it is not there yet
+   * \param n the port index
+   * \param vlan the VLAN identifier
+   */
+  void AddMember (uint32_t n, uint16_t vlan);
+
+  /**
+   * \brief Learn the port a MAC address is sending from
+   * \param source the source address
+   * \param vlan the VLAN of the frame
+   * \param n the index of the port the frame was received on
+   */
+  void Learn (Mac48Address source, uint16_t vlan, uint32_t n);
+
+  /**
+   * \brief Look up the port of a MAC address
+   * \param dest the destination address
+   * \param vlan the VLAN of the frame
+   * \param n set to the index of the port, if the address is known
+   * \return true if the address is known and its entry has not expired
+   */
+  bool Lookup (Mac48Address dest, uint16_t vlan, uint32_t &n) const;
+
+  /**
+   * \brief Insert a key in the timer wheel
+   * \param key the key of the forwarding database entry
+   * \param remaining the time until the entry expires
+   */
+  void InsertInWheel (uint64_t key, Time remaining);
+
+  /**
+   * \brief Advance the timer wheel by a slot and remove the expired entries
+   */
+  void AgingTick (void);
+
+  /**
+   * \brief Forward a frame to the ports of its VLAN or to the learned port
+   * \param in the index of the ingress port, or the number of ports if the
+   *        frame is sent by the switch device itself
+   * \param packet the frame
+   * \param protocol the frame protocol
+   * \param src the frame source
+   * \param dst the frame destination
+   * \param vlan the VLAN of the frame
+   */
+  void Forward (uint32_t in, Ptr<Packet> packet, uint16_t protocol,
+                Mac48Address src, Mac48Address dst, uint16_t vlan);
+
+  /**
+   * \brief Flood a frame to the member ports of its VLAN
+   * \param in the index of the ingress port, which is skipped
+   * \param packet the frame
+   * \param protocol the frame protocol
+   * \param src the frame source
+   * \param dst the frame destination
+   * \param vlan the VLAN of the frame
+   */
+  void Flood (uint32_t in, Ptr<const Packet> packet, uint16_t protocol,
+              Mac48Address src, Mac48Address dst, uint16_t vlan);
+
+  /**
+   * \brief Send a frame through a port after the forwarding latency
+   * \param out the index of the egress port
+   * \param packet the frame
+   * \param protocol the frame protocol
+   * \param src the frame source
+   * \param dst the frame destination
+   * \param vlan the VLAN of the frame
+   */
+  void Output (uint32_t out, Ptr<Packet> packet, uint16_t protocol,
+               Mac48Address src, Mac48Address dst, uint16_t vlan);
+
+  /**
+   * \brief Send a frame through a port, or enqueue it in the queue disc
+   * of the port
+   * \param out the index of the egress port
+   * \param packet the frame
+   * \param protocol the frame protocol
+   * \param src the frame source
+   * \param dst the frame destination
+   * \param vlan the VLAN of the frame
+   */
+  void Transmit (uint32_t out, Ptr<Packet> packet, uint16_t protocol,
+                 Mac48Address src, Mac48Address dst, uint16_t vlan);
+
+  NetDevice::ReceiveCallback m_rxCallback; //!< receive callback
+  NetDevice::PromiscReceiveCallback m_promiscRxCallback; //!< promiscuous receive callback
+
+  Mac48Address m_address; //!< MAC address of the NetDevice
+  Ptr<Node> m_node; //!< node owning this NetDevice
+  Ptr<BridgeChannel> m_channel; //!< virtual bridged channel
+  uint32_t m_ifIndex; //!< Interface index
+  uint16_t m_mtu; //!< MTU of the switch
+  bool m_enableLearning; //!< true if the switch learns the MAC addresses
+  Time m_agingTime; //!< time it takes for a learned address to expire
+  uint32_t m_agingSlots; //!< number of slots of the timer wheel
+  Time m_latency; //!< forwarding latency
+
+  std::vector<Port> m_ports; //!< the ports
+  std::vector<uint32_t> m_portIndex; //!< port index of the port devices, by interface index
+  std::unordered_map<uint16_t, std::vector<uint32_t> > m_vlanPorts; //!< member ports of each VLAN
+  std::unordered_map<uint64_t, FdbEntry> m_fdb; //!< forwarding database
+  std::vector<std::vector<uint64_t> > m_wheel; //!< timer wheel of the forwarding database keys
+  uint32_t m_wheelPos; //!< current slot of the timer wheel
+  EventId m_agingEvent; //!< next tick of the timer wheel
+};
+
+} // namespace ns3
+
+#endif /* SWITCH_NET_DEVICE_H */
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef VLAN_TAG_H
+#define VLAN_TAG_H
+
+#include "ns3/tag.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::VlanTag declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup bridge
+ * \brief The VLAN identifier of a frame sent through a tagged switch port
+ *
+ * This packet tag stands for the IEEE 802.1Q tag of a frame which is sent
+ * through a port of a SwitchNetDevice that is a tagged member of the VLAN
+ * of the frame. The four bytes of the 802.1Q tag are not added to the frame.
+ */
+class VlanTag : public Tag
+{
+public:
+  VlanTag ();
+
+  /**
+   * \brief Constructor
+   * \param vlan the VLAN identifier
+   */
+  VlanTag (uint16_t vlan);
+
+  /**
+   * \brief Set the VLAN identifier
+   * \param vlan the VLAN identifier
+   */
+  void SetVlan (uint16_t vlan);
+
+  /**
+   * \brief Get the VLAN identifier
+   * \returns the VLAN identifier
+   */
+  uint16_t GetVlan (void) const;
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  // inherited function, no need to doc.
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  // inherited function, no need to doc.
+  virtual uint32_t GetSerializedSize (void) const;
+
+  // inherited function, no need to doc.
+  virtual void Serialize (TagBuffer i) const;
+
+  // inherited function, no need to doc.
+  virtual void Deserialize (TagBuffer i);
+
+  // inherited function, no need to doc.
+  virtual void Print (std::ostream &os) const;
+private:
+  uint16_t m_vlan;  //!< the VLAN identifier carried by the tag
+};
+
+} // namespace ns3
+
+#endif /* VLAN_TAG_H */
@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Network topology
+//
+//   fg source                                fg sink
+//             \   1 Gbps           1 Gbps   /
+//              r0 ----------------------- r1
+//             /         100 Mbps           \   bg sink
+//   bg source             10 ms
+//
+// - One foreground flow, and nBackground background flows, all using
+//   BulkSendApplication.
+// - With --fluid, the background flows are represented by a TcpFluidModel
+//   instead of being simulated at the packet level.
+// - The program prints the goodput of the foreground flow, which is close
+//   to its fair share of the bottleneck in both cases, and the wall clock
+//   time of the simulation.
+
+#include <chrono>
+#include <iostream>
+#include "ns3/core-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/network-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpFluidBackgroundExample");
+
+int
+main (int argc, char *argv[])
+{
+  bool fluid = false;
+  uint32_t nBackground = 20;
+  Time simTime = Seconds (10);
+
+  CommandLine cmd (__FILE__);
+  cmd.AddValue ("fluid", "Represent the background flows with the fluid model", fluid);
+  cmd.AddValue ("nBackground", "Number of background flows", nBackground);
+  cmd.AddValue ("simTime", "Simulation time", simTime);
+  cmd.Parse (argc, argv);
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+
+  NodeContainer routers;
+  routers.Create (2);
+  NodeContainer hosts;
+  hosts.Create (4);
+  Ptr<Node> fgSource = hosts.Get (0);
+  Ptr<Node> bgSource = hosts.Get (1);
+  Ptr<Node> fgSink = hosts.Get (2);
+  Ptr<Node> bgSink = hosts.Get (3);
+
+  InternetStackHelper internet;
+  internet.InstallAll ();
+
+  PointToPointHelper access;
+  access.SetDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+  access.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  PointToPointHelper bottleneck;
+  bottleneck.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  bottleneck.SetChannelAttribute ("Delay", StringValue ("10ms"));
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (bottleneck.Install (routers.Get (0), routers.Get (1)));
+  Ipv4InterfaceContainer sinks;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      address.NewNetwork ();
+      Ipv4InterfaceContainer interfaces = address.Assign (access.Install (hosts.Get (i), routers.Get (i / 2)));
+      sinks.Add (interfaces.Get (0));
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  uint16_t port = 5000;
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer fgApps = sinkHelper.Install (fgSink);
+  BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (sinks.GetAddress (2), port));
+  fgApps.Add (source.Install (fgSource));
+  fgApps.Start (Seconds (0.1));
+
+  Ptr<TcpFluidModel> model;
+  if (fluid)
+    {
+      model = CreateObject<TcpFluidModel> ();
+      for (uint32_t i = 0; i < nBackground; i++)
+        {
+          model->AddFlow (bgSource, sinks.GetAddress (3));
+        }
+    }
+  else
+    {
+      ApplicationContainer bgApps = sinkHelper.Install (bgSink);
+      source.SetAttribute ("Remote", AddressValue (InetSocketAddress (sinks.GetAddress (3), port)));
+      for (uint32_t i = 0; i < nBackground; i++)
+        {
+          bgApps.Add (source.Install (bgSource));
+        }
+      bgApps.Start (Seconds (0));
+    }
+
+  auto start = std::chrono::steady_clock::now ();
+  Simulator::Stop (simTime);
+  Simulator::Run ();
+  auto end = std::chrono::steady_clock::now ();
+
+  Ptr<PacketSink> sink = DynamicCast<PacketSink> (fgApps.Get (0));
+  double goodput = sink->GetTotalRx () * 8 / (simTime - Seconds (0.1)).GetSeconds () / 1e6;
+  std::cout << "Background flows: " << nBackground << (fluid ? " (fluid)" : " (packets)") << std::endl;
+  std::cout << "Foreground goodput: " << goodput << " Mbps (fair share "
+            << 100.0 / (nBackground + 1) << " Mbps)" << std::endl;
+  std::cout << "Wall clock time: " << std::chrono::duration<double> (end - start).count () << " s" << std::endl;
+
+  Simulator::Destroy ();
+  if (model)
+    {
+      model->Dispose ();
+    }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "switch-helper.h"
+#include "ns3/log.h"
+#include "ns3/switch-net-device.h"
+#include "ns3/queue-disc.h"
+#include "ns3/node.h"
+#include "ns3/names.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SwitchHelper implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SwitchHelper");
+
+SwitchHelper::SwitchHelper ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_deviceFactory.SetTypeId ("ns3::SwitchNetDevice");
+}
+
+void
+SwitchHelper::SetDeviceAttribute (std::string n1, const AttributeValue &v1)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_deviceFactory.Set (n1, v1);
+}
+
+void
+SwitchHelper::SetQueueDisc (std::string type,
+                            std::string n1, const AttributeValue &v1,
+                            std::string n2, const AttributeValue &v2,
+                            std::string n3, const AttributeValue &v3,
+                            std::string n4, const AttributeValue &v4)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_queueDiscFactory = ObjectFactory ();
+  m_queueDiscFactory.SetTypeId (type);
+  m_queueDiscFactory.Set (n1, v1);
+  m_queueDiscFactory.Set (n2, v2);
+  m_queueDiscFactory.Set (n3, v3);
+  m_queueDiscFactory.Set (n4, v4);
+}
+
+NetDeviceContainer
+SwitchHelper::Install (Ptr<Node> node, NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_LOGIC ("**** Install switch device on node " << node->GetId ());
+
+  NetDeviceContainer devs;
+  Ptr<SwitchNetDevice> dev = m_deviceFactory.Create<SwitchNetDevice> ();
+  devs.Add (dev);
+  node->AddDevice (dev);
+
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      NS_LOG_LOGIC ("**** Add SwitchPort "<< *i);
+      uint32_t n = dev->AddSwitchPort (*i);
+      if (m_queueDiscFactory.IsTypeIdSet ())
+        {
+          dev->SetPortQueueDisc (n, m_queueDiscFactory.Create<QueueDisc> ());
+        }
+    }
+  return devs;
+}
+
+NetDeviceContainer
+SwitchHelper::Install (std::string nodeName, NetDeviceContainer c)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Ptr<Node> node = Names::Find<Node> (nodeName);
+  return Install (node, c);
+}
+
+} // namespace ns3
@@ -0,0 +1,104 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SWITCH_HELPER_H
+#define SWITCH_HELPER_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
+#include <string>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SwitchHelper declaration.
+ */
+
+namespace ns3 {
+
+class Node;
+class AttributeValue;
+
+/**
+ * \ingroup bridge
+ * \brief Add a VLAN-aware learning switch (ns3::SwitchNetDevice) to a node
+ */
+class SwitchHelper
+{
+public:
+  /*
+   * Construct a SwitchHelper
+   */
+  SwitchHelper ();
+  /**
+   * Set an attribute on each ns3::SwitchNetDevice created by
+   * SwitchHelper::Install
+   *
+   * \param n1 the name of the attribute to set
+   * \param v1 the value of the attribute to set
+   */
+  void SetDeviceAttribute (std::string n1, const AttributeValue &v1);
+  /**
+   * Set the type and the attributes of the queue disc installed on each
+   * port of the switch devices created by SwitchHelper::Install. By
+   * default, no queue disc is installed.
+   *
+   * \param type the type of queue disc
+   * \param n1 the name of the attribute to set on the queue disc
+   * \param v1 the value of the attribute to set on the queue disc
+   * \param n2 the name of the attribute to set on the queue disc
+   * \param v2 the value of the attribute to set on the queue disc
+   * \param n3 the name of the attribute to set on the queue disc
+   * \param v3 the value of the attribute to set on the queue disc
+   * \param n4 the name of the attribute to set on the queue disc
+   * \param v4 the value of the attribute to set on the queue disc
+   */
+  void SetQueueDisc (std::string type,
+                     std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                     std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                     std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+                     std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue ());
+  /**
+   * This method creates an ns3::SwitchNetDevice with the attributes
+   * configured by SwitchHelper::SetDeviceAttribute, adds the device
+   * to the node, and attaches the given NetDevices as ports of the
+   * switch, each with a queue disc if SwitchHelper::SetQueueDisc was
+   * called.
+   *
+   * \param node The node to install the device in
+   * \param c Container of NetDevices to add as switch ports
+   * \returns A container holding the added net device.
+   */
+  NetDeviceContainer Install (Ptr<Node> node, NetDeviceContainer c);
+  /**
+   * This method creates an ns3::SwitchNetDevice with the attributes
+   * configured by SwitchHelper::SetDeviceAttribute, adds the device
+   * to the node, and attaches the given NetDevices as ports of the
+   * switch.
+   *
+   * \param nodeName The name of the node to install the device in
+   * \param c Container of NetDevices to add as switch ports
+   * \returns A container holding the added net device.
+   */
+  NetDeviceContainer Install (std::string nodeName, NetDeviceContainer c);
+private:
+  ObjectFactory m_deviceFactory; //!< Object factory of the switch devices
+  ObjectFactory m_queueDiscFactory; //!< Object factory of the queue discs
+};
+
+} // namespace ns3
+
+
+#endif /* SWITCH_HELPER_H */
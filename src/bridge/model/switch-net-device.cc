@@ -0,0 +1,774 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "switch-net-device.h"
+#include "vlan-tag.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/queue-disc.h"
+#include "ns3/net-device-queue-interface.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::SwitchNetDevice implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SwitchNetDevice");
+
+NS_OBJECT_ENSURE_REGISTERED (SwitchNetDevice);
+
+SwitchQueueDiscItem::SwitchQueueDiscItem (Ptr<Packet> p, Mac48Address source, Mac48Address dest,
+                                          uint16_t protocol, uint16_t vlan)
+  : QueueDiscItem (p, dest, protocol),
+    m_source (source),
+    m_vlan (vlan)
+{
+}
+
+SwitchQueueDiscItem::~SwitchQueueDiscItem ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Mac48Address
+SwitchQueueDiscItem::GetSource (void) const
+{
+  return m_source;
+}
+
+uint16_t
+SwitchQueueDiscItem::GetVlan (void) const
+{
+  return m_vlan;
+}
+
+void
+SwitchQueueDiscItem::AddHeader (void)
+{
+}
+
+bool
+SwitchQueueDiscItem::Mark (void)
+{
+  return false;
+}
+
+uint32_t
+SwitchQueueDiscItem::Hash (uint32_t perturbation) const
+{
+  NS_LOG_FUNCTION (this << perturbation);
+
+  uint8_t buf[18];
+  m_source.CopyTo (buf);
+  Mac48Address::ConvertFrom (GetAddress ()).CopyTo (buf + 6);
+  buf[12] = (m_vlan >> 8) & 0xff;
+  buf[13] = m_vlan & 0xff;
+  std::memcpy (buf + 14, &perturbation, 4);
+
+  return Hash32 ((char*) buf, 18);
+}
+
+
+TypeId
+SwitchNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SwitchNetDevice")
+    .SetParent<NetDevice> ()
+    .SetGroupName("Bridge")
+    .AddConstructor<SwitchNetDevice> ()
+    .AddAttribute ("Mtu", "The MAC-level Maximum Transmission Unit",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&SwitchNetDevice::SetMtu,
+                                         &SwitchNetDevice::GetMtu),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("EnableLearning",
+                   "Enable the learning of the MAC addresses",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&SwitchNetDevice::m_enableLearning),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AgingTime",
+                   "Time it takes for a learned MAC address to expire.",
+                   TimeValue (Seconds (300)),
+                   MakeTimeAccessor (&SwitchNetDevice::m_agingTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("AgingSlots",
+                   "The number of slots of the timer wheel removing the expired MAC addresses. "
+                   "Expired addresses are removed at most AgingTime/AgingSlots after they expire.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&SwitchNetDevice::m_agingSlots),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("Latency",
+                   "The time from the reception of a frame to its transmission through a port.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&SwitchNetDevice::m_latency),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+
+SwitchNetDevice::SwitchNetDevice ()
+  : m_node (0),
+    m_ifIndex (0),
+    m_wheelPos (0)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_channel = CreateObject<BridgeChannel> ();
+}
+
+SwitchNetDevice::~SwitchNetDevice()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
+
+void
+SwitchNetDevice::DoDispose ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Simulator::Cancel (m_agingEvent);
+  for (auto& port : m_ports)
+    {
+      if (port.qdisc)
+        {
+          // break the reference cycle between the queue disc and the port
+          // device, unless the port device has been disposed of already
+          Ptr<NetDeviceQueueInterface> ndqi = port.device->GetObject<NetDeviceQueueInterface> ();
+          if (ndqi && ndqi->GetNTxQueues () > 0)
+            {
+              ndqi->GetTxQueue (0)->SetWakeCallback (MakeNullCallback <void> ());
+            }
+          port.qdisc->SetSendCallback (nullptr);
+          port.qdisc->Dispose ();
+          port.qdisc = 0;
+        }
+      port.device = 0;
+    }
+  m_ports.clear ();
+  m_vlanPorts.clear ();
+  m_fdb.clear ();
+  m_wheel.clear ();
+  m_channel = 0;
+  m_node = 0;
+  NetDevice::DoDispose ();
+}
+
+void
+SwitchNetDevice::DoInitialize ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (auto& port : m_ports)
+    {
+      if (port.qdisc)
+        {
+          port.qdisc->Initialize ();
+        }
+    }
+  NetDevice::DoInitialize ();
+}
+
+uint64_t
+SwitchNetDevice::FdbKey (Mac48Address address, uint16_t vlan)
+{
+  uint8_t buf[6];
+  address.CopyTo (buf);
+  uint64_t key = vlan;
+  for (uint8_t i = 0; i < 6; i++)
+    {
+      key = (key << 8) | buf[i];
+    }
+  return key;
+}
+
+void
+SwitchNetDevice::AddMember (uint32_t n, uint16_t vlan)
+{
+  std::vector<uint32_t> &members = m_vlanPorts[vlan];
+  if (std::find (members.begin (), members.end (), n) == members.end ())
+    {
+      members.push_back (n);
+    }
+}
+
+void
+SwitchNetDevice::ReceiveFromDevice (Ptr<NetDevice> incomingPort, Ptr<const Packet> packet, uint16_t protocol,
+                                    Address const &src, Address const &dst, PacketType packetType)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_DEBUG ("UID is " << packet->GetUid ());
+
+  Mac48Address src48 = Mac48Address::ConvertFrom (src);
+  Mac48Address dst48 = Mac48Address::ConvertFrom (dst);
+
+  if (!m_promiscRxCallback.IsNull ())
+    {
+      m_promiscRxCallback (this, packet, protocol, src, dst, packetType);
+    }
+
+  uint32_t in = m_portIndex[incomingPort->GetIfIndex ()];
+  uint16_t vlan = m_ports[in].vlan;
+
+  // the frame is copied once, to remove the VLAN tag
+  Ptr<Packet> frame = packet->Copy ();
+  VlanTag tag;
+  if (frame->RemovePacketTag (tag))
+    {
+      vlan = tag.GetVlan ();
+      if (!m_ports[in].tagged.test (vlan))
+        {
+          NS_LOG_LOGIC ("Port " << in << " is not a member of VLAN " << vlan << ": drop");
+          return;
+        }
+    }
+
+  Learn (src48, vlan, in);
+
+  switch (packetType)
+    {
+    case PACKET_HOST:
+      if (dst48 == m_address && vlan == DEFAULT_VLAN)
+        {
+          m_rxCallback (this, frame, protocol, src);
+        }
+      break;
+
+    case PACKET_BROADCAST:
+    case PACKET_MULTICAST:
+      if (vlan == DEFAULT_VLAN)
+        {
+          m_rxCallback (this, frame, protocol, src);
+        }
+      Flood (in, frame, protocol, src48, dst48, vlan);
+      break;
+
+    case PACKET_OTHERHOST:
+      if (dst48 == m_address)
+        {
+          if (vlan == DEFAULT_VLAN)
+            {
+              m_rxCallback (this, frame, protocol, src);
+            }
+        }
+      else
+        {
+          Forward (in, frame, protocol, src48, dst48, vlan);
+        }
+      break;
+    }
+}
+
+void
+SwitchNetDevice::Forward (uint32_t in, Ptr<Packet> packet, uint16_t protocol,
+                          Mac48Address src, Mac48Address dst, uint16_t vlan)
+{
+  NS_LOG_FUNCTION (this << in << packet << protocol << src << dst << vlan);
+
+  uint32_t out;
+  if (!dst.IsGroup () && Lookup (dst, vlan, out))
+    {
+      if (out != in)
+        {
+          NS_LOG_LOGIC ("Forwarding database says to use port " << out);
+          Output (out, packet, protocol, src, dst, vlan);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Destination is on the ingress port: drop");
+        }
+      return;
+    }
+  NS_LOG_LOGIC ("No learned state: flood to the ports of VLAN " << vlan);
+  Flood (in, packet, protocol, src, dst, vlan);
+}
+
+void
+SwitchNetDevice::Flood (uint32_t in, Ptr<const Packet> packet, uint16_t protocol,
+                        Mac48Address src, Mac48Address dst, uint16_t vlan)
+{
+  NS_LOG_FUNCTION (this << in << packet << protocol << src << dst << vlan);
+
+  auto it = m_vlanPorts.find (vlan);
+  if (it == m_vlanPorts.end ())
+    {
+      return;
+    }
+  for (uint32_t out : it->second)
+    {
+      if (out != in)
+        {
+          Output (out, packet->Copy (), protocol, src, dst, vlan);
+        }
+    }
+}
+
+void
+SwitchNetDevice::Output (uint32_t out, Ptr<Packet> packet, uint16_t protocol,
+                         Mac48Address src, Mac48Address dst, uint16_t vlan)
+{
+  if (m_latency.IsStrictlyPositive ())
+    {
+      Simulator::Schedule (m_latency, &SwitchNetDevice::Transmit, this,
+                           out, packet, protocol, src, dst, vlan);
+    }
+  else
+    {
+      Transmit (out, packet, protocol, src, dst, vlan);
+    }
+}
+
+void
+SwitchNetDevice::Transmit (uint32_t out, Ptr<Packet> packet, uint16_t protocol,
+                           Mac48Address src, Mac48Address dst, uint16_t vlan)
+{
+  NS_LOG_FUNCTION (this << out << packet << protocol << src << dst << vlan);
+
+  Port &port = m_ports[out];
+  if (vlan != port.vlan)
+    {
+      packet->AddPacketTag (VlanTag (vlan));
+    }
+
+  if (port.qdisc)
+    {
+      // as done by the TrafficControlLayer, enqueue the frame and try to
+      // dequeue frames from the queue disc
+      port.qdisc->Enqueue (Create<SwitchQueueDiscItem> (packet, src, dst, protocol, vlan));
+      port.qdisc->Run ();
+    }
+  else
+    {
+      port.device->SendFrom (packet, src, dst, protocol);
+    }
+}
+
+void
+SwitchNetDevice::Learn (Mac48Address source, uint16_t vlan, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << source << vlan << n);
+  if (!m_enableLearning)
+    {
+      return;
+    }
+
+  uint64_t key = FdbKey (source, vlan);
+  auto ret = m_fdb.insert ({key, {n, Simulator::Now () + m_agingTime}});
+  if (!ret.second)
+    {
+      // the key is already in the timer wheel, which reinserts it if the
+      // entry has not expired when its slot is reached
+      ret.first->second.port = n;
+      ret.first->second.expirationTime = Simulator::Now () + m_agingTime;
+      return;
+    }
+
+  if (m_wheel.size () != m_agingSlots && m_fdb.size () == 1)
+    {
+      m_wheel.assign (m_agingSlots, std::vector<uint64_t> ());
+      m_wheelPos = 0;
+    }
+  InsertInWheel (key, m_agingTime);
+
+  if (!m_agingEvent.IsRunning ())
+    {
+      m_agingEvent = Simulator::Schedule (m_agingTime / m_wheel.size (),
+                                          &SwitchNetDevice::AgingTick, this);
+    }
+}
+
+bool
+SwitchNetDevice::Lookup (Mac48Address dest, uint16_t vlan, uint32_t &n) const
+{
+  if (!m_enableLearning)
+    {
+      return false;
+    }
+  auto it = m_fdb.find (FdbKey (dest, vlan));
+  if (it == m_fdb.end () || it->second.expirationTime <= Simulator::Now ())
+    {
+      return false;
+    }
+  n = it->second.port;
+  return true;
+}
+
+void
+SwitchNetDevice::InsertInWheel (uint64_t key, Time remaining)
+{
+  uint32_t nSlots = m_wheel.size ();
+  Time tick = m_agingTime / nSlots;
+  int64_t slots = tick.IsStrictlyPositive () ? (remaining.GetTimeStep () + tick.GetTimeStep () - 1) / tick.GetTimeStep () : 1;
+  slots = std::min<int64_t> (std::max<int64_t> (slots, 1), nSlots - 1);
+  m_wheel[(m_wheelPos + slots) % nSlots].push_back (key);
+}
+
+void
+SwitchNetDevice::AgingTick (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_wheelPos = (m_wheelPos + 1) % m_wheel.size ();
+  std::vector<uint64_t> keys;
+  keys.swap (m_wheel[m_wheelPos]);
+
+  Time now = Simulator::Now ();
+  for (uint64_t key : keys)
+    {
+      auto it = m_fdb.find (key);
+      NS_ASSERT (it != m_fdb.end ());
+      if (it->second.expirationTime <= now)
+        {
+          m_fdb.erase (it);
+        }
+      else
+        {
+          InsertInWheel (key, it->second.expirationTime - now);
+        }
+    }
+  // reuse the memory of the slot
+  keys.clear ();
+  if (m_wheel[m_wheelPos].empty ())
+    {
+      m_wheel[m_wheelPos].swap (keys);
+    }
+
+  NS_LOG_LOGIC ("Forwarding database size: " << m_fdb.size ());
+  if (!m_fdb.empty ())
+    {
+      m_agingEvent = Simulator::Schedule (m_agingTime / m_wheel.size (),
+                                          &SwitchNetDevice::AgingTick, this);
+    }
+}
+
+Ptr<NetDevice>
+SwitchNetDevice::GetLearnedPort (Mac48Address address, uint16_t vlan) const
+{
+  NS_LOG_FUNCTION (this << address << vlan);
+  uint32_t n;
+  if (Lookup (address, vlan, n))
+    {
+      return m_ports[n].device;
+    }
+  return 0;
+}
+
+uint32_t
+SwitchNetDevice::GetNFdbEntries (void) const
+{
+  return m_fdb.size ();
+}
+
+uint32_t
+SwitchNetDevice::GetNSwitchPorts (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ports.size ();
+}
+
+Ptr<NetDevice>
+SwitchNetDevice::GetSwitchPort (uint32_t n) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ports[n].device;
+}
+
+uint32_t
+SwitchNetDevice::AddSwitchPort (Ptr<NetDevice> switchPort)
+{
+  NS_LOG_FUNCTION (this << switchPort);
+  NS_ASSERT (switchPort != this);
+  NS_ASSERT (switchPort->GetNode () == m_node);
+  if (!Mac48Address::IsMatchingType (switchPort->GetAddress ()))
+    {
+      NS_FATAL_ERROR ("Device does not support eui 48 addresses: cannot be added to switch.");
+    }
+  if (!switchPort->SupportsSendFrom ())
+    {
+      NS_FATAL_ERROR ("Device does not support SendFrom: cannot be added to switch.");
+    }
+  if (m_address == Mac48Address ())
+    {
+      m_address = Mac48Address::ConvertFrom (switchPort->GetAddress ());
+    }
+
+  NS_LOG_DEBUG ("RegisterProtocolHandler for " << switchPort->GetInstanceTypeId ().GetName ());
+  m_node->RegisterProtocolHandler (MakeCallback (&SwitchNetDevice::ReceiveFromDevice, this),
+                                   0, switchPort, true);
+
+  uint32_t n = m_ports.size ();
+  m_ports.push_back ({switchPort, DEFAULT_VLAN, std::bitset<4096> (), 0});
+  uint32_t ifIndex = switchPort->GetIfIndex ();
+  if (ifIndex >= m_portIndex.size ())
+    {
+      m_portIndex.resize (ifIndex + 1);
+    }
+  m_portIndex[ifIndex] = n;
+  AddMember (n, DEFAULT_VLAN);
+  m_channel->AddChannel (switchPort->GetChannel ());
+  return n;
+}
+
+void
+SwitchNetDevice::SetPortVlan (uint32_t n, uint16_t vlan)
+{
+  NS_LOG_FUNCTION (this << n << vlan);
+  NS_ABORT_MSG_IF (vlan == 0 || vlan > 4094, "Invalid VLAN identifier " << vlan);
+  NS_ASSERT (n < m_ports.size ());
+
+  uint16_t old = m_ports[n].vlan;
+  m_ports[n].vlan = vlan;
+  if (!m_ports[n].tagged.test (old))
+    {
+      std::vector<uint32_t> &members = m_vlanPorts[old];
+      members.erase (std::remove (members.begin (), members.end (), n), members.end ());
+    }
+  AddMember (n, vlan);
+}
+
+uint16_t
+SwitchNetDevice::GetPortVlan (uint32_t n) const
+{
+  NS_ASSERT (n < m_ports.size ());
+  return m_ports[n].vlan;
+}
+
+void
+SwitchNetDevice::AddPortTaggedVlan (uint32_t n, uint16_t vlan)
+{
+  NS_LOG_FUNCTION (this << n << vlan);
+  NS_ABORT_MSG_IF (vlan == 0 || vlan > 4094, "Invalid VLAN identifier " << vlan);
+  NS_ASSERT (n < m_ports.size ());
+
+  m_ports[n].tagged.set (vlan);
+  AddMember (n, vlan);
+}
+
+void
+SwitchNetDevice::SetPortQueueDisc (uint32_t n, Ptr<QueueDisc> qdisc)
+{
+  NS_LOG_FUNCTION (this << n << qdisc);
+  NS_ASSERT (n < m_ports.size ());
+  NS_ABORT_MSG_IF (m_ports[n].qdisc, "A queue disc is already installed on port " << n);
+
+  Ptr<NetDevice> device = m_ports[n].device;
+  Ptr<NetDeviceQueueInterface> ndqi = device->GetObject<NetDeviceQueueInterface> ();
+  if (ndqi)
+    {
+      NS_ABORT_MSG_IF (ndqi->GetNTxQueues () != 1,
+                       "Queue discs can only be installed on switch ports with a single transmission queue");
+      qdisc->SetNetDeviceQueueInterface (ndqi);
+      ndqi->GetTxQueue (0)->SetWakeCallback (MakeCallback (&QueueDisc::Run, qdisc));
+    }
+  qdisc->SetSendCallback ([device] (Ptr<QueueDiscItem> item)
+                          {
+                            Ptr<SwitchQueueDiscItem> switchItem = StaticCast<SwitchQueueDiscItem> (item);
+                            device->SendFrom (item->GetPacket (), switchItem->GetSource (),
+                                              item->GetAddress (), item->GetProtocol ());
+                          });
+  m_ports[n].qdisc = qdisc;
+
+  if (IsInitialized ())
+    {
+      qdisc->Initialize ();
+    }
+}
+
+Ptr<QueueDisc>
+SwitchNetDevice::GetPortQueueDisc (uint32_t n) const
+{
+  NS_ASSERT (n < m_ports.size ());
+  return m_ports[n].qdisc;
+}
+
+void
+SwitchNetDevice::SetIfIndex (const uint32_t index)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_ifIndex = index;
+}
+
+uint32_t
+SwitchNetDevice::GetIfIndex (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_ifIndex;
+}
+
+Ptr<Channel>
+SwitchNetDevice::GetChannel (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_channel;
+}
+
+void
+SwitchNetDevice::SetAddress (Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_address = Mac48Address::ConvertFrom (address);
+}
+
+Address
+SwitchNetDevice::GetAddress (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_address;
+}
+
+bool
+SwitchNetDevice::SetMtu (const uint16_t mtu)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_mtu = mtu;
+  return true;
+}
+
+uint16_t
+SwitchNetDevice::GetMtu (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_mtu;
+}
+
+bool
+SwitchNetDevice::IsLinkUp (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+void
+SwitchNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{}
+
+bool
+SwitchNetDevice::IsBroadcast (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+Address
+SwitchNetDevice::GetBroadcast (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return Mac48Address ("ff:ff:ff:ff:ff:ff");
+}
+
+bool
+SwitchNetDevice::IsMulticast (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+Address
+SwitchNetDevice::GetMulticast (Ipv4Address multicastGroup) const
+{
+  NS_LOG_FUNCTION (this << multicastGroup);
+  return Mac48Address::GetMulticast (multicastGroup);
+}
+
+bool
+SwitchNetDevice::IsPointToPoint (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return false;
+}
+
+bool
+SwitchNetDevice::IsBridge (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+bool
+SwitchNetDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return SendFrom (packet, m_address, dest, protocolNumber);
+}
+
+bool
+SwitchNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address& dest, uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  // the switch device itself is not a port, hence no port is skipped
+  Forward (m_ports.size (), packet, protocolNumber, Mac48Address::ConvertFrom (src),
+           Mac48Address::ConvertFrom (dest), DEFAULT_VLAN);
+  return true;
+}
+
+Ptr<Node>
+SwitchNetDevice::GetNode (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_node;
+}
+
+void
+SwitchNetDevice::SetNode (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_node = node;
+}
+
+bool
+SwitchNetDevice::NeedsArp (void) const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+void
+SwitchNetDevice::SetReceiveCallback (NetDevice::ReceiveCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_rxCallback = cb;
+}
+
+void
+SwitchNetDevice::SetPromiscReceiveCallback (NetDevice::PromiscReceiveCallback cb)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_promiscRxCallback = cb;
+}
+
+bool
+SwitchNetDevice::SupportsSendFrom () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+Address
+SwitchNetDevice::GetMulticast (Ipv6Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  return Mac48Address::GetMulticast (addr);
+}
+
+} // namespace ns3
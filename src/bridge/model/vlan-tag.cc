@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "vlan-tag.h"
+
+/**
+ * \file
+ * \ingroup bridge
+ * ns3::VlanTag implementation.
+ */
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (VlanTag);
+
+VlanTag::VlanTag ()
+  : m_vlan (0)
+{
+}
+
+VlanTag::VlanTag (uint16_t vlan)
+  : m_vlan (vlan)
+{
+}
+
+void
+VlanTag::SetVlan (uint16_t vlan)
+{
+  m_vlan = vlan;
+}
+
+uint16_t
+VlanTag::GetVlan (void) const
+{
+  return m_vlan;
+}
+
+TypeId
+VlanTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::VlanTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Bridge")
+    .AddConstructor<VlanTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+VlanTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+VlanTag::GetSerializedSize (void) const
+{
+  return sizeof (uint16_t);
+}
+
+void
+VlanTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_vlan);
+}
+
+void
+VlanTag::Deserialize (TagBuffer i)
+{
+  m_vlan = i.ReadU16 ();
+}
+
+void
+VlanTag::Print (std::ostream &os) const
+{
+  os << "VLAN=" << m_vlan;
+}
+
+} // namespace ns3
@@ -0,0 +1,457 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/queue-disc.h"
+#include "ns3/switch-net-device.h"
+#include "ns3/switch-helper.h"
+#include "ns3/vlan-tag.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup bridge
+ * \defgroup bridge-test bridge module tests
+ */
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief Base class of the SwitchNetDevice test cases, which connects hosts
+ * to the ports of switch devices and counts the frames each host sees.
+ */
+class SwitchTestBase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the test case name
+   */
+  SwitchTestBase (std::string name);
+  /**
+   * Send a frame from a host
+   * \param from the index of the sending host
+   * \param to the destination address
+   */
+  void SendFrame (uint32_t from, Mac48Address to);
+
+protected:
+  /**
+   * Create a switch node
+   * \return the switch node
+   */
+  Ptr<Node> CreateSwitchNode (void);
+  /**
+   * Connect a new host to a new port device of a switch node
+   * \param switchNode the switch node
+   * \return the port device
+   */
+  Ptr<NetDevice> AddHost (Ptr<Node> switchNode);
+  /**
+   * Connect two switch nodes by a link
+   * \param a the first switch node
+   * \param b the second switch node
+   * \return the port devices of the link
+   */
+  NetDeviceContainer Connect (Ptr<Node> a, Ptr<Node> b);
+  /**
+   * Get the address of a host
+   * \param i the index of the host
+   * \return the address of the host
+   */
+  Mac48Address GetHostAddress (uint32_t i) const;
+  /**
+   * Receive a frame at a host
+   * \param dev the host device
+   * \param p the frame
+   * \param protocol the protocol number
+   * \param from the source address
+   * \param to the destination address
+   * \param type the packet type
+   */
+  void Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+
+  SimpleNetDeviceHelper m_portHelper;       //!< Helper of the switch port devices
+  std::vector<Ptr<NetDevice> > m_hosts;     //!< The host devices
+  std::vector<uint32_t> m_rx;               //!< The number of frames seen by each host
+  std::vector<Time> m_lastRx;               //!< The time of the last frame seen by each host
+  uint32_t m_rxTagged;                      //!< The number of frames seen with a VLAN tag
+};
+
+SwitchTestBase::SwitchTestBase (std::string name)
+  : TestCase (name),
+    m_rxTagged (0)
+{
+}
+
+Ptr<Node>
+SwitchTestBase::CreateSwitchNode (void)
+{
+  return CreateObject<Node> ();
+}
+
+Ptr<NetDevice>
+SwitchTestBase::AddHost (Ptr<Node> switchNode)
+{
+  Ptr<Node> host = CreateObject<Node> ();
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  SimpleNetDeviceHelper hostHelper;
+  hostHelper.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  Ptr<NetDevice> hostDev = hostHelper.Install (host, channel).Get (0);
+  host->RegisterProtocolHandler (MakeCallback (&SwitchTestBase::Receive, this), 0, hostDev, true);
+  m_hosts.push_back (hostDev);
+  m_rx.push_back (0);
+  m_lastRx.push_back (Seconds (0));
+  return m_portHelper.Install (switchNode, channel).Get (0);
+}
+
+NetDeviceContainer
+SwitchTestBase::Connect (Ptr<Node> a, Ptr<Node> b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devs;
+  devs.Add (m_portHelper.Install (a, channel));
+  devs.Add (m_portHelper.Install (b, channel));
+  return devs;
+}
+
+void
+SwitchTestBase::SendFrame (uint32_t from, Mac48Address to)
+{
+  m_hosts[from]->Send (Create<Packet> (1000), to, 0x0800);
+}
+
+Mac48Address
+SwitchTestBase::GetHostAddress (uint32_t i) const
+{
+  return Mac48Address::ConvertFrom (m_hosts[i]->GetAddress ());
+}
+
+void
+SwitchTestBase::Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol,
+                         const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  for (uint32_t i = 0; i < m_hosts.size (); i++)
+    {
+      if (m_hosts[i] == dev)
+        {
+          m_rx[i]++;
+          m_lastRx[i] = Simulator::Now ();
+        }
+    }
+  VlanTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      m_rxTagged++;
+    }
+}
+
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief Check that unknown unicast frames are flooded and that known
+ * unicast frames are sent to the learned port only.
+ */
+class SwitchLearningTestCase : public SwitchTestBase
+{
+public:
+  SwitchLearningTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SwitchLearningTestCase::SwitchLearningTestCase ()
+  : SwitchTestBase ("Check the learning of the MAC addresses")
+{
+}
+
+void
+SwitchLearningTestCase::DoRun (void)
+{
+  Ptr<Node> sw = CreateSwitchNode ();
+  NetDeviceContainer ports;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      ports.Add (AddHost (sw));
+    }
+  SwitchHelper helper;
+  Ptr<SwitchNetDevice> dev = DynamicCast<SwitchNetDevice> (helper.Install (sw, ports).Get (0));
+
+  // host 1 is not known yet, hence the frame is flooded to hosts 1 and 2
+  Simulator::Schedule (Seconds (1), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+  // host 0 has been learned
+  Simulator::Schedule (Seconds (2), &SwitchTestBase::SendFrame, this, 1, GetHostAddress (0));
+  // host 1 has been learned
+  Simulator::Schedule (Seconds (3), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_rx[0], 1, "Host 0 should only see the frame from host 1");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[1], 2, "Host 1 should see both frames from host 0");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[2], 1, "Host 2 should only see the flooded frame");
+  NS_TEST_EXPECT_MSG_EQ (dev->GetNFdbEntries (), 2, "Two addresses should be learned");
+  NS_TEST_EXPECT_MSG_EQ (dev->GetLearnedPort (GetHostAddress (0)), ports.Get (0), "Wrong port for host 0");
+  NS_TEST_EXPECT_MSG_EQ (dev->GetLearnedPort (GetHostAddress (1)), ports.Get (1), "Wrong port for host 1");
+  NS_TEST_EXPECT_MSG_EQ (dev->GetLearnedPort (GetHostAddress (2)), 0, "Host 2 should not be known");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief Check that frames are only forwarded to the ports of their VLAN,
+ * also across a link between two switches which is a tagged member of a VLAN.
+ */
+class SwitchVlanTestCase : public SwitchTestBase
+{
+public:
+  SwitchVlanTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SwitchVlanTestCase::SwitchVlanTestCase ()
+  : SwitchTestBase ("Check the VLAN-aware forwarding")
+{
+}
+
+void
+SwitchVlanTestCase::DoRun (void)
+{
+  // hosts 0, 1 and 2 are connected to switch A, hosts 3 and 4 to switch B
+  Ptr<Node> a = CreateSwitchNode ();
+  Ptr<Node> b = CreateSwitchNode ();
+  NetDeviceContainer portsA;
+  NetDeviceContainer portsB;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      portsA.Add (AddHost (a));
+    }
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      portsB.Add (AddHost (b));
+    }
+  NetDeviceContainer trunk = Connect (a, b);
+  portsA.Add (trunk.Get (0));
+  portsB.Add (trunk.Get (1));
+
+  SwitchHelper helper;
+  Ptr<SwitchNetDevice> devA = DynamicCast<SwitchNetDevice> (helper.Install (a, portsA).Get (0));
+  Ptr<SwitchNetDevice> devB = DynamicCast<SwitchNetDevice> (helper.Install (b, portsB).Get (0));
+
+  // VLAN 10: hosts 0, 1 and 3. VLAN 20: host 2. VLAN 1: host 4
+  devA->SetPortVlan (0, 10);
+  devA->SetPortVlan (1, 10);
+  devA->SetPortVlan (2, 20);
+  devA->AddPortTaggedVlan (3, 10);
+  devB->SetPortVlan (0, 10);
+  devB->AddPortTaggedVlan (2, 10);
+
+  Mac48Address broadcast = Mac48Address::GetBroadcast ();
+  Simulator::Schedule (Seconds (1), &SwitchTestBase::SendFrame, this, 0, broadcast);
+  Simulator::Schedule (Seconds (2), &SwitchTestBase::SendFrame, this, 2, broadcast);
+  Simulator::Schedule (Seconds (3), &SwitchTestBase::SendFrame, this, 4, broadcast);
+  // host 3 sends to host 0, which has been learned in VLAN 10 by both switches
+  Simulator::Schedule (Seconds (4), &SwitchTestBase::SendFrame, this, 3, GetHostAddress (0));
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_rx[0], 1, "Host 0 should only see the frame from host 3");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[1], 1, "Host 1 should only see the broadcast frame of VLAN 10");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[2], 0, "Host 2 is alone in VLAN 20");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[3], 1, "Host 3 should only see the broadcast frame of VLAN 10");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[4], 0, "Host 4 is alone in VLAN 1");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTagged, 0, "Hosts should not see tagged frames");
+  NS_TEST_EXPECT_MSG_EQ (devB->GetLearnedPort (GetHostAddress (0), 10), trunk.Get (1),
+                         "Host 0 should be learned on the trunk port in VLAN 10");
+  NS_TEST_EXPECT_MSG_EQ (devB->GetLearnedPort (GetHostAddress (0), 1), 0,
+                         "Host 0 should not be learned in VLAN 1");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief Check that the learned addresses expire and that the timer wheel
+ * removes them from the forwarding database.
+ */
+class SwitchAgingTestCase : public SwitchTestBase
+{
+public:
+  SwitchAgingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the forwarding database
+   * \param dev the switch device
+   * \param known whether host 0 should be known
+   * \param entries the expected number of entries
+   */
+  void Check (Ptr<SwitchNetDevice> dev, bool known, uint32_t entries);
+};
+
+SwitchAgingTestCase::SwitchAgingTestCase ()
+  : SwitchTestBase ("Check the aging of the learned MAC addresses")
+{
+}
+
+void
+SwitchAgingTestCase::Check (Ptr<SwitchNetDevice> dev, bool known, uint32_t entries)
+{
+  NS_TEST_EXPECT_MSG_EQ ((dev->GetLearnedPort (GetHostAddress (0)) != 0), known,
+                         "Unexpected state of host 0 at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (dev->GetNFdbEntries (), entries,
+                         "Unexpected number of entries at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+SwitchAgingTestCase::DoRun (void)
+{
+  Ptr<Node> sw = CreateSwitchNode ();
+  NetDeviceContainer ports;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      ports.Add (AddHost (sw));
+    }
+  SwitchHelper helper;
+  helper.SetDeviceAttribute ("AgingTime", TimeValue (Seconds (1)));
+  helper.SetDeviceAttribute ("AgingSlots", UintegerValue (4));
+  Ptr<SwitchNetDevice> dev = DynamicCast<SwitchNetDevice> (helper.Install (sw, ports).Get (0));
+
+  Simulator::Schedule (Seconds (0.1), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+  Simulator::Schedule (Seconds (0.5), &SwitchAgingTestCase::Check, this, dev, true, 1);
+  // the entry is removed at most AgingTime/AgingSlots after it expires
+  Simulator::Schedule (Seconds (1.4), &SwitchAgingTestCase::Check, this, dev, false, 0);
+  // the address is learned again, and refreshed before it expires
+  Simulator::Schedule (Seconds (2), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+  Simulator::Schedule (Seconds (2.8), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+  Simulator::Schedule (Seconds (3.5), &SwitchAgingTestCase::Check, this, dev, true, 1);
+  // the entry has expired, but it has not been removed yet
+  Simulator::Schedule (Seconds (3.9), &SwitchAgingTestCase::Check, this, dev, false, 1);
+  Simulator::Schedule (Seconds (4.1), &SwitchAgingTestCase::Check, this, dev, false, 0);
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief Check that frames are enqueued in the queue discs of the ports and
+ * delayed by the forwarding latency.
+ */
+class SwitchQueueDiscTestCase : public SwitchTestBase
+{
+public:
+  SwitchQueueDiscTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+SwitchQueueDiscTestCase::SwitchQueueDiscTestCase ()
+  : SwitchTestBase ("Check the queue discs of the ports and the forwarding latency")
+{
+}
+
+void
+SwitchQueueDiscTestCase::DoRun (void)
+{
+  // the port devices can only store a frame, hence the frames sent to host 1
+  // by hosts 0 and 2 at the same time are backlogged in the queue disc
+  m_portHelper.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  m_portHelper.SetQueue ("ns3::DropTailQueue", "MaxSize", StringValue ("1p"));
+  Ptr<Node> sw = CreateSwitchNode ();
+  NetDeviceContainer ports;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      ports.Add (AddHost (sw));
+    }
+  SwitchHelper helper;
+  helper.SetDeviceAttribute ("Latency", TimeValue (MicroSeconds (10)));
+  helper.SetQueueDisc ("ns3::FifoQueueDisc");
+  Ptr<SwitchNetDevice> dev = DynamicCast<SwitchNetDevice> (helper.Install (sw, ports).Get (0));
+
+  Simulator::Schedule (Seconds (1), &SwitchTestBase::SendFrame, this, 1, Mac48Address::GetBroadcast ());
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      Simulator::Schedule (Seconds (2), &SwitchTestBase::SendFrame, this, 0, GetHostAddress (1));
+      Simulator::Schedule (Seconds (2), &SwitchTestBase::SendFrame, this, 2, GetHostAddress (1));
+    }
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  // a frame of 1000 bytes is sent in 1 ms at 8 Mbps
+  NS_TEST_EXPECT_MSG_EQ (m_lastRx[0], Seconds (1) + MilliSeconds (2) + MicroSeconds (10),
+                         "The broadcast frame should be delayed by the forwarding latency");
+  NS_TEST_EXPECT_MSG_EQ (m_rx[1], 20, "Host 1 should receive all the frames");
+  NS_TEST_EXPECT_MSG_EQ (m_lastRx[1], Seconds (2) + MilliSeconds (21) + MicroSeconds (10),
+                         "The egress port should be busy for 20 ms");
+
+  QueueDisc::Stats stats = dev->GetPortQueueDisc (1)->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalReceivedPackets, 20, "The frames should go through the queue disc");
+  NS_TEST_EXPECT_MSG_EQ (stats.nTotalDroppedPackets, 0, "No frame should be dropped");
+  NS_TEST_EXPECT_MSG_EQ (dev->GetPortQueueDisc (0)->GetStats ().nTotalReceivedPackets, 1,
+                         "The broadcast frame should go through the queue disc of port 0");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup bridge-test
+ * \ingroup tests
+ *
+ * \brief SwitchNetDevice TestSuite
+ */
+class SwitchNetDeviceTestSuite : public TestSuite
+{
+public:
+  SwitchNetDeviceTestSuite ();
+};
+
+SwitchNetDeviceTestSuite::SwitchNetDeviceTestSuite ()
+  : TestSuite ("switch-net-device", UNIT)
+{
+  AddTestCase (new SwitchLearningTestCase, TestCase::QUICK);
+  AddTestCase (new SwitchVlanTestCase, TestCase::QUICK);
+  AddTestCase (new SwitchAgingTestCase, TestCase::QUICK);
+  AddTestCase (new SwitchQueueDiscTestCase, TestCase::QUICK);
+}
+
+static SwitchNetDeviceTestSuite g_switchNetDeviceTestSuite; //!< Static variable for test initialization
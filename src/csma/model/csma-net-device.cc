@@ -29,6 +29,8 @@
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-item.h"
+#include "ns3/net-device-queue-interface.h"
 #include "ns3/trace-source-accessor.h"
 #include "csma-net-device.h"
 #include "csma-channel.h"
@@ -1048,6 +1050,64 @@ CsmaNetDevice::SupportsSendFrom () const
   return true;
 }
 
+bool
+CsmaNetDevice::SupportsSendBatch () const
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return true;
+}
+
+std::size_t
+CsmaNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (items.size ());
+
+  NS_ASSERT (IsLinkUp ());
+
+  //
+  // Only transmit if send side of net device is enabled
+  //
+  if (IsSendEnabled () == false)
+    {
+      for (auto& item : items)
+        {
+          m_macTxDropTrace (item->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+  std::size_t n;
+  for (n = 0; n < items.size (); n++)
+    {
+      // leave the remaining packets to the queue disc if there is no more room
+      if (ndqi && ndqi->GetTxQueue (0)->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = items[n]->GetPacket ();
+      AddHeader (packet, m_address, Mac48Address::ConvertFrom (items[n]->GetAddress ()),
+                 items[n]->GetProtocol ());
+      m_macTxTrace (packet);
+      if (m_queue->Enqueue (packet) == false)
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  //
+  // Start a transmission once the whole burst is queued, if the device is idle
+  //
+  if (m_txMachineState == READY && m_queue->IsEmpty () == false)
+    {
+      m_currentPkt = m_queue->Dequeue ();
+      m_promiscSnifferTrace (m_currentPkt);
+      m_snifferTrace (m_currentPkt);
+      TransmitStart ();
+    }
+  return n;
+}
+
 int64_t
 CsmaNetDevice::AssignStreams (int64_t stream)
 {
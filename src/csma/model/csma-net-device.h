@@ -326,6 +326,8 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSendBatch (void) const;
+  virtual std::size_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
 
  /**
   * Assign a fixed random variable stream number to the random variables
@@ -22,10 +22,15 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
+#include "ns3/abort.h"
+#include <algorithm>
 #include <fstream>
 #include <sstream>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
+#define MAX_LOSS_WHEEL_SLOTS 1024
 
 namespace ns3 {
 
@@ -53,6 +58,10 @@ FlowMonitor::GetTypeId (void)
                    DoubleValue (0.001),
                    MakeDoubleAccessor (&FlowMonitor::m_delayBinWidth),
                    MakeDoubleChecker <double> ())
+    .AddAttribute ("DelayQuantileAccuracy", ("The relative accuracy of the delay percentiles."),
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&FlowMonitor::m_delayQuantileAccuracy),
+                   MakeDoubleChecker <double> (1e-6, 0.5))
     .AddAttribute ("JitterBinWidth", ("The width used in the jitter histogram."),
                    DoubleValue (0.001),
                    MakeDoubleAccessor (&FlowMonitor::m_jitterBinWidth),
@@ -69,6 +78,16 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("FlowSamplingRate", ("Monitor one flow out of this number, "
+                                        "chosen by a hash of the flow identifier."),
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FlowMonitor::m_flowSamplingRate),
+                   MakeUintegerChecker <uint32_t> (1))
+    .AddAttribute ("PacketSamplingRate", ("Monitor one packet out of this number "
+                                          "in each monitored flow."),
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FlowMonitor::m_packetSamplingRate),
+                   MakeUintegerChecker <uint32_t> (1))
   ;
   return tid;
 }
@@ -80,7 +99,10 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_flowSamplingRate (1),
+    m_packetSamplingRate (1),
+    m_lossWheelNext (0),
+    m_enabled (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -91,12 +113,22 @@ FlowMonitor::DoDispose (void)
   NS_LOG_FUNCTION (this);
   Simulator::Cancel (m_startEvent);
   Simulator::Cancel (m_stopEvent);
+  Simulator::Cancel (m_exportEvent);
+  if (m_exportStream.is_open ())
+    {
+      // the simulation is not destroyed yet
+      Simulator::Cancel (m_exportDestroyEvent);
+      FinishExport ();
+    }
+  m_exportedStats.clear ();
   for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
       iter != m_classifiers.end ();
       iter ++)
     {
       *iter = 0;
     }
+  m_trackedPackets.clear ();
+  m_lossWheel.clear ();
   for (uint32_t i = 0; i < m_flowProbes.size (); i++)
     {
       m_flowProbes[i]->Dispose ();
@@ -109,14 +141,15 @@ inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
   NS_LOG_FUNCTION (this);
-  FlowStatsContainerI iter;
-  iter = m_flowStats.find (flowId);
-  if (iter == m_flowStats.end ())
+  std::unordered_map<FlowId, FlowStats *>::iterator iter;
+  iter = m_flowStatsIndex.find (flowId);
+  if (iter == m_flowStatsIndex.end ())
     {
       FlowMonitor::FlowStats &ref = m_flowStats[flowId];
-      ref.delaySum = Seconds (0);
-      ref.jitterSum = Seconds (0);
-      ref.lastDelay = Seconds (0);
+      m_flowStatsIndex[flowId] = &ref;
+      ref.delaySum = Time (0);
+      ref.jitterSum = Time (0);
+      ref.lastDelay = Time (0);
       ref.txBytes = 0;
       ref.rxBytes = 0;
       ref.txPackets = 0;
@@ -124,6 +157,7 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.lostPackets = 0;
       ref.timesForwarded = 0;
       ref.delayHistogram.SetDefaultBinWidth (m_delayBinWidth);
+      ref.delaySketch = QuantileSketch (m_delayQuantileAccuracy);
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
@@ -131,10 +165,121 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
     }
   else
     {
-      return iter->second;
+      return *iter->second;
+    }
+}
+
+uint64_t
+FlowMonitor::TrackedPacketKey (FlowId flowId, FlowPacketId packetId)
+{
+  return (static_cast<uint64_t> (flowId) << 32) | packetId;
+}
+
+void
+FlowMonitor::LinkTrackedPacket (TrackedPacket &tracked)
+{
+  if (m_lossWheel.empty () || m_lossWheelDelay != m_maxPerHopDelay)
+    {
+      // BuildLossWheel links every tracked packet, including this one
+      BuildLossWheel ();
+      return;
+    }
+  if (m_maxPerHopDelay > Time::Max () - tracked.lastSeenTime)
+    {
+      // the packet is never considered lost
+      tracked.slot = NO_LOSS_SLOT;
+      tracked.prev = 0;
+      tracked.next = 0;
+      return;
+    }
+  Time deadline = tracked.lastSeenTime + m_maxPerHopDelay;
+  int64_t slot = std::max (deadline.GetTimeStep () / PERIODIC_CHECK_INTERVAL.GetTimeStep (),
+                           m_lossWheelNext);
+  tracked.slot = slot % m_lossWheel.size ();
+  tracked.prev = 0;
+  tracked.next = m_lossWheel[tracked.slot];
+  if (tracked.next != 0)
+    {
+      tracked.next->prev = &tracked;
+    }
+  m_lossWheel[tracked.slot] = &tracked;
+}
+
+void
+FlowMonitor::UnlinkTrackedPacket (TrackedPacket &tracked)
+{
+  if (tracked.slot == NO_LOSS_SLOT)
+    {
+      return;
+    }
+  if (tracked.prev != 0)
+    {
+      tracked.prev->next = tracked.next;
+    }
+  else
+    {
+      NS_ASSERT (m_lossWheel[tracked.slot] == &tracked);
+      m_lossWheel[tracked.slot] = tracked.next;
+    }
+  if (tracked.next != 0)
+    {
+      tracked.next->prev = tracked.prev;
+    }
+  tracked.prev = 0;
+  tracked.next = 0;
+}
+
+void
+FlowMonitor::BuildLossWheel ()
+{
+  NS_LOG_FUNCTION (this << m_maxPerHopDelay.As (Time::S));
+  int64_t width = PERIODIC_CHECK_INTERVAL.GetTimeStep ();
+  // the packets are checked at most one slot after their deadline, and the
+  // deadlines are at most MaxPerHopDelay in the future, hence the slots
+  // are never wrapped onto a slot which is not checked yet, unless the
+  // number of slots is capped: the packets are then checked once per turn
+  // of the wheel until their deadline
+  m_lossWheel.assign (std::min (std::max (m_maxPerHopDelay.GetTimeStep (), int64_t (0)) / width + 2,
+                                int64_t (MAX_LOSS_WHEEL_SLOTS)), 0);
+  m_lossWheelNext = Simulator::Now ().GetTimeStep () / width;
+  m_lossWheelDelay = m_maxPerHopDelay;
+  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
+       iter != m_trackedPackets.end (); iter++)
+    {
+      LinkTrackedPacket (iter->second);
     }
 }
 
+void
+FlowMonitor::LosePacket (TrackedPacket &tracked)
+{
+  // packet is considered lost, add it to the loss statistics
+  std::unordered_map<FlowId, FlowStats *>::iterator flow = m_flowStatsIndex.find (tracked.key >> 32);
+  NS_ASSERT (flow != m_flowStatsIndex.end ());
+  flow->second->lostPackets++;
+
+  // we won't track it anymore
+  UnlinkTrackedPacket (tracked);
+  m_trackedPackets.erase (tracked.key);
+}
+
+bool
+FlowMonitor::IsSampled (FlowId flowId, FlowPacketId packetId) const
+{
+  if (m_packetSamplingRate > 1 && packetId % m_packetSamplingRate != 0)
+    {
+      return false;
+    }
+  return m_flowSamplingRate == 1
+         || Hash32 (reinterpret_cast<const char *> (&flowId), sizeof (flowId)) % m_flowSamplingRate == 0;
+}
+
+uint32_t
+FlowMonitor::GetNTrackedPackets () const
+{
+  return m_trackedPackets.size ();
+}
+
 
 void
 FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetId, uint32_t packetSize)
@@ -146,14 +291,22 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  uint64_t key = TrackedPacketKey (flowId, packetId);
+  std::pair<TrackedPacketMap::iterator, bool> inserted = m_trackedPackets.insert (std::make_pair (key, TrackedPacket ()));
+  TrackedPacket &tracked = inserted.first->second;
+  if (!inserted.second)
+    {
+      UnlinkTrackedPacket (tracked);
+    }
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
+  tracked.key = key;
+  LinkTrackedPacket (tracked);
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
 
-  probe->AddPacketStats (flowId, packetSize, Seconds (0));
+  probe->AddPacketStats (flowId, packetSize, Time (0));
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.txBytes += packetSize;
@@ -175,8 +328,7 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
@@ -186,6 +338,8 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
 
   tracked->second.timesForwarded++;
   tracked->second.lastSeenTime = Simulator::Now ();
+  UnlinkTrackedPacket (tracked->second);
+  LinkTrackedPacket (tracked->second);
 
   Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
@@ -201,7 +355,7 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
@@ -215,11 +369,13 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
 
   FlowStats &stats = GetStatsForFlow (flowId);
   stats.delaySum += delay;
-  stats.delayHistogram.AddValue (delay.GetSeconds ());
+  double delaySeconds = delay.GetSeconds ();
+  stats.delayHistogram.AddValue (delaySeconds);
+  stats.delaySketch.Add (delaySeconds);
   if (stats.rxPackets > 0 )
     {
       Time jitter = stats.lastDelay - delay;
-      if (jitter > Seconds (0))
+      if (jitter.IsStrictlyPositive ())
         {
           stats.jitterSum += jitter;
           stats.jitterHistogram.AddValue (jitter.GetSeconds ());
@@ -254,6 +410,7 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
+  UnlinkTrackedPacket (tracked->second);
   m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
 }
 
@@ -281,13 +438,14 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (TrackedPacketKey (flowId, packetId));
   if (tracked != m_trackedPackets.end ())
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
+      UnlinkTrackedPacket (tracked->second);
       m_trackedPackets.erase (tracked);
     }
 }
@@ -303,24 +461,20 @@ void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
   NS_LOG_FUNCTION (this << maxDelay.As (Time::S));
+  if (maxDelay == m_maxPerHopDelay)
+    {
+      CheckForLostPackets ();
+      return;
+    }
   Time now = Simulator::Now ();
 
   for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
        iter != m_trackedPackets.end (); )
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
+      TrackedPacket &tracked = (iter++)->second;
+      if (now - tracked.lastSeenTime >= maxDelay)
         {
-          // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
-
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
-        }
-      else
-        {
-          iter++;
+          LosePacket (tracked);
         }
     }
 }
@@ -328,7 +482,35 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
 void
 FlowMonitor::CheckForLostPackets ()
 {
-  CheckForLostPackets (m_maxPerHopDelay);
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  int64_t current = now.GetTimeStep () / PERIODIC_CHECK_INTERVAL.GetTimeStep ();
+  if (m_trackedPackets.empty ())
+    {
+      m_lossWheelNext = current;
+      return;
+    }
+  if (m_lossWheelDelay != m_maxPerHopDelay)
+    {
+      BuildLossWheel ();
+    }
+  int64_t nSlots = m_lossWheel.size ();
+  // the current slot is checked again next time, since its deadlines are
+  // not all passed yet
+  for (int64_t slot = std::max (m_lossWheelNext, current - nSlots + 1); slot <= current; slot++)
+    {
+      TrackedPacket *tracked = m_lossWheel[slot % nSlots];
+      while (tracked != 0)
+        {
+          TrackedPacket *next = tracked->next;
+          if (now - tracked->lastSeenTime >= m_maxPerHopDelay)
+            {
+              LosePacket (*tracked);
+            }
+          tracked = next;
+        }
+    }
+  m_lossWheelNext = current;
 }
 
 void
@@ -407,6 +589,10 @@ FlowMonitor::StopRightNow ()
     }
   m_enabled = false;
   CheckForLostPackets ();
+  if (m_exportStream.is_open ())
+    {
+      ExportChanges ();
+    }
 }
 
 void
@@ -467,6 +653,7 @@ FlowMonitor::SerializeToXmlStream (std::ostream &os, uint16_t indent, bool enabl
       if (enableHistograms)
         {
           flowI->second.delayHistogram.SerializeToXmlStream (os, indent, "delayHistogram");
+          flowI->second.delaySketch.SerializeToXmlStream (os, indent, "delayQuantiles");
           flowI->second.jitterHistogram.SerializeToXmlStream (os, indent, "jitterHistogram");
           flowI->second.packetSizeHistogram.SerializeToXmlStream (os, indent, "packetSizeHistogram");
           flowI->second.flowInterruptionsHistogram.SerializeToXmlStream (os, indent, "flowInterruptionsHistogram");
@@ -522,6 +709,93 @@ FlowMonitor::SerializeToXmlFile (std::string fileName, bool enableHistograms, bo
   os.close ();
 }
 
+void
+FlowMonitor::EnablePeriodicExport (std::string fileName, Time interval)
+{
+  NS_LOG_FUNCTION (this << fileName << interval.As (Time::S));
+  NS_ABORT_MSG_UNLESS (interval.IsStrictlyPositive (), "The export interval must be positive");
+  Simulator::Cancel (m_exportEvent);
+  if (m_exportStream.is_open ())
+    {
+      Simulator::Cancel (m_exportDestroyEvent);
+      FinishExport ();
+    }
+  m_exportStream.open (fileName.c_str (), std::ios::out|std::ios::trunc);
+  NS_ABORT_MSG_UNLESS (m_exportStream.is_open (), "Could not open the export file " << fileName);
+  m_exportStream << "time,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,"
+                 << "timesForwarded,delaySum,jitterSum\n";
+  m_exportedStats.clear ();
+  m_exportInterval = interval;
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+  m_exportDestroyEvent = Simulator::ScheduleDestroy (&FlowMonitor::FinishExport, this);
+}
+
+void
+FlowMonitor::PeriodicExport ()
+{
+  NS_LOG_FUNCTION (this);
+  ExportChanges ();
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::FinishExport ()
+{
+  NS_LOG_FUNCTION (this);
+  ExportChanges ();
+  m_exportStream.close ();
+}
+
+void
+FlowMonitor::ExportChanges ()
+{
+  NS_LOG_FUNCTION (this);
+  CheckForLostPackets ();
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      std::pair<std::unordered_map<FlowId, ExportedStats>::iterator, bool> inserted
+        = m_exportedStats.insert (std::make_pair (flowI->first, ExportedStats ()));
+      ExportedStats &last = inserted.first->second;
+      if (inserted.second)
+        {
+          last.txBytes = 0;
+          last.rxBytes = 0;
+          last.txPackets = 0;
+          last.rxPackets = 0;
+          last.lostPackets = 0;
+          last.timesForwarded = 0;
+          last.delaySum = Time (0);
+          last.jitterSum = Time (0);
+        }
+      if (stats.txPackets == last.txPackets && stats.rxPackets == last.rxPackets
+          && stats.lostPackets == last.lostPackets)
+        {
+          continue;
+        }
+      m_exportStream << now << ',' << flowI->first
+                     << ',' << stats.txBytes - last.txBytes
+                     << ',' << stats.rxBytes - last.rxBytes
+                     << ',' << stats.txPackets - last.txPackets
+                     << ',' << stats.rxPackets - last.rxPackets
+                     << ',' << stats.lostPackets - last.lostPackets
+                     << ',' << stats.timesForwarded - last.timesForwarded
+                     << ',' << (stats.delaySum - last.delaySum).GetNanoSeconds ()
+                     << ',' << (stats.jitterSum - last.jitterSum).GetNanoSeconds ()
+                     << '\n';
+      last.txBytes = stats.txBytes;
+      last.rxBytes = stats.rxBytes;
+      last.txPackets = stats.txPackets;
+      last.rxPackets = stats.rxPackets;
+      last.lostPackets = stats.lostPackets;
+      last.timesForwarded = stats.timesForwarded;
+      last.delaySum = stats.delaySum;
+      last.jitterSum = stats.jitterSum;
+    }
+  m_exportStream.flush ();
+}
+
 
 } // namespace ns3
 
@@ -23,12 +23,15 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
 #include "ns3/flow-probe.h"
 #include "ns3/flow-classifier.h"
 #include "ns3/histogram.h"
+#include "ns3/quantile-sketch.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
 
@@ -46,6 +49,15 @@ namespace ns3 {
  * The FlowMonitor class is responsible for coordinating efforts
  * regarding probes, and collects end-to-end flow statistics.
  *
+ * The packets in transit are stored in a hash table, and they are linked
+ * to the slots of a timer wheel by the time they are to be considered lost,
+ * so that the periodic check for lost packets only visits the packets that
+ * are lost (or about to be).
+ *
+ * The monitoring can be limited to a sample of the flows (FlowSamplingRate
+ * attribute) and to a sample of the packets of each flow (PacketSamplingRate
+ * attribute). The probes do not report the packets which are not sampled,
+ * hence the statistics only account for the sampled packets.
  */
 class FlowMonitor : public Object
 {
@@ -112,6 +124,9 @@ public:
 
     /// Histogram of the packet delays
     Histogram delayHistogram;
+    /// Percentiles of the packet delays, in seconds, estimated in
+    /// constant memory
+    QuantileSketch delaySketch;
     /// Histogram of the packet jitters
     Histogram jitterHistogram;
     /// Histogram of the packet sizes
@@ -203,6 +218,20 @@ public:
   void ReportDrop (Ptr<FlowProbe> probe, FlowId flowId, FlowPacketId packetId,
                    uint32_t packetSize, uint32_t reasonCode);
 
+  /// FlowProbe implementations are supposed to call this method before
+  /// reporting that a new packet was transmitted, and to neither report
+  /// nor tag the packets which are not sampled.  A flow is sampled if the
+  /// hash of its identifier is a multiple of FlowSamplingRate, and a packet
+  /// of a sampled flow is sampled if its identifier is a multiple of
+  /// PacketSamplingRate.
+  /// \param flowId flow identification
+  /// \param packetId Packet ID
+  /// \return true if the packet is to be monitored
+  bool IsSampled (FlowId flowId, FlowPacketId packetId) const;
+
+  /// \return the number of packets in transit which are currently tracked
+  uint32_t GetNTrackedPackets () const;
+
   /// Check right now for packets that appear to be lost
   void CheckForLostPackets ();
 
@@ -258,6 +287,18 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Append periodically to a CSV file the changes of the statistics of
+  /// each flow since the previous period.  The file has the columns
+  /// time, flowId, txBytes, rxBytes, txPackets, rxPackets, lostPackets,
+  /// timesForwarded, delaySum and jitterSum, where the times are in
+  /// nanoseconds, and it has a line per period for each flow whose
+  /// statistics changed.  The file is flushed after every period.  The
+  /// changes of the last, partial period are exported when the monitor is
+  /// stopped or disposed, or when the simulation is destroyed.
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the export period
+  void EnablePeriodicExport (std::string fileName, Time interval);
+
 
 protected:
 
@@ -272,15 +313,36 @@ private:
     Time firstSeenTime; //!< absolute time when the packet was first seen by a probe
     Time lastSeenTime; //!< absolute time when the packet was last seen by a probe
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
+    uint64_t key; //!< key of the packet in the map of the tracked packets
+    TrackedPacket *prev; //!< previous packet in the same slot of the loss wheel
+    TrackedPacket *next; //!< next packet in the same slot of the loss wheel
+    uint32_t slot; //!< slot of the loss wheel, or NO_LOSS_SLOT
   };
 
+  /// The slot of the packets which are never considered lost, i.e., when
+  /// MaxPerHopDelay is too large for their deadline to be represented
+  static const uint32_t NO_LOSS_SLOT = 0xffffffff;
+
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
+  /// FlowId --> FlowStats, for the per packet lookups
+  std::unordered_map<FlowId, FlowStats *> m_flowStatsIndex;
 
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef std::unordered_map<uint64_t, TrackedPacket> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
+  uint32_t m_flowSamplingRate; //!< One flow out of this number is monitored
+  uint32_t m_packetSamplingRate; //!< One packet out of this number is monitored
+
+  /// Heads of the lists of the tracked packets in each slot of the loss
+  /// wheel. The slots are PERIODIC_CHECK_INTERVAL wide, and a packet is in
+  /// the slot of the time it is to be considered lost. The number of slots
+  /// is capped, and the packets to be considered lost after a full turn of
+  /// the wheel are checked once per turn
+  std::vector<TrackedPacket *> m_lossWheel;
+  int64_t m_lossWheelNext; //!< First slot (not wrapped) not yet checked
+  Time m_lossWheelDelay; //!< The MaxPerHopDelay the loss wheel is built for
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
   // note: this is needed only for serialization
@@ -288,8 +350,29 @@ private:
 
   EventId m_startEvent;     //!< Start event
   EventId m_stopEvent;      //!< Stop event
+
+  /// The flow statistics at the last periodic export
+  struct ExportedStats
+  {
+    uint64_t txBytes; //!< Transmitted bytes
+    uint64_t rxBytes; //!< Received bytes
+    uint32_t txPackets; //!< Transmitted packets
+    uint32_t rxPackets; //!< Received packets
+    uint32_t lostPackets; //!< Lost packets
+    uint32_t timesForwarded; //!< Times the received packets were forwarded
+    Time delaySum; //!< Sum of the delays
+    Time jitterSum; //!< Sum of the jitters
+  };
+  /// FlowId --> ExportedStats
+  std::unordered_map<FlowId, ExportedStats> m_exportedStats;
+  std::ofstream m_exportStream; //!< The periodic export file
+  Time m_exportInterval;        //!< The periodic export interval
+  EventId m_exportEvent;        //!< The periodic export event
+  EventId m_exportDestroyEvent; //!< The export of the last changes when the simulation is destroyed
+
   bool m_enabled;           //!< FlowMon is enabled
   double m_delayBinWidth;   //!< Delay bin width (for histograms)
+  double m_delayQuantileAccuracy; //!< Relative accuracy of the delay percentiles
   double m_jitterBinWidth;  //!< Jitter bin width (for histograms)
   double m_packetSizeBinWidth;  //!< packet size bin width (for histograms)
   double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
@@ -302,6 +385,39 @@ private:
 
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// Periodic function to export the changes of the flow statistics
+  void PeriodicExport ();
+
+  /// Export the last changes of the flow statistics, and close the export file
+  void FinishExport ();
+
+  /// Append to the export file the changes of the flow statistics since
+  /// they were last exported
+  void ExportChanges ();
+
+  /// Compute the key of a tracked packet
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet ID
+  /// \returns the key of the packet in the map of the tracked packets
+  static uint64_t TrackedPacketKey (FlowId flowId, FlowPacketId packetId);
+
+  /// Link a tracked packet to the slot of the loss wheel of the time it is
+  /// to be considered lost
+  /// \param tracked the tracked packet
+  void LinkTrackedPacket (TrackedPacket &tracked);
+
+  /// Unlink a tracked packet from its slot of the loss wheel
+  /// \param tracked the tracked packet
+  void UnlinkTrackedPacket (TrackedPacket &tracked);
+
+  /// Build the loss wheel for the current MaxPerHopDelay and link all the
+  /// tracked packets to it
+  void BuildLossWheel ();
+
+  /// Account a tracked packet as lost and stop tracking it
+  /// \param tracked the tracked packet
+  void LosePacket (TrackedPacket &tracked);
 };
 
 
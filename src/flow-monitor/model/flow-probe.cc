@@ -79,7 +79,7 @@ FlowProbe::AddPacketDropStats (FlowId flowId, uint32_t packetSize, uint32_t reas
 FlowProbe::Stats
 FlowProbe::GetStats () const 
 {
-  return m_stats;
+  return Stats (m_stats.begin (), m_stats.end ());
 }
 
 void
@@ -89,7 +89,8 @@ FlowProbe::SerializeToXmlStream (std::ostream &os, uint16_t indent, uint32_t ind
 
   indent += 2;
 
-  for (Stats::const_iterator iter = m_stats.begin (); iter != m_stats.end (); iter++)
+  Stats stats = GetStats ();
+  for (Stats::const_iterator iter = stats.begin (); iter != stats.end (); iter++)
     {
       os << std::string ( indent, ' ' );
       os << "<FlowStats "
@@ -22,6 +22,7 @@
 #define FLOW_PROBE_H
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "ns3/object.h"
@@ -104,7 +105,7 @@ public:
 
 protected:
   Ptr<FlowMonitor> m_flowMonitor; //!< the FlowMonitor instance
-  Stats m_stats; //!< The flow stats
+  std::unordered_map<FlowId, FlowStats> m_stats; //!< The flow stats
 
 };
 
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "ns3/ipv4-header.h"
 #include "ns3/flow-classifier.h"
@@ -92,12 +94,34 @@ public:
 
 private:
 
+  /// Hash function of the FiveTuple
+  class FiveTupleHash
+  {
+  public:
+    /// Hash function
+    /// \param tuple the FiveTuple
+    /// \return the hash of the tuple
+    std::size_t operator() (const FiveTuple &tuple) const;
+  };
+
+  /// Per flow data
+  struct FlowInfo
+  {
+    FiveTuple tuple;            //!< The flow tuple
+    FlowPacketId lastPacketId;  //!< The identifier of the last packet of the flow
+    /// (DSCP value, packet count) pairs, sorted by DSCP value
+    std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscpCounts;
+  };
+
+  /// Get the data of a flow
+  /// \param flowId the FlowId
+  /// \return the flow data, or null if the flow is unknown
+  const FlowInfo * GetFlowInfo (FlowId flowId) const;
+
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// Flow data, indexed by FlowId - 1
+  std::vector<FlowInfo> m_flows;
 
 };
 
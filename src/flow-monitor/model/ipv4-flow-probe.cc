@@ -308,6 +308,11 @@ Ipv4FlowProbe::SendOutgoingLogger (const Ipv4Header &ipHeader, Ptr<const Packet>
 
   if (m_classifier->Classify (ipHeader, ipPayload, &flowId, &packetId))
     {
+      if (!m_flowMonitor->IsSampled (flowId, packetId))
+        {
+          NS_LOG_DEBUG ("Packet (flowId=" << flowId << ", packetId=" << packetId << ") not sampled");
+          return;
+        }
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportFirstTx ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<"); "
                                      << ipHeader << *ipPayload);
@@ -436,6 +441,10 @@ Ipv4FlowProbe::DropLogger (const Ipv4Header &ipHeader, Ptr<const Packet> ipPaylo
           myReason = DROP_FRAGMENT_TIMEOUT;
           NS_LOG_DEBUG ("DROP_FRAGMENT_TIMEOUT");
           break;
+        case Ipv4L3Protocol::DROP_FRAGMENT_BUFFER_FULL:
+          myReason = DROP_FRAGMENT_BUFFER_FULL;
+          NS_LOG_DEBUG ("DROP_FRAGMENT_BUFFER_FULL");
+          break;
 
         default:
           myReason = DROP_INVALID_REASON;
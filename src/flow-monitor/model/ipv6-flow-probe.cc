@@ -263,6 +263,11 @@ Ipv6FlowProbe::SendOutgoingLogger (const Ipv6Header &ipHeader, Ptr<const Packet>
 
   if (m_classifier->Classify (ipHeader, ipPayload, &flowId, &packetId))
     {
+      if (!m_flowMonitor->IsSampled (flowId, packetId))
+        {
+          NS_LOG_DEBUG ("Packet (flowId=" << flowId << ", packetId=" << packetId << ") not sampled");
+          return;
+        }
       uint32_t size = (ipPayload->GetSize () + ipHeader.GetSerializedSize ());
       NS_LOG_DEBUG ("ReportFirstTx ("<<this<<", "<<flowId<<", "<<packetId<<", "<<size<<"); "
                                      << ipHeader << *ipPayload);
@@ -381,6 +386,10 @@ Ipv6FlowProbe::DropLogger (const Ipv6Header &ipHeader, Ptr<const Packet> ipPaylo
           myReason = DROP_FRAGMENT_TIMEOUT;
           NS_LOG_DEBUG ("DROP_FRAGMENT_TIMEOUT");
           break;
+        case Ipv6L3Protocol::DROP_FRAGMENT_BUFFER_FULL:
+          myReason = DROP_FRAGMENT_BUFFER_FULL;
+          NS_LOG_DEBUG ("DROP_FRAGMENT_BUFFER_FULL");
+          break;
         default:
           myReason = DROP_INVALID_REASON;
           NS_FATAL_ERROR ("Unexpected drop reason code " << reason);
@@ -83,6 +83,7 @@ public:
     DROP_MALFORMED_HEADER, /**< Malformed header */
 
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout exceeded */
+    DROP_FRAGMENT_BUFFER_FULL, /**< Fragment reassembly buffer full */
 
     DROP_INVALID_REASON, /**< Fallback reason (no known reason) */
   };
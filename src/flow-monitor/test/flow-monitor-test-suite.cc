@@ -0,0 +1,464 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/udp-header.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include <fstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor
+ * \defgroup flow-monitor-test flow-monitor module tests
+ */
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief A FlowProbe which is driven directly by the test cases
+ */
+class FlowMonitorTestProbe : public FlowProbe
+{
+public:
+  /**
+   * Constructor
+   * \param monitor the FlowMonitor the probe reports to
+   */
+  FlowMonitorTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets which are not received are accounted as
+ * lost after MaxPerHopDelay, and that the tracked packets are released.
+ */
+class FlowMonitorLossTestCase : public TestCase
+{
+public:
+  FlowMonitorLossTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the number of tracked packets and of lost packets of a flow
+   * \param tracked the expected number of tracked packets
+   * \param flowId the flow
+   * \param lost the expected number of lost packets of the flow
+   */
+  void CheckLost (uint32_t tracked, FlowId flowId, uint32_t lost);
+  /**
+   * Set the MaxPerHopDelay attribute of the FlowMonitor
+   * \param delay the delay
+   */
+  void SetMaxPerHopDelay (Time delay);
+
+  Ptr<FlowMonitor> m_monitor; //!< The FlowMonitor under test
+};
+
+FlowMonitorLossTestCase::FlowMonitorLossTestCase ()
+  : TestCase ("Check the detection of the lost packets")
+{
+}
+
+void
+FlowMonitorLossTestCase::CheckLost (uint32_t tracked, FlowId flowId, uint32_t lost)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_monitor->GetNTrackedPackets (), tracked,
+                         "Unexpected number of tracked packets at " << Simulator::Now ().As (Time::S));
+  FlowMonitor::FlowStatsContainer stats = m_monitor->GetFlowStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats[flowId].lostPackets, lost,
+                         "Unexpected number of lost packets of flow " << flowId
+                         << " at " << Simulator::Now ().As (Time::S));
+}
+
+void
+FlowMonitorLossTestCase::SetMaxPerHopDelay (Time delay)
+{
+  m_monitor->SetAttribute ("MaxPerHopDelay", TimeValue (delay));
+}
+
+void
+FlowMonitorLossTestCase::DoRun (void)
+{
+  m_monitor = CreateObject<FlowMonitor> ();
+  m_monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (2)));
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (m_monitor);
+
+  // packet 0 of flow 1 is never seen again, and it is lost at 2.5s;
+  // packet 1 of flow 1 is forwarded at 1.2s, and it is lost at 3.2s
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, m_monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, m_monitor, probe, 1, 1, 100);
+  Simulator::Schedule (Seconds (1.2), &FlowMonitor::ReportForwarding, m_monitor, probe, 1, 1, 100);
+  // the packet of flow 2 is received
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, m_monitor, probe, 2, 0, 100);
+  Simulator::Schedule (Seconds (1.5), &FlowMonitor::ReportLastRx, m_monitor, probe, 2, 0, 100);
+
+  Simulator::Schedule (Seconds (2.4), &FlowMonitorLossTestCase::CheckLost, this, 2, 1, 0);
+  Simulator::Schedule (Seconds (3.1), &FlowMonitorLossTestCase::CheckLost, this, 1, 1, 1);
+  Simulator::Schedule (Seconds (4.1), &FlowMonitorLossTestCase::CheckLost, this, 0, 1, 2);
+  Simulator::Schedule (Seconds (4.1), &FlowMonitorLossTestCase::CheckLost, this, 0, 2, 0);
+
+  // an explicit check with another delay
+  Simulator::Schedule (Seconds (4.5), &FlowMonitor::ReportFirstTx, m_monitor, probe, 3, 0, 100);
+  Simulator::Schedule (Seconds (4.8), static_cast<void (FlowMonitor::*) (Time)> (&FlowMonitor::CheckForLostPackets),
+                       m_monitor, Seconds (0.1));
+  Simulator::Schedule (Seconds (4.8), &FlowMonitorLossTestCase::CheckLost, this, 0, 3, 1);
+
+  // a change of MaxPerHopDelay applies to the packets already tracked
+  Simulator::Schedule (Seconds (5), &FlowMonitor::ReportFirstTx, m_monitor, probe, 4, 0, 100);
+  Simulator::Schedule (Seconds (5.1), &FlowMonitorLossTestCase::SetMaxPerHopDelay, this, Seconds (0.5));
+  Simulator::Schedule (Seconds (5.9), &FlowMonitorLossTestCase::CheckLost, this, 1, 4, 0);
+  Simulator::Schedule (Seconds (6.1), &FlowMonitorLossTestCase::CheckLost, this, 0, 4, 1);
+
+  Simulator::Stop (Seconds (7));
+  Simulator::Run ();
+
+  FlowMonitor::FlowStatsContainer stats = m_monitor->GetFlowStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats[1].txPackets, 2, "Two packets of flow 1 were sent");
+  NS_TEST_EXPECT_MSG_EQ (stats[1].timesForwarded, 0, "The forwarding of lost packets is not counted");
+  NS_TEST_EXPECT_MSG_EQ (stats[2].rxPackets, 1, "The packet of flow 2 was received");
+  NS_TEST_EXPECT_MSG_EQ (stats[2].delaySketch.GetCount (), 1, "The delay of flow 2 was measured once");
+  NS_TEST_EXPECT_MSG_EQ_TOL (stats[2].delaySketch.GetQuantile (0.99), 1, 1e-9, "Wrong delay percentile of flow 2");
+
+  m_monitor = 0;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check the detection of the lost packets with a MaxPerHopDelay
+ * longer than the loss wheel, or infinite.
+ */
+class FlowMonitorLongDelayTestCase : public TestCase
+{
+public:
+  FlowMonitorLongDelayTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Check the number of lost packets of a flow
+   * \param monitor the FlowMonitor
+   * \param flowId the flow
+   * \param lost the expected number of lost packets of the flow
+   */
+  void CheckLost (Ptr<FlowMonitor> monitor, FlowId flowId, uint32_t lost);
+};
+
+FlowMonitorLongDelayTestCase::FlowMonitorLongDelayTestCase ()
+  : TestCase ("Check the detection of the lost packets with a long MaxPerHopDelay")
+{
+}
+
+void
+FlowMonitorLongDelayTestCase::CheckLost (Ptr<FlowMonitor> monitor, FlowId flowId, uint32_t lost)
+{
+  FlowMonitor::FlowStatsContainer stats = monitor->GetFlowStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats[flowId].lostPackets, lost,
+                         "Unexpected number of lost packets of flow " << flowId
+                         << " at " << Simulator::Now ().As (Time::S));
+}
+
+void
+FlowMonitorLongDelayTestCase::DoRun (void)
+{
+  // the packet of the first monitor goes around the loss wheel before being lost
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (2000)));
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (1500), &FlowMonitorLongDelayTestCase::CheckLost, this, monitor, 1, 0);
+  Simulator::Schedule (Seconds (2000.1), &FlowMonitorLongDelayTestCase::CheckLost, this, monitor, 1, 0);
+  Simulator::Schedule (Seconds (2001.1), &FlowMonitorLongDelayTestCase::CheckLost, this, monitor, 1, 1);
+
+  // the packet of the second monitor is never lost, however late it is received
+  Ptr<FlowMonitor> never = CreateObject<FlowMonitor> ();
+  never->SetAttribute ("MaxPerHopDelay", TimeValue (Time::Max ()));
+  Ptr<FlowProbe> neverProbe = CreateObject<FlowMonitorTestProbe> (never);
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, never, neverProbe, 1, 0, 100);
+  Simulator::Schedule (Seconds (1), &FlowMonitor::ReportForwarding, never, neverProbe, 1, 0, 100);
+  Simulator::Schedule (Seconds (2001.5), &FlowMonitor::ReportLastRx, never, neverProbe, 1, 0, 100);
+
+  Simulator::Stop (Seconds (2002));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (monitor->GetNTrackedPackets (), 0, "The lost packet is still tracked");
+  NS_TEST_EXPECT_MSG_EQ (never->GetNTrackedPackets (), 0, "The received packet is still tracked");
+  CheckLost (never, 1, 0);
+  NS_TEST_EXPECT_MSG_EQ (never->GetFlowStats ().at (1).rxPackets, 1, "The packet was received");
+  NS_TEST_EXPECT_MSG_EQ (never->GetFlowStats ().at (1).timesForwarded, 1, "The packet was forwarded once");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check the periodic export of the changes of the flow statistics,
+ * including the last changes when the monitor is disposed or when the
+ * simulation is destroyed.
+ */
+class FlowMonitorExportTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param dispose whether the monitor is disposed before the simulation is destroyed
+   */
+  FlowMonitorExportTestCase (bool dispose);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_dispose; //!< Whether the monitor is disposed before the simulation is destroyed
+};
+
+FlowMonitorExportTestCase::FlowMonitorExportTestCase (bool dispose)
+  : TestCase (dispose ? "Check the periodic export of the flow statistics, until the monitor is disposed"
+              : "Check the periodic export of the flow statistics, until the simulation is destroyed"),
+    m_dispose (dispose)
+{
+}
+
+void
+FlowMonitorExportTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("flow-monitor-export.csv");
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (2)));
+  monitor->EnablePeriodicExport (fileName, Seconds (1));
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+
+  // a packet received after 200ms, then a packet which is lost at 3.5s
+  Simulator::Schedule (Seconds (0.5), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.7), &FlowMonitor::ReportLastRx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (1.5), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 1, 100);
+  // a packet received after 100ms, in the last, partial period
+  Simulator::Schedule (Seconds (4.2), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 2, 100);
+  Simulator::Schedule (Seconds (4.3), &FlowMonitor::ReportLastRx, monitor, probe, 1, 2, 100);
+
+  Simulator::Stop (Seconds (4.5));
+  Simulator::Run ();
+  if (m_dispose)
+    {
+      monitor->Dispose ();
+    }
+  Simulator::Destroy ();
+  monitor = 0;
+
+  std::ifstream file (fileName.c_str ());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline (file, line))
+    {
+      lines.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines.size (), 5, "Expected a header and four lines of changes");
+  NS_TEST_EXPECT_MSG_EQ (lines[0], "time,flowId,txBytes,rxBytes,txPackets,rxPackets,lostPackets,"
+                         "timesForwarded,delaySum,jitterSum", "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (lines[1], "1000000000,1,100,100,1,1,0,0,200000000,0",
+                         "Wrong changes in the first period");
+  NS_TEST_EXPECT_MSG_EQ (lines[2], "2000000000,1,100,0,1,0,0,0,0,0",
+                         "Wrong changes in the second period");
+  NS_TEST_EXPECT_MSG_EQ (lines[3], "4000000000,1,0,0,0,0,1,0,0,0",
+                         "The loss should be exported in the fourth period");
+  NS_TEST_EXPECT_MSG_EQ (lines[4], "4500000000,1,100,100,1,1,0,0,100000000,100000000",
+                         "The changes of the last period should be exported at the end");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check the sampling of the flows and of the packets.
+ */
+class FlowMonitorSamplingTestCase : public TestCase
+{
+public:
+  FlowMonitorSamplingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FlowMonitorSamplingTestCase::FlowMonitorSamplingTestCase ()
+  : TestCase ("Check the sampling of the flows and of the packets")
+{
+}
+
+void
+FlowMonitorSamplingTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  for (FlowId flowId = 1; flowId < 100; flowId++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (monitor->IsSampled (flowId, flowId), true, "Everything is sampled by default");
+    }
+
+  monitor->SetAttribute ("PacketSamplingRate", UintegerValue (4));
+  for (FlowPacketId packetId = 0; packetId < 100; packetId++)
+    {
+      bool expected = (packetId % 4 == 0);
+      NS_TEST_EXPECT_MSG_EQ (monitor->IsSampled (1, packetId), expected,
+                             "One packet out of 4 is sampled");
+    }
+
+  monitor->SetAttribute ("PacketSamplingRate", UintegerValue (1));
+  monitor->SetAttribute ("FlowSamplingRate", UintegerValue (4));
+  uint32_t sampled = 0;
+  for (FlowId flowId = 1; flowId <= 4000; flowId++)
+    {
+      bool isSampled = monitor->IsSampled (flowId, 0);
+      for (FlowPacketId packetId = 1; packetId < 5; packetId++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (monitor->IsSampled (flowId, packetId), isSampled,
+                                 "All the packets of a flow are sampled, or none");
+        }
+      sampled += isSampled;
+    }
+  NS_TEST_EXPECT_MSG_GT (sampled, 850, "About one flow out of 4 should be sampled");
+  NS_TEST_EXPECT_MSG_LT (sampled, 1150, "About one flow out of 4 should be sampled");
+
+  monitor->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check the classification of the packets by the Ipv4FlowClassifier.
+ */
+class Ipv4FlowClassifierTestCase : public TestCase
+{
+public:
+  Ipv4FlowClassifierTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Classify a UDP packet
+   * \param src the source address
+   * \param dst the destination address
+   * \param srcPort the source port
+   * \param dscp the DSCP value
+   * \param packetId the packet identifier
+   * \return the flow identifier
+   */
+  FlowId Classify (Ipv4Address src, Ipv4Address dst, uint16_t srcPort,
+                   Ipv4Header::DscpType dscp, FlowPacketId *packetId);
+
+  Ptr<Ipv4FlowClassifier> m_classifier; //!< The classifier under test
+};
+
+Ipv4FlowClassifierTestCase::Ipv4FlowClassifierTestCase ()
+  : TestCase ("Check the classification of the packets by the Ipv4FlowClassifier")
+{
+}
+
+FlowId
+Ipv4FlowClassifierTestCase::Classify (Ipv4Address src, Ipv4Address dst, uint16_t srcPort,
+                                      Ipv4Header::DscpType dscp, FlowPacketId *packetId)
+{
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (src);
+  ipHeader.SetDestination (dst);
+  ipHeader.SetProtocol (17);
+  ipHeader.SetDscp (dscp);
+  UdpHeader udpHeader;
+  udpHeader.SetSourcePort (srcPort);
+  udpHeader.SetDestinationPort (9);
+  Ptr<Packet> payload = Create<Packet> (100);
+  payload->AddHeader (udpHeader);
+
+  FlowId flowId = 0;
+  bool classified = m_classifier->Classify (ipHeader, payload, &flowId, packetId);
+  NS_TEST_EXPECT_MSG_EQ (classified, true, "UDP packets should be classified");
+  return flowId;
+}
+
+void
+Ipv4FlowClassifierTestCase::DoRun (void)
+{
+  m_classifier = Create<Ipv4FlowClassifier> ();
+  Ipv4Address a ("10.0.0.1");
+  Ipv4Address b ("10.0.0.2");
+  FlowPacketId packetId;
+
+  NS_TEST_EXPECT_MSG_EQ (Classify (a, b, 1000, Ipv4Header::DscpDefault, &packetId), 1, "First flow");
+  NS_TEST_EXPECT_MSG_EQ (packetId, 0, "First packet of the flow");
+  NS_TEST_EXPECT_MSG_EQ (Classify (b, a, 1000, Ipv4Header::DscpDefault, &packetId), 2, "Second flow");
+  NS_TEST_EXPECT_MSG_EQ (Classify (a, b, 1001, Ipv4Header::DscpDefault, &packetId), 3, "Third flow");
+  NS_TEST_EXPECT_MSG_EQ (Classify (a, b, 1000, Ipv4Header::DSCP_AF11, &packetId), 1, "First flow again");
+  NS_TEST_EXPECT_MSG_EQ (packetId, 1, "Second packet of the flow");
+  NS_TEST_EXPECT_MSG_EQ (Classify (a, b, 1000, Ipv4Header::DSCP_AF11, &packetId), 1, "First flow again");
+  NS_TEST_EXPECT_MSG_EQ (packetId, 2, "Third packet of the flow");
+
+  Ipv4FlowClassifier::FiveTuple tuple = m_classifier->FindFlow (2);
+  NS_TEST_EXPECT_MSG_EQ (tuple.sourceAddress, b, "Wrong source address of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (tuple.destinationAddress, a, "Wrong destination address of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (tuple.sourcePort, 1000, "Wrong source port of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (tuple.destinationPort, 9, "Wrong destination port of flow 2");
+
+  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscps = m_classifier->GetDscpCounts (1);
+  NS_TEST_ASSERT_MSG_EQ (dscps.size (), 2, "Two DSCP values were used by flow 1");
+  NS_TEST_EXPECT_MSG_EQ (dscps[0].first, Ipv4Header::DSCP_AF11, "AF11 is the most used DSCP value");
+  NS_TEST_EXPECT_MSG_EQ (dscps[0].second, 2, "Two packets were marked AF11");
+  NS_TEST_EXPECT_MSG_EQ (dscps[1].second, 1, "One packet was not marked");
+
+  m_classifier = 0;
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorLossTestCase, TestCase::QUICK);
+  AddTestCase (new FlowMonitorLongDelayTestCase, TestCase::QUICK);
+  AddTestCase (new FlowMonitorExportTestCase (true), TestCase::QUICK);
+  AddTestCase (new FlowMonitorExportTestCase (false), TestCase::QUICK);
+  AddTestCase (new FlowMonitorSamplingTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4FlowClassifierTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite; //!< Static variable for test initialization
@@ -565,6 +565,52 @@ InternetStackHelper::EnablePcapIpv6Internal (std::string prefix, Ptr<Ipv6> ipv6,
   g_interfaceFileMapIpv6[std::make_pair (ipv6, interface)] = file;
 }
 
+/**
+ * \brief Record an event traced without context in a binary trace
+ * \param stream the output stream
+ * \param type the event type
+ * \param packet the packet
+ * \returns true if the stream holds a binary trace, in which the event was recorded
+ */
+static bool
+RecordBinaryTraceEvent (Ptr<OutputStreamWrapper> stream, BinaryTrace::EventType type, Ptr<const Packet> packet)
+{
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer == 0)
+    {
+      return false;
+    }
+  writer->Record (type, packet);
+  return true;
+}
+
+/**
+ * \brief Record an event traced with a context in a binary trace
+ * \param stream the output stream
+ * \param type the event type
+ * \param context the context
+ * \param interface the interface
+ * \param packet the packet
+ * \returns true if the stream holds a binary trace, in which the event was recorded
+ */
+static bool
+RecordBinaryTraceEvent (Ptr<OutputStreamWrapper> stream, BinaryTrace::EventType type,
+                        std::string context, uint32_t interface, Ptr<const Packet> packet)
+{
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer == 0)
+    {
+      return false;
+    }
+#ifdef INTERFACE_CONTEXT
+  std::ostringstream oss;
+  oss << context << "(" << interface << ")";
+  context = oss.str ();
+#endif
+  writer->Record (type, context, packet);
+  return true;
+}
+
 /**
  * \brief Sync function for IPv4 dropped packet - Ascii output
  * \param stream the output stream
@@ -598,6 +644,10 @@ Ipv4L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::DROP, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -622,6 +672,10 @@ Ipv4L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::TRANSMIT, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -646,6 +700,10 @@ Ipv4L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::RECEIVE, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -684,6 +742,10 @@ Ipv4L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::DROP, context, interface, p))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -715,6 +777,10 @@ Ipv4L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::TRANSMIT, context, interface, packet))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -746,6 +812,10 @@ Ipv4L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::RECEIVE, context, interface, packet))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -936,6 +1006,10 @@ Ipv6L3ProtocolDropSinkWithoutContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::DROP, p))
+    {
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -960,6 +1034,10 @@ Ipv6L3ProtocolTxSinkWithoutContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::TRANSMIT, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -984,6 +1062,10 @@ Ipv6L3ProtocolRxSinkWithoutContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::RECEIVE, packet))
+    {
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *packet << std::endl;
 }
 
@@ -1022,6 +1104,10 @@ Ipv6L3ProtocolDropSinkWithContext (
 
   Ptr<Packet> p = packet->Copy ();
   p->AddHeader (header);
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::DROP, context, interface, p))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *p << std::endl;
@@ -1053,6 +1139,10 @@ Ipv6L3ProtocolTxSinkWithContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::TRANSMIT, context, interface, packet))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "t " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -1084,6 +1174,10 @@ Ipv6L3ProtocolRxSinkWithContext (
       return;
     }
 
+  if (RecordBinaryTraceEvent (stream, BinaryTrace::RECEIVE, context, interface, packet))
+    {
+      return;
+    }
 #ifdef INTERFACE_CONTEXT
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << "(" << interface << ") " 
                         << *packet << std::endl;
@@ -29,9 +29,11 @@ NS_LOG_COMPONENT_DEFINE ("GlobalRoutingHelper");
 
 Ipv4GlobalRoutingHelper::Ipv4GlobalRoutingHelper ()
 {
+  m_factory.SetTypeId ("ns3::Ipv4GlobalRouting");
 }
 
 Ipv4GlobalRoutingHelper::Ipv4GlobalRoutingHelper (const Ipv4GlobalRoutingHelper &o)
+  : m_factory (o.m_factory)
 {
 }
 
@@ -51,12 +53,45 @@ Ipv4GlobalRoutingHelper::Create (Ptr<Node> node) const
   node->AggregateObject (globalRouter);
 
   NS_LOG_LOGIC ("Adding GlobalRouting Protocol to node " << node->GetId ());
-  Ptr<Ipv4GlobalRouting> globalRouting = CreateObject<Ipv4GlobalRouting> ();
+  Ptr<Ipv4GlobalRouting> globalRouting = m_factory.Create<Ipv4GlobalRouting> ();
   globalRouter->SetRoutingProtocol (globalRouting);
 
   return globalRouting;
 }
 
+void
+Ipv4GlobalRoutingHelper::Set (std::string name, const AttributeValue &value)
+{
+  m_factory.Set (name, value);
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingHelper::GetGlobalRouting (Ptr<NetDevice> device, uint32_t &interface)
+{
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, "No IPv4 on the node of the device");
+  int32_t index = ipv4->GetInterfaceForDevice (device);
+  NS_ASSERT_MSG (index >= 0, "No IPv4 interface for the device");
+  interface = index;
+  Ptr<GlobalRouter> globalRouter = device->GetNode ()->GetObject<GlobalRouter> ();
+  NS_ASSERT_MSG (globalRouter, "No global routing on the node of the device");
+  return globalRouter->GetRoutingProtocol ();
+}
+
+void
+Ipv4GlobalRoutingHelper::SetEcmpWeight (Ptr<NetDevice> device, uint16_t weight)
+{
+  uint32_t interface;
+  GetGlobalRouting (device, interface)->SetEcmpWeight (interface, weight);
+}
+
+uint64_t
+Ipv4GlobalRoutingHelper::GetEcmpSelections (Ptr<NetDevice> device)
+{
+  uint32_t interface;
+  return GetGlobalRouting (device, interface)->GetEcmpSelections (interface);
+}
+
 void 
 Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
 {
@@ -66,9 +101,7 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
 void 
 Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
 {
-  GlobalRouteManager::DeleteGlobalRoutes ();
-  GlobalRouteManager::BuildGlobalRoutingDatabase ();
-  GlobalRouteManager::InitializeRoutes ();
+  GlobalRouteManager::UpdateGlobalRoutes ();
 }
 
 
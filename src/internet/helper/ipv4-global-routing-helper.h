@@ -22,9 +22,12 @@
 
 #include "ns3/node-container.h"
 #include "ns3/ipv4-routing-helper.h"
+#include "ns3/object-factory.h"
 
 namespace ns3 {
 
+class Ipv4GlobalRouting;
+
 /**
  * \ingroup ipv4Helpers
  *
@@ -62,6 +65,36 @@ public:
    */
   virtual Ptr<Ipv4RoutingProtocol> Create (Ptr<Node> node) const;
 
+  /**
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set.
+   *
+   * This method controls the attributes of ns3::Ipv4GlobalRouting, e.g.,
+   * its "EcmpMode".
+   */
+  void Set (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Set the weight of the equal-cost routes through a device.
+   *
+   * \param device the device, which must have an IPv4 interface on a node
+   * with global routing
+   * \param weight the weight
+   *
+   * \see Ipv4GlobalRouting::SetEcmpWeight
+   */
+  static void SetEcmpWeight (Ptr<NetDevice> device, uint16_t weight);
+
+  /**
+   * \param device the device, which must have an IPv4 interface on a node
+   * with global routing
+   * \returns the number of packets routed through the device after a choice
+   * among several equal-cost routes
+   *
+   * \see Ipv4GlobalRouting::GetEcmpSelections
+   */
+  static uint64_t GetEcmpSelections (Ptr<NetDevice> device);
+
   /**
    * \brief Build a routing database and initialize the routing tables of
    * the nodes in the simulation.  Makes all nodes in the simulation into
@@ -83,6 +116,11 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the routes of the routers whose shortest path tree may have
+   * been changed by the topology changes are recomputed, the other
+   * routers keep their routes.  The SPF calculations can be spread over
+   * several threads with the "GlobalRoutingThreads" global value.
+   *
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -92,6 +130,16 @@ private:
    * \return
    */
   Ipv4GlobalRoutingHelper &operator = (const Ipv4GlobalRoutingHelper &);
+
+  /**
+   * \brief Get the global routing of a device, and the index of its interface.
+   * \param device the device
+   * \param interface the index of the IPv4 interface of the device
+   * \returns the global routing of the node of the device
+   */
+  static Ptr<Ipv4GlobalRouting> GetGlobalRouting (Ptr<NetDevice> device, uint32_t &interface);
+
+  ObjectFactory m_factory; //!< Factory of the Ipv4GlobalRouting objects
 };
 
 } // namespace ns3
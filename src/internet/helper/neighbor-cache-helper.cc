@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <set>
+
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/bridge-net-device.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/ndisc-cache.h"
+#include "neighbor-cache-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NeighborCacheHelper");
+
+/**
+ * \brief Get the bridge of which a device is a port
+ * \param device the device
+ * \returns the bridge, or 0 if the device is not a bridge port
+ */
+static Ptr<BridgeNetDevice>
+GetBridge (Ptr<NetDevice> device)
+{
+  Ptr<Node> node = device->GetNode ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<BridgeNetDevice> bridge = DynamicCast<BridgeNetDevice> (node->GetDevice (i));
+      if (bridge)
+        {
+          for (uint32_t j = 0; j < bridge->GetNBridgePorts (); j++)
+            {
+              if (bridge->GetBridgePort (j) == device)
+                {
+                  return bridge;
+                }
+            }
+        }
+    }
+  return 0;
+}
+
+NeighborCacheHelper::NeighborCacheHelper ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (void) const
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); i++)
+        {
+          PopulateDevice ((*node)->GetDevice (i));
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (Ptr<Channel> channel) const
+{
+  NS_LOG_FUNCTION (this << channel);
+  for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = channel->GetDevice (i);
+      Ptr<BridgeNetDevice> bridge = GetBridge (device);
+      if (bridge)
+        {
+          device = bridge;
+        }
+      PopulateDevice (device);
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const Ipv4InterfaceContainer &c) const
+{
+  NS_LOG_FUNCTION (this);
+  for (Ipv4InterfaceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = DynamicCast<Ipv4L3Protocol> (i->first);
+      NS_ASSERT_MSG (ipv4, "Ipv4 is not an Ipv4L3Protocol");
+      PopulateArpCache (ipv4->GetInterface (i->second));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNeighborCache (const Ipv6InterfaceContainer &c) const
+{
+  NS_LOG_FUNCTION (this);
+  for (Ipv6InterfaceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Ipv6L3Protocol> ipv6 = DynamicCast<Ipv6L3Protocol> (i->first);
+      NS_ASSERT_MSG (ipv6, "Ipv6 is not an Ipv6L3Protocol");
+      PopulateNdiscCache (ipv6->GetInterface (i->second));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateDevice (Ptr<NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  Ptr<Ipv4L3Protocol> ipv4 = device->GetNode ()->GetObject<Ipv4L3Protocol> ();
+  int32_t interface = ipv4 ? ipv4->GetInterfaceForDevice (device) : -1;
+  if (interface >= 0)
+    {
+      PopulateArpCache (ipv4->GetInterface (interface));
+    }
+  Ptr<Ipv6L3Protocol> ipv6 = device->GetNode ()->GetObject<Ipv6L3Protocol> ();
+  interface = ipv6 ? ipv6->GetInterfaceForDevice (device) : -1;
+  if (interface >= 0)
+    {
+      PopulateNdiscCache (ipv6->GetInterface (interface));
+    }
+}
+
+void
+NeighborCacheHelper::PopulateArpCache (Ptr<Ipv4Interface> interface) const
+{
+  NS_LOG_FUNCTION (this << interface);
+  Ptr<ArpCache> cache = interface->GetArpCache ();
+  if (!cache)
+    {
+      return;
+    }
+  for (auto &neighbor : GetNeighbors (interface->GetDevice ()))
+    {
+      Ptr<Ipv4L3Protocol> ipv4 = neighbor->GetNode ()->GetObject<Ipv4L3Protocol> ();
+      int32_t index = ipv4 ? ipv4->GetInterfaceForDevice (neighbor) : -1;
+      if (index < 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4Interface> remote = ipv4->GetInterface (index);
+      for (uint32_t i = 0; i < remote->GetNAddresses (); i++)
+        {
+          Ipv4Address address = remote->GetAddress (i).GetLocal ();
+          ArpCache::Entry *entry = cache->Lookup (address);
+          // Do not strand the packets of a pending resolution
+          if (entry && entry->IsWaitReply ())
+            {
+              continue;
+            }
+          if (!entry)
+            {
+              entry = cache->Add (address);
+            }
+          NS_LOG_LOGIC ("Node " << interface->GetDevice ()->GetNode ()->GetId () << ": "
+                        << address << " is at " << neighbor->GetAddress ());
+          entry->SetMacAddress (neighbor->GetAddress ());
+          entry->MarkPermanent ();
+        }
+    }
+}
+
+void
+NeighborCacheHelper::PopulateNdiscCache (Ptr<Ipv6Interface> interface) const
+{
+  NS_LOG_FUNCTION (this << interface);
+  Ptr<NdiscCache> cache = interface->GetNdiscCache ();
+  if (!cache)
+    {
+      return;
+    }
+  for (auto &neighbor : GetNeighbors (interface->GetDevice ()))
+    {
+      Ptr<Ipv6L3Protocol> ipv6 = neighbor->GetNode ()->GetObject<Ipv6L3Protocol> ();
+      int32_t index = ipv6 ? ipv6->GetInterfaceForDevice (neighbor) : -1;
+      if (index < 0)
+        {
+          continue;
+        }
+      Ptr<Ipv6Interface> remote = ipv6->GetInterface (index);
+      for (uint32_t i = 0; i < remote->GetNAddresses (); i++)
+        {
+          Ipv6Address address = remote->GetAddress (i).GetAddress ();
+          NdiscCache::Entry *entry = cache->Lookup (address);
+          // Do not strand the packets of a pending resolution
+          if (entry && entry->IsIncomplete ())
+            {
+              continue;
+            }
+          if (!entry)
+            {
+              entry = cache->Add (address);
+            }
+          NS_LOG_LOGIC ("Node " << interface->GetDevice ()->GetNode ()->GetId () << ": "
+                        << address << " is at " << neighbor->GetAddress ());
+          entry->SetMacAddress (neighbor->GetAddress ());
+          entry->SetRouter (ipv6->IsForwarding (index));
+          entry->MarkPermanent ();
+        }
+    }
+}
+
+std::vector<Ptr<NetDevice> >
+NeighborCacheHelper::GetNeighbors (Ptr<NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+  std::vector<Ptr<NetDevice> > neighbors;
+  std::set<Ptr<NetDevice> > visited;
+  std::set<Ptr<Channel> > visitedChannels;
+  std::vector<Ptr<Channel> > channels;
+
+  // The channels reachable from a bridge are those of its ports
+  auto enter = [&] (Ptr<NetDevice> dev)
+    {
+      visited.insert (dev);
+      Ptr<BridgeNetDevice> bridge = DynamicCast<BridgeNetDevice> (dev);
+      if (bridge)
+        {
+          for (uint32_t i = 0; i < bridge->GetNBridgePorts (); i++)
+            {
+              visited.insert (bridge->GetBridgePort (i));
+              channels.push_back (bridge->GetBridgePort (i)->GetChannel ());
+            }
+        }
+      else
+        {
+          channels.push_back (dev->GetChannel ());
+        }
+    };
+
+  enter (device);
+  while (!channels.empty ())
+    {
+      Ptr<Channel> channel = channels.back ();
+      channels.pop_back ();
+      if (!channel || !visitedChannels.insert (channel).second)
+        {
+          continue;
+        }
+      for (std::size_t i = 0; i < channel->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> peer = channel->GetDevice (i);
+          if (visited.count (peer))
+            {
+              continue;
+            }
+          Ptr<BridgeNetDevice> bridge = GetBridge (peer);
+          if (bridge)
+            {
+              if (!visited.count (bridge))
+                {
+                  neighbors.push_back (bridge);
+                  enter (bridge);
+                }
+            }
+          else
+            {
+              visited.insert (peer);
+              neighbors.push_back (peer);
+            }
+        }
+    }
+  return neighbors;
+}
+
+} // namespace ns3
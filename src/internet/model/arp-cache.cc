@@ -17,6 +17,8 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <vector>
+
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
@@ -197,9 +199,16 @@ ArpCache::HandleWaitReplyTimeout (void)
   NS_LOG_FUNCTION (this);
   ArpCache::Entry* entry;
   bool restartWaitReplyTimer = false;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++) 
+  // Marking an entry dead removes it from m_waitReplyEntries
+  std::vector<ArpCache::Entry *> waiting;
+  waiting.reserve (m_waitReplyEntries.size ());
+  for (auto &i : m_waitReplyEntries)
+    {
+      waiting.push_back (i.second);
+    }
+  for (auto i = waiting.begin (); i != waiting.end (); i++)
     {
-      entry = (*i).second;
+      entry = *i;
       if (entry != 0 && entry->IsWaitReply ())
         {
           if (entry->GetRetries () < m_maxRetries)
@@ -249,6 +258,8 @@ ArpCache::Flush (void)
       delete (*i).second;
     }
   m_arpCache.erase (m_arpCache.begin (), m_arpCache.end ());
+  m_macIndex.clear ();
+  m_waitReplyEntries.clear ();
   if (m_waitReplyTimer.IsRunning ())
     {
       NS_LOG_LOGIC ("Stopping WaitReplyTimer at " << Simulator::Now ().GetSeconds () << " due to ArpCache flush");
@@ -302,15 +313,34 @@ ArpCache::LookupInverse (Address to)
   NS_LOG_FUNCTION (this << to);
 
   std::list<ArpCache::Entry *> entryList;
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+  auto range = m_macIndex.equal_range (to);
+  for (auto i = range.first; i != range.second; i++)
     {
-      ArpCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == to)
+      entryList.push_back (i->second);
+    }
+  return entryList;
+}
+
+void
+ArpCache::IndexMacAddress (ArpCache::Entry *entry, const Address &macAddress)
+{
+  NS_LOG_FUNCTION (this << entry << macAddress);
+  if (!entry->GetMacAddress ().IsInvalid ())
+    {
+      auto range = m_macIndex.equal_range (entry->GetMacAddress ());
+      for (auto i = range.first; i != range.second; i++)
         {
-          entryList.push_back (entry);
+          if (i->second == entry)
+            {
+              m_macIndex.erase (i);
+              break;
+            }
         }
     }
-  return entryList;
+  if (!macAddress.IsInvalid ())
+    {
+      m_macIndex.emplace (macAddress, entry);
+    }
 }
 
 
@@ -342,16 +372,16 @@ void
 ArpCache::Remove (ArpCache::Entry *entry)
 {
   NS_LOG_FUNCTION (this << entry);
-  
-  for (CacheI i = m_arpCache.begin (); i != m_arpCache.end (); i++)
+
+  CacheI i = m_arpCache.find (entry->GetIpv4Address ());
+  if (i != m_arpCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_arpCache.erase (i);
-          entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
-          delete entry;
-          return;
-        }
+      m_arpCache.erase (i);
+      IndexMacAddress (entry, Address ());
+      m_waitReplyEntries.erase (entry->GetIpv4Address ());
+      entry->ClearPendingPacket (); //clear the pending packets for entry's ipaddress
+      delete entry;
+      return;
     }
   NS_LOG_WARN ("Entry not found in this ARP Cache");
 }
@@ -396,6 +426,10 @@ ArpCache::Entry::MarkDead (void)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_state == ALIVE || m_state == WAIT_REPLY || m_state == DEAD);
+  if (m_state == WAIT_REPLY)
+    {
+      m_arp->m_waitReplyEntries.erase (m_ipv4Address);
+    }
   m_state = DEAD;
   ClearRetries ();
   UpdateSeen ();
@@ -405,7 +439,9 @@ ArpCache::Entry::MarkAlive (Address macAddress)
 {
   NS_LOG_FUNCTION (this << macAddress);
   NS_ASSERT (m_state == WAIT_REPLY);
+  m_arp->IndexMacAddress (this, macAddress);
   m_macAddress = macAddress;
+  m_arp->m_waitReplyEntries.erase (m_ipv4Address);
   m_state = ALIVE;
   ClearRetries ();
   UpdateSeen ();
@@ -416,6 +452,10 @@ ArpCache::Entry::MarkPermanent (void)
   NS_LOG_FUNCTION (this << m_macAddress);
   NS_ASSERT (!m_macAddress.IsInvalid ());
 
+  if (m_state == WAIT_REPLY)
+    {
+      m_arp->m_waitReplyEntries.erase (m_ipv4Address);
+    }
   m_state = PERMANENT;
   ClearRetries ();
   UpdateSeen ();
@@ -445,6 +485,7 @@ ArpCache::Entry::MarkWaitReply (Ipv4PayloadHeaderPair waiting)
   NS_ASSERT_MSG (waiting.first, "Can not add a null packet to the ARP queue");
 
   m_state = WAIT_REPLY;
+  m_arp->m_waitReplyEntries[m_ipv4Address] = this;
   m_pending.push_back (waiting);
   UpdateSeen ();
   m_arp->StartWaitReplyTimer ();
@@ -460,6 +501,7 @@ void
 ArpCache::Entry::SetMacAddress (Address macAddress)
 {
   NS_LOG_FUNCTION (this);
+  m_arp->IndexMacAddress (this, macAddress);
   m_macAddress = macAddress;
 }
 Ipv4Address 
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include <unordered_map>
 #include "ns3/simulator.h"
 #include "ns3/callback.h"
@@ -47,6 +48,11 @@ class Ipv4Header;
  *
  * A cached lookup table for translating layer 3 addresses to layer 2.
  * This implementation does lookups from IPv4 to a MAC address
+ *
+ * The entries are also indexed by MAC address, for the inverse lookups done
+ * on the packets received from routers, and the entries waiting for a reply
+ * are kept apart, so that the retransmission of the ARP requests does not
+ * visit the whole cache.
  */
 class ArpCache : public Object
 {
@@ -336,8 +342,21 @@ private:
    * If there are no Arp requests pending, this event is not scheduled.
    */
   void HandleWaitReplyTimeout (void);
+
+  /**
+   * \brief Move an entry to a new MAC address in the index of the MAC addresses.
+   *
+   * Called by the entry before it changes its MAC address.
+   *
+   * \param entry the entry
+   * \param macAddress the new MAC address of the entry
+   */
+  void IndexMacAddress (ArpCache::Entry *entry, const Address &macAddress);
+
   uint32_t m_pendingQueueSize; //!< number of packets waiting for a resolution
   Cache m_arpCache; //!< the ARP cache
+  std::multimap<Address, ArpCache::Entry *> m_macIndex; //!< the entries with a valid MAC address, by MAC address
+  std::map<Ipv4Address, ArpCache::Entry *> m_waitReplyEntries; //!< the entries in WaitReply state, by IP address
   TracedCallback<Ptr<const Packet> > m_dropTrace; //!< trace for packets dropped by the ARP cache queue
 };
 
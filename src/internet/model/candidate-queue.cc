@@ -49,9 +49,9 @@ operator<< (std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream& 
 operator<< (std::ostream& os, const CandidateQueue& q)
 {
-  typedef CandidateQueue::CandidateList_t List_t;
+  typedef std::vector<SPFVertex*> List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  const List_t list = q.GetSortedVertices ();
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
@@ -66,7 +66,9 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_heap (),
+    m_positions (),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -81,7 +83,7 @@ void
 CandidateQueue::Clear (void)
 {
   NS_LOG_FUNCTION (this);
-  while (!m_candidates.empty ())
+  while (!m_heap.empty ())
     {
       SPFVertex *p = Pop ();
       delete p;
@@ -94,24 +96,33 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.distance = vNew->GetDistanceFromRoot ();
+  c.sequence = m_sequence++;
+  m_heap.push_back (c);
+  m_positions[vNew] = m_heap.size () - 1;
+  SiftUp (m_heap.size () - 1);
 }
 
 SPFVertex *
 CandidateQueue::Pop (void)
 {
   NS_LOG_FUNCTION (this);
-  if (m_candidates.empty ())
+  if (m_heap.empty ())
     {
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_heap.front ().vertex;
+  m_positions.erase (v);
+  Candidate last = m_heap.back ();
+  m_heap.pop_back ();
+  if (!m_heap.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -119,44 +130,43 @@ SPFVertex *
 CandidateQueue::Top (void) const
 {
   NS_LOG_FUNCTION (this);
-  if (m_candidates.empty ())
+  if (m_heap.empty ())
     {
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_heap.front ().vertex;
 }
 
 bool
 CandidateQueue::Empty (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_candidates.empty ();
+  return m_heap.empty ();
 }
 
 uint32_t
 CandidateQueue::Size (void) const
 {
   NS_LOG_FUNCTION (this);
-  return m_candidates.size ();
+  return m_heap.size ();
 }
 
 SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  const Candidate *found = 0;
+  for (std::vector<Candidate>::const_iterator i = m_heap.begin (); i != m_heap.end (); i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      // the first match in the order of the queue
+      if (i->vertex->GetVertexId () == addr && (found == 0 || IsBefore (*i, *found)))
         {
-          return v;
+          found = &(*i);
         }
     }
 
-  return 0;
+  return found != 0 ? found->vertex : 0;
 }
 
 void
@@ -164,11 +174,47 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Sort the candidates by their new distance, keeping the previous order
+  // of the candidates at the same distance
+  std::vector<Candidate> previous = m_heap;
+  std::sort (previous.begin (), previous.end (), &CandidateQueue::IsBefore);
+  m_sequence = 0;
+  for (std::vector<Candidate>::iterator i = previous.begin (); i != previous.end (); i++)
+    {
+      i->distance = i->vertex->GetDistanceFromRoot ();
+      i->sequence = m_sequence++;
+    }
+  m_heap.clear ();
+  for (std::vector<Candidate>::const_iterator i = previous.begin (); i != previous.end (); i++)
+    {
+      m_heap.push_back (*i);
+      m_positions[i->vertex] = m_heap.size () - 1;
+      SiftUp (m_heap.size () - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  std::unordered_map<SPFVertex*, uint32_t>::const_iterator it = m_positions.find (v);
+  NS_ASSERT_MSG (it != m_positions.end (), "Vertex not in the candidate queue");
+  uint32_t i = it->second;
+  if (v->GetDistanceFromRoot () > m_heap[i].distance)
+    {
+      Reorder ();
+      return;
+    }
+  // A vertex getting closer is ordered after the vertices already at its
+  // new distance, as if it was pushed again
+  m_heap[i].distance = v->GetDistanceFromRoot ();
+  m_heap[i].sequence = m_sequence++;
+  SiftUp (i);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -177,24 +223,82 @@ CandidateQueue::Reorder (void)
  * This ordering is necessary for implementing ECMP
  */
 bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::IsBefore (Candidate const &c1, Candidate const &c2)
+{
+  if (c1.distance != c2.distance)
+    {
+      return c1.distance < c2.distance;
+    }
+  bool network1 = c1.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  bool network2 = c2.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  if (network1 != network2)
+    {
+      return network1;
+    }
+  return c1.sequence < c2.sequence;
+}
+
+void
+CandidateQueue::Place (uint32_t i, Candidate const &c)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
+  m_heap[i] = c;
+  m_positions[c.vertex] = i;
+}
 
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_heap[i];
+  while (i > 0)
     {
-      result = true;
+      uint32_t parent = (i - 1) / 2;
+      if (!IsBefore (c, m_heap[parent]))
+        {
+          break;
+        }
+      Place (i, m_heap[parent]);
+      i = parent;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  Place (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  Candidate c = m_heap[i];
+  uint32_t size = m_heap.size ();
+  for (;;)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
+      uint32_t child = 2 * i + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && IsBefore (m_heap[child + 1], m_heap[child]))
+        {
+          child++;
+        }
+      if (!IsBefore (m_heap[child], c))
         {
-          result = true;
+          break;
         }
+      Place (i, m_heap[child]);
+      i = child;
+    }
+  Place (i, c);
+}
+
+std::vector<SPFVertex*>
+CandidateQueue::GetSortedVertices (void) const
+{
+  std::vector<Candidate> sorted = m_heap;
+  std::sort (sorted.begin (), sorted.end (), &CandidateQueue::IsBefore);
+  std::vector<SPFVertex*> vertices;
+  for (std::vector<Candidate>::const_iterator i = sorted.begin (); i != sorted.end (); i++)
+    {
+      vertices.push_back (i->vertex);
     }
-  return result;
+  return vertices;
 }
 
 } // namespace ns3
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap which keeps track of the position of each
+ * vertex, so that Push (), Pop () and Reorder (SPFVertex*) take a time
+ * logarithmic in the number of candidates.  Vertices at the same distance
+ * are popped in the order in which they were pushed, a vertex whose
+ * distance was decreased being considered as pushed again.
  */
 class CandidateQueue
 {
@@ -154,6 +161,17 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the order of the Candidate Queue after the value of
+ * m_distanceFromRoot of a single vertex changed.
+ *
+ * This is equivalent to Reorder (), but only moves the given vertex.
+ *
+ * @see SPFVertex
+ * @param v The vertex whose distance changed, which must be in the queue.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -171,21 +189,50 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
-/**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
- *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
- */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
+  /// A vertex in the queue
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< the vertex
+    uint32_t distance;  //!< the distance of the vertex when it was (re)ordered
+    uint64_t sequence;  //!< the order in which the vertex was (re)ordered
+  };
+
+  /**
+   * \brief return true if c1 < c2
+   *
+   * A candidate is ranked first if its distance is smaller; in case of a
+   * tie, network vertices are ranked before router vertices, which is
+   * necessary for implementing ECMP, and then the first (re)ordered vertex.
+   *
+   * \param c1 first candidate
+   * \param c2 second candidate
+   * \return True if c1 should be popped before c2; false otherwise
+   */
+  static bool IsBefore (Candidate const &c1, Candidate const &c2);
+  /**
+   * \brief Move a candidate up the heap until its parent is before it
+   * \param i the position of the candidate in the heap
+   */
+  void SiftUp (uint32_t i);
+  /**
+   * \brief Move a candidate down the heap until its children are after it
+   * \param i the position of the candidate in the heap
+   */
+  void SiftDown (uint32_t i);
+  /**
+   * \brief Store a candidate at a position of the heap
+   * \param i the position
+   * \param c the candidate
+   */
+  void Place (uint32_t i, Candidate const &c);
+  /**
+   * \returns the candidates, from the first to be popped to the last
+   */
+  std::vector<SPFVertex*> GetSortedVertices (void) const;
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  std::vector<Candidate> m_heap; //!< SPFVertex candidates, as a binary heap
+  std::unordered_map<SPFVertex*, uint32_t> m_positions; //!< positions of the candidates in the heap
+  uint64_t m_sequence; //!< sequence number of the next candidate (re)ordered
 
   /**
    * \brief Stream insertion operator.
@@ -26,7 +26,9 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
+#include <unordered_map>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -38,6 +40,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -674,13 +677,49 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Find the Link State Advertisements which differ from the ones of
+   * another database.
+   *
+   * The LSAs found in only one of the databases, or with different contents,
+   * are reported by link state ID.  External LSAs are compared in the order
+   * of the databases, and reported by the ID of their advertising router.
+   *
+   * @param other the other database
+   * @param ids the IDs of the LSAs which differ, added to the set
+   */
+  void FindChangedLSAs (GlobalRouteManagerLSDB const *other, std::set<Ipv4Address> &ids) const;
+
+  /**
+   * @brief Find the routers which can reach some of the Link State
+   * Advertisements in their SPF calculation.
+   *
+   * The links between the LSAs followed by the SPF calculation are gathered
+   * in a compact graph, in compressed sparse row (CSR) form, which is walked
+   * backwards from the given LSAs.  The routes computed by a router only
+   * depend on the LSAs it reaches.
+   *
+   * @param ids the link state IDs of the LSAs
+   * @param routers the link state IDs of the router LSAs from which one of the
+   * LSAs can be reached, including the LSAs themselves, added to the set
+   */
+  void FindReachingRouters (std::set<Ipv4Address> const &ids, std::set<Ipv4Address> &routers) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+  typedef std::map<Ipv4Address, LSDBMap_t::const_iterator> LinkDataIndex_t; //!< container of link data / database entries
+
+  /**
+   * @param a a Link State Advertisement
+   * @param b another Link State Advertisement
+   * @returns true if both LSAs have the same contents
+   */
+  static bool IsSameLSA (GlobalRoutingLSA const *a, GlobalRoutingLSA const *b);
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  LinkDataIndex_t m_linkDataIndex; //!< router LSAs, by the link data of their TransitNetwork link records
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -735,6 +774,16 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the routes of the routers
+ * affected by the changes since the previous calculation.
+ *
+ * This is equivalent to DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes (), except that the routes of the routers which cannot
+ * reach any of the Link State Advertisements which changed are left untouched.
+ */
+  virtual void UpdateGlobalRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  * @param lsdb the pre-built LSDB
@@ -767,8 +816,52 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief Construct a worker computing the routes of some routers, in
+ * parallel with other workers.
+ *
+ * @param lsdb the LSDB of the route manager creating the worker, which the
+ * worker only reads and does not delete
+ */
+  GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+  typedef std::vector<std::pair<Ipv4Address, Ptr<Node> > > RouterList_t; //!< container of router IDs / nodes
+  typedef std::pair<GlobalRoutingLSA::SPFStatus, SPFVertex*> LSAStatus_t; //!< SPF status of an LSA / vertex of a candidate LSA
+  typedef std::unordered_map<GlobalRoutingLSA*, LSAStatus_t> LSAStatusMap_t; //!< container of LSAs / SPF status
+
   SPFVertex* m_spfroot; //!< the root node
+  Ptr<Node> m_spfrootNode; //!< the node of the root, which gets the routes
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  /**
+   * The SPF status of the LSAs explored by the current SPF calculation.  It
+   * is kept here rather than in the LSAs so that workers can run SPF
+   * calculations on the same LSDB.
+   */
+  LSAStatusMap_t m_lsaStatus;
+  RouterList_t m_workerRoots; //!< the routers whose routes are computed by a worker
+
+  /**
+   * \brief Delete the routes of a router
+   *
+   * \param node the node of the router
+   * \param router the router
+   */
+  void DeleteRoutes (Ptr<Node> node, Ptr<GlobalRouter> router);
+
+  /**
+   * \brief Compute the routes of some routers
+   *
+   * The SPF calculations are spread over the number of threads set by the
+   * "GlobalRoutingThreads" global value.
+   *
+   * \param roots the routers
+   */
+  void CalculateRoutes (RouterList_t const &roots);
+
+  /**
+   * \brief Compute the routes of the routers of a worker
+   */
+  void CalculateWorkerRoutes (void);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -787,8 +880,9 @@ private:
    *
    * Equivalent to quagga ospf_spf_calculate
    * \param root the root node
+   * \param node the node of the root, if any, which gets the routes
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (Ipv4Address root, Ptr<Node> node);
 
   /**
    * \brief Process Stub nodes
@@ -936,8 +1030,8 @@ private:
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
    *
-   * This is a wrapper around GetInterfaceForPrefix(), but we first
-   * have to find the right node pointer to pass to that function.
+   * This is a wrapper around GetInterfaceForPrefix(), called on the node
+   * at the root of the SPF tree.
    * If no such interface is found, return -1 (note:  unit test framework
    * for routing assumes -1 to be a legal return value)
    *
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gso-tag.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (GsoTag);
+
+GsoTag::GsoTag ()
+  : m_segmentSize (0)
+{
+}
+
+GsoTag::GsoTag (uint32_t segmentSize)
+  : m_segmentSize (segmentSize)
+{
+}
+
+TypeId
+GsoTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GsoTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<GsoTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+GsoTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+GsoTag::SetSegmentSize (uint32_t segmentSize)
+{
+  m_segmentSize = segmentSize;
+}
+
+uint32_t
+GsoTag::GetSegmentSize (void) const
+{
+  return m_segmentSize;
+}
+
+uint32_t
+GsoTag::GetSerializedSize (void) const
+{
+  return sizeof (uint32_t);
+}
+
+void
+GsoTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_segmentSize);
+}
+
+void
+GsoTag::Deserialize (TagBuffer i)
+{
+  m_segmentSize = i.ReadU32 ();
+}
+
+void
+GsoTag::Print (std::ostream &os) const
+{
+  os << "GsoTag SegmentSize=" << m_segmentSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef GSO_TAG_H
+#define GSO_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup internet
+ *
+ * \brief Tag of a super-segment sent with generic segmentation offload
+ *
+ * TcpSocketBase adds this tag to the super-segments that it does not split
+ * into segments before the IP layer (see the TcpSocketBase attributes
+ * GsoMaxSegments and GsoSplit). The tag carries the size of the segments
+ * the super-segment stands for, like gso_size in Linux. Ipv4L3Protocol and
+ * Ipv6L3Protocol do not fragment tagged packets which exceed the MTU of
+ * their outgoing device, so that the super-segment crosses the network as
+ * a single packet; the devices on its path must accept such frames (e.g.,
+ * PointToPointNetDevice does not check the size of the frames it sends).
+ */
+class GsoTag : public Tag
+{
+public:
+  GsoTag ();
+
+  /**
+   * \brief Constructor
+   * \param segmentSize the size of the segments of the super-segment
+   */
+  GsoTag (uint32_t segmentSize);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Set the size of the segments of the super-segment
+   * \param segmentSize the segment size
+   */
+  void SetSegmentSize (uint32_t segmentSize);
+
+  /**
+   * \brief Get the size of the segments of the super-segment
+   * \returns the segment size
+   */
+  uint32_t GetSegmentSize (void) const;
+
+  // inherited functions, no doc necessary
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  uint32_t m_segmentSize; //!< Size of the segments of the super-segment
+};
+
+} // namespace ns3
+
+#endif /* GSO_TAG_H */
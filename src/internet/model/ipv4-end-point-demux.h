@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are also indexed by local port, and by local port and peer.
+ * A lookup only considers the endpoints connected to the source of the
+ * packet and the endpoints listening on its destination port (i.e., with
+ * wildcard peers), so that its cost does not depend on the number of
+ * connections.  The endpoints notify the demux when their peer changes.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +173,78 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /// Key of the endpoints with a local port and a peer
+  struct PeerKey
+  {
+    uint16_t localPort;     //!< Local port
+    Ipv4Address peerAddr;   //!< Peer address, any for wildcard peers
+    uint16_t peerPort;      //!< Peer port, 0 for wildcard peers
+
+    /**
+     * \param other another key
+     * \returns true if the keys are equal
+     */
+    bool operator == (PeerKey const &other) const;
+  };
+
+  /// Hash function class for PeerKey
+  struct PeerKeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator () (PeerKey const &key) const;
+  };
+
+  /// Positions of an endpoint in the list and in the indexes
+  struct Position
+  {
+    EndPointsI all;     //!< Position in m_endPoints
+    EndPointsI port;    //!< Position in the endpoints of the local port
+    EndPointsI peer;    //!< Position in the endpoints of the peer
+    PeerKey key;        //!< Key of the endpoints of the peer
+  };
+
+  /**
+   * \brief Add a new endpoint to the list and to the indexes.
+   * \param endPoint the endpoint
+   * \returns the endpoint
+   */
+  Ipv4EndPoint *Insert (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Index an endpoint by its peer.
+   * \param endPoint the endpoint
+   * \param position the positions of the endpoint
+   */
+  void InsertPeer (Ipv4EndPoint *endPoint, Position &position);
+
+  /**
+   * \brief Remove an endpoint from the index of the peers.
+   * \param position the positions of the endpoint
+   */
+  void RemovePeer (Position &position);
+
+  /**
+   * \brief Update the index of the peers after the peer of an endpoint changed.
+   *
+   * Called by Ipv4EndPoint::SetPeer.
+   *
+   * \param endPoint the endpoint
+   */
+  void NotifyPeerChanged (Ipv4EndPoint *endPoint);
+
+  /**
+   * \param localPort the local port
+   * \param peerAddr the peer address
+   * \param peerPort the peer port
+   * \returns the endpoints with the local port and peer, or 0 if there are none
+   */
+  EndPoints *GetPeerEndPoints (uint16_t localPort, Ipv4Address peerAddr, uint16_t peerPort);
+
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +271,21 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points of each local port, in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_portEndPoints;
+
+  /**
+   * \brief The end points of each local port and peer.
+   */
+  std::unordered_map<PeerKey, EndPoints, PeerKeyHash> m_peerEndPoints;
+
+  /**
+   * \brief The positions of the end points.
+   */
+  std::unordered_map<Ipv4EndPoint *, Position> m_positions;
 };
 
 } // namespace ns3
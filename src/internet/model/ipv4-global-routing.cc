@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -27,6 +28,9 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -43,11 +47,34 @@ Ipv4GlobalRouting::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::Ipv4GlobalRouting")
     .SetParent<Object> ()
     .SetGroupName ("Internet")
+    .AddConstructor<Ipv4GlobalRouting> ()
     .AddAttribute ("RandomEcmpRouting",
                    "Set to true if packets are randomly routed among ECMP; set to false for using only one route consistently",
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_randomEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("EcmpMode",
+                   "How the route of a packet is chosen among ECMP routes, unless RandomEcmpRouting is set",
+                   EnumValue (Ipv4GlobalRouting::ECMP_FIRST),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::m_ecmpMode),
+                   MakeEnumChecker (Ipv4GlobalRouting::ECMP_FIRST, "First",
+                                    Ipv4GlobalRouting::ECMP_FLOW_HASH, "FlowHash",
+                                    Ipv4GlobalRouting::ECMP_FLOWLET, "Flowlet"))
+    .AddAttribute ("EcmpHashSeed",
+                   "The seed of the flow hash. Routers using different seeds avoid hash polarization.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_ecmpHashSeed),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FlowletGap",
+                   "The idle time after which the next packet of a flow starts a new flowlet",
+                   TimeValue (MicroSeconds (500)),
+                   MakeTimeAccessor (&Ipv4GlobalRouting::m_flowletGap),
+                   MakeTimeChecker ())
+    .AddAttribute ("FlowletTableSize",
+                   "The number of entries of the flowlet table, shared by the flows of the same hash",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_flowletTableSize),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -59,7 +86,13 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_ecmpMode (ECMP_FIRST),
+    m_ecmpHashSeed (0),
+    m_flowletTableSize (4096),
+    m_nIndexedRoutes (0),
+    m_nonPrefixRoutes (0),
+    m_routeInputVersion (1)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +113,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_routeInputVersion++;
+  m_hostRouteIndex[dest].push_back (route);
 }
 
 void 
@@ -90,6 +125,8 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_routeInputVersion++;
+  m_hostRouteIndex[dest].push_back (route);
 }
 
 void 
@@ -105,6 +142,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeInputVersion++;
+  IndexNetworkRoute (m_networkRouteIndex, route);
 }
 
 void 
@@ -118,6 +157,8 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_routeInputVersion++;
+  IndexNetworkRoute (m_networkRouteIndex, route);
 }
 
 void 
@@ -133,101 +174,363 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_routeInputVersion++;
+  IndexNetworkRoute (m_ASexternalRouteIndex, route);
 }
 
+bool
+Ipv4GlobalRouting::GetIndexKey (const Ipv4RoutingTableEntry *route, uint8_t key[4], uint8_t &length)
+{
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint32_t hostBits = ~mask.Get ();
+  if ((hostBits & (hostBits + 1)) != 0)
+    {
+      return false;
+    }
+  route->GetDestNetwork ().CombineMask (mask).Serialize (key);
+  length = mask.GetPrefixLength ();
+  return true;
+}
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+void
+Ipv4GlobalRouting::IndexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  uint8_t key[4];
+  uint8_t length;
+  if (GetIndexKey (route, key, length))
+    {
+      index.Insert (key, length, IndexedRoute (m_nIndexedRoutes++, route));
+    }
+  else
+    {
+      m_nonPrefixRoutes++;
+    }
+}
+
+void
+Ipv4GlobalRouting::UnindexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  uint8_t key[4];
+  uint8_t length;
+  if (!GetIndexKey (route, key, length))
+    {
+      m_nonPrefixRoutes--;
+      return;
+    }
+  NetworkRouteIndex::Values const *routes = index.Find (key, length);
+  NS_ASSERT (routes != 0);
+  for (IndexedRoute const &indexed : *routes)
+    {
+      if (indexed.second == route)
+        {
+          IndexedRoute removed = indexed;
+          index.Remove (key, length, removed);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Route not indexed");
+}
+
+void
+Ipv4GlobalRouting::LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif, RouteVec &routes)
 {
   NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  std::unordered_map<Ipv4Address, RouteVec, Ipv4AddressHash>::const_iterator host = m_hostRouteIndex.find (dest);
+  if (host != m_hostRouteIndex.end ())
+    {
+      for (Ipv4RoutingTableEntry *route : host->second)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          routes.push_back (route);
+          NS_LOG_LOGIC (routes.size () << "Found global host route" << route);
+        }
+    }
+  if (routes.size () > 0)
+    {
+      return;
+    }
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  uint8_t key[4];
+  dest.Serialize (key);
+  // all the matching network routes are candidates, whatever the mask
+  // length, in the order they were added
+  std::vector<IndexedRoute> candidates;
+  m_networkRouteIndex.Match (key, [&] (uint8_t length, NetworkRouteIndex::Values const &values)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest () == dest)
+      for (IndexedRoute const &indexed : values)
         {
-          if (oif != 0)
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (indexed.second->GetInterface ()))
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          candidates.push_back (indexed);
+        }
+    });
+  if (candidates.size () > 0)
+    {
+      std::sort (candidates.begin (), candidates.end ());
+      for (IndexedRoute const &indexed : candidates)
+        {
+          routes.push_back (indexed.second);
+          NS_LOG_LOGIC (routes.size () << "Found global network route" << indexed.second);
+        }
+      return;
+    }
+
+  // only the first matching external route is a candidate
+  IndexedRoute first (0, 0);
+  m_ASexternalRouteIndex.Match (key, [&] (uint8_t length, NetworkRouteIndex::Values const &values)
+    {
+      for (IndexedRoute const &indexed : values)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (indexed.second->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          if (first.second == 0 || indexed.first < first.first)
+            {
+              first = indexed;
+            }
+          break;
+        }
+    });
+  if (first.second != 0)
+    {
+      NS_LOG_LOGIC ("Found external route" << first.second);
+      routes.push_back (first.second);
+    }
+}
+
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const
+{
+  uint8_t prot = header.GetProtocol ();
+  uint16_t srcPort = 0;
+  uint16_t destPort = 0;
+  // Use the ports of the unfragmented TCP and UDP packets only, so that the
+  // fragments of a packet follow the same route
+  if (p != 0 && (prot == 6 || prot == 17) && header.IsLastFragment ()
+      && header.GetFragmentOffset () == 0 && p->GetSize () >= 4)
+    {
+      // the ports are the first four bytes of the TCP and UDP headers
+      uint8_t ports[4];
+      p->CopyData (ports, 4);
+      srcPort = (ports[0] << 8) | ports[1];
+      destPort = (ports[2] << 8) | ports[3];
+    }
+
+  // serialize the 5-tuple and the seed in buf, as Ipv4QueueDiscItem::Hash
+  uint8_t buf[17];
+  header.GetSource ().Serialize (buf);
+  header.GetDestination ().Serialize (buf + 4);
+  buf[8] = prot;
+  buf[9] = (srcPort >> 8) & 0xff;
+  buf[10] = srcPort & 0xff;
+  buf[11] = (destPort >> 8) & 0xff;
+  buf[12] = destPort & 0xff;
+  buf[13] = (m_ecmpHashSeed >> 24) & 0xff;
+  buf[14] = (m_ecmpHashSeed >> 16) & 0xff;
+  buf[15] = (m_ecmpHashSeed >> 8) & 0xff;
+  buf[16] = m_ecmpHashSeed & 0xff;
+  return Hash32 ((char*) buf, 17);
+}
+
+uint32_t
+Ipv4GlobalRouting::GetTotalWeight (const RouteVec &routes) const
+{
+  uint32_t total = 0;
+  for (Ipv4RoutingTableEntry *route : routes)
+    {
+      total += GetEcmpWeight (route->GetInterface ());
+    }
+  return total > 0 ? total : routes.size ();
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectWeighted (const RouteVec &routes, uint32_t value) const
+{
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      sum += GetEcmpWeight (routes[i]->GetInterface ());
+      if (value < sum)
+        {
+          return i;
+        }
+    }
+  // all the routes have weight 0
+  return value;
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectRoute (const RouteVec &routes, const Ipv4Header &header, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << header << p);
+  if (!m_randomEcmpRouting && (routes.size () == 1 || m_ecmpMode == ECMP_FIRST))
+    {
+      // the first route of non-zero weight, if any
+      for (uint32_t i = 0; i < routes.size (); i++)
+        {
+          if (GetEcmpWeight (routes[i]->GetInterface ()) > 0)
+            {
+              return i;
+            }
+        }
+      return 0;
+    }
+
+  uint32_t total = GetTotalWeight (routes);
+  uint32_t selectIndex;
+  if (m_randomEcmpRouting)
+    {
+      // pick up one of the routes at random, for each packet
+      selectIndex = SelectWeighted (routes, m_rand->GetInteger (0, total - 1));
+    }
+  else if (m_ecmpMode == ECMP_FLOW_HASH)
+    {
+      uint64_t hash = GetFlowHash (header, p);
+      selectIndex = SelectWeighted (routes, (hash * total) >> 32);
+    }
+  else
+    {
+      NS_ASSERT (m_ecmpMode == ECMP_FLOWLET);
+      if (m_flowlets.size () != m_flowletTableSize)
+        {
+          Flowlet empty = {-1, 0};
+          m_flowlets.assign (m_flowletTableSize, empty);
+        }
+      Flowlet &flowlet = m_flowlets[GetFlowHash (header, p) % m_flowlets.size ()];
+      int64_t now = Simulator::Now ().GetTimeStep ();
+      selectIndex = routes.size ();
+      if (flowlet.lastSeen >= 0 && now - flowlet.lastSeen < m_flowletGap.GetTimeStep ())
+        {
+          // keep the route of the flowlet, if still available
+          for (uint32_t i = 0; i < routes.size (); i++)
+            {
+              if (routes[i]->GetInterface () == flowlet.interface)
                 {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
+                  selectIndex = i;
+                  break;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
         }
+      if (selectIndex == routes.size ())
+        {
+          NS_LOG_LOGIC ("New flowlet");
+          selectIndex = SelectWeighted (routes, m_rand->GetInteger (0, total - 1));
+          flowlet.interface = routes[selectIndex]->GetInterface ();
+        }
+      flowlet.lastSeen = now;
     }
-  if (allRoutes.size () == 0) // if no host route is found
+
+  uint32_t interface = routes[selectIndex]->GetInterface ();
+  if (routes.size () > 1)
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      if (interface >= m_ecmpInterfaces.size ())
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          EcmpInterface ecmpInterface = {1, 0};
+          m_ecmpInterfaces.resize (interface + 1, ecmpInterface);
+        }
+      m_ecmpInterfaces[interface].selections++;
+    }
+  return selectIndex;
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << header << p << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << header.GetDestination ());
+  Ipv4Address dest = header.GetDestination ();
+  Ptr<Ipv4Route> rtentry = 0;
+  // store all available routes that bring packets to their destination
+  RouteVec allRoutes;
+
+  if (m_nonPrefixRoutes == 0)
+    {
+      LookupIndex (dest, oif, allRoutes);
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
+      for (HostRoutesCI i = m_hostRoutes.begin (); 
+           i != m_hostRoutes.end (); 
+           i++) 
+        {
+          NS_ASSERT ((*i)->IsHost ());
+          if ((*i)->GetDest () == dest)
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              allRoutes.push_back (*i);
+              NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
             }
         }
-    }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
-    {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      if (allRoutes.size () == 0) // if no host route is found
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
+          for (NetworkRoutesI j = m_networkRoutes.begin (); 
+               j != m_networkRoutes.end (); 
+               j++) 
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
+              Ipv4Mask mask = (*j)->GetDestNetworkMask ();
+              Ipv4Address entry = (*j)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry)) 
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != 0)
                     {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
+                      if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
+                    }
+                  allRoutes.push_back (*j);
+                  NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+                }
+            }
+        }
+      if (allRoutes.size () == 0)  // consider external if no host/network found
+        {
+          for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
+               k != m_ASexternalRoutes.end ();
+               k++)
+            {
+              Ipv4Mask mask = (*k)->GetDestNetworkMask ();
+              Ipv4Address entry = (*k)->GetDestNetwork ();
+              if (mask.IsMatch (dest, entry))
+                {
+                  NS_LOG_LOGIC ("Found external route" << *k);
+                  if (oif != 0)
+                    {
+                      if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                        {
+                          NS_LOG_LOGIC ("Not on requested interface, skipping");
+                          continue;
+                        }
                     }
+                  allRoutes.push_back (*k);
+                  break;
                 }
-              allRoutes.push_back (*k);
-              break;
             }
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
-        {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
-        }
-      else 
-        {
-          selectIndex = 0;
-        }
+      uint32_t selectIndex = SelectRoute (allRoutes, header, p);
       Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
@@ -305,10 +608,37 @@ Ipv4GlobalRouting::GetRoute (uint32_t index) const
   // quiet compiler.
   return 0;
 }
+void
+Ipv4GlobalRouting::SetEcmpWeight (uint32_t interface, uint16_t weight)
+{
+  NS_LOG_FUNCTION (this << interface << weight);
+  if (interface >= m_ecmpInterfaces.size ())
+    {
+      EcmpInterface ecmpInterface = {1, 0};
+      m_ecmpInterfaces.resize (interface + 1, ecmpInterface);
+    }
+  m_ecmpInterfaces[interface].weight = weight;
+  // the route chosen in the First mode may change
+  m_routeInputVersion++;
+}
+
+uint16_t
+Ipv4GlobalRouting::GetEcmpWeight (uint32_t interface) const
+{
+  return interface < m_ecmpInterfaces.size () ? m_ecmpInterfaces[interface].weight : 1;
+}
+
+uint64_t
+Ipv4GlobalRouting::GetEcmpSelections (uint32_t interface) const
+{
+  return interface < m_ecmpInterfaces.size () ? m_ecmpInterfaces[interface].selections : 0;
+}
+
 void 
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_routeInputVersion++;
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -319,6 +649,12 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              RouteVec &indexed = m_hostRouteIndex[(*i)->GetDest ()];
+              indexed.erase (std::find (indexed.begin (), indexed.end (), *i));
+              if (indexed.empty ())
+                {
+                  m_hostRouteIndex.erase ((*i)->GetDest ());
+                }
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +672,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexNetworkRoute (m_networkRouteIndex, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +689,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexNetworkRoute (m_ASexternalRouteIndex, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +730,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostRouteIndex.clear ();
+  m_networkRouteIndex.Clear ();
+  m_ASexternalRouteIndex.Clear ();
+  m_nonPrefixRoutes = 0;
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -475,7 +817,9 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  // The packets of TcpL4Protocol and UdpSocketImpl start with their
+  // transport header, whose ports are hashed
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -524,7 +868,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -544,9 +888,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -556,9 +898,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -568,9 +908,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -580,9 +918,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -594,5 +930,12 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   m_ipv4 = ipv4;
 }
 
+uint32_t
+Ipv4GlobalRouting::GetRouteInputVersion (void) const
+{
+  // Only the first route among equal cost paths can be cached
+  return (m_randomEcmpRouting || m_ecmpMode != ECMP_FIRST) ? 0 : m_routeInputVersion;
+}
+
 
 } // namespace ns3
@@ -21,6 +21,8 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +30,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -65,6 +68,18 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * When several routes of equal cost lead to a destination, the route of a
+ * packet is chosen according to the "EcmpMode" attribute: always the first
+ * route, by a hash of the 5-tuple of the packet (so that the packets of a
+ * flow follow the same path), or by flowlet switching, where a flow moves to
+ * another route, chosen at random, when it has been idle for "FlowletGap".
+ * The routes are weighted by the ECMP weight of their output interface (see
+ * SetEcmpWeight); in the first route mode, the routes of weight 0 are
+ * skipped. "RandomEcmpRouting", which chooses a route at random for each
+ * packet, takes precedence over "EcmpMode".  The packets sent by the node
+ * itself are hashed with their ports when they are given to RouteOutput
+ * with their transport header, as by TcpL4Protocol and UdpSocketImpl.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -76,6 +91,17 @@ public:
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /**
+   * \brief Selection of a route among equal-cost multipath (ECMP) routes
+   */
+  enum EcmpMode
+  {
+    ECMP_FIRST,     //!< The first route, always
+    ECMP_FLOW_HASH, //!< By a hash of the 5-tuple of the packet
+    ECMP_FLOWLET    //!< At random, for each flowlet of a flow
+  };
+
   /**
    * \brief Construct an empty Ipv4GlobalRouting routing protocol,
    *
@@ -99,6 +125,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteInputVersion (void) const;
 
   /**
    * \brief Add a host route to the global routing table.
@@ -218,6 +245,34 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Set the weight of the routes through an interface among
+   * equal-cost routes.
+   *
+   * The share of the flows, flowlets or packets routed through an interface
+   * is proportional to its weight.  An interface of weight 0 is only used if
+   * all the equal-cost routes have weight 0.  In the first route mode, the
+   * first route of non-zero weight is used.
+   *
+   * \param interface the interface index
+   * \param weight the weight (1 by default)
+   */
+  void SetEcmpWeight (uint32_t interface, uint16_t weight);
+
+  /**
+   * \param interface the interface index
+   * \returns the weight of the routes through the interface among
+   * equal-cost routes
+   */
+  uint16_t GetEcmpWeight (uint32_t interface) const;
+
+  /**
+   * \param interface the interface index
+   * \returns the number of packets routed through the interface after a
+   * choice among several equal-cost routes
+   */
+  uint64_t GetEcmpSelections (uint32_t interface) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -238,6 +293,27 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  EcmpMode m_ecmpMode;          //!< Selection of the route among ECMP routes
+  uint32_t m_ecmpHashSeed;      //!< Seed of the flow hash
+  Time m_flowletGap;            //!< Idle time after which a flow may change route
+  uint32_t m_flowletTableSize;  //!< Number of entries of the flowlet table
+
+  /// ECMP state of an interface
+  struct EcmpInterface
+  {
+    uint16_t weight;     //!< Weight among the equal-cost routes
+    uint64_t selections; //!< Number of packets routed through the interface after a choice
+  };
+  std::vector<EcmpInterface> m_ecmpInterfaces; //!< ECMP state, by interface index
+
+  /// Entry of the flowlet table
+  struct Flowlet
+  {
+    int64_t lastSeen;   //!< Time step of the last packet, negative if none
+    uint32_t interface; //!< Output interface of the flowlet
+  };
+  /// Flowlet table, by flow hash; the flows of the same slot share their flowlets, as in switches
+  std::vector<Flowlet> m_flowlets;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -260,18 +336,106 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
+  /// container of the routes to a destination
+  typedef std::vector<Ipv4RoutingTableEntry *> RouteVec;
+
+  /// a route and its insertion number, which orders the routes of the index as in the lists
+  typedef std::pair<uint64_t, Ipv4RoutingTableEntry *> IndexedRoute;
+
+  /// index of the routes to networks, by destination network
+  typedef PrefixTrie<IndexedRoute, 4> NetworkRouteIndex;
+
   /**
-   * \brief Lookup in the forwarding table for destination.
+   * \brief Add a route to a network or external AS to an index.
+   * \param index the index
+   * \param route the route
+   */
+  void IndexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove a route to a network or external AS from an index.
+   * \param index the index
+   * \param route the route
+   */
+  void UnindexNetworkRoute (NetworkRouteIndex &index, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Get the key of a route to a network in the indices.
+   * \param route the route
+   * \param key the destination network, in network byte order
+   * \param length the length of the network mask
+   * \return false if the network mask is not a prefix, so that the route can not be indexed
+   */
+  static bool GetIndexKey (const Ipv4RoutingTableEntry *route, uint8_t key[4], uint8_t &length);
+
+  /**
+   * \brief Find the routes to a destination with the indices.
+   *
+   * The routes are the same, and in the same order, as those found by
+   * scanning the lists.
+   *
    * \param dest destination address
    * \param oif output interface if any (put 0 otherwise)
+   * \param routes the routes found
+   */
+  void LookupIndex (Ipv4Address dest, Ptr<NetDevice> oif, RouteVec &routes);
+
+  /**
+   * \brief Hash the flow of a packet.
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, starting with its transport header,
+   * or 0 if the ports are not known
+   * \return the hash of the 5-tuple, or of the addresses and protocol if the
+   * ports are not known
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const;
+
+  /**
+   * \brief Get the sum of the ECMP weights of routes.
+   * \param routes the routes
+   * \return the sum of the weights, or the number of routes if they all
+   * have weight 0, in which case they are all used
+   */
+  uint32_t GetTotalWeight (const RouteVec &routes) const;
+
+  /**
+   * \brief Choose a route among weighted routes.
+   * \param routes the routes
+   * \param value a value in [0, GetTotalWeight (routes))
+   * \return the index of the route
+   */
+  uint32_t SelectWeighted (const RouteVec &routes, uint32_t value) const;
+
+  /**
+   * \brief Choose the route of a packet among equal-cost routes.
+   * \param routes the routes, not empty
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, or 0 if the ports are not known
+   * \return the index of the route
+   */
+  uint32_t SelectRoute (const RouteVec &routes, const Ipv4Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Lookup in the forwarding table for destination.
+   * \param header the IPv4 header of the packet
+   * \param p the payload of the packet, or 0 if the ports are not known
+   * \param oif output interface if any (put 0 otherwise)
    * \return Ipv4Route to route the packet to reach dest address
    */
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif = 0);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  /// Routes to hosts, by destination, in the order of m_hostRoutes
+  std::unordered_map<Ipv4Address, RouteVec, Ipv4AddressHash> m_hostRouteIndex;
+  NetworkRouteIndex m_networkRouteIndex;    //!< Routes to networks, by destination network
+  NetworkRouteIndex m_ASexternalRouteIndex; //!< External routes, by destination network
+  uint64_t m_nIndexedRoutes;  //!< Number of routes added to the indices so far
+  uint32_t m_nonPrefixRoutes; //!< Number of routes whose network mask is not a prefix; lookups scan the lists if any
+  uint32_t m_routeInputVersion; //!< Version of the routes, see GetRouteInputVersion
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
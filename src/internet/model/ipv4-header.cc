@@ -22,6 +22,8 @@
 #include "ns3/abort.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/header-image.h"
+#include "ns3/ip-checksum.h"
 #include "ipv4-header.h"
 
 namespace ns3 {
@@ -383,13 +385,15 @@ void
 Ipv4Header::Serialize (Buffer::Iterator start) const
 {
   NS_LOG_FUNCTION (this << &start);
-  Buffer::Iterator i = start;
 
-  uint8_t verIhl = (4 << 4) | (5);
-  i.WriteU8 (verIhl);
-  i.WriteU8 (m_tos);
-  i.WriteHtonU16 (m_payloadSize + 5*4);
-  i.WriteHtonU16 (m_identification);
+  // Byte image of the header with the constant fields set: version 4,
+  // header length 5 words, zero checksum
+  static const uint8_t image[20] = { (4 << 4) | 5 };
+  uint8_t *data = start.WriteImage (image, sizeof (image));
+
+  data[1] = m_tos;
+  HeaderImage::WriteHtonU16 (data + 2, m_payloadSize + 5*4);
+  HeaderImage::WriteHtonU16 (data + 4, m_identification);
   uint32_t fragmentOffset = m_fragmentOffset / 8;
   uint8_t flagsFrag = (fragmentOffset >> 8) & 0x1f;
   if (m_flags & DONT_FRAGMENT) 
@@ -400,25 +404,21 @@ Ipv4Header::Serialize (Buffer::Iterator start) const
     {
       flagsFrag |= (1<<5);
     }
-  i.WriteU8 (flagsFrag);
-  uint8_t frag = fragmentOffset & 0xff;
-  i.WriteU8 (frag);
-  i.WriteU8 (m_ttl);
-  i.WriteU8 (m_protocol);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU32 (m_source.Get ());
-  i.WriteHtonU32 (m_destination.Get ());
+  data[6] = flagsFrag;
+  data[7] = fragmentOffset & 0xff;
+  data[8] = m_ttl;
+  data[9] = m_protocol;
+  HeaderImage::WriteHtonU32 (data + 12, m_source.Get ());
+  HeaderImage::WriteHtonU32 (data + 16, m_destination.Get ());
 
   if (m_calcChecksum) 
     {
-      i = start;
-      uint16_t checksum = i.CalculateIpChecksum (20);
+      uint16_t checksum = ~IpChecksumCalculate (data, 20);
       NS_LOG_LOGIC ("checksum=" <<checksum);
-      i = start;
-      i.Next (10);
-      i.WriteU16 (checksum);
+      HeaderImage::WriteU16 (data + 10, checksum);
     }
 }
+
 uint32_t
 Ipv4Header::Deserialize (Buffer::Iterator start)
 {
@@ -43,6 +43,7 @@
 #include "icmpv4-l4-protocol.h"
 #include "ipv4-interface.h"
 #include "ipv4-raw-socket-impl.h"
+#include "gso-tag.h"
 
 namespace ns3 {
 
@@ -71,6 +72,20 @@ Ipv4L3Protocol::GetTypeId (void)
                    TimeValue (Seconds (30)),
                    MakeTimeAccessor (&Ipv4L3Protocol::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("FragmentReassemblyBufferSize",
+                   "The maximum number of bytes held by the fragments "
+                   "waiting for reassembly. When it is exceeded, the "
+                   "oldest packets are dropped. Zero meaning infinite.",
+                   UintegerValue (4 * 1024 * 1024),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_fragmentReassemblyBufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RouteCacheSize",
+                   "The maximum number of routes cached for the forwarded "
+                   "unicast packets, by destination and input interface. "
+                   "Zero disables the cache.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&Ipv4L3Protocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("EnableDuplicatePacketDetection",
                    "Enable multicast duplicate packet detection based on RFC 6621",
                    BooleanValue (false),
@@ -130,6 +145,11 @@ Ipv4L3Protocol::GetTypeId (void)
 }
 
 Ipv4L3Protocol::Ipv4L3Protocol()
+  : m_fragmentsSize (0),
+    m_routeCacheVersion (0),
+    m_routeCacheKey (0),
+    m_routeCacheHits (0),
+    m_routeCacheMisses (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -293,6 +313,7 @@ Ipv4L3Protocol::SetRoutingProtocol (Ptr<Ipv4RoutingProtocol> routingProtocol)
   NS_LOG_FUNCTION (this << routingProtocol);
   m_routingProtocol = routingProtocol;
   m_routingProtocol->SetIpv4 (this);
+  FlushRouteCache ();
 }
 
 
@@ -323,6 +344,7 @@ Ipv4L3Protocol::DoDispose (void)
   m_sockets.clear ();
   m_node = 0;
   m_routingProtocol = 0;
+  m_routeCache.clear ();
 
   for (MapFragments_t::iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
@@ -330,6 +352,7 @@ Ipv4L3Protocol::DoDispose (void)
     }
 
   m_fragments.clear ();
+  m_fragmentsSize = 0;
   m_timeoutEventList.clear ();
   if (m_timeoutEvent.IsRunning ())
     {
@@ -422,6 +445,7 @@ Ipv4L3Protocol::AddIpv4Interface (Ptr<Ipv4Interface>interface)
   uint32_t index = m_interfaces.size ();
   m_interfaces.push_back (interface);
   m_reverseInterfacesContainer[interface->GetDevice ()] = index;
+  FlushRouteCache ();
   return index;
 }
 
@@ -661,7 +685,36 @@ Ipv4L3Protocol::Receive ( Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t p
     }
 
   NS_ASSERT_MSG (m_routingProtocol != 0, "Need a routing protocol object to process packets");
+
+  // Look up the route of the unicast packets in the cache first
+  Ipv4Address destination = ipHeader.GetDestination ();
+  uint32_t routeVersion = 0;
+  if (m_routeCacheSize > 0 && !destination.IsMulticast () && !destination.IsBroadcast ())
+    {
+      routeVersion = m_routingProtocol->GetRouteInputVersion ();
+    }
+  if (routeVersion != 0)
+    {
+      if (routeVersion != m_routeCacheVersion)
+        {
+          NS_LOG_LOGIC ("Routes changed, flushing the route cache");
+          m_routeCache.clear ();
+          m_routeCacheVersion = routeVersion;
+        }
+      m_routeCacheKey = (static_cast<uint64_t> (destination.Get ()) << 32) | static_cast<uint32_t> (interface);
+      std::unordered_map<uint64_t, Ptr<Ipv4Route> >::const_iterator it = m_routeCache.find (m_routeCacheKey);
+      if (it != m_routeCache.end ())
+        {
+          NS_LOG_LOGIC ("Found cached route to " << destination);
+          m_routeCacheHits++;
+          IpForward (it->second, packet, ipHeader);
+          return;
+        }
+    }
+
   if (!m_routingProtocol->RouteInput (packet, ipHeader, device,
+                                      routeVersion != 0 ?
+                                      MakeCallback (&Ipv4L3Protocol::CacheAndForward, this) :
                                       MakeCallback (&Ipv4L3Protocol::IpForward, this),
                                       MakeCallback (&Ipv4L3Protocol::IpMulticastForward, this),
                                       MakeCallback (&Ipv4L3Protocol::LocalDeliver, this),
@@ -717,6 +770,25 @@ Ipv4L3Protocol::IsUnicast (Ipv4Address ad) const
   return true;
 }
 
+void
+Ipv4L3Protocol::FlushRouteCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_routeCache.clear ();
+}
+
+uint64_t
+Ipv4L3Protocol::GetRouteCacheHits (void) const
+{
+  return m_routeCacheHits;
+}
+
+uint64_t
+Ipv4L3Protocol::GetRouteCacheMisses (void) const
+{
+  return m_routeCacheMisses;
+}
+
 bool
 Ipv4L3Protocol::IsUnicast (Ipv4Address ad, Ipv4Mask interfaceMask) const
 {
@@ -914,8 +986,7 @@ Ipv4L3Protocol::DecreaseIdentification (Ipv4Address source,
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
-  m_identification[key]--;
+  m_identification[IdentificationKey_t (srcDst, protocol)]--;
 }
 
 Ipv4Header
@@ -940,13 +1011,13 @@ Ipv4L3Protocol::BuildHeader (
   uint64_t src = source.Get ();
   uint64_t dst = destination.Get ();
   uint64_t srcDst = dst | (src << 32);
-  std::pair<uint64_t, uint8_t> key = std::make_pair (srcDst, protocol);
+  uint16_t &identification = m_identification[IdentificationKey_t (srcDst, protocol)];
 
   if (mayFragment == true)
     {
       ipHeader.SetMayFragment ();
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   else
     {
@@ -955,8 +1026,8 @@ Ipv4L3Protocol::BuildHeader (
       // identification requirement:
       // >> Originating sources MAY set the IPv4 ID field of atomic datagrams
       //    to any value.
-      ipHeader.SetIdentification (m_identification[key]);
-      m_identification[key]++;
+      ipHeader.SetIdentification (identification);
+      identification++;
     }
   if (Node::ChecksumEnabled ())
     {
@@ -999,7 +1070,10 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   if (outInterface->IsUp ())
     {
       NS_LOG_LOGIC ("Send to " << targetLabel << " " << target);
-      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+      GsoTag gsoTag;
+      // Super-segments sent with GSO are not fragmented
+      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+           && !packet->PeekPacketTag (gsoTag))
         {
           std::list<Ipv4PayloadHeaderPair> listFragments;
           DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
@@ -1094,6 +1168,20 @@ Ipv4L3Protocol::IpForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ip
   SendRealOut (rtentry, packet, ipHeader);
 }
 
+void
+Ipv4L3Protocol::CacheAndForward (Ptr<Ipv4Route> rtentry, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  NS_LOG_FUNCTION (this << rtentry << p << header);
+  m_routeCacheMisses++;
+  if (m_routeCache.size () >= m_routeCacheSize)
+    {
+      NS_LOG_LOGIC ("Route cache full, flushing it");
+      m_routeCache.clear ();
+    }
+  m_routeCache[m_routeCacheKey] = rtentry;
+  IpForward (rtentry, p, header);
+}
+
 void
 Ipv4L3Protocol::LocalDeliver (Ptr<const Packet> packet, Ipv4Header const&ip, uint32_t iif)
 {
@@ -1163,6 +1251,7 @@ Ipv4L3Protocol::AddAddress (uint32_t i, Ipv4InterfaceAddress address)
   NS_LOG_FUNCTION (this << i << address);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   bool retVal = interface->AddAddress (address);
+  FlushRouteCache ();
   if (m_routingProtocol != 0)
     {
       m_routingProtocol->NotifyAddAddress (i, address);
@@ -1194,6 +1283,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, uint32_t addressIndex)
   Ipv4InterfaceAddress address = interface->RemoveAddress (addressIndex);
   if (address != Ipv4InterfaceAddress ())
     {
+      FlushRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, address);
@@ -1217,6 +1307,7 @@ Ipv4L3Protocol::RemoveAddress (uint32_t i, Ipv4Address address)
   Ipv4InterfaceAddress ifAddr = interface->RemoveAddress (address);
   if (ifAddr != Ipv4InterfaceAddress ())
     {
+      FlushRouteCache ();
       if (m_routingProtocol != 0)
         {
           m_routingProtocol->NotifyRemoveAddress (i, ifAddr);
@@ -1351,6 +1442,7 @@ Ipv4L3Protocol::SetUp (uint32_t i)
   if (interface->GetDevice ()->GetMtu () >= 68)
     {
       interface->SetUp ();
+      FlushRouteCache ();
 
       if (m_routingProtocol != 0)
         {
@@ -1369,6 +1461,7 @@ Ipv4L3Protocol::SetDown (uint32_t ifaceIndex)
   NS_LOG_FUNCTION (this << ifaceIndex);
   Ptr<Ipv4Interface> interface = GetInterface (ifaceIndex);
   interface->SetDown ();
+  FlushRouteCache ();
 
   if (m_routingProtocol != 0)
     {
@@ -1391,6 +1484,7 @@ Ipv4L3Protocol::SetForwarding (uint32_t i, bool val)
   NS_LOG_FUNCTION (this << i);
   Ptr<Ipv4Interface> interface = GetInterface (i);
   interface->SetForwarding (val);
+  FlushRouteCache ();
 }
 
 Ptr<NetDevice>
@@ -1409,6 +1503,7 @@ Ipv4L3Protocol::SetIpForward (bool forward)
     {
       (*i)->SetForwarding (forward);
     }
+  FlushRouteCache ();
 }
 
 bool 
@@ -1423,6 +1518,7 @@ Ipv4L3Protocol::SetWeakEsModel (bool model)
 {
   NS_LOG_FUNCTION (this << model);
   m_weakEsModel = model;
+  FlushRouteCache ();
 }
 
 bool 
@@ -1540,6 +1636,21 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
   key.first = addressCombination;
   key.second = idProto;
 
+  if (m_fragmentReassemblyBufferSize)
+    {
+      if (p->GetSize () > m_fragmentReassemblyBufferSize)
+        {
+          NS_LOG_LOGIC ("Fragment larger than the reassembly buffer");
+          m_dropTrace (ipHeader, packet, DROP_FRAGMENT_BUFFER_FULL, m_node->GetObject<Ipv4> (), iif);
+          return false;
+        }
+      // make room for the fragment, possibly dropping its own packet
+      while (m_fragmentsSize + p->GetSize () > m_fragmentReassemblyBufferSize)
+        {
+          DropOldestFragments ();
+        }
+    }
+
   Ptr<Fragments> fragments;
 
   MapFragments_t::iterator it = m_fragments.find (key);
@@ -1558,11 +1669,13 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 
   NS_LOG_LOGIC ("Adding fragment - Size: " << packet->GetSize ( ) << " - Offset: " << (ipHeader.GetFragmentOffset ()) );
 
+  m_fragmentsSize += p->GetSize ();
   fragments->AddFragment (p, ipHeader.GetFragmentOffset (), !ipHeader.IsLastFragment () );
 
   if ( fragments->IsEntire () )
     {
       packet = fragments->GetPacket ();
+      m_fragmentsSize -= fragments->GetSize ();
       m_timeoutEventList.erase (fragments->GetTimeoutIter ());
       fragments = 0;
       m_fragments.erase (key);
@@ -1573,7 +1686,10 @@ Ipv4L3Protocol::ProcessFragment (Ptr<Packet>& packet, Ipv4Header& ipHeader, uint
 }
 
 Ipv4L3Protocol::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_moreFragment (0),
+    m_contiguousEnd (0),
+    m_nextOffset (0),
+    m_size (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -1588,22 +1704,26 @@ Ipv4L3Protocol::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentO
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
-
-  for (it = m_fragments.begin (); it != m_fragments.end (); it++)
+  // fragments with the same offset are kept in arrival order
+  std::multimap<uint16_t, Ptr<Packet> >::iterator it = m_fragments.insert (std::make_pair (fragmentOffset, fragment));
+  if (std::next (it) == m_fragments.end ())
     {
-      if (it->second > fragmentOffset)
-        {
-          break;
-        }
+      m_moreFragment = moreFragment;
     }
+  m_size += fragment->GetSize ();
 
-  if (it == m_fragments.end ())
+  // A fragment below m_nextOffset starts within the contiguous data:
+  // it can only extend it. The others are merged in offset order.
+  if (fragmentOffset < m_nextOffset)
     {
-      m_moreFragment = moreFragment;
+      m_contiguousEnd = std::max (m_contiguousEnd, fragmentOffset + fragment->GetSize ());
+    }
+  for (it = m_fragments.lower_bound (m_nextOffset);
+       it != m_fragments.end () && it->first <= m_contiguousEnd; it++)
+    {
+      m_contiguousEnd = std::max (m_contiguousEnd, it->first + it->second->GetSize ());
+      m_nextOffset = it->first + 1;
     }
-
-  m_fragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
 }
 
 bool
@@ -1611,29 +1731,10 @@ Ipv4L3Protocol::Fragments::IsEntire () const
 {
   NS_LOG_FUNCTION (this);
 
-  bool ret = !m_moreFragment && m_fragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin (); it != m_fragments.end (); it++)
-        {
-          // overlapping fragments do exist
-          NS_LOG_LOGIC ("Checking overlaps " << lastEndOffset << " - " << it->second );
-
-          if (lastEndOffset < it->second)
-            {
-              ret = false;
-              break;
-            }
-          // fragments might overlap in strange ways
-          uint16_t fragmentEnd = it->first->GetSize () + it->second;
-          lastEndOffset = std::max ( lastEndOffset, fragmentEnd );
-        }
-    }
-
-  return ret;
+  // overlapping fragments do exist, but there is no hole if all the
+  // fragments start within the contiguous data
+  return !m_moreFragment && !m_fragments.empty ()
+         && m_nextOffset > m_fragments.rbegin ()->first;
 }
 
 Ptr<Packet>
@@ -1641,32 +1742,32 @@ Ipv4L3Protocol::Fragments::GetPacket () const
 {
   NS_LOG_FUNCTION (this);
 
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
+  std::multimap<uint16_t, Ptr<Packet> >::const_iterator it = m_fragments.begin ();
 
-  Ptr<Packet> p = it->first->Copy ();
+  Ptr<Packet> p = it->second->Copy ();
   uint16_t lastEndOffset = p->GetSize ();
   it++;
 
   for ( ; it != m_fragments.end (); it++)
     {
-      if ( lastEndOffset > it->second )
+      if ( lastEndOffset > it->first )
         {
           // The fragments are overlapping.
           // We do not overwrite the "old" with the "new" because we do not know when each arrived.
           // This is different from what Linux does.
           // It is not possible to emulate a fragmentation attack.
-          uint32_t newStart = lastEndOffset - it->second;
-          if ( it->first->GetSize () > newStart )
+          uint32_t newStart = lastEndOffset - it->first;
+          if ( it->second->GetSize () > newStart )
             {
-              uint32_t newSize = it->first->GetSize () - newStart;
-              Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
+              uint32_t newSize = it->second->GetSize () - newStart;
+              Ptr<Packet> tempFragment = it->second->CreateFragment (newStart, newSize);
               p->AddAtEnd (tempFragment);
             }
         }
       else
         {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
+          NS_LOG_LOGIC ("Adding: " << *(it->second) );
+          p->AddAtEnd (it->second);
         }
       lastEndOffset = p->GetSize ();
     }
@@ -1679,29 +1780,29 @@ Ipv4L3Protocol::Fragments::GetPartialPacket () const
 {
   NS_LOG_FUNCTION (this);
   
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_fragments.begin ();
+  std::multimap<uint16_t, Ptr<Packet> >::const_iterator it = m_fragments.begin ();
 
   Ptr<Packet> p = Create<Packet> ();
   uint16_t lastEndOffset = 0;
 
-  if ( m_fragments.begin ()->second > 0 )
+  if ( m_fragments.begin ()->first > 0 )
     {
       return p;
     }
 
   for ( it = m_fragments.begin (); it != m_fragments.end (); it++)
     {
-      if ( lastEndOffset > it->second )
+      if ( lastEndOffset > it->first )
         {
-          uint32_t newStart = lastEndOffset - it->second;
-          uint32_t newSize = it->first->GetSize () - newStart;
-          Ptr<Packet> tempFragment = it->first->CreateFragment (newStart, newSize);
+          uint32_t newStart = lastEndOffset - it->first;
+          uint32_t newSize = it->second->GetSize () - newStart;
+          Ptr<Packet> tempFragment = it->second->CreateFragment (newStart, newSize);
           p->AddAtEnd (tempFragment);
         }
-      else if ( lastEndOffset == it->second )
+      else if ( lastEndOffset == it->first )
         {
-          NS_LOG_LOGIC ("Adding: " << *(it->first) );
-          p->AddAtEnd (it->first);
+          NS_LOG_LOGIC ("Adding: " << *(it->second) );
+          p->AddAtEnd (it->second);
         }
       lastEndOffset = p->GetSize ();
     }
@@ -1709,6 +1810,12 @@ Ipv4L3Protocol::Fragments::GetPartialPacket () const
   return p;
 }
 
+uint32_t
+Ipv4L3Protocol::Fragments::GetSize () const
+{
+  return m_size;
+}
+
 void
 Ipv4L3Protocol::Fragments::SetTimeoutIter (FragmentsTimeoutsListI_t iter)
 {
@@ -1740,11 +1847,30 @@ Ipv4L3Protocol::HandleFragmentsTimeout (FragmentKey_t key, Ipv4Header & ipHeader
   m_dropTrace (ipHeader, packet, DROP_FRAGMENT_TIMEOUT, m_node->GetObject<Ipv4> (), iif);
 
   // clear the buffers
+  m_fragmentsSize -= it->second->GetSize ();
   it->second = 0;
 
   m_fragments.erase (key);
 }
 
+void
+Ipv4L3Protocol::DropOldestFragments (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the timeouts are sorted by arrival of the first fragment
+  FragmentKey_t key = std::get<1> (m_timeoutEventList.front ());
+  Ipv4Header ipHeader = std::get<2> (m_timeoutEventList.front ());
+  uint32_t iif = std::get<3> (m_timeoutEventList.front ());
+  m_timeoutEventList.pop_front ();
+
+  MapFragments_t::iterator it = m_fragments.find (key);
+  NS_LOG_LOGIC ("Reassembly buffer full, dropping " << it->second->GetSize () << " bytes");
+  m_dropTrace (ipHeader, it->second->GetPartialPacket (), DROP_FRAGMENT_BUFFER_FULL, m_node->GetObject<Ipv4> (), iif);
+  m_fragmentsSize -= it->second->GetSize ();
+  m_fragments.erase (it);
+}
+
 bool
 Ipv4L3Protocol::UpdateDuplicate (Ptr<const Packet> p, const Ipv4Header &header)
 {
@@ -1856,7 +1982,7 @@ Ipv4L3Protocol::SetTimeout (FragmentKey_t key, Ipv4Header ipHeader, uint32_t iif
 {
   Time now = Simulator::Now () + m_fragmentExpirationTimeout;
 
-  if (m_timeoutEventList.empty ())
+  if (!m_timeoutEvent.IsRunning ())
     {
       m_timeoutEvent = Simulator::Schedule (m_fragmentExpirationTimeout, &Ipv4L3Protocol::HandleTimeout, this);
     }
@@ -1872,7 +1998,7 @@ Ipv4L3Protocol::HandleTimeout (void)
 {
   Time now = Simulator::Now ();
 
-  while (!m_timeoutEventList.empty () && std::get<0> (*m_timeoutEventList.begin ()) == now)
+  while (!m_timeoutEventList.empty () && std::get<0> (*m_timeoutEventList.begin ()) <= now)
     {
       HandleFragmentsTimeout (std::get<1> (*m_timeoutEventList.begin ()),
                               std::get<2> (*m_timeoutEventList.begin ()),
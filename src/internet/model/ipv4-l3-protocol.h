@@ -23,6 +23,7 @@
 
 #include <list>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
@@ -102,7 +103,8 @@ public:
     DROP_INTERFACE_DOWN,   /**< Interface is down so can not send packet */
     DROP_ROUTE_ERROR,   /**< Route error */
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout exceeded */
-    DROP_DUPLICATE  /**< Duplicate packet received */
+    DROP_DUPLICATE,  /**< Duplicate packet received */
+    DROP_FRAGMENT_BUFFER_FULL /**< Fragment reassembly buffer full */
   };
 
   /**
@@ -222,6 +224,28 @@ public:
    */
   bool IsUnicast (Ipv4Address ad) const;
 
+  /**
+   * \brief Remove all the routes cached for the forwarded packets.
+   *
+   * The cache is flushed when the interfaces, their addresses or the
+   * routes of the routing protocol change, see
+   * Ipv4RoutingProtocol::GetRouteInputVersion.
+   */
+  void FlushRouteCache (void);
+
+  /**
+   * \brief Get the number of forwarded packets routed from the route cache.
+   * \returns the number of cache hits
+   */
+  uint64_t GetRouteCacheHits (void) const;
+
+  /**
+   * \brief Get the number of forwarded packets looked up in the route cache
+   * and routed by the routing protocol.
+   * \returns the number of cache misses
+   */
+  uint64_t GetRouteCacheMisses (void) const;
+
   /**
    * TracedCallback signature for packet send, forward, or local deliver events.
    *
@@ -349,6 +373,17 @@ private:
              Ptr<const Packet> p, 
              const Ipv4Header &header);
 
+  /**
+   * \brief Cache the route of a packet, and forward it.
+   * \param rtentry route
+   * \param p packet to forward
+   * \param header IPv4 header to add to the packet
+   */
+  void
+  CacheAndForward (Ptr<Ipv4Route> rtentry,
+                   Ptr<const Packet> p,
+                   const Ipv4Header &header);
+
   /**
    * \brief Forward a multicast packet.
    * \param mrtentry route
@@ -466,7 +501,22 @@ private:
   Ipv4InterfaceList m_interfaces; //!< List of IPv4 interfaces.
   Ipv4InterfaceReverseContainer m_reverseInterfacesContainer; //!< Container of NetDevice / Interface index associations.
   uint8_t m_defaultTtl;  //!< Default TTL
-  std::map<std::pair<uint64_t, uint8_t>, uint16_t> m_identification; //!< Identification (for each {src, dst, proto} tuple)
+  /// Key of the identification counters ({src, dst} and proto)
+  typedef std::pair<uint64_t, uint8_t> IdentificationKey_t;
+  /// Hash of the identification counters key
+  struct IdentificationKeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    std::size_t operator() (const IdentificationKey_t &key) const
+    {
+      return std::hash<uint64_t> () (key.first * 0x9e3779b97f4a7c15ULL ^ key.second);
+    }
+  };
+  /// Identification (for each {src, dst, proto} tuple)
+  std::unordered_map<IdentificationKey_t, uint16_t, IdentificationKeyHash> m_identification;
   Ptr<Node> m_node; //!< Node attached to stack.
 
   /// Trace of sent packets
@@ -513,6 +563,11 @@ private:
    */
   void HandleFragmentsTimeout (FragmentKey_t key, Ipv4Header & ipHeader, uint32_t iif);
 
+  /**
+   * \brief Drop the oldest packet in the reassembly buffer
+   */
+  void DropOldestFragments (void);
+
   /**
    * \brief Set a new timeout "event" for a fragmented packet
    * \param key the fragment identification
@@ -573,6 +628,12 @@ private:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Get the number of bytes held by the fragments.
+     * \returns the number of bytes
+     */
+    uint32_t GetSize () const;
+
     /**
      * \brief Set the Timeout iterator.
      * \param iter The iterator.
@@ -592,9 +653,24 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, sorted by offset.
+     */
+    std::multimap<uint16_t, Ptr<Packet> > m_fragments;
+
+    /**
+     * \brief End of the data received without holes from offset 0.
+     */
+    uint32_t m_contiguousEnd;
+
+    /**
+     * \brief The fragments at lower offsets are within m_contiguousEnd.
+     */
+    uint32_t m_nextOffset;
+
+    /**
+     * \brief Number of bytes held by the fragments.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_fragments;
+    uint32_t m_size;
 
     /**
      * \brief Timeout iterator to "event" handler
@@ -607,6 +683,16 @@ private:
 
   MapFragments_t       m_fragments; //!< Fragmented packets.
   Time                 m_fragmentExpirationTimeout; //!< Expiration timeout
+  uint32_t             m_fragmentReassemblyBufferSize; //!< Maximum number of bytes in the reassembly buffer
+  uint32_t             m_fragmentsSize; //!< Number of bytes in the reassembly buffer
+
+  /// Cached routes of the forwarded packets, by destination and input interface
+  std::unordered_map<uint64_t, Ptr<Ipv4Route> > m_routeCache;
+  uint32_t m_routeCacheSize;    //!< Maximum number of cached routes
+  uint32_t m_routeCacheVersion; //!< Version of the routes in the cache
+  uint64_t m_routeCacheKey;     //!< Key of the route being looked up
+  uint64_t m_routeCacheHits;    //!< Number of cache hits
+  uint64_t m_routeCacheMisses;  //!< Number of cache misses
 
   /// IETF RFC 6621, Section 6.2 de-duplication w/o IPSec
   /// RFC 6621 recommended duplicate packet tuple: {IPV hash, IP protocol, IP source address, IP destination address}
@@ -85,6 +85,24 @@ Ipv4ListRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit
     }
 }
 
+uint32_t
+Ipv4ListRouting::GetRouteInputVersion (void) const
+{
+  // The versions only grow, and so does their sum, also when a protocol is added
+  uint32_t version = 0;
+  for (Ipv4RoutingProtocolList::const_iterator i = m_routingProtocols.begin ();
+       i != m_routingProtocols.end (); i++)
+    {
+      uint32_t protocolVersion = (*i).second->GetRouteInputVersion ();
+      if (protocolVersion == 0)
+        {
+          return 0;
+        }
+      version += protocolVersion;
+    }
+  return version;
+}
+
 void
 Ipv4ListRouting::DoInitialize (void)
 {
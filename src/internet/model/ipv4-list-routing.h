@@ -90,6 +90,11 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  /**
+   * \returns the sum of the versions of the routing protocols, or 0 if the
+   * routes of any of them cannot be cached
+   */
+  virtual uint32_t GetRouteInputVersion (void) const;
 
 protected:
   virtual void DoDispose (void);
@@ -171,6 +171,23 @@ public:
    */
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const = 0;
 
+  /**
+   * \brief Get the version of the routes used by RouteInput
+   *
+   * Ipv4L3Protocol caches the routes of the forwarded unicast packets by
+   * destination and input interface while the version is unchanged. A
+   * protocol supporting the cache must return a non-zero version, that it
+   * changes whenever its routes change, and its unicast forwarding decisions
+   * must only depend on the destination, the input interface and the state of
+   * the stack (e.g., not on the source address, the ports or a random
+   * variable).
+   *
+   * The default implementation returns 0, i.e., the routes are not cached.
+   *
+   * \returns the version of the routes, or 0 if the routes cannot be cached
+   */
+  virtual uint32_t GetRouteInputVersion (void) const;
+
 };
 
 } // namespace ns3
@@ -26,6 +26,7 @@
 #include <iomanip>
 #include "ns3/log.h"
 #include "ns3/names.h"
+#include "ns3/unused.h"
 #include "ns3/packet.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
@@ -54,7 +55,9 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_nonPrefixRoutes (0),
+    m_routeInputVersion (1),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -76,7 +79,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   if (!LookupRoute (route, metric))
     {
       Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
-      m_networkRoutes.push_back (make_pair (routePtr, metric));
+      InsertNetworkRoute (routePtr, metric);
     }
 }
 
@@ -95,7 +98,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
     {
       Ipv4RoutingTableEntry *routePtr = new Ipv4RoutingTableEntry (route);
 
-      m_networkRoutes.push_back (make_pair (routePtr, metric));
+      InsertNetworkRoute (routePtr, metric);
     }
 }
 
@@ -153,7 +156,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  InsertNetworkRoute (route, 0);
 }
 
 uint32_t 
@@ -229,9 +232,84 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
+void
+Ipv4StaticRouting::InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NetworkRoutesI it = m_networkRoutes.insert (m_networkRoutes.end (), make_pair (route, metric));
+  m_routeInputVersion++;
+  uint8_t key[4];
+  uint8_t length;
+  if (GetIndexKey (route, key, length))
+    {
+      m_networkRouteIndex.Insert (key, length, it);
+    }
+  else
+    {
+      m_nonPrefixRoutes++;
+    }
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute (NetworkRoutesI it)
+{
+  uint8_t key[4];
+  uint8_t length;
+  if (GetIndexKey (it->first, key, length))
+    {
+      bool found = m_networkRouteIndex.Remove (key, length, it);
+      NS_ASSERT (found);
+      NS_UNUSED (found);
+    }
+  else
+    {
+      m_nonPrefixRoutes--;
+    }
+  m_routeInputVersion++;
+  delete it->first;
+  return m_networkRoutes.erase (it);
+}
+
+bool
+Ipv4StaticRouting::GetIndexKey (const Ipv4RoutingTableEntry *route, uint8_t key[4], uint8_t &length)
+{
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint32_t hostBits = ~mask.Get ();
+  if ((hostBits & (hostBits + 1)) != 0)
+    {
+      return false;
+    }
+  route->GetDestNetwork ().CombineMask (mask).Serialize (key);
+  length = mask.GetPrefixLength ();
+  return true;
+}
+
 bool
 Ipv4StaticRouting::LookupRoute (const Ipv4RoutingTableEntry &route, uint32_t metric)
 {
+  uint8_t key[4];
+  uint8_t length;
+  if (GetIndexKey (&route, key, length))
+    {
+      // only the routes to the same network can be equal
+      PrefixTrie<NetworkRoutesI, 4>::Values const *routes = m_networkRouteIndex.Find (key, length);
+      if (routes == 0)
+        {
+          return false;
+        }
+      for (NetworkRoutesI j : *routes)
+        {
+          Ipv4RoutingTableEntry* rtentry = j->first;
+          if (rtentry->GetDest () == route.GetDest () &&
+              rtentry->GetDestNetworkMask () == route.GetDestNetworkMask () &&
+              rtentry->GetGateway () == route.GetGateway () &&
+              rtentry->GetInterface () == route.GetInterface () &&
+              j->second == metric)
+            {
+              return true;
+            }
+        }
+      return false;
+    }
   for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
     {
       Ipv4RoutingTableEntry* rtentry = j->first;
@@ -253,8 +331,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -269,56 +345,104 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  Ipv4RoutingTableEntry *route = 0;
+  if (m_nonPrefixRoutes == 0)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      // The index visits the networks matching dest from the shortest
+      // prefix to the longest one: a network with a usable route
+      // supersedes the previous ones.
+      uint8_t key[4];
+      dest.Serialize (key);
+      m_networkRouteIndex.Match (key, [&] (uint8_t masklen, PrefixTrie<NetworkRoutesI, 4>::Values const &routes)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
+          Ipv4RoutingTableEntry *best = 0;
+          uint32_t shortest_metric = 0xffffffff;
+          for (NetworkRoutesI i : routes)
             {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+              Ipv4RoutingTableEntry *j = i->first;
+              uint32_t metric = i->second;
+              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << static_cast<uint16_t> (masklen) << ", metric " << metric);
+              if (oif != 0 && oif != m_ipv4->GetNetDevice (j->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
+              if (metric > shortest_metric)
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              shortest_metric = metric;
+              best = j;
+              if (masklen == 32)
+                {
+                  break;
+                }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
+          if (best != 0)
             {
-              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-              continue;
+              route = best;
             }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
+        });
+    }
+  else
+    {
+      uint16_t longest_mask = 0;
+      uint32_t shortest_metric = 0xffffffff;
+      for (NetworkRoutesI i = m_networkRoutes.begin (); 
+           i != m_networkRoutes.end (); 
+           i++) 
+        {
+          Ipv4RoutingTableEntry *j=i->first;
+          uint32_t metric =i->second;
+          Ipv4Mask mask = (j)->GetDestNetworkMask ();
+          uint16_t masklen = mask.GetPrefixLength ();
+          Ipv4Address entry = (j)->GetDestNetwork ();
+          NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
+          if (mask.IsMatch (dest, entry)) 
             {
-              break;
+              NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
+              if (oif != 0)
+                {
+                  if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
+                    {
+                      NS_LOG_LOGIC ("Not on requested interface, skipping");
+                      continue;
+                    }
+                }
+              if (masklen < longest_mask) // Not interested if got shorter mask
+                {
+                  NS_LOG_LOGIC ("Previous match longer, skipping");
+                  continue;
+                }
+              if (masklen > longest_mask) // Reset metric if longer masklen
+                {
+                  shortest_metric = 0xffffffff;
+                }
+              longest_mask = masklen;
+              if (metric > shortest_metric)
+                {
+                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                  continue;
+                }
+              shortest_metric = metric;
+              route = j;
+              if (masklen == 32)
+                {
+                  break;
+                }
             }
         }
     }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+    }
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " at the end");
@@ -503,8 +627,7 @@ Ipv4StaticRouting::RemoveRoute (Ipv4Address destination,
     if(destination == route->GetDest () && inputInterface == route->GetInterface ()
       && gateway == route->GetGateway ())
     {
-      delete i->first;
-      m_networkRoutes.erase (i);
+      EraseNetworkRoute (i);
       return true;
     }
   }
@@ -522,8 +645,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseNetworkRoute (j);
           return;
         }
       tmp++;
@@ -650,6 +772,8 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkRouteIndex.Clear ();
+  m_nonPrefixRoutes = 0;
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -688,8 +812,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -735,8 +858,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -824,4 +946,10 @@ Ipv4StaticRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Uni
   (*os).copyfmt (oldState);
 }
 
+uint32_t
+Ipv4StaticRouting::GetRouteInputVersion (void) const
+{
+  return m_routeInputVersion;
+}
+
 } // namespace ns3
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -86,6 +87,7 @@ public:
   virtual void NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address);
   virtual void SetIpv4 (Ptr<Ipv4> ipv4);
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream, Time::Unit unit = Time::S) const;
+  virtual uint32_t GetRouteInputVersion (void) const;
 
 /**
  * \brief Add a network route to the static routing table.
@@ -378,6 +380,29 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv4MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /**
+   * \brief Add a route at the end of the forwarding table.
+   * \param route route, owned by the forwarding table
+   * \param metric metric of route
+   */
+  void InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table and delete it.
+   * \param it the route
+   * \return the route that followed the removed one
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI it);
+
+  /**
+   * \brief Get the key of a route in the forwarding table index.
+   * \param route route
+   * \param key the destination network, in network byte order
+   * \param length the length of the network mask
+   * \return false if the network mask is not a prefix, so that the route can not be indexed
+   */
+  static bool GetIndexKey (const Ipv4RoutingTableEntry *route, uint8_t key[4], uint8_t &length);
+
   /**
    * \brief Checks if a route is already present in the forwarding table.
    * \param route route
@@ -409,6 +434,27 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the forwarding table for network, indexed by destination network.
+   *
+   * The values of each prefix are the routes to that network, in the
+   * order of m_networkRoutes.
+   */
+  PrefixTrie<NetworkRoutesI, 4> m_networkRouteIndex;
+
+  /**
+   * \brief the number of routes whose network mask is not a prefix.
+   *
+   * These routes are not indexed; as long as there are some, lookups
+   * scan m_networkRoutes.
+   */
+  uint32_t m_nonPrefixRoutes;
+
+  /**
+   * \brief the version of the network routes, see GetRouteInputVersion.
+   */
+  uint32_t m_routeInputVersion;
+
   /**
    * \brief the forwarding table for multicast.
    */
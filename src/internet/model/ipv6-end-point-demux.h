@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +35,11 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The endpoints are indexed by local port, and by local port and peer, so
+ * that a lookup only considers the endpoints connected to the source of the
+ * packet and the endpoints with wildcard peers.  The endpoints notify the
+ * demux when their peer changes.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +159,78 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /// Key of the endpoints with a local port and a peer
+  struct PeerKey
+  {
+    uint16_t localPort;     //!< Local port
+    Ipv6Address peerAddr;   //!< Peer address, any for wildcard peers
+    uint16_t peerPort;      //!< Peer port, 0 for wildcard peers
+
+    /**
+     * \param other another key
+     * \returns true if the keys are equal
+     */
+    bool operator == (PeerKey const &other) const;
+  };
+
+  /// Hash function class for PeerKey
+  struct PeerKeyHash
+  {
+    /**
+     * \param key the key
+     * \returns the hash of the key
+     */
+    size_t operator () (PeerKey const &key) const;
+  };
+
+  /// Positions of an endpoint in the list and in the indexes
+  struct Position
+  {
+    EndPointsI all;     //!< Position in m_endPoints
+    EndPointsI port;    //!< Position in the endpoints of the local port
+    EndPointsI peer;    //!< Position in the endpoints of the peer
+    PeerKey key;        //!< Key of the endpoints of the peer
+  };
+
+  /**
+   * \brief Add a new endpoint to the list and to the indexes.
+   * \param endPoint the endpoint
+   * \returns the endpoint
+   */
+  Ipv6EndPoint *Insert (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an endpoint by its peer.
+   * \param endPoint the endpoint
+   * \param position the positions of the endpoint
+   */
+  void InsertPeer (Ipv6EndPoint *endPoint, Position &position);
+
+  /**
+   * \brief Remove an endpoint from the index of the peers.
+   * \param position the positions of the endpoint
+   */
+  void RemovePeer (Position &position);
+
+  /**
+   * \brief Update the index of the peers after the peer of an endpoint changed.
+   *
+   * Called by Ipv6EndPoint::SetPeer.
+   *
+   * \param endPoint the endpoint
+   */
+  void NotifyPeerChanged (Ipv6EndPoint *endPoint);
+
+  /**
+   * \param localPort the local port
+   * \param peerAddr the peer address
+   * \param peerPort the peer port
+   * \returns the endpoints with the local port and peer, or 0 if there are none
+   */
+  EndPoints *GetPeerEndPoints (uint16_t localPort, Ipv6Address peerAddr, uint16_t peerPort);
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -178,6 +256,21 @@ private:
    * \brief A list of IPv6 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points of each local port, in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_portEndPoints;
+
+  /**
+   * \brief The end points of each local port and peer.
+   */
+  std::unordered_map<PeerKey, EndPoints, PeerKeyHash> m_peerEndPoints;
+
+  /**
+   * \brief The positions of the end points.
+   */
+  std::unordered_map<Ipv6EndPoint *, Position> m_positions;
 };
 
 } /* namespace ns3 */
@@ -308,11 +308,19 @@ TypeId Ipv6ExtensionFragment::GetTypeId ()
                    TimeValue (Seconds (60)),
                    MakeTimeAccessor (&Ipv6ExtensionFragment::m_fragmentExpirationTimeout),
                    MakeTimeChecker ())
+    .AddAttribute ("FragmentReassemblyBufferSize",
+                   "The maximum number of bytes held by the fragments "
+                   "waiting for reassembly. When it is exceeded, the "
+                   "oldest packets are dropped. Zero meaning infinite.",
+                   UintegerValue (4 * 1024 * 1024),
+                   MakeUintegerAccessor (&Ipv6ExtensionFragment::m_fragmentReassemblyBufferSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 Ipv6ExtensionFragment::Ipv6ExtensionFragment ()
+  : m_fragmentsSize (0)
 {
 }
 
@@ -330,6 +338,7 @@ void Ipv6ExtensionFragment::DoDispose ()
     }
 
   m_fragments.clear ();
+  m_fragmentsSize = 0;
   m_timeoutEventList.clear ();
   if (m_timeoutEvent.IsRunning ())
     {
@@ -376,6 +385,23 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
   Ipv6Header ipHeader = ipv6Header;
   ipHeader.SetNextHeader (fragmentHeader.GetNextHeader ());
 
+  if (m_fragmentReassemblyBufferSize)
+    {
+      if (p->GetSize () > m_fragmentReassemblyBufferSize)
+        {
+          NS_LOG_LOGIC ("Fragment larger than the reassembly buffer");
+          isDropped = true;
+          dropReason = Ipv6L3Protocol::DROP_FRAGMENT_BUFFER_FULL;
+          stopProcessing = true;
+          return 0;
+        }
+      // make room for the fragment, possibly dropping its own packet
+      while (m_fragmentsSize + p->GetSize () > m_fragmentReassemblyBufferSize)
+        {
+          DropOldestFragments ();
+        }
+    }
+
   MapFragments_t::iterator it = m_fragments.find (fragmentKey);
   if (it == m_fragments.end ())
     {
@@ -398,11 +424,13 @@ uint8_t Ipv6ExtensionFragment::Process (Ptr<Packet>& packet,
     }
 
   NS_LOG_DEBUG ("Add fragment with IP hdr id " << identification << " offset " << fragmentOffset);
+  m_fragmentsSize += p->GetSize ();
   fragments->AddFragment (p, fragmentOffset, moreFragment);
 
   if (fragments->IsEntire ())
     {
       packet = fragments->GetPacket ();
+      m_fragmentsSize -= fragments->GetSize ();
       m_timeoutEventList.erase (fragments->GetTimeoutIter ());
       m_fragments.erase (fragmentKey);
       NS_LOG_DEBUG ("Finished fragment with IP hdr id " << fragmentKey.second << " erase timeout, m_fragments.size(): " << m_fragments.size ());
@@ -615,14 +643,34 @@ void Ipv6ExtensionFragment::HandleFragmentsTimeout (FragmentKey_t fragmentKey,
   ipL3->ReportDrop (ipHeader, packet, Ipv6L3Protocol::DROP_FRAGMENT_TIMEOUT);
 
   // clear the buffers
+  m_fragmentsSize -= fragments->GetSize ();
   m_fragments.erase (fragmentKey);
 }
 
+void Ipv6ExtensionFragment::DropOldestFragments (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // the timeouts are sorted by arrival of the first fragment
+  FragmentKey_t fragmentKey = std::get<1> (m_timeoutEventList.front ());
+  Ipv6Header ipHeader = std::get<2> (m_timeoutEventList.front ());
+  m_timeoutEventList.pop_front ();
+
+  MapFragments_t::iterator it = m_fragments.find (fragmentKey);
+  NS_LOG_LOGIC ("Reassembly buffer full, dropping " << it->second->GetSize () << " bytes");
+  Ptr<Packet> packet = it->second->GetPartialPacket ();
+  Ptr<Ipv6L3Protocol> ipL3 = GetNode ()->GetObject<Ipv6L3Protocol> ();
+  ipL3->ReportDrop (ipHeader, packet ? packet : Create<Packet> (), Ipv6L3Protocol::DROP_FRAGMENT_BUFFER_FULL);
+
+  m_fragmentsSize -= it->second->GetSize ();
+  m_fragments.erase (it);
+}
+
 
 Ipv6ExtensionFragment::FragmentsTimeoutsListI_t Ipv6ExtensionFragment::SetTimeout (FragmentKey_t key, Ipv6Header ipHeader)
 {
   NS_LOG_FUNCTION (this << key.first << key.second << ipHeader);
-  if (m_timeoutEventList.empty ())
+  if (!m_timeoutEvent.IsRunning ())
     {
       NS_LOG_DEBUG ("Scheduling timeout for IP hdr id " << key.second << " at time " << (Simulator::Now () + m_fragmentExpirationTimeout).GetSeconds ());
       m_timeoutEvent = Simulator::Schedule (m_fragmentExpirationTimeout, &Ipv6ExtensionFragment::HandleTimeout, this);
@@ -646,7 +694,7 @@ void Ipv6ExtensionFragment::HandleTimeout (void)
     {
       NS_LOG_DEBUG ("Handle time " << std::get<0> (element).GetSeconds () << " IP hdr id " << std::get<1> (element).second);
     }
-  while (!m_timeoutEventList.empty () && std::get<0> (*m_timeoutEventList.begin ()) == now)
+  while (!m_timeoutEventList.empty () && std::get<0> (*m_timeoutEventList.begin ()) <= now)
     {
       HandleFragmentsTimeout (std::get<1> (*m_timeoutEventList.begin ()),
                               std::get<2> (*m_timeoutEventList.begin ()));
@@ -668,7 +716,9 @@ void Ipv6ExtensionFragment::HandleTimeout (void)
 
 
 Ipv6ExtensionFragment::Fragments::Fragments ()
-  : m_moreFragment (0)
+  : m_moreFragment (0),
+    m_holes (0),
+    m_size (0)
 {
 }
 
@@ -679,22 +729,31 @@ Ipv6ExtensionFragment::Fragments::~Fragments ()
 void Ipv6ExtensionFragment::Fragments::AddFragment (Ptr<Packet> fragment, uint16_t fragmentOffset, bool moreFragment)
 {
   NS_LOG_FUNCTION (this << fragment << fragmentOffset << moreFragment);
-  std::list<std::pair<Ptr<Packet>, uint16_t> >::iterator it;
 
-  for (it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
-    {
-      if (it->second > fragmentOffset)
-        {
-          break;
-        }
-    }
+  // fragments with the same offset are kept in arrival order
+  std::multimap<uint16_t, Ptr<Packet> >::iterator it = m_packetFragments.insert (std::make_pair (fragmentOffset, fragment));
+  std::multimap<uint16_t, Ptr<Packet> >::iterator next = std::next (it);
+  m_size += fragment->GetSize ();
 
-  if (it == m_packetFragments.end ())
+  if (next == m_packetFragments.end ())
     {
       m_moreFragment = moreFragment;
     }
 
-  m_packetFragments.insert (it, std::pair<Ptr<Packet>, uint16_t> (fragment, fragmentOffset));
+  // update the holes between the fragment and its neighbors
+  uint32_t previousEnd = 0;
+  if (it != m_packetFragments.begin ())
+    {
+      std::multimap<uint16_t, Ptr<Packet> >::iterator previous = std::prev (it);
+      previousEnd = previous->first + previous->second->GetSize ();
+    }
+  uint32_t end = fragmentOffset + fragment->GetSize ();
+  if (next != m_packetFragments.end ())
+    {
+      m_holes -= (previousEnd != next->first);
+      m_holes += (end != next->first);
+    }
+  m_holes += (previousEnd != fragmentOffset);
 }
 
 void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfragmentablePart)
@@ -705,34 +764,16 @@ void Ipv6ExtensionFragment::Fragments::SetUnfragmentablePart (Ptr<Packet> unfrag
 
 bool Ipv6ExtensionFragment::Fragments::IsEntire () const
 {
-  bool ret = !m_moreFragment && m_packetFragments.size () > 0;
-
-  if (ret)
-    {
-      uint16_t lastEndOffset = 0;
-
-      for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
-        {
-          if (lastEndOffset != it->second)
-            {
-              ret = false;
-              break;
-            }
-
-          lastEndOffset += it->first->GetSize ();
-        }
-    }
-
-  return ret;
+  return !m_moreFragment && m_packetFragments.size () > 0 && m_holes == 0;
 }
 
 Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPacket () const
 {
   Ptr<Packet> p =  m_unfragmentable->Copy ();
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::multimap<uint16_t, Ptr<Packet> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      p->AddAtEnd (it->first);
+      p->AddAtEnd (it->second);
     }
 
   return p;
@@ -753,14 +794,14 @@ Ptr<Packet> Ipv6ExtensionFragment::Fragments::GetPartialPacket () const
 
   uint16_t lastEndOffset = 0;
 
-  for (std::list<std::pair<Ptr<Packet>, uint16_t> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
+  for (std::multimap<uint16_t, Ptr<Packet> >::const_iterator it = m_packetFragments.begin (); it != m_packetFragments.end (); it++)
     {
-      if (lastEndOffset != it->second)
+      if (lastEndOffset != it->first)
         {
           break;
         }
-      p->AddAtEnd (it->first);
-      lastEndOffset += it->first->GetSize ();
+      p->AddAtEnd (it->second);
+      lastEndOffset += it->second->GetSize ();
     }
 
   return p;
@@ -773,6 +814,11 @@ void Ipv6ExtensionFragment::Fragments::SetTimeoutIter (FragmentsTimeoutsListI_t
   return;
 }
 
+uint32_t Ipv6ExtensionFragment::Fragments::GetSize () const
+{
+  return m_size;
+}
+
 Ipv6ExtensionFragment::FragmentsTimeoutsListI_t Ipv6ExtensionFragment::Fragments::GetTimeoutIter ()
 {
   return m_timeoutIter;
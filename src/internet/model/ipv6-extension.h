@@ -382,6 +382,12 @@ public:
      */
     Ptr<Packet> GetPartialPacket () const;
 
+    /**
+     * \brief Get the number of bytes held by the fragments.
+     * \returns the number of bytes
+     */
+    uint32_t GetSize () const;
+
     /**
      * \brief Set the Timeout iterator.
      * \param iter The iterator.
@@ -401,9 +407,20 @@ private:
     bool m_moreFragment;
 
     /**
-     * \brief The current fragments.
+     * \brief The current fragments, sorted by offset.
+     */
+    std::multimap<uint16_t, Ptr<Packet> > m_packetFragments;
+
+    /**
+     * \brief Number of consecutive fragments, including the start of the
+     * packet before the first one, that do not exactly follow each other.
      */
-    std::list<std::pair<Ptr<Packet>, uint16_t> > m_packetFragments;
+    uint32_t m_holes;
+
+    /**
+     * \brief Number of bytes held by the fragments.
+     */
+    uint32_t m_size;
 
     /**
      * \brief The unfragmentable part.
@@ -423,6 +440,11 @@ private:
    */
   void HandleFragmentsTimeout (FragmentKey_t key, Ipv6Header ipHeader);
 
+  /**
+   * \brief Drop the oldest packet in the reassembly buffer
+   */
+  void DropOldestFragments (void);
+
   /**
    * \brief Get the packet parts so far received.
    * \return the partial packet
@@ -466,6 +488,8 @@ private:
   FragmentsTimeoutsList_t m_timeoutEventList;  //!< Timeout "events" container
   EventId m_timeoutEvent;  //!< Event for the next scheduled timeout
   Time m_fragmentExpirationTimeout; //!< Expiration timeout
+  uint32_t m_fragmentReassemblyBufferSize; //!< Maximum number of bytes in the reassembly buffer
+  uint32_t m_fragmentsSize; //!< Number of bytes in the reassembly buffer
 };
 
 /**
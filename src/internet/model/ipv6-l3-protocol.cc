@@ -45,6 +45,7 @@
 #include "icmpv6-l4-protocol.h"
 #include "ndisc-cache.h"
 #include "ipv6-raw-socket-factory-impl.h"
+#include "gso-tag.h"
 
 /// Minimum IPv6 MTU, as defined by \RFC{2460}
 #define IPV6_MIN_MTU 1280
@@ -1113,7 +1114,10 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  // Super-segments sent with GSO are not fragmented
+  GsoTag gsoTag;
+  if (packet->GetSize () > targetMtu + 40 /* 40 => size of IPv6 header */
+      && !packet->PeekPacketTag (gsoTag))
     {
       // Router => drop
 
@@ -87,6 +87,7 @@ public:
     DROP_UNKNOWN_OPTION, /**< Unknown option */
     DROP_MALFORMED_HEADER, /**< Malformed header */
     DROP_FRAGMENT_TIMEOUT, /**< Fragment timeout */
+    DROP_FRAGMENT_BUFFER_FULL, /**< Fragment reassembly buffer full */
   };
 
   /**
@@ -26,6 +26,7 @@
 #include "ns3/ipv6-route.h"
 #include "ns3/net-device.h"
 #include "ns3/names.h"
+#include "ns3/unused.h"
 
 #include "ipv6-static-routing.h"
 #include "ipv6-routing-table-entry.h"
@@ -47,7 +48,8 @@ TypeId Ipv6StaticRouting::GetTypeId ()
 }
 
 Ipv6StaticRouting::Ipv6StaticRouting ()
-  : m_ipv6 (0)
+  : m_nonPrefixRoutes (0),
+    m_ipv6 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -162,7 +164,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   if (!LookupRoute (route, metric))
     {
       Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertNetworkRoute (routePtr, metric);
     }
 }
 
@@ -178,7 +180,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   if (!LookupRoute (route, metric))
     {
       Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertNetworkRoute (routePtr, metric);
     }
 }
 
@@ -190,7 +192,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   if (!LookupRoute (route, metric))
     {
       Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry (route);
-      m_networkRoutes.push_back (std::make_pair (routePtr, metric));
+      InsertNetworkRoute (routePtr, metric);
     }
 }
 
@@ -215,7 +217,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Address network = Ipv6Address ("ff00::"); /* RFC 3513 */
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
-  m_networkRoutes.push_back (std::make_pair (route, 0));
+  InsertNetworkRoute (route, 0);
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -300,8 +302,78 @@ bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceI
   return false;
 }
 
+void Ipv6StaticRouting::InsertNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric)
+{
+  NetworkRoutesI it = m_networkRoutes.insert (m_networkRoutes.end (), std::make_pair (route, metric));
+  uint8_t key[16];
+  uint8_t length;
+  if (GetIndexKey (route, key, length))
+    {
+      m_networkRouteIndex.Insert (key, length, it);
+    }
+  else
+    {
+      m_nonPrefixRoutes++;
+    }
+}
+
+Ipv6StaticRouting::NetworkRoutesI Ipv6StaticRouting::EraseNetworkRoute (NetworkRoutesI it)
+{
+  uint8_t key[16];
+  uint8_t length;
+  if (GetIndexKey (it->first, key, length))
+    {
+      bool found = m_networkRouteIndex.Remove (key, length, it);
+      NS_ASSERT (found);
+      NS_UNUSED (found);
+    }
+  else
+    {
+      m_nonPrefixRoutes--;
+    }
+  delete it->first;
+  return m_networkRoutes.erase (it);
+}
+
+bool Ipv6StaticRouting::GetIndexKey (const Ipv6RoutingTableEntry *route, uint8_t key[16], uint8_t &length)
+{
+  Ipv6Prefix prefix = route->GetDestNetworkPrefix ();
+  length = prefix.GetPrefixLength ();
+  if (length > 128 || !(prefix == Ipv6Prefix (length)))
+    {
+      return false;
+    }
+  route->GetDestNetwork ().CombinePrefix (prefix).GetBytes (key);
+  return true;
+}
+
 bool Ipv6StaticRouting::LookupRoute (const Ipv6RoutingTableEntry &route, uint32_t metric)
 {
+  uint8_t key[16];
+  uint8_t length;
+  if (GetIndexKey (&route, key, length))
+    {
+      // only the routes to the same network can be equal
+      PrefixTrie<NetworkRoutesI, 16>::Values const *routes = m_networkRouteIndex.Find (key, length);
+      if (routes == 0)
+        {
+          return false;
+        }
+      for (NetworkRoutesI j : *routes)
+        {
+          Ipv6RoutingTableEntry* rtentry = j->first;
+          if (rtentry->GetDest () == route.GetDest () &&
+              rtentry->GetDestNetworkPrefix () == route.GetDestNetworkPrefix () &&
+              rtentry->GetGateway () == route.GetGateway () &&
+              rtentry->GetInterface () == route.GetInterface () &&
+              rtentry->GetPrefixToUse () == route.GetPrefixToUse () &&
+              j->second == metric)
+            {
+              return true;
+            }
+        }
+      return false;
+    }
   for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
     {
       Ipv6RoutingTableEntry* rtentry = j->first;
@@ -323,8 +395,6 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
 {
   NS_LOG_FUNCTION (this << dst << interface);
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
-  uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (dst.IsLinkLocalMulticast ())
@@ -338,70 +408,120 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  Ipv6RoutingTableEntry* route = 0;
+  if (m_nonPrefixRoutes == 0)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
-
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
-
-      if (mask.IsMatch (dst, entry))
+      // The index visits the networks matching dst from the shortest
+      // prefix to the longest one: a network with a usable route
+      // supersedes the previous ones.
+      uint8_t key[16];
+      dst.GetBytes (key);
+      m_networkRouteIndex.Match (key, [&] (uint8_t maskLen, PrefixTrie<NetworkRoutesI, 16>::Values const &routes)
         {
-          NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
-
-          /* if interface is given, check the route will output on this interface */
-          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+          Ipv6RoutingTableEntry* best = 0;
+          uint32_t shortestMetric = 0xffffffff;
+          for (NetworkRoutesI it : routes)
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
+              Ipv6RoutingTableEntry* j = it->first;
+              uint32_t metric = it->second;
+              NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << static_cast<uint16_t> (maskLen) << ", metric " << metric);
 
-              if (maskLen > longestMask)
+              /* if interface is given, check the route will output on this interface */
+              if (interface && interface != m_ipv6->GetNetDevice (j->GetInterface ()))
                 {
-                  shortestMetric = 0xffffffff;
+                  continue;
                 }
-
-              longestMask = maskLen;
               if (metric > shortestMetric)
                 {
                   NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
                   continue;
                 }
-
               shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
-
-              if (route->GetGateway ().IsAny ())
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                }
-              else
+              best = j;
+              if (maskLen == 128)
                 {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+                  break;
                 }
+            }
+          if (best)
+            {
+              route = best;
+            }
+        });
+    }
+  else
+    {
+      uint16_t longestMask = 0;
+      uint32_t shortestMetric = 0xffffffff;
+      for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+        {
+          Ipv6RoutingTableEntry* j = it->first;
+          uint32_t metric = it->second;
+          Ipv6Prefix mask = j->GetDestNetworkPrefix ();
+          uint16_t maskLen = mask.GetPrefixLength ();
+          Ipv6Address entry = j->GetDestNetwork ();
 
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
-              if (maskLen == 128)
+          NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
+
+          if (mask.IsMatch (dst, entry))
+            {
+              NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
+
+              /* if interface is given, check the route will output on this interface */
+              if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
                 {
-                  break;
+                  if (maskLen < longestMask)
+                    {
+                      NS_LOG_LOGIC ("Previous match longer, skipping");
+                      continue;
+                    }
+
+                  if (maskLen > longestMask)
+                    {
+                      shortestMetric = 0xffffffff;
+                    }
+
+                  longestMask = maskLen;
+                  if (metric > shortestMetric)
+                    {
+                      NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+                      continue;
+                    }
+
+                  shortestMetric = metric;
+                  route = j;
+                  if (maskLen == 128)
+                    {
+                      break;
+                    }
                 }
             }
         }
     }
 
+  if (route)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv6Route> ();
+
+      if (route->GetGateway ().IsAny ())
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+        }
+      else if (route->GetDest ().IsAny ()) /* default route */
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
+        }
+      else
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+        }
+
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+    }
+
   if (rtentry)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetDestination () << " (Through " << rtentry->GetGateway () << ") at the end");
@@ -418,6 +538,8 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkRouteIndex.Clear ();
+  m_nonPrefixRoutes = 0;
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -566,8 +688,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseNetworkRoute (it);
           return;
         }
       tmp++;
@@ -585,8 +706,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex
           && rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseNetworkRoute (it);
           return;
         }
     }
@@ -715,8 +835,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -752,8 +871,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkPrefix () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -800,8 +918,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
 
           if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
             {
-              delete j->first;
-              j = m_networkRoutes.erase (j);
+              j = EraseNetworkRoute (j);
             }
           else
             {
@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -264,6 +265,29 @@ private:
   /// Iterator for container for the multicast routes
   typedef std::list<Ipv6MulticastRoutingTableEntry *>::iterator MulticastRoutesI;
 
+  /**
+   * \brief Add a route at the end of the forwarding table.
+   * \param route route, owned by the forwarding table
+   * \param metric metric of route
+   */
+  void InsertNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table and delete it.
+   * \param it the route
+   * \return the route that followed the removed one
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI it);
+
+  /**
+   * \brief Get the key of a route in the forwarding table index.
+   * \param route route
+   * \param key the destination network
+   * \param length the length of the network prefix
+   * \return false if the network prefix is not contiguous, so that the route can not be indexed
+   */
+  static bool GetIndexKey (const Ipv6RoutingTableEntry *route, uint8_t key[16], uint8_t &length);
+
   /**
    * \brief Checks if a route is already present in the forwarding table.
    * \param route route
@@ -294,6 +318,22 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the forwarding table for network, indexed by destination network.
+   *
+   * The values of each prefix are the routes to that network, in the
+   * order of m_networkRoutes.
+   */
+  PrefixTrie<NetworkRoutesI, 16> m_networkRouteIndex;
+
+  /**
+   * \brief the number of routes whose network prefix is not contiguous.
+   *
+   * These routes are not indexed; as long as there are some, lookups
+   * scan m_networkRoutes.
+   */
+  uint32_t m_nonPrefixRoutes;
+
   /**
    * \brief the forwarding table for multicast.
    */
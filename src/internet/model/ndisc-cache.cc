@@ -94,9 +94,10 @@ NdiscCache::Entry* NdiscCache::Lookup (Ipv6Address dst)
 {
   NS_LOG_FUNCTION (this << dst);
 
-  if (m_ndCache.find (dst) != m_ndCache.end ())
+  CacheI it = m_ndCache.find (dst);
+  if (it != m_ndCache.end ())
     {
-      NdiscCache::Entry* entry = m_ndCache[dst];
+      NdiscCache::Entry* entry = it->second;
       NS_LOG_LOGIC ("Found an entry: " << *entry);
 
       return entry;
@@ -110,16 +111,34 @@ std::list<NdiscCache::Entry*> NdiscCache::LookupInverse (Address dst)
   NS_LOG_FUNCTION (this << dst);
 
   std::list<NdiscCache::Entry *> entryList;
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  auto range = m_macIndex.equal_range (dst);
+  for (auto i = range.first; i != range.second; i++)
+    {
+      NS_LOG_LOGIC ("Found an entry:" << (*i->second));
+      entryList.push_back (i->second);
+    }
+  return entryList;
+}
+
+void NdiscCache::IndexMacAddress (NdiscCache::Entry *entry, const Address &mac)
+{
+  NS_LOG_FUNCTION (this << entry << mac);
+  if (!entry->GetMacAddress ().IsInvalid ())
     {
-      NdiscCache::Entry *entry = (*i).second;
-      if (entry->GetMacAddress () == dst)
+      auto range = m_macIndex.equal_range (entry->GetMacAddress ());
+      for (auto i = range.first; i != range.second; i++)
         {
-          NS_LOG_LOGIC ("Found an entry:" << (*entry));
-          entryList.push_back (entry);
+          if (i->second == entry)
+            {
+              m_macIndex.erase (i);
+              break;
+            }
         }
     }
-  return entryList;
+  if (!mac.IsInvalid ())
+    {
+      m_macIndex.emplace (mac, entry);
+    }
 }
 
 
@@ -138,15 +157,13 @@ void NdiscCache::Remove (NdiscCache::Entry* entry)
 {
   NS_LOG_FUNCTION (this << entry);
 
-  for (CacheI i = m_ndCache.begin (); i != m_ndCache.end (); i++)
+  CacheI i = m_ndCache.find (entry->GetIpv6Address ());
+  if (i != m_ndCache.end () && (*i).second == entry)
     {
-      if ((*i).second == entry)
-        {
-          m_ndCache.erase (i);
-          entry->ClearWaitingPacket ();
-          delete entry;
-          return;
-        }
+      m_ndCache.erase (i);
+      IndexMacAddress (entry, Address ());
+      entry->ClearWaitingPacket ();
+      delete entry;
     }
 }
 
@@ -160,6 +177,7 @@ void NdiscCache::Flush ()
     }
 
   m_ndCache.erase (m_ndCache.begin (), m_ndCache.end ());
+  m_macIndex.clear ();
 }
 
 void NdiscCache::SetUnresQlen (uint32_t unresQlen)
@@ -511,6 +529,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkReachable (A
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = REACHABLE;
+  m_ndCache->IndexMacAddress (this, mac);
   m_macAddress = mac;
   return m_waiting;
 }
@@ -537,6 +556,7 @@ std::list<NdiscCache::Ipv6PayloadHeaderPair> NdiscCache::Entry::MarkStale (Addre
 {
   NS_LOG_FUNCTION (this << mac);
   m_state = STALE;
+  m_ndCache->IndexMacAddress (this, mac);
   m_macAddress = mac;
   return m_waiting;
 }
@@ -599,6 +619,7 @@ Address NdiscCache::Entry::GetMacAddress () const
 void NdiscCache::Entry::SetMacAddress (Address mac)
 {
   NS_LOG_FUNCTION (this << mac << int(m_state));
+  m_ndCache->IndexMacAddress (this, mac);
   m_macAddress = mac;
 }
 
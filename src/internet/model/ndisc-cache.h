@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
 #include <unordered_map>
 
 #include "ns3/packet.h"
@@ -45,6 +46,9 @@ class Icmpv6L4Protocol;
  * \ingroup ipv6
  *
  * \brief IPv6 Neighbor Discovery cache.
+ *
+ * The entries are also indexed by MAC address, for the inverse lookups done
+ * on the packets received from routers.
  */
 class NdiscCache : public Object
 {
@@ -456,6 +460,21 @@ private:
    */
   NdiscCache& operator= (NdiscCache const &);
 
+  /**
+   * \brief Move an entry to a new MAC address in the index of the MAC addresses.
+   *
+   * Called by the entry before it changes its MAC address.
+   *
+   * \param entry the entry
+   * \param mac the new MAC address of the entry
+   */
+  void IndexMacAddress (NdiscCache::Entry *entry, const Address &mac);
+
+  /**
+   * \brief The entries with a valid MAC address, by MAC address.
+   */
+  std::multimap<Address, NdiscCache::Entry *> m_macIndex;
+
   /**
    * \brief The NetDevice.
    */
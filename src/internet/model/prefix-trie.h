@@ -0,0 +1,377 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A path-compressed binary trie of address prefixes
+ *
+ * The trie maps prefixes of N-byte keys (addresses in network byte order,
+ * e.g., N = 4 for IPv4 and N = 16 for IPv6) to the list of values inserted
+ * with that prefix, e.g., the equal-cost routes to a destination network.
+ * The values of a prefix are kept in insertion order.
+ *
+ * Nodes only exist for the inserted prefixes and for the branching points
+ * between them, so a lookup visits at most one node per distinct prefix
+ * length on the path to the key, whatever the number of prefixes.  The
+ * routing protocols keep a PrefixTrie alongside their route lists to find
+ * the routes matching a destination without scanning the lists.
+ *
+ * \tparam T the value type; values are compared with operator==
+ * \tparam N the key size (bytes)
+ */
+template <typename T, std::size_t N>
+class PrefixTrie
+{
+public:
+  /// Values of a prefix
+  typedef std::vector<T> Values;
+
+  PrefixTrie ();
+  ~PrefixTrie ();
+
+  // Delete copy constructor and assignment operator to avoid misuse
+  PrefixTrie (PrefixTrie const &) = delete;
+  PrefixTrie &operator = (PrefixTrie const &) = delete;
+
+  /**
+   * \brief Append a value to the values of a prefix
+   * \param key the key; the bits after the prefix length are ignored
+   * \param length the prefix length (bits)
+   * \param value the value
+   */
+  void Insert (const uint8_t *key, uint8_t length, T const &value);
+  /**
+   * \brief Remove the first occurrence of a value from the values of a prefix
+   * \param key the key; the bits after the prefix length are ignored
+   * \param length the prefix length (bits)
+   * \param value the value
+   * \returns true if the value was found
+   */
+  bool Remove (const uint8_t *key, uint8_t length, T const &value);
+  /**
+   * \param key the key; the bits after the prefix length are ignored
+   * \param length the prefix length (bits)
+   * \returns the values of the prefix, or 0 if there are none
+   */
+  Values const *Find (const uint8_t *key, uint8_t length) const;
+  /**
+   * \brief Visit the prefixes matching a key, from the shortest to the longest
+   *
+   * The visitor is called as visitor (length, values) for each prefix of
+   * the key that has values.
+   *
+   * \param key the key, e.g., a destination address
+   * \param visitor the visitor
+   */
+  template <typename F>
+  void Match (const uint8_t *key, F visitor) const;
+  /**
+   * \brief Remove all the prefixes
+   */
+  void Clear (void);
+  /**
+   * \returns true if there are no prefixes
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /// Maximum prefix length (bits)
+  static constexpr uint8_t MAX_LENGTH = N * 8;
+
+  /// A node of the trie
+  struct Node
+  {
+    uint8_t key[N];    //!< Prefix, with the bits after the length cleared
+    uint8_t length;    //!< Prefix length (bits)
+    Node *child[2];    //!< Children, by the bit after the prefix
+    Values values;     //!< Values of the prefix, none for branching nodes
+  };
+
+  /**
+   * \param key a key
+   * \param bit the index of a bit, from the most significant one
+   * \returns the bit
+   */
+  static uint8_t GetBit (const uint8_t *key, uint8_t bit);
+  /**
+   * \param a a key
+   * \param b another key
+   * \param max the maximum length to compare (bits)
+   * \returns the length of the common prefix of both keys, at most max
+   */
+  static uint8_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint8_t max);
+  /**
+   * \param node a node
+   * \param key a key
+   * \returns true if the prefix of the node is a prefix of the key
+   */
+  static bool IsPrefixOf (Node const *node, const uint8_t *key);
+  /**
+   * \param key the key
+   * \param length the prefix length (bits)
+   * \returns a new node without children nor values
+   */
+  static Node *CreateNode (const uint8_t *key, uint8_t length);
+  /**
+   * \brief Delete a node and its descendants
+   * \param node the node
+   */
+  static void DeleteNode (Node *node);
+
+  Node *m_root; //!< Root, the node with the shortest prefix
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of the templates declared above
+ ****************************************************/
+
+namespace ns3 {
+
+template <typename T, std::size_t N>
+PrefixTrie<T, N>::PrefixTrie ()
+  : m_root (0)
+{
+}
+
+template <typename T, std::size_t N>
+PrefixTrie<T, N>::~PrefixTrie ()
+{
+  DeleteNode (m_root);
+}
+
+template <typename T, std::size_t N>
+uint8_t
+PrefixTrie<T, N>::GetBit (const uint8_t *key, uint8_t bit)
+{
+  return (key[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+template <typename T, std::size_t N>
+uint8_t
+PrefixTrie<T, N>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint8_t max)
+{
+  uint8_t length = 0;
+  for (std::size_t i = 0; i < N && length < max; i++)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff == 0)
+        {
+          length += 8;
+          continue;
+        }
+      while ((diff & 0x80) == 0)
+        {
+          diff <<= 1;
+          length++;
+        }
+      break;
+    }
+  return std::min (length, max);
+}
+
+template <typename T, std::size_t N>
+bool
+PrefixTrie<T, N>::IsPrefixOf (Node const *node, const uint8_t *key)
+{
+  uint8_t bytes = node->length >> 3;
+  if (std::memcmp (node->key, key, bytes) != 0)
+    {
+      return false;
+    }
+  uint8_t bits = node->length & 7;
+  return bits == 0 || (key[bytes] & (0xff << (8 - bits)) & 0xff) == node->key[bytes];
+}
+
+template <typename T, std::size_t N>
+typename PrefixTrie<T, N>::Node *
+PrefixTrie<T, N>::CreateNode (const uint8_t *key, uint8_t length)
+{
+  NS_ASSERT (length <= MAX_LENGTH);
+  Node *node = new Node;
+  std::memset (node->key, 0, N);
+  std::memcpy (node->key, key, length >> 3);
+  if (length & 7)
+    {
+      node->key[length >> 3] = key[length >> 3] & (0xff << (8 - (length & 7)));
+    }
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::DeleteNode (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNode (node->child[0]);
+      DeleteNode (node->child[1]);
+      delete node;
+    }
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::Insert (const uint8_t *key, uint8_t length, T const &value)
+{
+  NS_ASSERT (length <= MAX_LENGTH);
+  Node **link = &m_root;
+  while (*link != 0)
+    {
+      Node *node = *link;
+      uint8_t common = GetCommonLength (node->key, key, std::min (node->length, length));
+      if (common == node->length)
+        {
+          if (common == length)
+            {
+              node->values.push_back (value);
+              return;
+            }
+          // the node is a prefix of the key, go down
+          link = &node->child[GetBit (key, common)];
+          continue;
+        }
+      // the key diverges from the node, or is a prefix of it
+      Node *parent = CreateNode (key, common);
+      parent->child[GetBit (node->key, common)] = node;
+      *link = parent;
+      if (common == length)
+        {
+          parent->values.push_back (value);
+        }
+      else
+        {
+          Node *leaf = CreateNode (key, length);
+          leaf->values.push_back (value);
+          parent->child[GetBit (key, common)] = leaf;
+        }
+      return;
+    }
+  *link = CreateNode (key, length);
+  (*link)->values.push_back (value);
+}
+
+template <typename T, std::size_t N>
+bool
+PrefixTrie<T, N>::Remove (const uint8_t *key, uint8_t length, T const &value)
+{
+  NS_ASSERT (length <= MAX_LENGTH);
+  // links followed from the root, to prune the branching nodes left behind
+  Node **path[MAX_LENGTH + 2];
+  uint32_t depth = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length && IsPrefixOf (*link, key))
+    {
+      path[depth++] = link;
+      link = &(*link)->child[GetBit (key, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != length || !IsPrefixOf (node, key))
+    {
+      return false;
+    }
+  typename Values::iterator it = std::find (node->values.begin (), node->values.end (), value);
+  if (it == node->values.end ())
+    {
+      return false;
+    }
+  node->values.erase (it);
+  // remove the nodes which have neither values nor two children
+  path[depth++] = link;
+  while (depth > 0)
+    {
+      link = path[--depth];
+      node = *link;
+      if (!node->values.empty () || (node->child[0] != 0 && node->child[1] != 0))
+        {
+          break;
+        }
+      *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+      delete node;
+    }
+  return true;
+}
+
+template <typename T, std::size_t N>
+typename PrefixTrie<T, N>::Values const *
+PrefixTrie<T, N>::Find (const uint8_t *key, uint8_t length) const
+{
+  Node const *node = m_root;
+  while (node != 0 && node->length < length && IsPrefixOf (node, key))
+    {
+      node = node->child[GetBit (key, node->length)];
+    }
+  if (node == 0 || node->length != length || node->values.empty () || !IsPrefixOf (node, key))
+    {
+      return 0;
+    }
+  return &node->values;
+}
+
+template <typename T, std::size_t N>
+template <typename F>
+void
+PrefixTrie<T, N>::Match (const uint8_t *key, F visitor) const
+{
+  Node const *node = m_root;
+  while (node != 0 && IsPrefixOf (node, key))
+    {
+      if (!node->values.empty ())
+        {
+          visitor (node->length, node->values);
+        }
+      if (node->length == MAX_LENGTH)
+        {
+          break;
+        }
+      node = node->child[GetBit (key, node->length)];
+    }
+}
+
+template <typename T, std::size_t N>
+void
+PrefixTrie<T, N>::Clear (void)
+{
+  DeleteNode (m_root);
+  m_root = 0;
+}
+
+template <typename T, std::size_t N>
+bool
+PrefixTrie<T, N>::IsEmpty (void) const
+{
+  return m_root == 0;
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
@@ -0,0 +1,666 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/queue-disc.h"
+#include "tcp-fluid-model.h"
+#include "tcp-header.h"
+#include "tcp-l4-protocol.h"
+#include "ipv4.h"
+#include "ipv4-header.h"
+#include "ipv4-route.h"
+#include "ipv4-routing-protocol.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpFluidModel");
+
+NS_OBJECT_ENSURE_REGISTERED (TcpFluidModel);
+
+TypeId
+TcpFluidModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TcpFluidModel")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TcpFluidModel> ()
+    .AddAttribute ("MinResidualShare",
+                   "Share of the capacity of a link which is always left to the "
+                   "packets, however loaded the link is by fluid flows",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&TcpFluidModel::m_minResidualShare),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("DetectPacketFlows",
+                   "Whether the TCP flows simulated at the packet level take "
+                   "part in the allocation of the capacity",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpFluidModel::m_detectPacketFlows),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PacketFlowTimeout",
+                   "Time without data after which a packet-level flow no "
+                   "longer takes part in the allocation",
+                   TimeValue (MilliSeconds (500)),
+                   MakeTimeAccessor (&TcpFluidModel::m_packetFlowTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("AdjustQueueDiscs",
+                   "Whether the part of the buffer occupied by the fluid flows "
+                   "is withdrawn from the root queue disc of saturated links",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpFluidModel::m_adjustQueueDiscs),
+                   MakeBooleanChecker ())
+    .AddTraceSource ("FlowStart",
+                     "A fluid flow started",
+                     MakeTraceSourceAccessor (&TcpFluidModel::m_flowStartTrace),
+                     "ns3::TcpFluidModel::FlowTracedCallback")
+    .AddTraceSource ("FlowComplete",
+                     "A fluid flow sent all its bytes",
+                     MakeTraceSourceAccessor (&TcpFluidModel::m_flowCompleteTrace),
+                     "ns3::TcpFluidModel::FlowTracedCallback")
+  ;
+  return tid;
+}
+
+TcpFluidModel::TcpFluidModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TcpFluidModel::~TcpFluidModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TcpFluidModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (auto &ipv4 : m_tracked)
+    {
+      ipv4->TraceDisconnectWithoutContext ("Tx", MakeCallback (&TcpFluidModel::PacketSent, this));
+    }
+  m_tracked.clear ();
+  for (auto &flow : m_flows)
+    {
+      flow.m_startEvent.Cancel ();
+      flow.m_source = 0;
+    }
+  m_solveEvent.Cancel ();
+  m_completionEvent.Cancel ();
+  m_expireEvent.Cancel ();
+  m_links.clear ();
+  m_linkIndex.clear ();
+  m_packetFlows.clear ();
+  Object::DoDispose ();
+}
+
+uint32_t
+TcpFluidModel::AddFlow (Ptr<Node> source, Ipv4Address destination, uint64_t maxBytes,
+                        Time start, DataRate maxRate)
+{
+  NS_LOG_FUNCTION (this << source << destination << maxBytes << start << maxRate);
+  uint32_t flowId = m_flows.size ();
+  m_flows.emplace_back ();
+  FluidFlow &flow = m_flows.back ();
+  flow.m_source = source;
+  flow.m_destination = destination;
+  flow.m_size = maxBytes;
+  flow.m_maxRate = maxRate.GetBitRate ();
+  flow.m_startEvent = Simulator::Schedule (start, &TcpFluidModel::StartFlow, this, flowId);
+  return flowId;
+}
+
+void
+TcpFluidModel::StartFlow (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+  if (m_detectPacketFlows && !m_tracking)
+    {
+      TrackPacketFlows ();
+    }
+
+  FluidFlow &flow = m_flows[flowId];
+  bool found = FindPath (flow.m_source, flow.m_destination, flow.m_links);
+  NS_ABORT_MSG_UNLESS (found, "No route from node " << flow.m_source->GetId ()
+                       << " to " << flow.m_destination << " for fluid flow " << flowId);
+  NS_ABORT_MSG_IF (flow.m_links.empty () && flow.m_maxRate == 0,
+                   "Fluid flow " << flowId << " crosses no link with a DataRate and has no maximum rate");
+
+  Advance ();
+  flow.m_active = true;
+  m_flowStartTrace (flowId);
+  Update ();
+}
+
+void
+TcpFluidModel::StopFlow (uint32_t flowId)
+{
+  NS_LOG_FUNCTION (this << flowId);
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown fluid flow " << flowId);
+  FluidFlow &flow = m_flows[flowId];
+  flow.m_startEvent.Cancel ();
+  if (flow.m_active)
+    {
+      Advance ();
+      flow.m_active = false;
+      flow.m_rate = 0;
+      Update ();
+    }
+}
+
+DataRate
+TcpFluidModel::GetFlowRate (uint32_t flowId) const
+{
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown fluid flow " << flowId);
+  return DataRate (static_cast<uint64_t> (m_flows[flowId].m_rate));
+}
+
+uint64_t
+TcpFluidModel::GetFlowBytes (uint32_t flowId) const
+{
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown fluid flow " << flowId);
+  const FluidFlow &flow = m_flows[flowId];
+  double sent = flow.m_sent;
+  if (flow.m_active)
+    {
+      sent += flow.m_rate / 8 * (Simulator::Now () - m_lastAdvance).GetSeconds ();
+    }
+  if (flow.m_size > 0)
+    {
+      sent = std::min (sent, static_cast<double> (flow.m_size));
+    }
+  return static_cast<uint64_t> (std::llround (sent));
+}
+
+bool
+TcpFluidModel::IsFlowActive (uint32_t flowId) const
+{
+  NS_ASSERT_MSG (flowId < m_flows.size (), "Unknown fluid flow " << flowId);
+  return m_flows[flowId].m_active;
+}
+
+DataRate
+TcpFluidModel::GetLinkLoad (Ptr<NetDevice> device) const
+{
+  auto it = m_linkIndex.find (device);
+  if (it == m_linkIndex.end () || it->second < 0)
+    {
+      return DataRate (0);
+    }
+  return DataRate (static_cast<uint64_t> (m_links[it->second].m_load));
+}
+
+uint32_t
+TcpFluidModel::GetNPacketFlows (void) const
+{
+  return m_packetFlows.size ();
+}
+
+int32_t
+TcpFluidModel::GetLink (Ptr<NetDevice> device)
+{
+  auto it = m_linkIndex.find (device);
+  if (it != m_linkIndex.end ())
+    {
+      return it->second;
+    }
+
+  int32_t index = -1;
+  DataRateValue rate;
+  if (device->GetAttributeFailSafe ("DataRate", rate) && rate.Get ().GetBitRate () > 0)
+    {
+      index = m_links.size ();
+      m_links.emplace_back ();
+      m_links.back ().m_device = device;
+      m_links.back ().m_capacity = rate.Get ().GetBitRate ();
+      NS_LOG_LOGIC ("New link of " << rate.Get () << " on node " << device->GetNode ()->GetId ()
+                    << " device " << device->GetIfIndex ());
+    }
+  m_linkIndex[device] = index;
+  return index;
+}
+
+bool
+TcpFluidModel::FindPath (Ptr<Node> source, Ipv4Address destination, std::vector<uint32_t> &links)
+{
+  NS_LOG_FUNCTION (this << source << destination);
+  links.clear ();
+  Ptr<Node> node = source;
+  // Bound the length of the path in case of a routing loop
+  for (uint32_t hops = 0; hops < 255; hops++)
+    {
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      if (!ipv4)
+        {
+          return false;
+        }
+      if (ipv4->GetInterfaceForAddress (destination) >= 0)
+        {
+          return true;
+        }
+      Ptr<Ipv4RoutingProtocol> routing = ipv4->GetRoutingProtocol ();
+      if (!routing)
+        {
+          return false;
+        }
+
+      Ipv4Header header;
+      header.SetDestination (destination);
+      header.SetProtocol (TcpL4Protocol::PROT_NUMBER);
+      Socket::SocketErrno errno_;
+      Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, errno_);
+      if (!route)
+        {
+          return false;
+        }
+
+      Ptr<NetDevice> device = route->GetOutputDevice ();
+      int32_t link = GetLink (device);
+      if (link >= 0)
+        {
+          links.push_back (link);
+        }
+
+      Ipv4Address next = route->GetGateway ();
+      if (next == Ipv4Address::GetAny ())
+        {
+          next = destination;
+        }
+      Ptr<Channel> channel = device->GetChannel ();
+      if (!channel)
+        {
+          return false;
+        }
+      Ptr<Node> nextNode;
+      for (std::size_t i = 0; i < channel->GetNDevices () && !nextNode; i++)
+        {
+          Ptr<NetDevice> peer = channel->GetDevice (i);
+          Ptr<Ipv4> peerIpv4 = peer->GetNode ()->GetObject<Ipv4> ();
+          if (peer != device && peerIpv4 && peerIpv4->GetInterfaceForAddress (next) >= 0)
+            {
+              nextNode = peer->GetNode ();
+            }
+        }
+      if (!nextNode)
+        {
+          return false;
+        }
+      node = nextNode;
+    }
+  return false;
+}
+
+void
+TcpFluidModel::TrackPacketFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tracking = true;
+  for (NodeList::Iterator it = NodeList::Begin (); it != NodeList::End (); ++it)
+    {
+      Ptr<Ipv4> ipv4 = (*it)->GetObject<Ipv4> ();
+      if (ipv4 && ipv4->TraceConnectWithoutContext ("Tx", MakeCallback (&TcpFluidModel::PacketSent, this)))
+        {
+          m_tracked.push_back (ipv4);
+        }
+    }
+}
+
+void
+TcpFluidModel::PacketSent (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  Ipv4Header ipHeader;
+  packet->PeekHeader (ipHeader);
+  // Only the source of a flow reports it
+  if (ipHeader.GetProtocol () != TcpL4Protocol::PROT_NUMBER
+      || ipHeader.GetFragmentOffset () != 0
+      || ipv4->GetInterfaceForAddress (ipHeader.GetSource ()) < 0)
+    {
+      return;
+    }
+
+  Ptr<Packet> copy = packet->Copy ();
+  copy->RemoveHeader (ipHeader);
+  TcpHeader tcpHeader;
+  copy->PeekHeader (tcpHeader);
+  if (copy->GetSize () <= tcpHeader.GetSerializedSize ())
+    {
+      return;
+    }
+
+  PacketFlowKey key (ipHeader.GetSource ().Get (), ipHeader.GetDestination ().Get (),
+                     tcpHeader.GetSourcePort (), tcpHeader.GetDestinationPort ());
+  auto it = m_packetFlows.find (key);
+  if (it != m_packetFlows.end ())
+    {
+      it->second.m_lastSeen = Simulator::Now ();
+      return;
+    }
+
+  NS_LOG_LOGIC ("New packet flow from " << ipHeader.GetSource () << ":" << tcpHeader.GetSourcePort ()
+                << " to " << ipHeader.GetDestination () << ":" << tcpHeader.GetDestinationPort ());
+  PacketFlow &flow = m_packetFlows[key];
+  flow.m_lastSeen = Simulator::Now ();
+  // A flow without a path is still recorded, so that it is looked up once
+  if (!FindPath (ipv4->GetObject<Node> (), ipHeader.GetDestination (), flow.m_links))
+    {
+      flow.m_links.clear ();
+    }
+  if (!flow.m_links.empty ())
+    {
+      Update ();
+    }
+  if (!m_expireEvent.IsRunning ())
+    {
+      m_expireEvent = Simulator::Schedule (m_packetFlowTimeout, &TcpFluidModel::ExpirePacketFlows, this);
+    }
+}
+
+void
+TcpFluidModel::ExpirePacketFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time now = Simulator::Now ();
+  Time next = Time::Max ();
+  bool changed = false;
+  for (auto it = m_packetFlows.begin (); it != m_packetFlows.end (); )
+    {
+      if (it->second.m_lastSeen + m_packetFlowTimeout <= now)
+        {
+          changed = changed || !it->second.m_links.empty ();
+          it = m_packetFlows.erase (it);
+        }
+      else
+        {
+          next = std::min (next, it->second.m_lastSeen + m_packetFlowTimeout);
+          ++it;
+        }
+    }
+  if (changed)
+    {
+      Update ();
+    }
+  if (!m_packetFlows.empty ())
+    {
+      m_expireEvent = Simulator::Schedule (next - now, &TcpFluidModel::ExpirePacketFlows, this);
+    }
+}
+
+void
+TcpFluidModel::Update (void)
+{
+  if (!m_solveEvent.IsRunning ())
+    {
+      m_solveEvent = Simulator::ScheduleNow (&TcpFluidModel::Solve, this);
+    }
+}
+
+void
+TcpFluidModel::Advance (void)
+{
+  double elapsed = (Simulator::Now () - m_lastAdvance).GetSeconds ();
+  m_lastAdvance = Simulator::Now ();
+  if (elapsed <= 0)
+    {
+      return;
+    }
+  for (auto &flow : m_flows)
+    {
+      if (flow.m_active)
+        {
+          flow.m_sent += flow.m_rate / 8 * elapsed;
+          if (flow.m_size > 0)
+            {
+              flow.m_sent = std::min (flow.m_sent, static_cast<double> (flow.m_size));
+            }
+        }
+    }
+}
+
+void
+TcpFluidModel::Solve (void)
+{
+  NS_LOG_FUNCTION (this);
+  Advance ();
+
+  // The flows taking part in the allocation: the active fluid flows, then
+  // the packet flows
+  std::vector<const std::vector<uint32_t> *> paths;
+  std::vector<double> maxRates;
+  std::vector<uint32_t> fluidIds;
+  for (uint32_t i = 0; i < m_flows.size (); i++)
+    {
+      if (m_flows[i].m_active)
+        {
+          paths.push_back (&m_flows[i].m_links);
+          maxRates.push_back (m_flows[i].m_maxRate);
+          fluidIds.push_back (i);
+        }
+    }
+  for (auto &packetFlow : m_packetFlows)
+    {
+      if (!packetFlow.second.m_links.empty ())
+        {
+          paths.push_back (&packetFlow.second.m_links);
+          maxRates.push_back (0);
+        }
+    }
+
+  // Progressive filling: the rates of all the unfrozen flows grow together
+  // until a link is saturated or a flow reaches its maximum rate, at which
+  // point the flows concerned are frozen
+  uint32_t nLinks = m_links.size ();
+  std::vector<double> residual (nLinks);
+  std::vector<uint32_t> unfrozenOnLink (nLinks, 0);
+  std::vector<std::vector<uint32_t> > flowsOnLink (nLinks);
+  for (uint32_t l = 0; l < nLinks; l++)
+    {
+      residual[l] = m_links[l].m_capacity;
+    }
+  std::vector<uint32_t> capped;
+  for (uint32_t f = 0; f < paths.size (); f++)
+    {
+      for (uint32_t l : *paths[f])
+        {
+          unfrozenOnLink[l]++;
+          flowsOnLink[l].push_back (f);
+        }
+      if (maxRates[f] > 0)
+        {
+          capped.push_back (f);
+        }
+    }
+  std::sort (capped.begin (), capped.end (),
+             [&maxRates] (uint32_t a, uint32_t b) { return maxRates[a] < maxRates[b]; });
+
+  std::vector<double> rates (paths.size (), 0);
+  std::vector<bool> frozen (paths.size (), false);
+  uint32_t unfrozen = paths.size ();
+  double level = 0;
+  std::size_t nextCapped = 0;
+  auto freeze = [&] (uint32_t f)
+    {
+      frozen[f] = true;
+      rates[f] = level;
+      unfrozen--;
+      for (uint32_t l : *paths[f])
+        {
+          unfrozenOnLink[l]--;
+        }
+    };
+
+  while (unfrozen > 0)
+    {
+      double increment = std::numeric_limits<double>::infinity ();
+      for (uint32_t l = 0; l < nLinks; l++)
+        {
+          if (unfrozenOnLink[l] > 0)
+            {
+              increment = std::min (increment, residual[l] / unfrozenOnLink[l]);
+            }
+        }
+      while (nextCapped < capped.size () && frozen[capped[nextCapped]])
+        {
+          nextCapped++;
+        }
+      if (nextCapped < capped.size ())
+        {
+          increment = std::min (increment, maxRates[capped[nextCapped]] - level);
+        }
+      NS_ASSERT (increment < std::numeric_limits<double>::infinity ());
+      increment = std::max (increment, 0.0);
+
+      level += increment;
+      for (uint32_t l = 0; l < nLinks; l++)
+        {
+          residual[l] -= increment * unfrozenOnLink[l];
+        }
+      for (uint32_t l = 0; l < nLinks; l++)
+        {
+          if (unfrozenOnLink[l] > 0 && residual[l] <= 1e-9 * m_links[l].m_capacity)
+            {
+              for (uint32_t f : flowsOnLink[l])
+                {
+                  if (!frozen[f])
+                    {
+                      freeze (f);
+                    }
+                }
+            }
+        }
+      while (nextCapped < capped.size ()
+             && (frozen[capped[nextCapped]] || maxRates[capped[nextCapped]] - level <= 1e-9 * level))
+        {
+          if (!frozen[capped[nextCapped]])
+            {
+              freeze (capped[nextCapped]);
+            }
+          nextCapped++;
+        }
+    }
+
+  std::vector<double> loads (nLinks, 0);
+  for (uint32_t i = 0; i < fluidIds.size (); i++)
+    {
+      FluidFlow &flow = m_flows[fluidIds[i]];
+      flow.m_rate = rates[i];
+      NS_LOG_LOGIC ("Fluid flow " << fluidIds[i] << " rate " << flow.m_rate);
+      for (uint32_t l : flow.m_links)
+        {
+          loads[l] += flow.m_rate;
+        }
+    }
+  for (uint32_t l = 0; l < nLinks; l++)
+    {
+      Link &link = m_links[l];
+      bool saturated = !flowsOnLink[l].empty () && residual[l] <= 1e-9 * link.m_capacity;
+      if (loads[l] != link.m_load || saturated != link.m_saturated)
+        {
+          link.m_load = loads[l];
+          link.m_saturated = saturated;
+          ApplyLink (link);
+        }
+    }
+
+  // Schedule the next completion of a fluid flow
+  m_completionEvent.Cancel ();
+  double next = std::numeric_limits<double>::infinity ();
+  for (uint32_t id : fluidIds)
+    {
+      const FluidFlow &flow = m_flows[id];
+      if (flow.m_size > 0 && flow.m_rate > 0)
+        {
+          next = std::min (next, (flow.m_size - flow.m_sent) * 8 / flow.m_rate);
+        }
+    }
+  if (next < std::numeric_limits<double>::infinity ())
+    {
+      m_completionEvent = Simulator::Schedule (NanoSeconds (static_cast<int64_t> (std::ceil (next * 1e9))),
+                                               &TcpFluidModel::CompleteFlows, this);
+    }
+}
+
+void
+TcpFluidModel::ApplyLink (Link &link)
+{
+  NS_LOG_FUNCTION (this << link.m_device << link.m_load << link.m_saturated);
+  double share = std::max (1 - link.m_load / link.m_capacity, m_minResidualShare);
+  link.m_device->SetAttributeFailSafe ("DataRate",
+                                       DataRateValue (DataRate (static_cast<uint64_t> (link.m_capacity * share))));
+
+  if (!m_adjustQueueDiscs)
+    {
+      return;
+    }
+  Ptr<TrafficControlLayer> tc = link.m_device->GetNode ()->GetObject<TrafficControlLayer> ();
+  Ptr<QueueDisc> qdisc = tc ? tc->GetRootQueueDiscOnDevice (link.m_device) : 0;
+  QueueSizeValue size;
+  if (!qdisc || !qdisc->GetAttributeFailSafe ("MaxSize", size))
+    {
+      return;
+    }
+  if (!link.m_queueSaved)
+    {
+      link.m_queueSize = size.Get ();
+      link.m_queueSaved = true;
+    }
+  uint32_t value = link.m_queueSize.GetValue ();
+  if (link.m_saturated)
+    {
+      value = std::max<uint32_t> (1, std::lround (value * share));
+    }
+  // The queues of the disc cannot be shrunk below their backlog: keep the
+  // packets already queued, the limit is lowered further once they are gone
+  // at the next update of the fluid rates
+  value = std::max (value, qdisc->GetCurrentSize ().GetValue ());
+  qdisc->SetAttributeFailSafe ("MaxSize", QueueSizeValue (QueueSize (link.m_queueSize.GetUnit (), value)));
+}
+
+void
+TcpFluidModel::CompleteFlows (void)
+{
+  NS_LOG_FUNCTION (this);
+  Advance ();
+  for (uint32_t id = 0; id < m_flows.size (); id++)
+    {
+      FluidFlow &flow = m_flows[id];
+      // Less than a nanosecond of data left
+      if (flow.m_active && flow.m_size > 0
+          && (flow.m_size - flow.m_sent) * 8 <= flow.m_rate * 1e-9)
+        {
+          NS_LOG_LOGIC ("Fluid flow " << id << " completed");
+          flow.m_sent = flow.m_size;
+          flow.m_active = false;
+          flow.m_rate = 0;
+          m_flowCompleteTrace (id);
+        }
+    }
+  Update ();
+}
+
+} // namespace ns3
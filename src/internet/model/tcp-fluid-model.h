@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TCP_FLUID_MODEL_H
+#define TCP_FLUID_MODEL_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/data-rate.h"
+#include "ns3/queue-size.h"
+#include "ns3/traced-callback.h"
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Node;
+class NetDevice;
+class Packet;
+class Ipv4;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief Fluid model of background TCP flows for hybrid simulations
+ *
+ * Bulk TCP flows whose packets are of no interest, e.g. the background
+ * load of a scenario, can be added to this model instead of being simulated
+ * by BulkSendApplications. Such a fluid flow is a rate on each link of its
+ * path, and costs no event except its arrival and its departure.
+ *
+ * The rates of the fluid flows are the max-min fair allocation of the
+ * capacity of the links, which is the steady state that long TCP flows
+ * sharing a network approach. The allocation is computed again whenever a
+ * fluid flow arrives or departs. The path of a flow is the one given by the
+ * IPv4 routing protocols of the nodes at the time of its arrival; the
+ * capacity of a link is the DataRate attribute of its transmitting
+ * NetDevice (e.g., PointToPointNetDevice or SimpleNetDevice); devices
+ * without such an attribute are considered as links of infinite capacity.
+ * A flow may also be given a maximum rate, e.g. to account for a limited
+ * window.
+ *
+ * The TCP flows simulated at the packet level take part in the allocation
+ * as backlogged flows: the model detects them on the IPv4 Tx trace of the
+ * nodes when they send data, and forgets them when they do not send data
+ * for PacketFlowTimeout. The packets then experience the background load
+ * as follows:
+ *  - the DataRate of each device is set to the capacity which the fluid
+ *    flows leave (but no less than MinResidualShare of the capacity), so
+ *    that the packet flows get their fair share of the link and the
+ *    packets are delayed by the fluid flows;
+ *  - on the links saturated by the fluid flows, the part of the buffer
+ *    occupied by the fluid flows is withdrawn from the root queue disc of
+ *    the device: in a FIFO queue, the flows hold a share of the backlog
+ *    proportional to their rate, so the packets are left a share of the
+ *    buffer proportional to the capacity left to them.
+ *
+ * The model only handles IPv4 flows.
+ */
+class TcpFluidModel : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  TcpFluidModel ();
+  virtual ~TcpFluidModel ();
+
+  /**
+   * \brief Add a fluid flow
+   *
+   * Like a BulkSendApplication, the flow sends maxBytes bytes, or sends
+   * until StopFlow is called if maxBytes is zero.
+   *
+   * \param source the source node
+   * \param destination the destination address
+   * \param maxBytes the number of bytes to send (0 for no limit)
+   * \param start the time at which the flow starts, relative to now
+   * \param maxRate the maximum rate of the flow (0 for no limit)
+   * \returns the identifier of the flow
+   */
+  uint32_t AddFlow (Ptr<Node> source, Ipv4Address destination, uint64_t maxBytes = 0,
+                    Time start = Seconds (0), DataRate maxRate = DataRate (0));
+
+  /**
+   * \brief Stop a fluid flow
+   * \param flowId the identifier of the flow
+   */
+  void StopFlow (uint32_t flowId);
+
+  /**
+   * \brief Get the current rate of a fluid flow
+   * \param flowId the identifier of the flow
+   * \returns the rate of the flow, zero if it is not active
+   */
+  DataRate GetFlowRate (uint32_t flowId) const;
+
+  /**
+   * \brief Get the number of bytes sent so far by a fluid flow
+   * \param flowId the identifier of the flow
+   * \returns the number of bytes sent
+   */
+  uint64_t GetFlowBytes (uint32_t flowId) const;
+
+  /**
+   * \brief Check whether a fluid flow is sending
+   * \param flowId the identifier of the flow
+   * \returns true if the flow has started and has not completed or been stopped
+   */
+  bool IsFlowActive (uint32_t flowId) const;
+
+  /**
+   * \brief Get the sum of the rates of the fluid flows sent by a device
+   * \param device the transmitting device of a link
+   * \returns the fluid load of the link
+   */
+  DataRate GetLinkLoad (Ptr<NetDevice> device) const;
+
+  /**
+   * \returns the number of TCP flows currently detected at the packet level
+   */
+  uint32_t GetNPacketFlows (void) const;
+
+  /**
+   * \brief TracedCallback signature for fluid flow events
+   * \param [in] flowId the identifier of the flow
+   */
+  typedef void (* FlowTracedCallback)(uint32_t flowId);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// A link, i.e., a transmitting device
+  struct Link
+  {
+    Ptr<NetDevice> m_device;    //!< Transmitting device
+    double m_capacity {0};      //!< Capacity of the link (bit/s)
+    double m_load {0};          //!< Sum of the rates of the fluid flows (bit/s)
+    bool m_saturated {false};   //!< Whether the allocation saturates the link
+    bool m_queueSaved {false};  //!< Whether m_queueSize holds the size of the queue disc
+    QueueSize m_queueSize;      //!< Original maximum size of the root queue disc
+  };
+
+  /// A fluid flow
+  struct FluidFlow
+  {
+    Ptr<Node> m_source;             //!< Source node
+    Ipv4Address m_destination;      //!< Destination address
+    std::vector<uint32_t> m_links;  //!< Links of the path
+    double m_maxRate {0};           //!< Maximum rate (bit/s), 0 for no limit
+    double m_rate {0};              //!< Current rate (bit/s)
+    uint64_t m_size {0};            //!< Bytes to send, 0 for no limit
+    double m_sent {0};              //!< Bytes sent so far
+    bool m_active {false};          //!< Whether the flow is sending
+    EventId m_startEvent;           //!< Arrival of the flow
+  };
+
+  /// Key of a packet-level flow: source, destination, source port, destination port
+  typedef std::tuple<uint32_t, uint32_t, uint16_t, uint16_t> PacketFlowKey;
+
+  /// A TCP flow simulated at the packet level
+  struct PacketFlow
+  {
+    std::vector<uint32_t> m_links;  //!< Links of the path
+    Time m_lastSeen;                //!< Time of its last data packet
+  };
+
+  /**
+   * \brief Start a fluid flow
+   * \param flowId the identifier of the flow
+   */
+  void StartFlow (uint32_t flowId);
+
+  /**
+   * \brief Find the path from a node to an address with the routing protocols
+   * \param source the source node
+   * \param destination the destination address
+   * \param links the links of the path, filled by this function
+   * \returns false if there is no route to the destination
+   */
+  bool FindPath (Ptr<Node> source, Ipv4Address destination, std::vector<uint32_t> &links);
+
+  /**
+   * \brief Get the index of the link of a device, adding it if needed
+   * \param device the transmitting device
+   * \returns the index of the link, or -1 if the device has no capacity
+   */
+  int32_t GetLink (Ptr<NetDevice> device);
+
+  /**
+   * \brief Connect to the IPv4 Tx trace of the nodes to detect the packet flows
+   */
+  void TrackPacketFlows (void);
+
+  /**
+   * \brief Detect the TCP packet flows sent by a node
+   * \param packet the packet, with its IPv4 header
+   * \param ipv4 the IPv4 stack of the node
+   * \param interface the outgoing interface
+   */
+  void PacketSent (Ptr<const Packet> packet, Ptr<Ipv4> ipv4, uint32_t interface);
+
+  /**
+   * \brief Forget the packet flows which stopped sending data
+   */
+  void ExpirePacketFlows (void);
+
+  /**
+   * \brief Schedule the computation of the allocation
+   *
+   * All the arrivals and departures of the current time are taken into
+   * account by a single computation.
+   */
+  void Update (void);
+
+  /**
+   * \brief Account for the bytes sent by the fluid flows since the last update
+   */
+  void Advance (void);
+
+  /**
+   * \brief Compute the max-min fair allocation and apply it to the devices
+   */
+  void Solve (void);
+
+  /**
+   * \brief Set the rate and the queue disc size of a device according to the load of its link
+   * \param link the link
+   */
+  void ApplyLink (Link &link);
+
+  /**
+   * \brief Complete the fluid flows which sent all their bytes
+   */
+  void CompleteFlows (void);
+
+  std::vector<Link> m_links;                          //!< Links crossed by the flows
+  std::map<Ptr<NetDevice>, int32_t> m_linkIndex;      //!< Index of the link of each device
+  std::vector<FluidFlow> m_flows;                     //!< Fluid flows, by identifier
+  std::map<PacketFlowKey, PacketFlow> m_packetFlows;  //!< TCP flows simulated at the packet level
+  Time m_lastAdvance;                                 //!< Time of the last Advance
+  EventId m_solveEvent;                               //!< Pending computation of the allocation
+  EventId m_completionEvent;                          //!< Next completion of a fluid flow
+  EventId m_expireEvent;                              //!< Next check of the packet flows
+  bool m_tracking {false};                            //!< Whether the Tx traces are connected
+  std::vector<Ptr<Ipv4> > m_tracked;                  //!< IPv4 stacks whose Tx trace is connected
+
+  double m_minResidualShare;                          //!< Share of a link always left to the packets
+  Time m_packetFlowTimeout;                           //!< Inactivity after which a packet flow is forgotten
+  bool m_detectPacketFlows;                           //!< Whether the packet flows take part in the allocation
+  bool m_adjustQueueDiscs;                            //!< Whether the queue discs are resized
+
+  TracedCallback<uint32_t> m_flowStartTrace;          //!< Trace of the arrivals of fluid flows
+  TracedCallback<uint32_t> m_flowCompleteTrace;       //!< Trace of the completions of fluid flows
+};
+
+} // namespace ns3
+
+#endif /* TCP_FLUID_MODEL_H */
@@ -23,6 +23,7 @@
 #include "tcp-header.h"
 #include "tcp-option.h"
 #include "ns3/buffer.h"
+#include "ns3/header-image.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
 
@@ -315,14 +316,17 @@ void
 TcpHeader::Serialize (Buffer::Iterator start)  const
 {
   Buffer::Iterator i = start;
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
-  i.WriteHtonU32 (m_sequenceNumber.GetValue ());
-  i.WriteHtonU32 (m_ackNumber.GetValue ());
-  i.WriteHtonU16 (GetLength () << 12 | m_flags); //reserved bits are all zero
-  i.WriteHtonU16 (m_windowSize);
-  i.WriteHtonU16 (0);
-  i.WriteHtonU16 (m_urgentPointer);
+
+  // Byte image of the fixed part of the header, with a zero checksum
+  static const uint8_t image[20] = { 0 };
+  uint8_t *data = i.WriteImage (image, sizeof (image));
+  HeaderImage::WriteHtonU16 (data, m_sourcePort);
+  HeaderImage::WriteHtonU16 (data + 2, m_destinationPort);
+  HeaderImage::WriteHtonU32 (data + 4, m_sequenceNumber.GetValue ());
+  HeaderImage::WriteHtonU32 (data + 8, m_ackNumber.GetValue ());
+  HeaderImage::WriteHtonU16 (data + 12, GetLength () << 12 | m_flags); //reserved bits are all zero
+  HeaderImage::WriteHtonU16 (data + 14, m_windowSize);
+  HeaderImage::WriteHtonU16 (data + 18, m_urgentPointer);
 
   // Serialize options if they exist
   // This implementation does not presently try to align options on word
@@ -349,10 +353,7 @@ TcpHeader::Serialize (Buffer::Iterator start)  const
       uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
       i = start;
       uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-      i = start;
-      i.Next (16);
-      i.WriteU16 (checksum);
+      HeaderImage::WriteU16 (data + 16, checksum);
     }
 }
 
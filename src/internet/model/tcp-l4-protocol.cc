@@ -50,6 +50,7 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -703,6 +704,41 @@ TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
   NS_FATAL_ERROR ("Trying to send a packet without IP addresses");
 }
 
+void
+TcpL4Protocol::SendSegments (Ptr<Packet> pkt, const TcpHeader &outgoing, uint32_t segmentSize,
+                             const Address &saddr, const Address &daddr,
+                             Ptr<NetDevice> oif) const
+{
+  NS_LOG_FUNCTION (this << pkt << outgoing << segmentSize << saddr << daddr << oif);
+  NS_ASSERT (segmentSize > 0);
+
+  uint32_t size = pkt->GetSize ();
+  if (size <= segmentSize)
+    {
+      SendPacket (pkt, outgoing, saddr, daddr, oif);
+      return;
+    }
+
+  uint8_t flags = outgoing.GetFlags ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      TcpHeader header = outgoing;
+      header.SetSequenceNumber (outgoing.GetSequenceNumber () + offset);
+      uint8_t segmentFlags = flags;
+      if (offset > 0)
+        {
+          segmentFlags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          segmentFlags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      header.SetFlags (segmentFlags);
+      SendPacket (pkt->CreateFragment (offset, length), header, saddr, daddr, oif);
+    }
+}
+
 void
 TcpL4Protocol::AddSocket (Ptr<TcpSocketBase> socket)
 {
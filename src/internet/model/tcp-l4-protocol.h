@@ -218,6 +218,26 @@ public:
                    const Address &saddr, const Address &daddr,
                    Ptr<NetDevice> oif = 0) const;
 
+  /**
+   * \brief Send a super-segment via TCP, split into segments (GSO)
+   *
+   * This is the software equivalent of the segmentation offload of a
+   * NetDevice: the payload is cut into segments of at most segmentSize
+   * bytes, each sent with a copy of the header whose sequence number is
+   * moved forward. CWR is kept on the first segment only, and FIN and PSH
+   * on the last one only. The packet tags are copied in every segment.
+   *
+   * \param pkt The payload of the super-segment
+   * \param outgoing The header of the super-segment
+   * \param segmentSize The maximum payload size of the segments
+   * \param saddr The source Ipv4Address
+   * \param daddr The destination Ipv4Address
+   * \param oif The output interface bound. Defaults to null (unspecified).
+   */
+  void SendSegments (Ptr<Packet> pkt, const TcpHeader &outgoing, uint32_t segmentSize,
+                     const Address &saddr, const Address &daddr,
+                     Ptr<NetDevice> oif = 0) const;
+
   /**
    * \brief Make a socket fully operational
    *
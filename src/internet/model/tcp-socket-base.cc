@@ -59,6 +59,7 @@
 #include "tcp-congestion-ops.h"
 #include "tcp-recovery-ops.h"
 #include "ns3/tcp-rate-ops.h"
+#include "gso-tag.h"
 
 #include <math.h>
 #include <algorithm>
@@ -153,6 +154,31 @@ TcpSocketBase::GetTypeId (void)
                    MakeEnumChecker (TcpSocketState::Off, "Off",
                                     TcpSocketState::On, "On",
                                     TcpSocketState::AcceptOnly, "AcceptOnly"))
+    .AddAttribute ("GsoMaxSegments",
+                   "Maximum number of full segments of new data sent as one "
+                   "super-segment (generic segmentation offload); 1 disables it",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_gsoMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("GsoSplit",
+                   "Split the super-segments into segments before the IP layer, so "
+                   "that the network carries the same packets as without GSO. If false, "
+                   "a super-segment crosses the network as one packet, not fragmented by IP",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&TcpSocketBase::m_gsoSplit),
+                   MakeBooleanChecker ())
+    .AddAttribute ("GroMaxSegments",
+                   "Maximum number of in-order data segments coalesced before being "
+                   "processed (generic receive offload); 1 disables it",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_groMaxSegments),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("GroTimeout",
+                   "Maximum time a data segment is held for coalescing; it should be "
+                   "about the transmission time of GroMaxSegments segments",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&TcpSocketBase::m_groTimeout),
+                   MakeTimeChecker ())
     .AddTraceSource ("RTO",
                      "Retransmission timeout",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rto),
@@ -225,6 +251,11 @@ TcpSocketBase::GetTypeId (void)
                      "Receive tcp packet from IP protocol",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_rxTrace),
                      "ns3::TcpSocketBase::TcpTxRxTracedCallback")
+    .AddTraceSource ("GroDrop",
+                     "Segments held for coalescing, with their TCP header, and dropped "
+                     "because the timers were cancelled before they were processed",
+                     MakeTraceSourceAccessor (&TcpSocketBase::m_groDropTrace),
+                     "ns3::Packet::TracedCallback")
     .AddTraceSource ("EcnEchoSeq",
                      "Sequence of last received ECN Echo",
                      MakeTraceSourceAccessor (&TcpSocketBase::m_ecnEchoSeq),
@@ -356,7 +387,11 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_pacingTimer (Timer::CANCEL_ON_DESTROY),
     m_ecnEchoSeq (sock.m_ecnEchoSeq),
     m_ecnCESeq (sock.m_ecnCESeq),
-    m_ecnCWRSeq (sock.m_ecnCWRSeq)
+    m_ecnCWRSeq (sock.m_ecnCWRSeq),
+    m_gsoMaxSegments (sock.m_gsoMaxSegments),
+    m_gsoSplit (sock.m_gsoSplit),
+    m_groMaxSegments (sock.m_groMaxSegments),
+    m_groTimeout (sock.m_groTimeout)
 {
   NS_LOG_FUNCTION (this);
   NS_LOG_LOGIC ("Invoked the copy constructor");
@@ -1171,7 +1206,7 @@ TcpSocketBase::ForwardUp (Ptr<Packet> packet, Ipv4Header header, uint16_t port,
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
 
-  DoForwardUp (packet, fromAddress, toAddress);
+  GroReceive (packet, tcpHeader, fromAddress, toAddress);
 }
 
 void
@@ -1210,7 +1245,7 @@ TcpSocketBase::ForwardUp6 (Ptr<Packet> packet, Ipv6Header header, uint16_t port,
       m_congestionControl->CwndEvent (m_tcb, TcpSocketState::CA_EVENT_ECN_NO_CE);
     }
 
-  DoForwardUp (packet, fromAddress, toAddress);
+  GroReceive (packet, tcpHeader, fromAddress, toAddress);
 }
 
 void
@@ -1272,6 +1307,9 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
   // in case the packet still has a priority tag attached, remove it
   SocketPriorityTag priorityTag;
   packet->RemovePacketTag (priorityTag);
+  // same for the tag of a super-segment sent with GSO
+  GsoTag gsoTag;
+  packet->RemovePacketTag (gsoTag);
 
   // Peel off TCP header
   TcpHeader tcpHeader;
@@ -1445,6 +1483,102 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
     }
 }
 
+void
+TcpSocketBase::GroReceive (Ptr<Packet> packet, const TcpHeader &tcpHeader,
+                           const Address &fromAddress, const Address &toAddress)
+{
+  if (m_groMaxSegments <= 1)
+    {
+      DoForwardUp (packet, fromAddress, toAddress);
+      return;
+    }
+  NS_LOG_FUNCTION (this << packet << tcpHeader);
+
+  // Only data segments without other flags or options than timestamps are
+  // coalesced, as in Linux: anything else flushes the held segment, to keep
+  // the order of the segments
+  uint32_t payloadSize = packet->GetSize () - tcpHeader.GetSerializedSize ();
+  bool mergeable = m_state == ESTABLISHED && payloadSize > 0
+    && (tcpHeader.GetFlags () & ~TcpHeader::PSH) == TcpHeader::ACK;
+  const TcpHeader::TcpOptionList &options = tcpHeader.GetOptionList ();
+  for (auto it = options.begin (); mergeable && it != options.end (); ++it)
+    {
+      uint8_t kind = (*it)->GetKind ();
+      mergeable = kind == TcpOption::TS || kind == TcpOption::NOP || kind == TcpOption::END;
+    }
+
+  if (m_groPacket != nullptr)
+    {
+      if (mergeable && IsGroMergeable (tcpHeader))
+        {
+          NS_LOG_LOGIC ("Coalescing segment " << tcpHeader.GetSequenceNumber ());
+          packet->RemoveAtStart (tcpHeader.GetSerializedSize ());
+          m_groPacket->AddAtEnd (packet);
+          m_groNextSeq += payloadSize;
+          if (++m_groSegments >= m_groMaxSegments)
+            {
+              GroFlush ();
+            }
+          return;
+        }
+      GroFlush ();
+    }
+
+  if (!mergeable)
+    {
+      DoForwardUp (packet, fromAddress, toAddress);
+      return;
+    }
+
+  NS_LOG_LOGIC ("Holding segment " << tcpHeader.GetSequenceNumber () << " for coalescing");
+  m_groPacket = packet;
+  m_groSegments = 1;
+  m_groNextSeq = tcpHeader.GetSequenceNumber () + payloadSize;
+  m_groAck = tcpHeader.GetAckNumber ();
+  m_groWindow = tcpHeader.GetWindowSize ();
+  m_groTsValue = 0;
+  m_groTsEcho = 0;
+  if (tcpHeader.HasOption (TcpOption::TS))
+    {
+      Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+      m_groTsValue = ts->GetTimestamp ();
+      m_groTsEcho = ts->GetEcho ();
+    }
+  m_groFromAddress = fromAddress;
+  m_groToAddress = toAddress;
+  m_groEvent = Simulator::Schedule (m_groTimeout, &TcpSocketBase::GroFlush, this);
+}
+
+bool
+TcpSocketBase::IsGroMergeable (const TcpHeader &tcpHeader) const
+{
+  if (tcpHeader.GetSequenceNumber () != m_groNextSeq
+      || tcpHeader.GetAckNumber () != m_groAck
+      || tcpHeader.GetWindowSize () != m_groWindow)
+    {
+      return false;
+    }
+  if (tcpHeader.HasOption (TcpOption::TS))
+    {
+      Ptr<const TcpOptionTS> ts = DynamicCast<const TcpOptionTS> (tcpHeader.GetOption (TcpOption::TS));
+      return ts->GetTimestamp () == m_groTsValue && ts->GetEcho () == m_groTsEcho;
+    }
+  return true;
+}
+
+void
+TcpSocketBase::GroFlush (void)
+{
+  NS_LOG_FUNCTION (this << m_groSegments);
+  m_groEvent.Cancel ();
+  Ptr<Packet> packet = m_groPacket;
+  m_groPacket = nullptr;
+  if (packet != nullptr)
+    {
+      DoForwardUp (packet, m_groFromAddress, m_groToAddress);
+    }
+}
+
 /* Received a packet upon ESTABLISHED state. This function is mimicking the
     role of tcp_rcv_established() in tcp_input.c in Linux kernel. */
 void
@@ -3040,13 +3174,31 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
   NS_LOG_FUNCTION (this << seq << maxSize << withAck);
 
   bool isStartOfTransmission = BytesInFlight () == 0U;
-  TcpTxItem *outItem = m_txBuffer->CopyFromSequence (maxSize, seq);
+  bool isSuperSegment = m_gsoMaxSegments > 1 && maxSize > m_tcb->m_segmentSize;
+  TcpTxItem *outItem = m_txBuffer->CopyFromSequence (isSuperSegment ? m_tcb->m_segmentSize : maxSize, seq);
 
   m_rateOps->SkbSent(outItem, isStartOfTransmission);
 
   bool isRetransmission = outItem->IsRetrans ();
   Ptr<Packet> p = outItem->GetPacketCopy ();
   uint32_t sz = p->GetSize (); // Size of packet
+
+  // A super-segment (GSO) is made of one item per segment, so that the
+  // scoreboard and the rate samples keep the granularity of the wire
+  while (isSuperSegment && sz < maxSize)
+    {
+      outItem = m_txBuffer->CopyFromSequence (std::min (maxSize - sz, m_tcb->m_segmentSize),
+                                              seq + SequenceNumber32 (sz));
+      if (outItem == nullptr)
+        {
+          break;
+        }
+      m_rateOps->SkbSent (outItem, false);
+      NS_ASSERT (outItem->IsRetrans () == isRetransmission);
+      p->AddAtEnd (outItem->GetPacketCopy ());
+      sz = p->GetSize ();
+    }
+  isSuperSegment = isSuperSegment && sz > m_tcb->m_segmentSize;
   uint8_t flags = withAck ? TcpHeader::ACK : 0;
   uint32_t remainingData = m_txBuffer->SizeFromSequence (seq + SequenceNumber32 (sz));
 
@@ -3089,6 +3241,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     }
 
   AddSocketTags (p);
+  if (isSuperSegment && !m_gsoSplit)
+    {
+      p->AddPacketTag (GsoTag (m_tcb->m_segmentSize));
+    }
 
   if (m_closeOnEmpty && (remainingData == 0))
     {
@@ -3133,7 +3289,15 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   m_txTrace (p, header, this);
 
-  if (m_endPoint)
+  if (m_endPoint && isSuperSegment && m_gsoSplit)
+    {
+      m_tcp->SendSegments (p, header, m_tcb->m_segmentSize, m_endPoint->GetLocalAddress (),
+                           m_endPoint->GetPeerAddress (), m_boundnetdevice);
+      NS_LOG_DEBUG ("Send super-segment of size " << sz << " with remaining data " <<
+                    remainingData << " via TcpL4Protocol to " <<  m_endPoint->GetPeerAddress () <<
+                    ". Header " << header);
+    }
+  else if (m_endPoint)
     {
       m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
                          m_endPoint->GetPeerAddress (), m_boundnetdevice);
@@ -3141,6 +3305,14 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
                     remainingData << " via TcpL4Protocol to " <<  m_endPoint->GetPeerAddress () <<
                     ". Header " << header);
     }
+  else if (isSuperSegment && m_gsoSplit)
+    {
+      m_tcp->SendSegments (p, header, m_tcb->m_segmentSize, m_endPoint6->GetLocalAddress (),
+                           m_endPoint6->GetPeerAddress (), m_boundnetdevice);
+      NS_LOG_DEBUG ("Send super-segment of size " << sz << " with remaining data " <<
+                    remainingData << " via TcpL4Protocol to " <<  m_endPoint6->GetPeerAddress () <<
+                    ". Header " << header);
+    }
   else
     {
       m_tcp->SendPacket (p, header, m_endPoint6->GetLocalAddress (),
@@ -3283,6 +3455,21 @@ TcpSocketBase::SendPendingData (bool withAck)
           uint32_t maxSizeToSend = static_cast<uint32_t> (nextHigh - next);
           s = std::min (s, maxSizeToSend);
 
+          // With GSO, new data is sent as a super-segment of full segments,
+          // within the windows, and of at most 64 KB with the headers
+          if (m_gsoMaxSegments > 1 && s == m_tcb->m_segmentSize && next == m_tcb->m_highTxMark)
+            {
+              int32_t rWndLeft = (m_highRxAckMark + SequenceNumber32 (m_rWnd)) - next;
+              uint32_t gsoSize = std::min (std::min (availableWindow, availableData),
+                                           std::min (static_cast<uint32_t> (std::max (rWndLeft, 0)),
+                                                     65535U - 2 * 60));
+              uint32_t segments = std::min (gsoSize / m_tcb->m_segmentSize, m_gsoMaxSegments);
+              if (segments > 1)
+                {
+                  s = segments * m_tcb->m_segmentSize;
+                }
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3890,6 +4077,15 @@ TcpSocketBase::CancelAllTimers ()
   m_timewaitEvent.Cancel ();
   m_sendPendingDataEvent.Cancel ();
   m_pacingTimer.Cancel ();
+  m_groEvent.Cancel ();
+  if (m_groPacket != nullptr)
+    {
+      // the end point is being released, hence the held segments can no
+      // longer be processed
+      NS_LOG_WARN ("Dropping " << m_groSegments << " segments held for coalescing");
+      m_groDropTrace (m_groPacket);
+      m_groPacket = nullptr;
+    }
 }
 
 /* Move TCP to Time_Wait state and schedule a transition to Closed state */
@@ -200,6 +200,27 @@ public:
  * available to build them) are scattered around the code. For instance,
  * the SACK option is built in SendEmptyPacket only under certain conditions.
  *
+ * Segmentation and receive offloads
+ * ----------------------------------
+ *
+ * With the GsoMaxSegments attribute, new data may be sent in super-segments
+ * of up to GsoMaxSegments full segments (and at most 64 KB), as with the
+ * TSO/GSO of Linux. A super-segment is built from one TcpTxBuffer item per
+ * segment, so that the scoreboard keeps the granularity of the wire. By
+ * default (GsoSplit true), TcpL4Protocol::SendSegments splits it into
+ * segments before the IP layer: the network sees the same packets as
+ * without GSO, only the per-segment work of the socket is saved. With
+ * GsoSplit false, the super-segment crosses the network as a single packet,
+ * tagged with a GsoTag so that it is not fragmented by IP: this reduces the
+ * number of packets, and thus of events, by up to GsoMaxSegments on both
+ * the data and the ACK paths, at the cost of wire-level accuracy.
+ *
+ * On the receive side, the GroMaxSegments attribute enables the coalescing
+ * of in-order data segments (GRO): consecutive segments with the same ACK,
+ * window and options are merged before being processed, for at most
+ * GroTimeout after the first one, so that the receiver processes (and ACKs)
+ * them as a single segment.
+ *
  * SACK
  * ----
  *
@@ -737,6 +758,36 @@ protected:
   virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
                             const Address &toAddress);
 
+  /**
+   * \brief Coalesce an incoming segment with the previous ones (GRO), or
+   * pass it to DoForwardUp
+   *
+   * In-order data segments are held and merged until GroMaxSegments of
+   * them are merged, GroTimeout expires, or a segment which cannot be
+   * merged arrives; the merged segment is then passed to DoForwardUp.
+   *
+   * \param packet the incoming packet, with its TCP header
+   * \param tcpHeader the TCP header of the packet
+   * \param fromAddress the address of the sender of packet
+   * \param toAddress the address of the receiver of packet
+   */
+  void GroReceive (Ptr<Packet> packet, const TcpHeader &tcpHeader,
+                   const Address &fromAddress, const Address &toAddress);
+
+  /**
+   * \brief Check if a segment can be merged with the held segment (GRO)
+   *
+   * \param tcpHeader the TCP header of the segment
+   * \return true if the segment follows the held segment, with the same
+   * ACK, window and timestamps
+   */
+  bool IsGroMergeable (const TcpHeader &tcpHeader) const;
+
+  /**
+   * \brief Pass the segment held for coalescing, if any, to DoForwardUp
+   */
+  void GroFlush (void);
+
   /**
    * \brief Called by the L3 protocol when it received an ICMP packet to pass on to TCP.
    *
@@ -1347,6 +1398,23 @@ protected:
   TracedValue<SequenceNumber32> m_ecnEchoSeq {0};      //!< Sequence number of the last received ECN Echo
   TracedValue<SequenceNumber32> m_ecnCESeq   {0};      //!< Sequence number of the last received Congestion Experienced
   TracedValue<SequenceNumber32> m_ecnCWRSeq  {0};      //!< Sequence number of the last sent CWR
+
+  // Segmentation and receive offloads
+  uint32_t    m_gsoMaxSegments {1};     //!< Maximum number of segments of a super-segment
+  bool        m_gsoSplit       {true};  //!< Split the super-segments before the IP layer
+  uint32_t    m_groMaxSegments {1};     //!< Maximum number of segments coalesced on receive
+  Time        m_groTimeout     {Seconds (0.0)}; //!< Maximum time a segment is held for coalescing
+  Ptr<Packet> m_groPacket;              //!< Segment held for coalescing, with its TCP header
+  uint32_t    m_groSegments    {0};     //!< Number of segments merged in m_groPacket
+  SequenceNumber32 m_groNextSeq {0};    //!< Sequence number following m_groPacket
+  SequenceNumber32 m_groAck    {0};     //!< ACK number of m_groPacket
+  uint16_t    m_groWindow      {0};     //!< Window of m_groPacket
+  uint32_t    m_groTsValue     {0};     //!< Timestamp value of m_groPacket
+  uint32_t    m_groTsEcho      {0};     //!< Timestamp echo of m_groPacket
+  Address     m_groFromAddress;         //!< Source address of m_groPacket
+  Address     m_groToAddress;           //!< Destination address of m_groPacket
+  EventId     m_groEvent       {};      //!< Flush of m_groPacket
+  TracedCallback<Ptr<const Packet> > m_groDropTrace; //!< Trace of the held segments dropped
 };
 
 /**
@@ -21,6 +21,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <vector>
 
 #include "ns3/packet.h"
 #include "ns3/log.h"
@@ -296,7 +297,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  IndexItem (m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -310,36 +311,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  SentIndex::const_iterator pos = m_sentIndex.find (seq);
+  if (pos != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      PacketList::iterator it = pos->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
+          if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-              // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
-              if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -347,8 +345,10 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   if (! item->m_retrans)
     {
+      RemoveFromScoreboard (item);
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      AddToScoreboard (item);
     }
 
   return item;
@@ -400,7 +400,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -436,12 +436,25 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool indexed = (&list == &m_sentList);
+
+  if (indexed)
+    {
+      // Start from the sent item containing seq, instead of walking the list
+      SentIndex::const_iterator pos = m_sentIndex.upper_bound (seq);
+      if (pos != m_sentIndex.begin ())
+        {
+          --pos;
+          it = pos->second;
+          beginOfCurrentPacket = pos->first;
+        }
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!indexed || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -468,10 +481,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator first = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  IndexItem (first);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -534,10 +556,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              if (indexed)
+                {
+                  UnindexItem (currentItem);
+                }
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator first = list.insert (it, firstPart);
+              if (indexed)
+                {
+                  IndexItem (first);
+                  IndexItem (it);
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -550,6 +581,7 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
         {
           // The end isn't inside current packet, but there is an exception for
           // the merge and recurse strategy...
+          PacketList::iterator current = it;
           if (++it == list.end ())
             {
               // ...current is the last packet we sent. We have not more data;
@@ -565,8 +597,17 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
 
+          if (indexed)
+            {
+              UnindexItem (currentItem);
+              UnindexItem (next);
+            }
           MergeItems (currentItem, next);
           list.erase (it);
+          if (indexed)
+            {
+              IndexItem (current);
+            }
 
           delete next;
 
@@ -646,20 +687,88 @@ TcpTxBuffer::RemoveFromCounts (TcpTxItem *item, uint32_t size)
     }
 }
 
+bool
+TcpTxBuffer::IsInScoreboard (TcpTxItem const *item, Scoreboard set)
+{
+  switch (set)
+    {
+    case SACKED:
+      return item->m_sacked;
+    case LOST:
+      return item->m_lost;
+    case IN_FLIGHT:
+      return !item->m_sacked && !item->m_lost;
+    case NOT_SACKED:
+      return !item->m_sacked;
+    case NOT_RETRANS:
+      return !item->m_sacked && !item->m_retrans;
+    case TO_RETRANS:
+      return !item->m_sacked && !item->m_retrans && item->m_lost;
+    default:
+      NS_FATAL_ERROR ("Unknown scoreboard set " << set);
+    }
+  return false;
+}
+
+void
+TcpTxBuffer::AddToScoreboard (TcpTxItem const *item)
+{
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      if (IsInScoreboard (item, static_cast<Scoreboard> (i)))
+        {
+          m_scoreboard[i].insert (item->m_startSeq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::RemoveFromScoreboard (TcpTxItem const *item)
+{
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      if (IsInScoreboard (item, static_cast<Scoreboard> (i)))
+        {
+          m_scoreboard[i].erase (item->m_startSeq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::IndexItem (PacketList::iterator it)
+{
+  m_sentIndex[(*it)->m_startSeq] = it;
+  AddToScoreboard (*it);
+}
+
+void
+TcpTxBuffer::UnindexItem (TcpTxItem const *item)
+{
+  m_sentIndex.erase (item->m_startSeq);
+  RemoveFromScoreboard (item);
+}
+
+TcpTxItem *
+TcpTxBuffer::GetSentItem (const SequenceNumber32 &seq) const
+{
+  SentIndex::const_iterator pos = m_sentIndex.find (seq);
+  NS_ASSERT_MSG (pos != m_sentIndex.end (), "No sent item starts at " << seq);
+  return *pos->second;
+}
+
 bool
 TcpTxBuffer::IsRetransmittedDataAcked (const SequenceNumber32& ack) const
 {
   NS_LOG_FUNCTION (this);
-  for (const auto &it : m_sentList)
-     {
-       TcpTxItem *item = it;
-       Ptr<Packet> p = item->m_packet;
-       if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
-         {
-           return true;
-         }
-     }
-  return false;
+  // The only item which can end at ack is the last one starting before it
+  SentIndex::const_iterator pos = m_sentIndex.lower_bound (ack);
+  if (pos == m_sentIndex.begin ())
+    {
+      return false;
+    }
+  TcpTxItem *item = *(--pos)->second;
+  Ptr<Packet> p = item->m_packet;
+  return item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -708,6 +817,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
 
           RemoveFromCounts (item, pktSize);
 
+          UnindexItem (item);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -726,8 +836,10 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           pktSize -= offset;
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
+          UnindexItem (item);
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          IndexItem (i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -755,7 +867,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          RemoveFromScoreboard (head);
           head->m_sacked = false;
+          AddToScoreboard (head);
           m_sackedOut -= head->m_packet->GetSize ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
@@ -791,64 +905,26 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
-      while (item_it != m_sentList.end ())
+      // Check the boundary of the packets ... only mark as sacked if
+      // they are precisely mapped over the option. It means that if the receiver
+      // is reporting as sacked single range bytes that are not mapped 1:1
+      // in what we have, the option is discarded. There's room for improvement
+      // here. The items already sacked are skipped through the scoreboard.
+      const ScoreboardSet &notSacked = m_scoreboard[NOT_SACKED];
+      ScoreboardSet::const_iterator pos = notSacked.lower_bound ((*option_it).first);
+      while (pos != notSacked.end ())
         {
+          SequenceNumber32 beginOfCurrentPacket = *pos;
+          PacketList::iterator item_it = m_sentIndex.find (beginOfCurrentPacket)->second;
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
 
-          // Check the boundary of this packet ... only mark as sacked if
-          // it is precisely mapped over the option. It means that if the receiver
-          // is reporting as sacked single range bytes that are not mapped 1:1
-          // in what we have, the option is discarded. There's room for improvement
-          // here.
-          if (beginOfCurrentPacket >= (*option_it).first
-              && beginOfCurrentPacket + pktSize <= (*option_it).second)
-            {
-              if ((*item_it)->m_sacked)
-                {
-                  NS_ASSERT (!(*item_it)->m_lost);
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard already sacked");
-                }
-              else
-                {
-                  if ((*item_it)->m_lost)
-                    {
-                      (*item_it)->m_lost = false;
-                      m_lostOut -= (*item_it)->m_packet->GetSize ();
-                    }
-
-                  (*item_it)->m_sacked = true;
-                  m_sackedOut += (*item_it)->m_packet->GetSize ();
-                  bytesSacked += (*item_it)->m_packet->GetSize ();
-
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
-                    }
-
-                  NS_LOG_INFO ("Received block " << *option_it <<
-                               ", checking sentList for block " << *(*item_it) <<
-                               ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
-
-                  if (!sackedCb.IsNull ())
-                    {
-                      sackedCb (*item_it);
-                    }
-                }
-            }
-          else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+          if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
               // We already passed the received block end. Exit from the loop
               NS_LOG_INFO ("Received block [" << *option_it <<
@@ -857,8 +933,36 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
-          ++item_it;
+          // the item leaves the set when sacked
+          ++pos;
+
+          RemoveFromScoreboard (*item_it);
+          if ((*item_it)->m_lost)
+            {
+              (*item_it)->m_lost = false;
+              m_lostOut -= (*item_it)->m_packet->GetSize ();
+            }
+
+          (*item_it)->m_sacked = true;
+          AddToScoreboard (*item_it);
+          m_sackedOut += (*item_it)->m_packet->GetSize ();
+          bytesSacked += (*item_it)->m_packet->GetSize ();
+
+          if (m_highestSack.first == m_sentList.end()
+              || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+            {
+              m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+            }
+
+          NS_LOG_INFO ("Received block " << *option_it <<
+                       ", checking sentList for block " << *(*item_it) <<
+                       ", found in the sackboard, sacking, current highSack: " <<
+                       m_highestSack.second);
+
+          if (!sackedCb.IsNull ())
+            {
+              sackedCb (*item_it);
+            }
         }
     }
 
@@ -880,8 +984,6 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
-  uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -893,32 +995,33 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Find the m_dupAckThresh-th sacked item, counting down from the highest
+  // sack; the head is never counted
+  const ScoreboardSet &sacked = m_scoreboard[SACKED];
+  ScoreboardSet::const_iterator it = sacked.upper_bound (m_highestSack.second);
+  SequenceNumber32 limit = m_highestSack.second + 1;
+  uint32_t count = 0;
+  while (count < m_dupAckThresh && it != sacked.begin ())
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
+      if (*(--it) == m_firstByteSeq)
         {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
+          break;
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      limit = *it;
+      count++;
     }
 
-  if (sacked >= m_dupAckThresh)
+  if (count >= m_dupAckThresh)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
+      // All the items in flight before it are lost
+      const ScoreboardSet &inFlight = m_scoreboard[IN_FLIGHT];
+      while (!inFlight.empty () && *inFlight.begin () < limit)
         {
+          TcpTxItem *item = GetSentItem (*inFlight.begin ());
+          RemoveFromScoreboard (item);
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          AddToScoreboard (item);
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -930,37 +1033,25 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first item from seq which is lost or sacked decides
+  ScoreboardSet::const_iterator lost = m_scoreboard[LOST].lower_bound (seq);
+  ScoreboardSet::const_iterator sacked = m_scoreboard[SACKED].lower_bound (seq);
+  if (lost != m_scoreboard[LOST].end ()
+      && (sacked == m_scoreboard[SACKED].end () || *lost <= *sacked))
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
-
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+      return true;
     }
 
+  if (sacked != m_scoreboard[SACKED].end ())
+    {
+      NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+    }
   return false;
 }
 
@@ -982,36 +1073,25 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Condition 1.a , 1.b , and 1.c
+  const ScoreboardSet &toRetrans = m_scoreboard[TO_RETRANS];
+  if (!toRetrans.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              *seqHigh = *seq + m_segmentSize;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
+      NS_LOG_INFO("IsLost, returning" << *toRetrans.begin ());
+      *seq = *toRetrans.begin ();
+      *seqHigh = *seq + m_segmentSize;
+      return true;
+    }
 
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+  const ScoreboardSet &notRetrans = m_scoreboard[NOT_RETRANS];
+  if (isRecovery && !notRetrans.empty ())
+    {
+      NS_LOG_INFO ("Saving for rule 3 the seq " << *notRetrans.begin ());
+      isSeqPerRule3Valid = true;
+      seqPerRule3 = *notRetrans.begin ();
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1219,9 +1299,14 @@ TcpTxBuffer::ResetRenoSack ()
   NS_LOG_FUNCTION (this);
 
   m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  std::vector<SequenceNumber32> sacked (m_scoreboard[SACKED].begin (),
+                                        m_scoreboard[SACKED].end ());
+  for (auto it = sacked.begin (); it != sacked.end (); ++it)
     {
-      (*it)->m_sacked = false;
+      TcpTxItem *item = GetSentItem (*it);
+      RemoveFromScoreboard (item);
+      item->m_sacked = false;
+      AddToScoreboard (item);
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
@@ -1249,6 +1334,12 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      m_scoreboard[i].clear ();
+    }
+
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1264,6 +1355,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      UnindexItem (item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1292,6 +1384,11 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       m_lostOut = 0;
     }
 
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      m_scoreboard[i].clear ();
+    }
+
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
       if (resetSack)
@@ -1315,6 +1412,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
         }
 
       (*it)->m_retrans = false;
+      AddToScoreboard (*it);
     }
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
@@ -1347,8 +1445,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      RemoveFromScoreboard (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1358,6 +1458,8 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      RemoveFromScoreboard (m_sentList.front ());
+
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1378,6 +1480,8 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1398,19 +1502,17 @@ TcpTxBuffer::AddRenoSack (void)
 
   m_renoSack = true;
 
-  // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
-
-  // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
-    {
-      ++it;
-    }
+  // We can _never_ SACK the head, so start from the second segment sent,
+  // and find the "highest sacked" point, that is SND.UNA + m_sackedOut
+  ScoreboardSet::const_iterator pos = m_scoreboard[NOT_SACKED].upper_bound (m_firstByteSeq);
 
   // Add to the sacked size the size of the first "not sacked" segment
-  if (it != m_sentList.end ())
+  if (pos != m_scoreboard[NOT_SACKED].end ())
     {
+      PacketList::iterator it = m_sentIndex.find (*pos)->second;
+      RemoveFromScoreboard (*it);
       (*it)->m_sacked = true;
+      AddToScoreboard (*it);
       m_sackedOut += (*it)->m_packet->GetSize ();
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
@@ -1460,6 +1562,29 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Sent index out of sync");
+  uint32_t count[SCOREBOARD_SETS] = {};
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      SentIndex::const_iterator pos = m_sentIndex.find ((*it)->m_startSeq);
+      NS_ASSERT_MSG (pos != m_sentIndex.end () && pos->second == it,
+                     "Item " << **it << " not indexed");
+      for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+        {
+          if (IsInScoreboard (*it, static_cast<Scoreboard> (i)))
+            {
+              NS_ASSERT_MSG (m_scoreboard[i].count ((*it)->m_startSeq) == 1,
+                             "Item " << **it << " missing from scoreboard set " << i);
+              count[i]++;
+            }
+        }
+    }
+  for (uint32_t i = 0; i < SCOREBOARD_SETS; i++)
+    {
+      NS_ASSERT_MSG (count[i] == m_scoreboard[i].size (),
+                     "Stale items in scoreboard set " << i);
+    }
 }
 
 std::ostream &
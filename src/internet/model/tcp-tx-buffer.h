@@ -22,6 +22,8 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <map>
+#include <set>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -70,8 +72,18 @@ class Packet;
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding
+ * the segments sent covered by a SACK block and setting their SACK flag.
+ *
+ * With large windows, the sent list holds tens of thousands of items, and
+ * walking it for each SACK block, lost detection or retransmission would
+ * make SACK processing quadratic in the window. The sent items are
+ * therefore indexed by their first sequence number, and the scoreboard
+ * keeps, for each combination of flags looked for (e.g., lost but neither
+ * sacked nor retransmitted), the ordered set of the items having it. All
+ * the per-ACK operations (Update, UpdateLostCount, IsLost, NextSeg,
+ * AddRenoSack) then cost O(log n) per item whose flags change, instead of
+ * O(n).
  *
  * Item properties
  * ---------------
@@ -411,12 +423,72 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex; //!< index of the sent list by sequence
+  typedef std::set<SequenceNumber32> ScoreboardSet; //!< first sequence numbers of sent items
+
+  /**
+   * \brief Sets of sent items kept by the scoreboard, by the flags of the items
+   */
+  enum Scoreboard
+  {
+    SACKED = 0,   //!< Sacked items
+    LOST,         //!< Lost items
+    IN_FLIGHT,    //!< Items neither sacked nor lost
+    NOT_SACKED,   //!< Items not sacked
+    NOT_RETRANS,  //!< Items neither sacked nor retransmitted
+    TO_RETRANS,   //!< Lost items neither sacked nor retransmitted
+    SCOREBOARD_SETS //!< Number of sets
+  };
+
+  /**
+   * \param item an item
+   * \param set a scoreboard set
+   * \return true if the flags of the item place it in the set
+   */
+  static bool IsInScoreboard (TcpTxItem const *item, Scoreboard set);
+
+  /**
+   * \brief Add a sent item to the scoreboard sets matching its flags
+   *
+   * To be called after changing the flags of a sent item.
+   * \param item the item
+   */
+  void AddToScoreboard (TcpTxItem const *item);
+
+  /**
+   * \brief Remove a sent item from the scoreboard sets
+   *
+   * To be called before changing the flags of a sent item.
+   * \param item the item
+   */
+  void RemoveFromScoreboard (TcpTxItem const *item);
+
+  /**
+   * \brief Index an item of the sent list, by sequence and in the scoreboard
+   * \param it the item in the sent list
+   */
+  void IndexItem (PacketList::iterator it);
+
+  /**
+   * \brief Remove an item from the indexes of the sent list
+   *
+   * To be called before removing the item or changing its first sequence number.
+   * \param item the item
+   */
+  void UnindexItem (TcpTxItem const *item);
+
+  /**
+   * \param seq the first sequence number of a sent item
+   * \return the item
+   */
+  TcpTxItem *GetSentItem (const SequenceNumber32 &seq) const;
 
   /**
    * \brief Update the lost count
    *
-   * Reset lost to 0, then walk the sent list looking for lost segments.
-   * We have two possible algorithms for detecting lost packets:
+   * Mark as lost the segments, neither sacked nor lost yet, which are
+   * followed by "Dupack thresh" sacked segments. We have two possible
+   * algorithms for detecting lost packets:
    *
    * - RFC 6675 algorithm, which says that if more than "Dupack thresh" (e.g., 3)
    * sacked segments above the sequence, then we can consider the sequence lost;
@@ -427,9 +499,9 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
-   *
+   * and updates the lost count. It finds the "Dupack thresh"-th highest
+   * sacked segment and the segments in flight before it in the scoreboard,
+   * so each segment is visited once when it is marked as lost.
    */
   void UpdateLostCount ();
 
@@ -561,7 +633,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -602,6 +674,8 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentIndex m_sentIndex; //!< Items of the sent list, by first sequence number
+  ScoreboardSet m_scoreboard[SCOREBOARD_SETS]; //!< Sent items, by flags
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
@@ -20,6 +20,7 @@
 
 #include "udp-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/header-image.h"
 
 namespace ns3 {
 
@@ -185,35 +186,34 @@ UdpHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
-  i.WriteHtonU16 (m_sourcePort);
-  i.WriteHtonU16 (m_destinationPort);
+  // Byte image of the header, with a zero checksum
+  static const uint8_t image[8] = { 0 };
+  uint8_t *data = i.WriteImage (image, sizeof (image));
+
+  HeaderImage::WriteHtonU16 (data, m_sourcePort);
+  HeaderImage::WriteHtonU16 (data + 2, m_destinationPort);
   if (m_payloadSize == 0)
     {
-      i.WriteHtonU16 (start.GetSize ());
+      HeaderImage::WriteHtonU16 (data + 4, start.GetSize ());
     }
   else
     {
-      i.WriteHtonU16 (m_payloadSize);
+      HeaderImage::WriteHtonU16 (data + 4, m_payloadSize);
     }
 
   if ( m_checksum == 0)
     {
-      i.WriteU16 (0);
-
       if (m_calcChecksum)
         {
           uint16_t headerChecksum = CalculateHeaderChecksum (start.GetSize ());
           i = start;
           uint16_t checksum = i.CalculateIpChecksum (start.GetSize (), headerChecksum);
-
-          i = start;
-          i.Next (6);
-          i.WriteU16 (checksum);
+          HeaderImage::WriteU16 (data + 6, checksum);
         }
     }
   else
     {
-      i.WriteU16 (m_checksum);
+      HeaderImage::WriteU16 (data + 6, m_checksum);
     }
 }
 uint32_t
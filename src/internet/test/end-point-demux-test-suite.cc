@@ -0,0 +1,335 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/ipv6-interface.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Types of the IPv4 end point demux
+ */
+struct Ipv4DemuxTypes
+{
+  typedef Ipv4EndPointDemux Demux;      //!< Demux
+  typedef Ipv4EndPoint EndPoint;        //!< End point
+  typedef Ipv4Address Address;          //!< Address
+  typedef Ipv4Interface Interface;      //!< Interface
+
+  /**
+   * \param i an index
+   * \returns the i-th address of the test
+   */
+  static Address GetAddress (uint32_t i)
+  {
+    return Ipv4Address (0x0a000001 + i);
+  }
+  /**
+   * \param demux the demux
+   * \returns the end points of the demux
+   */
+  static Demux::EndPoints GetEndPoints (Demux &demux)
+  {
+    return demux.GetAllEndPoints ();
+  }
+};
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Types of the IPv6 end point demux
+ */
+struct Ipv6DemuxTypes
+{
+  typedef Ipv6EndPointDemux Demux;      //!< Demux
+  typedef Ipv6EndPoint EndPoint;        //!< End point
+  typedef Ipv6Address Address;          //!< Address
+  typedef Ipv6Interface Interface;      //!< Interface
+
+  /**
+   * \param i an index
+   * \returns the i-th address of the test
+   */
+  static Address GetAddress (uint32_t i)
+  {
+    uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+    buf[14] = (i + 1) >> 8;
+    buf[15] = (i + 1) & 0xff;
+    return Ipv6Address (buf);
+  }
+  /**
+   * \param demux the demux
+   * \returns the end points of the demux
+   */
+  static Demux::EndPoints GetEndPoints (Demux &demux)
+  {
+    return demux.GetEndPoints ();
+  }
+};
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux test
+ *
+ * Allocates, connects, disables and deallocates random end points, and
+ * checks the lookups against a scan of all the end points.
+ *
+ * \tparam T the types of the demux
+ */
+template <typename T>
+class EndPointDemuxTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the test
+   */
+  EndPointDemuxTestCase (std::string name);
+
+private:
+  virtual void DoRun (void);
+
+  typedef typename T::EndPoint EndPoint;  //!< End point
+  typedef typename T::Address Address;    //!< Address
+
+  /**
+   * \brief Look up the end point for a packet with a scan of all the end
+   * points, as a reference for Lookup.
+   *
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \returns the matching end point, or 0
+   */
+  EndPoint *ReferenceLookup (Address daddr, uint16_t dport, Address saddr, uint16_t sport);
+
+  /**
+   * \brief Check the lookups for a packet
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   */
+  void Check (Address daddr, uint16_t dport, Address saddr, uint16_t sport);
+
+  /**
+   * \returns a random address of the test
+   */
+  Address RandomAddress (void);
+
+  typename T::Demux m_demux;           //!< Demux under test
+  Ptr<typename T::Interface> m_interface; //!< Incoming interface
+  Ptr<UniformRandomVariable> m_rng;    //!< Random number generator
+};
+
+template <typename T>
+EndPointDemuxTestCase<T>::EndPointDemuxTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+template <typename T>
+typename T::Address
+EndPointDemuxTestCase<T>::RandomAddress (void)
+{
+  return T::GetAddress (m_rng->GetInteger (0, 7));
+}
+
+template <typename T>
+typename T::EndPoint *
+EndPointDemuxTestCase<T>::ReferenceLookup (Address daddr, uint16_t dport, Address saddr, uint16_t sport)
+{
+  // the most exact match: all four fields, all but the local address,
+  // the local port and address, and the local port only
+  EndPoint *found[4] = { 0, 0, 0, 0 };
+  typename T::Demux::EndPoints endPoints = T::GetEndPoints (m_demux);
+  for (typename T::Demux::EndPointsI i = endPoints.begin (); i != endPoints.end (); i++)
+    {
+      EndPoint *endPoint = *i;
+      if (!endPoint->IsRxEnabled () || endPoint->GetLocalPort () != dport)
+        {
+          continue;
+        }
+      bool localExact = endPoint->GetLocalAddress () == daddr;
+      bool localAny = endPoint->GetLocalAddress () == Address::GetAny ();
+      bool peerExact = endPoint->GetPeerAddress () == saddr && endPoint->GetPeerPort () == sport;
+      bool peerAny = endPoint->GetPeerAddress () == Address::GetAny () && endPoint->GetPeerPort () == 0;
+      if (localExact && peerExact)
+        {
+          found[0] = endPoint;
+        }
+      if (localAny && peerExact)
+        {
+          found[1] = endPoint;
+        }
+      if (localExact && peerAny)
+        {
+          found[2] = endPoint;
+        }
+      if (localAny && peerAny)
+        {
+          found[3] = endPoint;
+        }
+    }
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      if (found[i] != 0)
+        {
+          return found[i];
+        }
+    }
+  return 0;
+}
+
+template <typename T>
+void
+EndPointDemuxTestCase<T>::Check (Address daddr, uint16_t dport, Address saddr, uint16_t sport)
+{
+  EndPoint *expected = ReferenceLookup (daddr, dport, saddr, sport);
+  typename T::Demux::EndPoints endPoints = m_demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), (expected != 0 ? 1 : 0),
+                         "Wrong number of end points for " << daddr << ":" << dport << " from " << saddr << ":" << sport);
+  if (expected != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), expected,
+                             "Wrong end point for " << daddr << ":" << dport << " from " << saddr << ":" << sport);
+    }
+}
+
+template <typename T>
+void
+EndPointDemuxTestCase<T>::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+  m_interface = CreateObject<typename T::Interface> ();
+
+  std::vector<EndPoint *> endPoints;
+  for (uint32_t step = 0; step < 3000; step++)
+    {
+      uint32_t action = m_rng->GetInteger (0, 9);
+      EndPoint *endPoint = 0;
+      if (action < 2)
+        {
+          // a listener, on any or a given address
+          Address local = m_rng->GetInteger (0, 1) ? Address::GetAny () : RandomAddress ();
+          endPoint = m_demux.Allocate (0, local, m_rng->GetInteger (1, 8));
+        }
+      else if (action < 5)
+        {
+          // a connected end point
+          Address local = m_rng->GetInteger (0, 3) ? RandomAddress () : Address::GetAny ();
+          endPoint = m_demux.Allocate (0, local, m_rng->GetInteger (1, 8),
+                                       RandomAddress (), m_rng->GetInteger (1000, 1010));
+        }
+      else if (action < 6)
+        {
+          // an ephemeral end point, connected later
+          endPoint = m_demux.Allocate (RandomAddress ());
+          endPoint->SetPeer (RandomAddress (), m_rng->GetInteger (1000, 1010));
+        }
+      else if (action < 7 && !endPoints.empty ())
+        {
+          // disable or reconnect an end point
+          EndPoint *other = endPoints[m_rng->GetInteger (0, endPoints.size () - 1)];
+          if (m_rng->GetInteger (0, 1))
+            {
+              other->SetRxEnabled (!other->IsRxEnabled ());
+            }
+          else if (other->GetLocalPort () >= 49152)
+            {
+              other->SetPeer (RandomAddress (), m_rng->GetInteger (1000, 1010));
+            }
+        }
+      else if (action < 9 && !endPoints.empty ())
+        {
+          uint32_t index = m_rng->GetInteger (0, endPoints.size () - 1);
+          m_demux.DeAllocate (endPoints[index]);
+          endPoints.erase (endPoints.begin () + index);
+        }
+      if (endPoint != 0)
+        {
+          endPoints.push_back (endPoint);
+        }
+
+      // lookups of existing and random four-tuples
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          uint16_t dport = m_rng->GetInteger (1, 8);
+          Address daddr = RandomAddress ();
+          Address saddr = RandomAddress ();
+          uint16_t sport = m_rng->GetInteger (1000, 1010);
+          if (!endPoints.empty () && m_rng->GetInteger (0, 1))
+            {
+              EndPoint *other = endPoints[m_rng->GetInteger (0, endPoints.size () - 1)];
+              dport = other->GetLocalPort ();
+              if (other->GetLocalAddress () != Address::GetAny ())
+                {
+                  daddr = other->GetLocalAddress ();
+                }
+              if (other->GetPeerPort () != 0)
+                {
+                  saddr = other->GetPeerAddress ();
+                  sport = other->GetPeerPort ();
+                }
+            }
+          Check (daddr, dport, saddr, sport);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (T::GetEndPoints (m_demux).size (), endPoints.size (), "Wrong number of end points");
+  for (uint32_t i = 0; i < endPoints.size (); i++)
+    {
+      m_demux.DeAllocate (endPoints[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_demux.LookupPortLocal (1), false, "End point left after deallocation");
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief End point demux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new EndPointDemuxTestCase<Ipv4DemuxTypes> ("Check the lookups of Ipv4EndPointDemux"), TestCase::QUICK);
+  AddTestCase (new EndPointDemuxTestCase<Ipv6DemuxTypes> ("Check the lookups of Ipv6EndPointDemux"), TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite endPointDemuxTestSuite; //!< Static variable for test initialization
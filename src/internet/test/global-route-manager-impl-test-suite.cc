@@ -27,6 +27,7 @@
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
 #include <cstdlib> // for rand()
+#include <vector>
 
 using namespace ns3;
 
@@ -65,13 +66,34 @@ GlobalRouteManagerImplTestCase::DoRun (void)
       candidate.Push (v);
     }
 
+  uint32_t lastDistance = 0;
   for (int i = 0; i < 100; ++i)
     {
       SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ ((v->GetDistanceFromRoot () >= lastDistance), true,
+                             "CandidateQueue popped a farther vertex first");
+      lastDistance = v->GetDistanceFromRoot ();
       delete v;
       v = 0;
     }
 
+  // A vertex moved closer to the root by Reorder pops first
+  std::vector<SPFVertex *> vertices;
+  for (int i = 0; i < 10; ++i)
+    {
+      SPFVertex *v = new SPFVertex;
+      v->SetDistanceFromRoot (10 + i);
+      candidate.Push (v);
+      vertices.push_back (v);
+    }
+  vertices[7]->SetDistanceFromRoot (5);
+  candidate.Reorder (vertices[7]);
+  NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), vertices[7], "Reordered vertex not popped first");
+  NS_TEST_ASSERT_MSG_EQ (candidate.Pop (), vertices[0], "Wrong vertex popped after the reordered one");
+  delete vertices[7];
+  delete vertices[0];
+  candidate.Clear ();
+
   // Build fake link state database; four routers (0-3), 3 point-to-point
   // links
   //
@@ -0,0 +1,162 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-helper.h"
+#include "ns3/binary-trace-file.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the IPv4 ascii trace sinks of the InternetStackHelper
+ * record their events in a binary trace stream.
+ */
+class InternetStackBinaryTraceTestCase : public TestCase
+{
+public:
+  InternetStackBinaryTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Trace a UDP exchange between two nodes
+   * \param stream the trace stream
+   */
+  void RunScenario (Ptr<OutputStreamWrapper> stream);
+  /**
+   * Read a whole file
+   * \param filename the file name
+   * \returns the contents of the file
+   */
+  static std::string ReadFile (std::string filename);
+  /**
+   * Send a datagram
+   * \param socket the sending socket
+   * \param to the destination
+   */
+  static void Send (Ptr<Socket> socket, Address to);
+};
+
+InternetStackBinaryTraceTestCase::InternetStackBinaryTraceTestCase ()
+  : TestCase ("Check the IPv4 ascii trace sinks with a binary trace stream")
+{
+}
+
+void
+InternetStackBinaryTraceTestCase::Send (Ptr<Socket> socket, Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, to);
+}
+
+std::string
+InternetStackBinaryTraceTestCase::ReadFile (std::string filename)
+{
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  std::ostringstream contents;
+  contents << in.rdbuf ();
+  return contents.str ();
+}
+
+void
+InternetStackBinaryTraceTestCase::RunScenario (Ptr<OutputStreamWrapper> stream)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper devicesHelper;
+  NetDeviceContainer devices = devicesHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = addresses.Assign (devices);
+  // no ARP exchange, whose random jitter would differ between both runs
+  NeighborCacheHelper ().PopulateNeighborCache (interfaces);
+  internet.EnableAsciiIpv4 (stream, nodes);
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  sender->Bind ();
+  Address to = InetSocketAddress (interfaces.GetAddress (1), 1234);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Simulator::Schedule (MilliSeconds (1 + i), &InternetStackBinaryTraceTestCase::Send, sender, to);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+InternetStackBinaryTraceTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  // The InternetStackHelper keeps the streams until the program exits, so
+  // they must own their files rather than refer to local streams
+  std::string asciiFilename = CreateTempDirFilename ("internet-stack.tr");
+  std::string binaryFilename = CreateTempDirFilename ("internet-stack.bin");
+  AsciiTraceHelper ascii;
+  Ptr<OutputStreamWrapper> asciiStream = ascii.CreateFileStream (asciiFilename);
+  RunScenario (asciiStream);
+  asciiStream->GetStream ()->flush ();
+  // the pending events are written at Simulator::Destroy
+  RunScenario (ascii.CreateBinaryFileStream (binaryFilename, BinaryTrace::FULL_PACKET));
+
+  std::string asciiTrace = ReadFile (asciiFilename);
+  NS_TEST_ASSERT_MSG_NE (asciiTrace.find ("\nt "), std::string::npos, "No transmit event traced");
+  NS_TEST_ASSERT_MSG_NE (asciiTrace.find ("\nr "), std::string::npos, "No receive event traced");
+  std::ifstream binary (binaryFilename.c_str (), std::ios::binary);
+  std::ostringstream converted;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceReader::ConvertToAscii (binary, converted), true, "Not a binary trace");
+  NS_TEST_EXPECT_MSG_EQ (converted.str (), asciiTrace, "Converted trace differs from the ascii trace");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief InternetStackHelper binary trace TestSuite
+ */
+class InternetStackBinaryTraceTestSuite : public TestSuite
+{
+public:
+  InternetStackBinaryTraceTestSuite ();
+};
+
+InternetStackBinaryTraceTestSuite::InternetStackBinaryTraceTestSuite ()
+  : TestSuite ("internet-stack-binary-trace", UNIT)
+{
+  AddTestCase (new InternetStackBinaryTraceTestCase, TestCase::QUICK);
+}
+
+static InternetStackBinaryTraceTestSuite g_internetStackBinaryTraceTestSuite; //!< Static variable for test initialization
@@ -110,6 +110,7 @@ class Ipv4FragmentationTest: public TestCase
   uint32_t m_size;        //!< packet size.
   uint8_t m_icmpType;     //!< ICMP type.
   bool m_broadcast;       //!< broadcast packets
+  uint32_t m_bufferFullDrops; //!< Packets dropped because the reassembly buffer is full.
 
 public:
   virtual void DoRun (void);
@@ -156,6 +157,17 @@ public:
   void HandleReadIcmpClient (Ipv4Address icmpSource, uint8_t icmpTtl, uint8_t icmpType,
                              uint8_t icmpCode, uint32_t icmpInfo);
 
+  /**
+   * \brief Handle packets dropped by the server.
+   * \param ipHeader The IP header.
+   * \param packet The packet.
+   * \param reason The drop reason.
+   * \param ipv4 The IPv4 stack.
+   * \param interface The interface.
+   */
+  void HandleDropServer (const Ipv4Header &ipHeader, Ptr<const Packet> packet,
+                         Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface);
+
   /**
    * \brief Set the packet fill.
    * \param fill The fill.
@@ -182,6 +194,7 @@ Ipv4FragmentationTest::Ipv4FragmentationTest (bool broadcast)
   m_size = 0;
   m_icmpType = 0;
   m_broadcast = broadcast;
+  m_bufferFullDrops = 0;
 }
 
 Ipv4FragmentationTest::~Ipv4FragmentationTest ()
@@ -270,6 +283,16 @@ Ipv4FragmentationTest::HandleReadIcmpClient (Ipv4Address icmpSource,
   m_icmpType = icmpType;
 }
 
+void
+Ipv4FragmentationTest::HandleDropServer (const Ipv4Header &ipHeader, Ptr<const Packet> packet,
+                                         Ipv4L3Protocol::DropReason reason, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  if (reason == Ipv4L3Protocol::DROP_FRAGMENT_BUFFER_FULL)
+    {
+      m_bufferFullDrops++;
+    }
+}
+
 void
 Ipv4FragmentationTest::SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize)
 {
@@ -526,6 +549,36 @@ Ipv4FragmentationTest::DoRun (void)
       NS_TEST_EXPECT_MSG_EQ (end, m_receivedPacketServer->GetSize (), "trivial");
     }
 
+  // Fifth test: normal channel, no errors, no delays, small reassembly buffer.
+  // The packets larger than the buffer are dropped while they are reassembled,
+  // the others are received.
+  Ptr<Ipv4L3Protocol> serverIpv4 = serverNode->GetObject<Ipv4L3Protocol> ();
+  serverIpv4->SetAttribute ("FragmentReassemblyBufferSize", UintegerValue (8000));
+  serverIpv4->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv4FragmentationTest::HandleDropServer, this));
+  for (int i= 0; i<5; i++)
+    {
+      uint32_t packetSize = packetSizes[i];
+
+      SetFill (fillData, 78, packetSize);
+
+      m_receivedPacketServer = Create<Packet> ();
+      m_bufferFullDrops = 0;
+      Simulator::ScheduleWithContext (m_socketClient->GetNode ()->GetId (), Seconds (0),
+                                      &Ipv4FragmentationTest::SendClient, this);
+      Simulator::Run ();
+
+      if (packetSize < 8000)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_receivedPacketServer->GetSize (), packetSize, "Packet size not correct");
+          NS_TEST_EXPECT_MSG_EQ (m_bufferFullDrops, 0, "Unexpected drop");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_receivedPacketServer->GetSize (), 0, "Server got a packet larger than the buffer");
+          NS_TEST_EXPECT_MSG_GT (m_bufferFullDrops, 0, "No drop for a full buffer");
+        }
+    }
+
 
   Simulator::Destroy ();
 }
@@ -15,8 +15,11 @@
  */
 
 #include <vector>
+#include <sstream>
+#include <algorithm>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/enum.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -42,6 +45,9 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -1244,6 +1250,416 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental and parallel recomputation test
+ *
+ * Randomly changes the interfaces of a mesh of routers, and of a disconnected
+ * component with a LAN, and checks that the routes updated by
+ * RecomputeRoutingTables, and the routes computed in several threads, are
+ * the routes computed from scratch.
+ */
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \returns the global routes of the nodes, one string per node
+   */
+  std::vector<std::string> GetRoutes (void) const;
+
+  /**
+   * \brief Delete the routes and compute them from scratch
+   * \param threads the number of threads computing the routes
+   */
+  static void ComputeRoutes (uint32_t threads);
+
+  /**
+   * The metrics of the mesh give equal cost paths.  The SPF calculation
+   * does not support equal cost paths to a LAN, so the metrics of the
+   * component with the LAN are all distinct.
+   *
+   * \param node the index of a node
+   * \returns a random metric for an interface of the node
+   */
+  uint16_t GetMetric (uint32_t node);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+  Ptr<UniformRandomVariable> m_rng; //!< Random number generator
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Incremental and parallel global route computation")
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingIncrementalTestCase::GetRoutes (void) const
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = m_nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          oss << *globalRouting->GetRoute (j) << "\n";
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+uint16_t
+Ipv4GlobalRoutingIncrementalTestCase::GetMetric (uint32_t node)
+{
+  if (node < 24)
+    {
+      return m_rng->GetInteger (1, 2);
+    }
+  return m_rng->GetInteger (1, 10000);
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::ComputeRoutes (uint32_t threads)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // a mesh of 24 routers, and a chain of 6 routers not connected to it
+  uint32_t nMesh = 24;
+  m_rng = rng;
+  m_nodes.Create (nMesh + 6);
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  for (uint32_t i = 0; i < nMesh; i++)
+    {
+      links.push_back (std::make_pair (i, (i + 1) % nMesh));
+    }
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      uint32_t a = rng->GetInteger (0, nMesh - 1);
+      uint32_t b = (a + rng->GetInteger (2, nMesh - 2)) % nMesh;
+      links.push_back (std::make_pair (a, b));
+    }
+  for (uint32_t i = nMesh; i + 1 < m_nodes.GetN (); i++)
+    {
+      links.push_back (std::make_pair (i, i + 1));
+    }
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      NodeContainer pair (m_nodes.Get (links[i].first), m_nodes.Get (links[i].second));
+      ipv4.Assign (simpleHelper.Install (pair, CreateObject<SimpleChannel> ()));
+      ipv4.NewNetwork ();
+    }
+  // a LAN between three routers of the chain
+  SimpleNetDeviceHelper lanHelper;
+  NodeContainer lan (m_nodes.Get (nMesh), m_nodes.Get (nMesh + 3), m_nodes.Get (nMesh + 5));
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lanHelper.Install (lan, CreateObject<SimpleChannel> ()));
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = m_nodes.Get (i)->GetObject<Ipv4> ();
+      for (uint32_t j = 1; j < ip->GetNInterfaces (); j++)
+        {
+          ip->SetMetric (j, GetMetric (i));
+        }
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::string> routes = GetRoutes ();
+  ComputeRoutes (4);
+  NS_TEST_ASSERT_MSG_EQ ((GetRoutes () == routes), true, "Routes computed in parallel differ");
+
+  for (uint32_t step = 0; step < 20; step++)
+    {
+      uint32_t changes = rng->GetInteger (1, 3);
+      for (uint32_t k = 0; k < changes; k++)
+        {
+          uint32_t i = rng->GetInteger (0, m_nodes.GetN () - 1);
+          Ptr<Ipv4> ip = m_nodes.Get (i)->GetObject<Ipv4> ();
+          uint32_t j = rng->GetInteger (1, ip->GetNInterfaces () - 1);
+          if (rng->GetInteger (0, 3) == 0)
+            {
+              ip->SetMetric (j, GetMetric (i));
+            }
+          else if (ip->IsUp (j))
+            {
+              ip->SetDown (j);
+            }
+          else
+            {
+              ip->SetUp (j);
+            }
+        }
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      routes = GetRoutes ();
+      ComputeRoutes (1);
+      NS_TEST_ASSERT_MSG_EQ ((GetRoutes () == routes), true, "Routes updated at step " << step << " differ");
+      ComputeRoutes (4);
+      NS_TEST_ASSERT_MSG_EQ ((GetRoutes () == routes), true, "Routes computed in parallel at step " << step << " differ");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Count the packets forwarded by a node
+ * \param count the counter
+ * \param header the IPv4 header of the packet
+ * \param packet the packet
+ * \param interface the input interface
+ */
+static void
+CountForwarded (uint32_t *count, const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  (*count)++;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the first route, flow hash, weighted and flowlet ECMP routing.
+ *
+ * The source, or r0 itself, sends UDP flows to the sink across three
+ * equal-cost paths:
+ *
+ *               m0
+ *             /    \
+ *   src --- r0 - m1 - r1 --- sink
+ *             \    /
+ *               m2
+ */
+class Ipv4GlobalRoutingEcmpTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param mode the ECMP mode of the routers
+   */
+  Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::EcmpMode mode);
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Send a packet
+   * \param socket the socket of the flow
+   */
+  void SendPacket (Ptr<Socket> socket);
+
+  /**
+   * \returns the number of packets routed through each path by r0
+   */
+  std::vector<uint64_t> GetSelections (void) const;
+
+  /**
+   * \brief Send packets on some flows, and run the simulation
+   * \param flows the number of flows
+   * \param packets the number of packets per flow
+   * \param interval the time between the packets of a flow
+   * \param source the index of the node sending the flows
+   * \returns the number of packets routed through each path by r0 meanwhile
+   */
+  std::vector<uint64_t> Send (uint32_t flows, uint32_t packets, Time interval, uint32_t source = 0);
+
+  Ipv4GlobalRouting::EcmpMode m_mode;  //!< ECMP mode
+  NodeContainer m_nodes;                //!< Nodes used in the test
+  NetDeviceContainer m_paths;           //!< Devices of r0 towards the three paths
+  Ipv4Address m_sink;                   //!< Address of the sink
+};
+
+Ipv4GlobalRoutingEcmpTestCase::Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::EcmpMode mode)
+  : TestCase (mode == Ipv4GlobalRouting::ECMP_FIRST ? "First route ECMP routing"
+              : mode == Ipv4GlobalRouting::ECMP_FLOW_HASH ? "Flow hash ECMP routing" : "Flowlet ECMP routing"),
+    m_mode (mode)
+{
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::SendPacket (Ptr<Socket> socket)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (m_sink, 1234));
+}
+
+std::vector<uint64_t>
+Ipv4GlobalRoutingEcmpTestCase::GetSelections (void) const
+{
+  std::vector<uint64_t> selections;
+  for (uint32_t i = 0; i < m_paths.GetN (); i++)
+    {
+      selections.push_back (Ipv4GlobalRoutingHelper::GetEcmpSelections (m_paths.Get (i)));
+    }
+  return selections;
+}
+
+std::vector<uint64_t>
+Ipv4GlobalRoutingEcmpTestCase::Send (uint32_t flows, uint32_t packets, Time interval, uint32_t source)
+{
+  std::vector<uint64_t> before = GetSelections ();
+  for (uint32_t i = 0; i < flows; i++)
+    {
+      Ptr<Socket> socket = m_nodes.Get (source)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+      socket->Bind ();
+      for (uint32_t j = 0; j < packets; j++)
+        {
+          Simulator::Schedule (interval * j, &Ipv4GlobalRoutingEcmpTestCase::SendPacket, this, socket);
+        }
+    }
+  Simulator::Run ();
+  std::vector<uint64_t> selections = GetSelections ();
+  for (uint32_t i = 0; i < selections.size (); i++)
+    {
+      selections[i] -= before[i];
+    }
+  return selections;
+}
+
+void
+Ipv4GlobalRoutingEcmpTestCase::DoRun (void)
+{
+  // src, r0, m0, m1, m2, r1, sink
+  m_nodes.Create (7);
+  Ipv4GlobalRoutingHelper globalRouting;
+  globalRouting.Set ("EcmpMode", EnumValue (m_mode));
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.SetRoutingHelper (globalRouting);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  std::vector<std::pair<uint32_t, uint32_t> > links;
+  links.push_back (std::make_pair (0, 1));
+  for (uint32_t i = 2; i < 5; i++)
+    {
+      links.push_back (std::make_pair (1, i));
+      links.push_back (std::make_pair (i, 5));
+    }
+  links.push_back (std::make_pair (5, 6));
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      NodeContainer pair (m_nodes.Get (links[i].first), m_nodes.Get (links[i].second));
+      NetDeviceContainer devices = simpleHelper.Install (pair);
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      if (links[i].first == 1)
+        {
+          m_paths.Add (devices.Get (0));
+        }
+      m_sink = interfaces.GetAddress (1);
+    }
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  Ptr<Socket> sink = m_nodes.Get (6)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+
+  Ptr<Ipv4GlobalRouting> r0 = m_nodes.Get (1)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+  std::vector<uint64_t> selections;
+  if (m_mode == Ipv4GlobalRouting::ECMP_FIRST)
+    {
+      NS_TEST_EXPECT_MSG_GT (r0->GetRouteInputVersion (), 0, "The first routes can be cached");
+
+      // count the packets forwarded by m0, m1 and m2
+      std::vector<uint32_t> forwarded (3, 0);
+      for (uint32_t i = 0; i < forwarded.size (); i++)
+        {
+          m_nodes.Get (2 + i)->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+            "UnicastForward", MakeBoundCallback (&CountForwarded, &forwarded[i]));
+        }
+
+      // all the packets follow the first route
+      Send (10, 1, MilliSeconds (1));
+      uint32_t first = std::max_element (forwarded.begin (), forwarded.end ()) - forwarded.begin ();
+      NS_TEST_EXPECT_MSG_EQ (forwarded[first], 10, "A single path for all the flows");
+
+      // until its weight is 0, even if the route is cached by r0
+      Ipv4GlobalRoutingHelper::SetEcmpWeight (m_paths.Get (first), 0);
+      Send (10, 1, MilliSeconds (1));
+      NS_TEST_EXPECT_MSG_EQ (forwarded[first], 10, "A path of weight 0 is not used");
+      NS_TEST_EXPECT_MSG_EQ (*std::max_element (forwarded.begin (), forwarded.end ()), 10,
+                             "A single path for all the flows");
+    }
+  else if (m_mode == Ipv4GlobalRouting::ECMP_FLOW_HASH)
+    {
+      NS_TEST_EXPECT_MSG_EQ (r0->GetRouteInputVersion (), 0, "ECMP routes cannot be cached");
+
+      // the packets of a flow follow the same path
+      selections = Send (1, 50, MilliSeconds (1));
+      std::sort (selections.begin (), selections.end ());
+      NS_TEST_EXPECT_MSG_EQ (selections[1], 0, "A single path for a single flow");
+      NS_TEST_EXPECT_MSG_EQ (selections[2], 50, "A single path for a single flow");
+
+      // the flows are spread over the paths
+      selections = Send (300, 2, MilliSeconds (1));
+      for (uint32_t i = 0; i < selections.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_GT (selections[i], 100, "Path " << i << " is used");
+        }
+
+      // and so are the flows of r0 itself
+      selections = Send (300, 1, MilliSeconds (1), 1);
+      for (uint32_t i = 0; i < selections.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_GT (selections[i], 50, "Path " << i << " is used by the local flows");
+        }
+
+      // in proportion to the weights
+      Ipv4GlobalRoutingHelper::SetEcmpWeight (m_paths.Get (0), 0);
+      Ipv4GlobalRoutingHelper::SetEcmpWeight (m_paths.Get (1), 3);
+      selections = Send (300, 1, MilliSeconds (1));
+      NS_TEST_EXPECT_MSG_EQ (selections[0], 0, "A path of weight 0 is not used");
+      NS_TEST_EXPECT_MSG_GT (selections[1], 2 * selections[2], "Paths used according to their weights");
+    }
+  else
+    {
+      // back to back packets stay in the same flowlet
+      selections = Send (1, 50, MicroSeconds (10));
+      std::sort (selections.begin (), selections.end ());
+      NS_TEST_EXPECT_MSG_EQ (selections[2], 50, "A single path for a single flowlet");
+
+      // a flow changes path after an idle time
+      selections = Send (1, 50, MilliSeconds (1));
+      uint32_t used = 0;
+      for (uint32_t i = 0; i < selections.size (); i++)
+        {
+          used += (selections[i] > 0);
+        }
+      NS_TEST_EXPECT_MSG_EQ (used, 3, "The flowlets of a flow use all the paths");
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1683,10 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_FIRST), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_FLOW_HASH), TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingEcmpTestCase (Ipv4GlobalRouting::ECMP_FLOWLET), TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
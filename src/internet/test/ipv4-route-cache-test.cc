@@ -0,0 +1,292 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Base class of the route cache tests: a source, a router and a sink
+ * connected by two links.
+ */
+class Ipv4RouteCacheTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param name the test name
+   */
+  Ipv4RouteCacheTestCase (std::string name);
+
+protected:
+  /**
+   * \brief Create the nodes, their links and their addresses
+   */
+  void Setup (void);
+  /**
+   * \brief Receive the packets of the sink
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Send a packet to the sink
+   */
+  void Send (void);
+
+  NodeContainer m_nodes;             //!< Source, router and sink
+  Ipv4InterfaceContainer m_first;    //!< Interfaces of the source-router link
+  Ipv4InterfaceContainer m_second;   //!< Interfaces of the router-sink link
+  Ptr<Ipv4L3Protocol> m_router;      //!< IPv4 of the router
+  Ptr<Socket> m_txSocket;            //!< Socket of the source
+  uint32_t m_received;               //!< Packets received by the sink
+};
+
+Ipv4RouteCacheTestCase::Ipv4RouteCacheTestCase (std::string name)
+  : TestCase (name),
+    m_received (0)
+{
+}
+
+void
+Ipv4RouteCacheTestCase::Setup (void)
+{
+  m_nodes.Create (3);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer first = simpleHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (1)));
+  NetDeviceContainer second = simpleHelper.Install (NodeContainer (m_nodes.Get (1), m_nodes.Get (2)));
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (m_nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.1.0", "255.255.255.0");
+  m_first = ipv4.Assign (first);
+  ipv4.SetBase ("10.0.2.0", "255.255.255.0");
+  m_second = ipv4.Assign (second);
+  m_router = m_nodes.Get (1)->GetObject<Ipv4L3Protocol> ();
+
+  Ptr<Socket> rxSocket = m_nodes.Get (2)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&Ipv4RouteCacheTestCase::Receive, this));
+  m_txSocket = m_nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+}
+
+void
+Ipv4RouteCacheTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_received++;
+    }
+}
+
+void
+Ipv4RouteCacheTestCase::Send (void)
+{
+  m_txSocket->SendTo (Create<Packet> (100), 0, InetSocketAddress (m_second.GetAddress (1), 1234));
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes of the forwarded packets are cached, and that
+ * the cache follows the changes of the routes and of the interfaces
+ */
+class Ipv4RouteCacheStaticTestCase : public Ipv4RouteCacheTestCase
+{
+public:
+  Ipv4RouteCacheStaticTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the route cache counters of the router
+   * \param hits the expected hits
+   * \param misses the expected misses
+   * \param received the expected number of packets received by the sink
+   */
+  void Check (uint64_t hits, uint64_t misses, uint32_t received);
+  /**
+   * \brief Add a host route to the sink at the router
+   */
+  void AddHostRoute (void);
+  /**
+   * \brief Bring the interface of the router to the sink down
+   */
+  void SetDown (void);
+};
+
+Ipv4RouteCacheStaticTestCase::Ipv4RouteCacheStaticTestCase ()
+  : Ipv4RouteCacheTestCase ("Cache the static routes of the forwarded packets")
+{
+}
+
+void
+Ipv4RouteCacheStaticTestCase::Check (uint64_t hits, uint64_t misses, uint32_t received)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_router->GetRouteCacheHits (), hits, "Route cache hits at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_EQ (m_router->GetRouteCacheMisses (), misses, "Route cache misses at " << Simulator::Now ().As (Time::S));
+  NS_TEST_EXPECT_MSG_EQ (m_received, received, "Packets received at " << Simulator::Now ().As (Time::S));
+}
+
+void
+Ipv4RouteCacheStaticTestCase::AddHostRoute (void)
+{
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (m_router)->AddHostRouteTo (m_second.GetAddress (1), m_second.Get (0).second);
+}
+
+void
+Ipv4RouteCacheStaticTestCase::SetDown (void)
+{
+  m_router->SetDown (m_second.Get (0).second);
+}
+
+void
+Ipv4RouteCacheStaticTestCase::DoRun (void)
+{
+  Setup ();
+  Ipv4StaticRoutingHelper staticRouting;
+  staticRouting.GetStaticRouting (m_nodes.Get (0)->GetObject<Ipv4> ())->SetDefaultRoute (m_first.GetAddress (1), m_first.Get (0).second);
+
+  // The first packet is routed by the routing protocol, the next ones by the cache
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Simulator::Schedule (Seconds (i), &Ipv4RouteCacheStaticTestCase::Send, this);
+    }
+  Simulator::Schedule (Seconds (3.5), &Ipv4RouteCacheStaticTestCase::Check, this, 2, 1, 3);
+
+  // A new route invalidates the cache
+  Simulator::Schedule (Seconds (3.5), &Ipv4RouteCacheStaticTestCase::AddHostRoute, this);
+  Simulator::Schedule (Seconds (4), &Ipv4RouteCacheStaticTestCase::Send, this);
+  Simulator::Schedule (Seconds (5), &Ipv4RouteCacheStaticTestCase::Send, this);
+  Simulator::Schedule (Seconds (5.5), &Ipv4RouteCacheStaticTestCase::Check, this, 3, 2, 5);
+
+  // So does an interface going down: the packet is dropped
+  Simulator::Schedule (Seconds (5.5), &Ipv4RouteCacheStaticTestCase::SetDown, this);
+  Simulator::Schedule (Seconds (6), &Ipv4RouteCacheStaticTestCase::Send, this);
+  Simulator::Schedule (Seconds (6.5), &Ipv4RouteCacheStaticTestCase::Check, this, 3, 2, 5);
+
+  Simulator::Run ();
+
+  // The packets of the sink are delivered locally, and not cached
+  Ptr<Ipv4L3Protocol> sink = m_nodes.Get (2)->GetObject<Ipv4L3Protocol> ();
+  NS_TEST_EXPECT_MSG_EQ (sink->GetRouteCacheHits () + sink->GetRouteCacheMisses (), 0, "No route cached at the sink");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the routes are not cached when the routing protocol
+ * does not allow it, or when the cache is disabled
+ */
+class Ipv4RouteCacheDisabledTestCase : public Ipv4RouteCacheTestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param randomEcmp use random ECMP routing instead of disabling the cache
+   */
+  Ipv4RouteCacheDisabledTestCase (bool randomEcmp);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_randomEcmp; //!< Use random ECMP routing
+};
+
+Ipv4RouteCacheDisabledTestCase::Ipv4RouteCacheDisabledTestCase (bool randomEcmp)
+  : Ipv4RouteCacheTestCase (randomEcmp ? "No route cache with random ECMP routing" : "No route cache when disabled"),
+    m_randomEcmp (randomEcmp)
+{
+}
+
+void
+Ipv4RouteCacheDisabledTestCase::DoRun (void)
+{
+  Setup ();
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Ptr<Ipv4GlobalRouting> globalRouting = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting> (m_router->GetRoutingProtocol ());
+  NS_TEST_ASSERT_MSG_NE (globalRouting, 0, "Global routing at the router");
+  NS_TEST_EXPECT_MSG_NE (globalRouting->GetRouteInputVersion (), 0, "Global routes can be cached");
+  if (m_randomEcmp)
+    {
+      globalRouting->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+      NS_TEST_EXPECT_MSG_EQ (globalRouting->GetRouteInputVersion (), 0, "Random routes cannot be cached");
+      NS_TEST_EXPECT_MSG_EQ (m_router->GetRoutingProtocol ()->GetRouteInputVersion (), 0, "The list follows its protocols");
+    }
+  else
+    {
+      m_router->SetAttribute ("RouteCacheSize", UintegerValue (0));
+    }
+
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      Simulator::Schedule (Seconds (i), &Ipv4RouteCacheDisabledTestCase::Send, this);
+    }
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, 3, "Packets forwarded without the cache");
+  NS_TEST_EXPECT_MSG_EQ (m_router->GetRouteCacheHits (), 0, "No route cache hit");
+  NS_TEST_EXPECT_MSG_EQ (m_router->GetRouteCacheMisses (), 0, "No route cache miss");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 route cache TestSuite
+ */
+class Ipv4RouteCacheTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteCacheTestSuite ()
+    : TestSuite ("ipv4-route-cache", UNIT)
+  {
+    AddTestCase (new Ipv4RouteCacheStaticTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4RouteCacheDisabledTestCase (true), TestCase::QUICK);
+    AddTestCase (new Ipv4RouteCacheDisabledTestCase (false), TestCase::QUICK);
+  }
+};
+
+static Ipv4RouteCacheTestSuite g_ipv4RouteCacheTestSuite; //!< Static variable for test initialization
@@ -22,6 +22,9 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-header.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
@@ -35,6 +38,7 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -201,6 +205,189 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting lookup Test
+ *
+ * Check the routes found through the forwarding table index against a
+ * scan of the forwarding table, with random routes of random prefix
+ * lengths and metrics, before and after removing routes, and with a
+ * route whose network mask is not a prefix.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Find the route to a destination by scanning the forwarding table.
+   * \param routes the forwarding table, with the metric of each route
+   * \param dest the destination
+   * \param oif the output interface, or 0
+   * \param route the route found
+   * \return true if a route was found
+   */
+  bool ScanRoutes (std::vector<std::pair<Ipv4RoutingTableEntry, uint32_t> > const &routes,
+                   Ipv4Address dest, uint32_t oif, Ipv4RoutingTableEntry &route);
+
+  /**
+   * \brief Compare RouteOutput with ScanRoutes for random destinations.
+   * \param routing the static routing
+   * \param ipv4 the IPv4 stack
+   * \param networks networks to draw the destinations from
+   * \param step the step of the test, for the messages
+   */
+  void CheckRoutes (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                    std::vector<Ipv4Address> const &networks, std::string step);
+
+  Ptr<UniformRandomVariable> m_rng; //!< Random number generator
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase ()
+  : TestCase ("Check the static routing lookups against a scan of the routes")
+{
+}
+
+bool
+Ipv4StaticRoutingLookupTestCase::ScanRoutes (std::vector<std::pair<Ipv4RoutingTableEntry, uint32_t> > const &routes,
+                                             Ipv4Address dest, uint32_t oif, Ipv4RoutingTableEntry &route)
+{
+  bool found = false;
+  uint16_t longestMask = 0;
+  uint32_t shortestMetric = 0xffffffff;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      Ipv4RoutingTableEntry const &entry = routes[i].first;
+      uint32_t metric = routes[i].second;
+      Ipv4Mask mask = entry.GetDestNetworkMask ();
+      uint16_t maskLength = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, entry.GetDestNetwork ()) || (oif != 0 && entry.GetInterface () != oif))
+        {
+          continue;
+        }
+      if (maskLength < longestMask)
+        {
+          continue;
+        }
+      if (maskLength > longestMask)
+        {
+          shortestMetric = 0xffffffff;
+        }
+      longestMask = maskLength;
+      if (metric > shortestMetric)
+        {
+          continue;
+        }
+      shortestMetric = metric;
+      route = entry;
+      found = true;
+      if (maskLength == 32)
+        {
+          break;
+        }
+    }
+  return found;
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::CheckRoutes (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                                              std::vector<Ipv4Address> const &networks, std::string step)
+{
+  std::vector<std::pair<Ipv4RoutingTableEntry, uint32_t> > routes;
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      routes.push_back (std::make_pair (routing->GetRoute (i), routing->GetMetric (i)));
+    }
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      // a random address in a random network, or anywhere
+      uint32_t dest = m_rng->GetInteger (0, 0xffffffff);
+      if (i % 4 != 0)
+        {
+          uint32_t network = networks[m_rng->GetInteger (0, networks.size () - 1)].Get ();
+          uint32_t hostBits = m_rng->GetInteger (0, 12);
+          dest = (network & (0xffffffff << hostBits)) | (dest & ~(0xffffffff << hostBits));
+        }
+      uint32_t oif = (i % 3 == 0) ? m_rng->GetInteger (1, 3) : 0;
+
+      Ipv4Header header;
+      header.SetDestination (Ipv4Address (dest));
+      Socket::SocketErrno err;
+      Ptr<Ipv4Route> found = routing->RouteOutput (Create<Packet> (), header,
+                                                   oif ? ipv4->GetNetDevice (oif) : 0, err);
+      Ipv4RoutingTableEntry expected;
+      if (!ScanRoutes (routes, Ipv4Address (dest), oif, expected))
+        {
+          NS_TEST_ASSERT_MSG_EQ ((found == 0), true, step << ": unexpected route to " << Ipv4Address (dest));
+          continue;
+        }
+      NS_TEST_ASSERT_MSG_EQ ((found != 0), true, step << ": no route to " << Ipv4Address (dest));
+      NS_TEST_ASSERT_MSG_EQ (found->GetGateway (), expected.GetGateway (),
+                             step << ": wrong gateway to " << Ipv4Address (dest));
+      NS_TEST_ASSERT_MSG_EQ (found->GetOutputDevice (), ipv4->GetNetDevice (expected.GetInterface ()),
+                             step << ": wrong device to " << Ipv4Address (dest));
+    }
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.0");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      address.Assign (NetDeviceContainer (device));
+      address.NewNetwork ();
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper helper;
+  Ptr<Ipv4StaticRouting> routing = helper.GetStaticRouting (ipv4);
+
+  // nested networks, with equal cost routes through all the interfaces
+  std::vector<Ipv4Address> networks;
+  const uint8_t lengths[] = { 0, 8, 12, 16, 20, 24, 28, 31, 32 };
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      uint32_t length = lengths[m_rng->GetInteger (0, sizeof (lengths) - 1)];
+      Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+      Ipv4Address network = i < 100 ? Ipv4Address (m_rng->GetInteger (0, 0xffffffff))
+        : Ipv4Address (networks[m_rng->GetInteger (0, networks.size () - 1)].Get ()
+                       ^ (m_rng->GetInteger (0, 255) << (32 - std::max<uint32_t> (length, 8))));
+      networks.push_back (network.CombineMask (mask));
+      uint32_t interface = m_rng->GetInteger (1, 3);
+      Ipv4Address gateway (0x0a000002 + ((interface - 1) << 8));
+      routing->AddNetworkRouteTo (network, mask, gateway, interface, m_rng->GetInteger (0, 2));
+    }
+  CheckRoutes (routing, ipv4, networks, "Random routes");
+
+  for (uint32_t i = 0; i < 150; i++)
+    {
+      routing->RemoveRoute (m_rng->GetInteger (0, routing->GetNRoutes () - 1));
+    }
+  CheckRoutes (routing, ipv4, networks, "Removed routes");
+
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.255.0"), Ipv4Address ("10.0.1.2"), 2);
+  CheckRoutes (routing, ipv4, networks, "Non-prefix mask");
+
+  routing->RemoveRoute (Ipv4Address ("10.0.0.0"), Ipv4Address ("10.0.1.2"), 2);
+  CheckRoutes (routing, ipv4, networks, "Non-prefix mask removed");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +404,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -52,6 +52,8 @@
 #include "ns3/udp-l4-protocol.h"
 
 #include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-extension.h"
+#include "ns3/ipv6-extension-demux.h"
 #include "ns3/icmpv6-l4-protocol.h"
 #include "ns3/traffic-control-layer.h"
 #include "ns3/internet-stack-helper.h"
@@ -121,6 +123,7 @@ class Ipv6FragmentationTest : public TestCase
   uint32_t m_size;        //!< packet size.
   uint8_t m_icmpType;     //!< ICMP type.
   uint8_t m_icmpCode;     //!< ICMP code.
+  uint32_t m_bufferFullDrops; //!< Packets dropped because the reassembly buffer is full.
 
 public:
   virtual void DoRun (void);
@@ -163,6 +166,17 @@ public:
   void HandleReadIcmpClient (Ipv6Address icmpSource, uint8_t icmpTtl, uint8_t icmpType,
                              uint8_t icmpCode, uint32_t icmpInfo);
 
+  /**
+   * \brief Handle packets dropped by the server.
+   * \param ipHeader The IP header.
+   * \param packet The packet.
+   * \param reason The drop reason.
+   * \param ipv6 The IPv6 stack.
+   * \param interface The interface.
+   */
+  void HandleDropServer (const Ipv6Header &ipHeader, Ptr<const Packet> packet,
+                         Ipv6L3Protocol::DropReason reason, Ptr<Ipv6> ipv6, uint32_t interface);
+
   /**
    * \brief Set the packet fill.
    * \param fill The fill.
@@ -188,6 +202,7 @@ Ipv6FragmentationTest::Ipv6FragmentationTest ()
   m_size = 0;
   m_icmpType = 0;
   m_icmpCode = 0;
+  m_bufferFullDrops = 0;
 }
 
 Ipv6FragmentationTest::~Ipv6FragmentationTest ()
@@ -271,6 +286,16 @@ Ipv6FragmentationTest::HandleReadIcmpClient (Ipv6Address icmpSource,
   m_icmpCode = icmpCode;
 }
 
+void
+Ipv6FragmentationTest::HandleDropServer (const Ipv6Header &ipHeader, Ptr<const Packet> packet,
+                                         Ipv6L3Protocol::DropReason reason, Ptr<Ipv6> ipv6, uint32_t interface)
+{
+  if (reason == Ipv6L3Protocol::DROP_FRAGMENT_BUFFER_FULL)
+    {
+      m_bufferFullDrops++;
+    }
+}
+
 void
 Ipv6FragmentationTest::SetFill (uint8_t *fill, uint32_t fillSize, uint32_t dataSize)
 {
@@ -520,6 +545,36 @@ Ipv6FragmentationTest::DoRun (void)
       NS_TEST_EXPECT_MSG_EQ (end, m_receivedPacketServer->GetSize (), "trivial");
     }
 
+  // Fifth test: normal channel, no errors, no delays, small reassembly buffer.
+  // The packets larger than the buffer are dropped while they are reassembled,
+  // the others are received.
+  Ptr<Ipv6Extension> fragmentExtension = serverNode->GetObject<Ipv6ExtensionDemux> ()->GetExtension (Ipv6ExtensionFragment::EXT_NUMBER);
+  fragmentExtension->SetAttribute ("FragmentReassemblyBufferSize", UintegerValue (8000));
+  serverNode->GetObject<Ipv6L3Protocol> ()->TraceConnectWithoutContext ("Drop", MakeCallback (&Ipv6FragmentationTest::HandleDropServer, this));
+  for (int i = 0; i < 5; i++)
+    {
+      uint32_t packetSize = packetSizes[i];
+
+      SetFill (fillData, 78, packetSize);
+
+      m_receivedPacketServer = Create<Packet> ();
+      m_bufferFullDrops = 0;
+      Simulator::ScheduleWithContext (m_socketClient->GetNode ()->GetId (), Seconds (0),
+                                      &Ipv6FragmentationTest::SendClient, this);
+      Simulator::Run ();
+
+      if (packetSize < 8000)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_receivedPacketServer->GetSize (), packetSize, "Packet size not correct");
+          NS_TEST_EXPECT_MSG_EQ (m_bufferFullDrops, 0, "Unexpected drop");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_receivedPacketServer->GetSize (), 0, "Server got a packet larger than the buffer");
+          NS_TEST_EXPECT_MSG_GT (m_bufferFullDrops, 0, "No drop for a full buffer");
+        }
+    }
+
   Simulator::Destroy ();
 }
 
@@ -0,0 +1,364 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/bridge-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/neighbor-cache-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-l3-protocol.h"
+#include "ns3/ipv6-interface.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/mac48-address.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the MAC address index and the wait-reply set of the caches
+ */
+class NeighborCacheIndexTestCase : public TestCase
+{
+public:
+  NeighborCacheIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Count the ARP requests
+   * \param cache the ARP cache
+   * \param to the requested address
+   */
+  void ArpRequest (Ptr<const ArpCache> cache, Ipv4Address to);
+  /**
+   * \brief Count the dropped packets
+   * \param p the packet
+   */
+  void Drop (Ptr<const Packet> p);
+
+  std::map<Ipv4Address, uint32_t> m_requests; //!< ARP requests per address
+  uint32_t m_drops;                           //!< Dropped packets
+};
+
+NeighborCacheIndexTestCase::NeighborCacheIndexTestCase ()
+  : TestCase ("Inverse lookup, removal and retransmission in the neighbor caches"),
+    m_drops (0)
+{
+}
+
+void
+NeighborCacheIndexTestCase::ArpRequest (Ptr<const ArpCache> cache, Ipv4Address to)
+{
+  m_requests[to]++;
+}
+
+void
+NeighborCacheIndexTestCase::Drop (Ptr<const Packet> p)
+{
+  m_drops++;
+}
+
+void
+NeighborCacheIndexTestCase::DoRun (void)
+{
+  Address mac1 = Mac48Address ("00:00:00:00:00:01");
+  Address mac2 = Mac48Address ("00:00:00:00:00:02");
+
+  Ptr<ArpCache> arp = CreateObject<ArpCache> ();
+  ArpCache::Entry *a1 = arp->Add (Ipv4Address ("10.0.0.1"));
+  ArpCache::Entry *a2 = arp->Add (Ipv4Address ("10.0.0.2"));
+  ArpCache::Entry *a3 = arp->Add (Ipv4Address ("10.0.0.3"));
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 0, "Entries without a MAC address are not indexed");
+  a1->SetMacAddress (mac1);
+  a2->SetMacAddress (mac1);
+  a3->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 2, "Two addresses share the first MAC");
+  a2->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 1, "The changed MAC is removed from the index");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 2, "The changed MAC is added to the index");
+  arp->Remove (a3);
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 1, "A removed entry is not in the index");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).front (), a2, "The remaining entry is found");
+  NS_TEST_EXPECT_MSG_EQ (arp->Lookup (Ipv4Address ("10.0.0.3")), 0, "The entry is removed");
+  arp->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac1).size (), 0, "The index is flushed");
+  NS_TEST_EXPECT_MSG_EQ (arp->LookupInverse (mac2).size (), 0, "The index is flushed");
+
+  Ptr<NdiscCache> ndisc = CreateObject<NdiscCache> ();
+  NdiscCache::Entry *n1 = ndisc->Add (Ipv6Address ("2001:db8::1"));
+  NdiscCache::Entry *n2 = ndisc->Add (Ipv6Address ("2001:db8::2"));
+  NdiscCache::Entry *n3 = ndisc->Add (Ipv6Address ("fe80::2"));
+  n1->SetMacAddress (mac1);
+  n2->SetMacAddress (mac2);
+  n3->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 1, "One address has the first MAC");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 2, "Two addresses share the second MAC");
+  n1->SetMacAddress (mac2);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac1).size (), 0, "The changed MAC is removed from the index");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 3, "The changed MAC is added to the index");
+  ndisc->Remove (n2);
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 2, "A removed entry is not in the index");
+  NS_TEST_EXPECT_MSG_EQ (ndisc->Lookup (Ipv6Address ("2001:db8::2")), 0, "The entry is removed");
+  ndisc->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (ndisc->LookupInverse (mac2).size (), 0, "The index is flushed");
+
+  // Only the entries still waiting for a reply are retransmitted
+  Ptr<Node> node = CreateObject<Node> ();
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  node->AddDevice (device);
+  arp->SetDevice (device, 0);
+  arp->SetAttribute ("MaxRetries", UintegerValue (3));
+  arp->SetWaitReplyTimeout (Seconds (1));
+  arp->SetArpRequestCallback (MakeCallback (&NeighborCacheIndexTestCase::ArpRequest, this));
+  arp->TraceConnectWithoutContext ("Drop", MakeCallback (&NeighborCacheIndexTestCase::Drop, this));
+  a1 = arp->Add (Ipv4Address ("10.0.0.1"));
+  a2 = arp->Add (Ipv4Address ("10.0.0.2"));
+  a1->MarkWaitReply (ArpCache::Ipv4PayloadHeaderPair (Create<Packet> (100), Ipv4Header ()));
+  a2->MarkWaitReply (ArpCache::Ipv4PayloadHeaderPair (Create<Packet> (100), Ipv4Header ()));
+  Simulator::Schedule (Seconds (1.5), &ArpCache::Entry::MarkAlive, a1, mac1);
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_requests[Ipv4Address ("10.0.0.1")], 1, "The resolved entry is retransmitted once");
+  NS_TEST_EXPECT_MSG_EQ (m_requests[Ipv4Address ("10.0.0.2")], 3, "The pending entry is retransmitted MaxRetries times");
+  NS_TEST_EXPECT_MSG_EQ (m_drops, 1, "The packet of the unresolved entry is dropped");
+  NS_TEST_EXPECT_MSG_EQ (a1->IsAlive (), true, "The resolved entry is alive");
+  NS_TEST_EXPECT_MSG_EQ (a2->IsDead (), true, "The unresolved entry is dead");
+
+  Simulator::Destroy ();
+  arp->Dispose ();
+  ndisc->Dispose ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that NeighborCacheHelper fills the caches of a LAN
+ */
+class NeighborCacheLanTestCase : public TestCase
+{
+public:
+  NeighborCacheLanTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Receive a packet
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Send a packet
+   * \param socket the sending socket
+   * \param to the destination address
+   */
+  void Send (Ptr<Socket> socket, Ipv4Address to);
+
+  Time m_rxTime; //!< Reception time of the packet
+};
+
+NeighborCacheLanTestCase::NeighborCacheLanTestCase ()
+  : TestCase ("Populate the ARP and NDISC caches of a LAN")
+{
+}
+
+void
+NeighborCacheLanTestCase::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      m_rxTime = Simulator::Now ();
+    }
+}
+
+void
+NeighborCacheLanTestCase::Send (Ptr<Socket> socket, Ipv4Address to)
+{
+  socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (to, 1234));
+}
+
+void
+NeighborCacheLanTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer ipv4Interfaces = ipv4.Assign (devices);
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  ipv6.Assign (devices);
+
+  NeighborCacheHelper neighborCache;
+  neighborCache.PopulateNeighborCache ();
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4L3Protocol> ipv4L3 = nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+      Ptr<ArpCache> arp = ipv4L3->GetInterface (ipv4L3->GetInterfaceForDevice (devices.Get (i)))->GetArpCache ();
+      Ptr<Ipv6L3Protocol> ipv6L3 = nodes.Get (i)->GetObject<Ipv6L3Protocol> ();
+      Ptr<NdiscCache> ndisc = ipv6L3->GetInterface (ipv6L3->GetInterfaceForDevice (devices.Get (i)))->GetNdiscCache ();
+      for (uint32_t j = 0; j < nodes.GetN (); j++)
+        {
+          ArpCache::Entry *entry = arp->Lookup (ipv4Interfaces.GetAddress (j));
+          if (i == j)
+            {
+              NS_TEST_EXPECT_MSG_EQ (entry, 0, "No ARP entry for the own address");
+              continue;
+            }
+          NS_TEST_ASSERT_MSG_NE (entry, 0, "ARP entry of node " << j << " at node " << i);
+          NS_TEST_EXPECT_MSG_EQ (entry->IsPermanent (), true, "ARP entry is permanent");
+          NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (j)->GetAddress (), "ARP entry has the MAC of node " << j);
+
+          Ptr<Ipv6L3Protocol> remote = nodes.Get (j)->GetObject<Ipv6L3Protocol> ();
+          Ptr<Ipv6Interface> remoteInterface = remote->GetInterface (remote->GetInterfaceForDevice (devices.Get (j)));
+          NS_TEST_EXPECT_MSG_EQ (remoteInterface->GetNAddresses (), 2, "Link-local and global addresses");
+          for (uint32_t k = 0; k < remoteInterface->GetNAddresses (); k++)
+            {
+              NdiscCache::Entry *ndiscEntry = ndisc->Lookup (remoteInterface->GetAddress (k).GetAddress ());
+              NS_TEST_ASSERT_MSG_NE (ndiscEntry, 0, "NDISC entry of node " << j << " at node " << i);
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry->IsPermanent (), true, "NDISC entry is permanent");
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry->GetMacAddress (), devices.Get (j)->GetAddress (), "NDISC entry has the MAC of node " << j);
+              NS_TEST_EXPECT_MSG_EQ (ndiscEntry->IsRouter (), false, "Hosts are not routers");
+            }
+        }
+    }
+
+  // Without address resolution, the packet arrives after the channel delay
+  Ptr<Socket> rxSocket = nodes.Get (2)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  rxSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 1234));
+  rxSocket->SetRecvCallback (MakeCallback (&NeighborCacheLanTestCase::Receive, this));
+  Ptr<Socket> txSocket = nodes.Get (0)->GetObject<UdpSocketFactory> ()->CreateSocket ();
+  Simulator::Schedule (Seconds (1), &NeighborCacheLanTestCase::Send, this,
+                       txSocket, ipv4Interfaces.GetAddress (2));
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (m_rxTime, Seconds (1.001), "The packet is not delayed by ARP");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that NeighborCacheHelper goes through bridges and honors
+ * the interface containers
+ */
+class NeighborCacheBridgeTestCase : public TestCase
+{
+public:
+  NeighborCacheBridgeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+NeighborCacheBridgeTestCase::NeighborCacheBridgeTestCase ()
+  : TestCase ("Populate the ARP caches of some interfaces across a bridge")
+{
+}
+
+void
+NeighborCacheBridgeTestCase::DoRun (void)
+{
+  // a and c are on the first segment, b on the second one
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<Node> c = CreateObject<Node> ();
+  Ptr<Node> bridgeNode = CreateObject<Node> ();
+
+  Ptr<SimpleChannel> channel1 = CreateObject<SimpleChannel> ();
+  Ptr<SimpleChannel> channel2 = CreateObject<SimpleChannel> ();
+  SimpleNetDeviceHelper simpleHelper;
+  NetDeviceContainer devices = simpleHelper.Install (a, channel1);
+  devices.Add (simpleHelper.Install (b, channel2));
+  devices.Add (simpleHelper.Install (c, channel1));
+  NetDeviceContainer ports = simpleHelper.Install (bridgeNode, channel1);
+  ports.Add (simpleHelper.Install (bridgeNode, channel2));
+  BridgeHelper bridgeHelper;
+  bridgeHelper.Install (bridgeNode, ports);
+
+  InternetStackHelper internet;
+  internet.SetIpv6StackInstall (false);
+  internet.Install (NodeContainer (a, b, c));
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  NeighborCacheHelper neighborCache;
+  Ipv4InterfaceContainer populated;
+  populated.Add (interfaces.Get (0));
+  neighborCache.PopulateNeighborCache (populated);
+
+  Ptr<ArpCache> cacheA = a->GetObject<Ipv4L3Protocol> ()->GetInterface (interfaces.Get (0).second)->GetArpCache ();
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      ArpCache::Entry *entry = cacheA->Lookup (interfaces.GetAddress (i));
+      NS_TEST_ASSERT_MSG_NE (entry, 0, "ARP entry of " << interfaces.GetAddress (i));
+      NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), devices.Get (i)->GetAddress (), "ARP entry has the right MAC");
+    }
+  NS_TEST_EXPECT_MSG_EQ (cacheA->LookupInverse (devices.Get (1)->GetAddress ()).size (), 1, "Inverse lookup across the bridge");
+
+  Ptr<ArpCache> cacheB = b->GetObject<Ipv4L3Protocol> ()->GetInterface (interfaces.Get (1).second)->GetArpCache ();
+  NS_TEST_EXPECT_MSG_EQ (cacheB->Lookup (interfaces.GetAddress (0)), 0, "Interfaces not in the container are left alone");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Neighbor cache TestSuite
+ */
+class NeighborCacheTestSuite : public TestSuite
+{
+public:
+  NeighborCacheTestSuite ()
+    : TestSuite ("neighbor-cache", UNIT)
+  {
+    AddTestCase (new NeighborCacheIndexTestCase, TestCase::QUICK);
+    AddTestCase (new NeighborCacheLanTestCase, TestCase::QUICK);
+    AddTestCase (new NeighborCacheBridgeTestCase, TestCase::QUICK);
+  }
+};
+
+static NeighborCacheTestSuite g_neighborCacheTestSuite; //!< Static variable for test initialization
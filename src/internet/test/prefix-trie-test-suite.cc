@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include <cstring>
+
+#include "ns3/test.h"
+#include "ns3/prefix-trie.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie Test
+ *
+ * Insert and remove random, nested prefixes and check the prefixes
+ * matching random keys against a scan of the inserted prefixes.
+ *
+ * \tparam N the key size (bytes)
+ */
+template <std::size_t N>
+class PrefixTrieTestCase : public TestCase
+{
+public:
+  PrefixTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// An inserted prefix
+  struct Prefix
+  {
+    uint8_t key[N];   //!< Key
+    uint8_t length;   //!< Prefix length
+    uint32_t value;   //!< Value
+  };
+
+  /**
+   * \param prefix a prefix
+   * \param key a key
+   * \returns true if the prefix is a prefix of the key
+   */
+  static bool IsPrefixOf (Prefix const &prefix, const uint8_t *key);
+
+  /**
+   * \brief Check the trie against the inserted prefixes for random keys.
+   * \param trie the trie
+   * \param prefixes the inserted prefixes, in insertion order
+   */
+  void Check (PrefixTrie<uint32_t, N> const &trie, std::vector<Prefix> const &prefixes);
+
+  /**
+   * \param key the key to randomize
+   * \param prefixes prefixes to draw the key from
+   */
+  void RandomKey (uint8_t *key, std::vector<Prefix> const &prefixes);
+
+  Ptr<UniformRandomVariable> m_rng; //!< Random number generator
+};
+
+template <std::size_t N>
+PrefixTrieTestCase<N>::PrefixTrieTestCase ()
+  : TestCase ("Check a PrefixTrie of " + std::to_string (N * 8) + "-bit keys")
+{
+}
+
+template <std::size_t N>
+bool
+PrefixTrieTestCase<N>::IsPrefixOf (Prefix const &prefix, const uint8_t *key)
+{
+  for (uint32_t bit = 0; bit < prefix.length; bit++)
+    {
+      if (((prefix.key[bit / 8] ^ key[bit / 8]) >> (7 - bit % 8)) & 1)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+template <std::size_t N>
+void
+PrefixTrieTestCase<N>::RandomKey (uint8_t *key, std::vector<Prefix> const &prefixes)
+{
+  for (std::size_t i = 0; i < N; i++)
+    {
+      key[i] = m_rng->GetInteger (0, 255);
+    }
+  if (!prefixes.empty () && m_rng->GetInteger (0, 3) != 0)
+    {
+      // share a random number of bits with an inserted prefix
+      Prefix const &prefix = prefixes[m_rng->GetInteger (0, prefixes.size () - 1)];
+      uint32_t bits = m_rng->GetInteger (0, N * 8);
+      for (uint32_t bit = 0; bit < bits; bit++)
+        {
+          uint8_t mask = 0x80 >> (bit % 8);
+          key[bit / 8] = (key[bit / 8] & ~mask) | (prefix.key[bit / 8] & mask);
+        }
+    }
+}
+
+template <std::size_t N>
+void
+PrefixTrieTestCase<N>::Check (PrefixTrie<uint32_t, N> const &trie, std::vector<Prefix> const &prefixes)
+{
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint8_t key[N];
+      RandomKey (key, prefixes);
+
+      // the values of the matching prefixes, by prefix length
+      std::vector<std::vector<uint32_t> > expected (N * 8 + 1);
+      for (Prefix const &prefix : prefixes)
+        {
+          if (IsPrefixOf (prefix, key))
+            {
+              expected[prefix.length].push_back (prefix.value);
+            }
+        }
+      std::vector<std::vector<uint32_t> > found (N * 8 + 1);
+      int32_t previous = -1;
+      bool ordered = true;
+      trie.Match (key, [&] (uint8_t length, typename PrefixTrie<uint32_t, N>::Values const &values)
+        {
+          ordered = ordered && length > previous;
+          previous = length;
+          found[length] = values;
+        });
+      NS_TEST_ASSERT_MSG_EQ (ordered, true, "Prefixes not visited from the shortest");
+      for (uint32_t length = 0; length <= N * 8; length++)
+        {
+          NS_TEST_ASSERT_MSG_EQ ((found[length] == expected[length]), true,
+                                 "Wrong values for the prefix of length " << length);
+          typename PrefixTrie<uint32_t, N>::Values const *values = trie.Find (key, length);
+          NS_TEST_ASSERT_MSG_EQ (((values != 0 ? *values : std::vector<uint32_t> ()) == expected[length]), true,
+                                 "Wrong values found for the prefix of length " << length);
+        }
+    }
+}
+
+template <std::size_t N>
+void
+PrefixTrieTestCase<N>::DoRun (void)
+{
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (N);
+
+  PrefixTrie<uint32_t, N> trie;
+  std::vector<Prefix> prefixes;
+  for (uint32_t value = 0; value < 1000; value++)
+    {
+      Prefix prefix;
+      RandomKey (prefix.key, prefixes);
+      prefix.length = m_rng->GetInteger (0, N * 8);
+      prefix.value = value;
+      if (value % 5 == 0 && !prefixes.empty ())
+        {
+          // another value for an inserted prefix
+          prefix = prefixes[m_rng->GetInteger (0, prefixes.size () - 1)];
+          prefix.value = value;
+        }
+      trie.Insert (prefix.key, prefix.length, prefix.value);
+      prefixes.push_back (prefix);
+    }
+  Check (trie, prefixes);
+
+  for (uint32_t i = 0; i < 700; i++)
+    {
+      uint32_t index = m_rng->GetInteger (0, prefixes.size () - 1);
+      Prefix prefix = prefixes[index];
+      NS_TEST_ASSERT_MSG_EQ (trie.Remove (prefix.key, prefix.length, prefix.value), true, "Value not removed");
+      NS_TEST_ASSERT_MSG_EQ (trie.Remove (prefix.key, prefix.length, prefix.value), false, "Value removed twice");
+      prefixes.erase (prefixes.begin () + index);
+    }
+  Check (trie, prefixes);
+
+  for (Prefix const &prefix : prefixes)
+    {
+      trie.Remove (prefix.key, prefix.length, prefix.value);
+    }
+  NS_TEST_ASSERT_MSG_EQ (trie.IsEmpty (), true, "Nodes left after removing all the values");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief PrefixTrie TestSuite
+ */
+class PrefixTrieTestSuite : public TestSuite
+{
+public:
+  PrefixTrieTestSuite ();
+};
+
+PrefixTrieTestSuite::PrefixTrieTestSuite ()
+  : TestSuite ("prefix-trie", UNIT)
+{
+  AddTestCase (new PrefixTrieTestCase<4>, TestCase::QUICK);
+  AddTestCase (new PrefixTrieTestCase<16>, TestCase::QUICK);
+}
+
+static PrefixTrieTestSuite prefixTrieTestSuite; //!< Static variable for test initialization
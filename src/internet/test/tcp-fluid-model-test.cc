@@ -0,0 +1,525 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-helper.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/tcp-fluid-model.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpFluidModelTestSuite");
+
+/**
+ * \brief Connect two nodes with a pair of SimpleNetDevices and number them
+ * \param a the first node
+ * \param b the second node
+ * \param rate the rate of the devices
+ * \param address the address helper of the link
+ * \returns the interfaces of the link
+ */
+static Ipv4InterfaceContainer
+ConnectNodes (Ptr<Node> a, Ptr<Node> b, DataRate rate, Ipv4AddressHelper &address)
+{
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  return address.Assign (simple.Install (NodeContainer (a, b)));
+}
+
+/**
+ * \brief Get the rate of a device
+ * \param device the device
+ * \returns the value of its DataRate attribute
+ */
+static DataRate
+GetDeviceRate (Ptr<NetDevice> device)
+{
+  DataRateValue rate;
+  device->GetAttribute ("DataRate", rate);
+  return rate.Get ();
+}
+
+/**
+ * \brief Get the maximum size of the root queue disc of a device
+ * \param device the device
+ * \returns the value of the MaxSize attribute of the queue disc
+ */
+static QueueSize
+GetQueueDiscSize (Ptr<NetDevice> device)
+{
+  Ptr<QueueDisc> qdisc = device->GetNode ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (device);
+  QueueSizeValue size;
+  qdisc->GetAttribute ("MaxSize", size);
+  return size.Get ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the max-min fair allocation of the fluid model
+ *
+ * Two links of 10 and 4 Mbps in a row. Flow A crosses both links, flow B
+ * the first and flow C the second one: the second link is shared fairly by
+ * A and C, and B gets the rest of the first link (8 Mbps). Flow D, limited
+ * to 1 Mbps, then starts on the first link and takes 1 Mbps from B.
+ */
+class TcpFluidModelMaxMinTestCase : public TestCase
+{
+public:
+  TcpFluidModelMaxMinTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the rates of the flows
+   * \param rates the expected rates of the flows, in Mbps
+   */
+  void CheckRates (std::vector<double> rates);
+
+  Ptr<TcpFluidModel> m_model;   //!< The fluid model
+  NetDeviceContainer m_devices; //!< The transmitting devices of the links
+  QueueSize m_queueSize;        //!< Original size of the queue discs
+};
+
+TcpFluidModelMaxMinTestCase::TcpFluidModelMaxMinTestCase ()
+  : TestCase ("Max-min fair allocation of the fluid flows")
+{
+}
+
+void
+TcpFluidModelMaxMinTestCase::CheckRates (std::vector<double> rates)
+{
+  for (uint32_t i = 0; i < rates.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_model->GetFlowRate (i).GetBitRate () / 1e6, rates[i], 1e-6,
+                                 "Unexpected rate of flow " << i);
+    }
+  // Both links are saturated by the fluid flows
+  for (uint32_t i = 0; i < m_devices.GetN (); i++)
+    {
+      Ptr<NetDevice> device = m_devices.Get (i);
+      DataRate capacity (i == 0 ? "10Mbps" : "4Mbps");
+      NS_TEST_EXPECT_MSG_EQ (m_model->GetLinkLoad (device), capacity, "Link " << i << " is not saturated");
+      NS_TEST_EXPECT_MSG_EQ (GetDeviceRate (device).GetBitRate (), capacity.GetBitRate () / 100,
+                             "The packets were not left the minimum share of link " << i);
+      NS_TEST_EXPECT_MSG_EQ (GetQueueDiscSize (device).GetValue (), static_cast<uint32_t> (std::lround (m_queueSize.GetValue () / 100.0)),
+                             "The buffer of link " << i << " was not given to the fluid flows");
+    }
+}
+
+void
+TcpFluidModelMaxMinTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer first = ConnectNodes (nodes.Get (0), nodes.Get (1), DataRate ("10Mbps"), address);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer second = ConnectNodes (nodes.Get (1), nodes.Get (2), DataRate ("4Mbps"), address);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  m_devices.Add (first.Get (0).first->GetNetDevice (first.Get (0).second));
+  m_devices.Add (second.Get (0).first->GetNetDevice (second.Get (0).second));
+  m_queueSize = GetQueueDiscSize (m_devices.Get (0));
+
+  m_model = CreateObject<TcpFluidModel> ();
+  m_model->AddFlow (nodes.Get (0), second.GetAddress (1));
+  m_model->AddFlow (nodes.Get (0), first.GetAddress (1));
+  m_model->AddFlow (nodes.Get (1), second.GetAddress (1));
+  m_model->AddFlow (nodes.Get (0), first.GetAddress (1), 0, Seconds (1), DataRate ("1Mbps"));
+
+  Simulator::Schedule (Seconds (0.5), &TcpFluidModelMaxMinTestCase::CheckRates, this,
+                       std::vector<double> {2, 8, 2, 0});
+  Simulator::Schedule (Seconds (1.5), &TcpFluidModelMaxMinTestCase::CheckRates, this,
+                       std::vector<double> {2, 7, 2, 1});
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_model->Dispose ();
+  m_model = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the departures of fluid flows
+ *
+ * Two flows share a link of 8 Mbps. The first one sends 1 MB, i.e., during
+ * 2 s at 4 Mbps, then the second one gets the whole link until it is
+ * stopped, after which the link is given back to the packets.
+ */
+class TcpFluidModelDepartureTestCase : public TestCase
+{
+public:
+  TcpFluidModelDepartureTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Record the completion of a flow
+   * \param flowId the flow
+   */
+  void FlowComplete (uint32_t flowId);
+
+  /// Check the bytes sent by the second flow and stop it
+  void StopSecondFlow (void);
+
+  Ptr<TcpFluidModel> m_model;   //!< The fluid model
+  Time m_completion;            //!< Completion time of the first flow
+  uint64_t m_secondBytes;       //!< Bytes sent by the second flow when it is stopped
+};
+
+TcpFluidModelDepartureTestCase::TcpFluidModelDepartureTestCase ()
+  : TestCase ("Departures of the fluid flows"),
+    m_secondBytes (0)
+{
+}
+
+void
+TcpFluidModelDepartureTestCase::FlowComplete (uint32_t flowId)
+{
+  NS_TEST_EXPECT_MSG_EQ (flowId, 0, "Only the first flow has a size");
+  m_completion = Simulator::Now ();
+}
+
+void
+TcpFluidModelDepartureTestCase::StopSecondFlow (void)
+{
+  m_secondBytes = m_model->GetFlowBytes (1);
+  m_model->StopFlow (1);
+}
+
+void
+TcpFluidModelDepartureTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectNodes (nodes.Get (0), nodes.Get (1), DataRate ("8Mbps"), address);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Ptr<NetDevice> device = nodes.Get (0)->GetDevice (1);
+  QueueSize queueSize = GetQueueDiscSize (device);
+
+  m_model = CreateObject<TcpFluidModel> ();
+  m_model->TraceConnectWithoutContext ("FlowComplete", MakeCallback (&TcpFluidModelDepartureTestCase::FlowComplete, this));
+  m_model->AddFlow (nodes.Get (0), interfaces.GetAddress (1), 1000000);
+  m_model->AddFlow (nodes.Get (0), interfaces.GetAddress (1));
+  Simulator::Schedule (Seconds (3), &TcpFluidModelDepartureTestCase::StopSecondFlow, this);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_completion.GetSeconds (), 2, 1e-6, "The first flow did not send 1 MB at 4 Mbps");
+  NS_TEST_ASSERT_MSG_EQ (m_model->GetFlowBytes (0), 1000000, "The first flow did not send 1 MB");
+  // 1 MB at 4 Mbps, then 1 MB at 8 Mbps
+  NS_TEST_ASSERT_MSG_EQ (m_secondBytes, 2000000, "The second flow did not get the whole link");
+  NS_TEST_ASSERT_MSG_EQ (m_model->IsFlowActive (1), false, "The second flow was not stopped");
+  NS_TEST_ASSERT_MSG_EQ (m_model->GetLinkLoad (device), DataRate (0), "The link is still loaded");
+  NS_TEST_ASSERT_MSG_EQ (GetDeviceRate (device), DataRate ("8Mbps"), "The link was not given back to the packets");
+  NS_TEST_ASSERT_MSG_EQ (GetQueueDiscSize (device), queueSize, "The buffer was not given back to the packets");
+
+  Simulator::Destroy ();
+  m_model->Dispose ();
+  m_model = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check a hybrid simulation of fluid and packet flows
+ *
+ * Three fluid flows share a link of 10 Mbps with a TCP flow simulated at
+ * the packet level, from 1 s to 4 s. The TCP flow is detected and gets its
+ * fair share of the link, 2.5 Mbps; once it stops, the fluid flows share
+ * the whole link again.
+ */
+class TcpFluidModelHybridTestCase : public TestCase
+{
+public:
+  TcpFluidModelHybridTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Fill the send buffer of the TCP flow
+   * \param socket the sending socket
+   * \param available the space in the send buffer
+   */
+  void Send (Ptr<Socket> socket, uint32_t available);
+
+  /**
+   * \brief Accept the TCP flow
+   * \param socket the accepted socket
+   * \param from the address of the sender
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+
+  /**
+   * \brief Receive the data of the TCP flow
+   * \param socket the receiving socket
+   */
+  void Receive (Ptr<Socket> socket);
+
+  /**
+   * \brief Check the allocation
+   * \param packetFlows the expected number of packet flows
+   * \param rate the expected rate of the fluid flows, in Mbps
+   */
+  void Check (uint32_t packetFlows, double rate);
+
+  Ptr<TcpFluidModel> m_model;   //!< The fluid model
+  Ptr<NetDevice> m_device;      //!< The device of the shared link
+  uint64_t m_received;          //!< Bytes received between 2 s and 4 s
+};
+
+TcpFluidModelHybridTestCase::TcpFluidModelHybridTestCase ()
+  : TestCase ("Hybrid simulation of fluid and packet flows"),
+    m_received (0)
+{
+}
+
+void
+TcpFluidModelHybridTestCase::Send (Ptr<Socket> socket, uint32_t available)
+{
+  while (Simulator::Now () < Seconds (4) && socket->GetTxAvailable () >= 1000)
+    {
+      socket->Send (Create<Packet> (1000));
+    }
+}
+
+void
+TcpFluidModelHybridTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&TcpFluidModelHybridTestCase::Receive, this));
+}
+
+void
+TcpFluidModelHybridTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      if (Simulator::Now () >= Seconds (2) && Simulator::Now () < Seconds (4))
+        {
+          m_received += packet->GetSize ();
+        }
+    }
+}
+
+void
+TcpFluidModelHybridTestCase::Check (uint32_t packetFlows, double rate)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_model->GetNPacketFlows (), packetFlows, "Unexpected number of packet flows");
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_model->GetFlowRate (i).GetBitRate () / 1e6, rate, 1e-5,
+                                 "Unexpected rate of fluid flow " << i);
+    }
+  double residual = std::max (10 - 3 * rate, 0.1);
+  NS_TEST_EXPECT_MSG_EQ_TOL (GetDeviceRate (m_device).GetBitRate () / 1e6, residual, 1e-5,
+                             "The packets were not left the rest of the link");
+}
+
+void
+TcpFluidModelHybridTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ConnectNodes (nodes.Get (0), nodes.Get (1), DataRate ("10Mbps"), address);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  m_device = nodes.Get (0)->GetDevice (1);
+
+  m_model = CreateObject<TcpFluidModel> ();
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      m_model->AddFlow (nodes.Get (0), interfaces.GetAddress (1));
+    }
+
+  Ptr<Socket> server = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  server->Bind (InetSocketAddress (Ipv4Address::GetAny (), 5000));
+  server->Listen ();
+  server->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                             MakeCallback (&TcpFluidModelHybridTestCase::Accept, this));
+
+  Ptr<Socket> client = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  client->SetAttribute ("SegmentSize", UintegerValue (1448));
+  client->Bind ();
+  client->SetSendCallback (MakeCallback (&TcpFluidModelHybridTestCase::Send, this));
+  Simulator::Schedule (Seconds (1), &Socket::Connect, client, InetSocketAddress (interfaces.GetAddress (1), 5000));
+  Simulator::Schedule (Seconds (4), &Socket::Close, client);
+
+  Simulator::Schedule (Seconds (0.5), &TcpFluidModelHybridTestCase::Check, this, 0, 10.0 / 3);
+  Simulator::Schedule (Seconds (2), &TcpFluidModelHybridTestCase::Check, this, 1, 2.5);
+  Simulator::Schedule (Seconds (6), &TcpFluidModelHybridTestCase::Check, this, 0, 10.0 / 3);
+  Simulator::Stop (Seconds (7));
+  Simulator::Run ();
+
+  // The fair share of the link, less the headers
+  double goodput = m_received * 8 / 2.0 / 1e6;
+  NS_LOG_INFO ("Goodput of the packet flow " << goodput << " Mbps");
+  NS_TEST_ASSERT_MSG_GT (goodput, 2.2, "The packet flow did not get its fair share of the link");
+  NS_TEST_ASSERT_MSG_LT (goodput, 2.5, "The packet flow got more than its fair share of the link");
+
+  Simulator::Destroy ();
+  m_model->Dispose ();
+  m_model = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the buffer of a saturated link with a single queue root disc
+ *
+ * The root queue disc of the link is a FifoQueueDisc of 1000 packets,
+ * whose internal queue cannot be shrunk below its backlog. 200 packets are
+ * queued when a fluid flow saturates the link: the limit is lowered to the
+ * backlog only, and given back once the flow stops.
+ */
+class TcpFluidModelFifoBacklogTestCase : public TestCase
+{
+public:
+  TcpFluidModelFifoBacklogTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Check the maximum size of the root queue disc
+   * \param size the expected maximum size
+   */
+  void CheckQueueDiscSize (QueueSize size);
+  /**
+   * \brief Queue packets in a queue disc, which is never run and keeps them
+   * \param qdisc the queue disc
+   * \param nPackets the number of packets
+   */
+  void Enqueue (Ptr<QueueDisc> qdisc, uint32_t nPackets);
+
+  Ptr<NetDevice> m_device;      //!< The device of the saturated link
+};
+
+TcpFluidModelFifoBacklogTestCase::TcpFluidModelFifoBacklogTestCase ()
+  : TestCase ("Buffer of a saturated link with a backlogged FifoQueueDisc")
+{
+}
+
+void
+TcpFluidModelFifoBacklogTestCase::CheckQueueDiscSize (QueueSize size)
+{
+  NS_TEST_EXPECT_MSG_EQ (GetQueueDiscSize (m_device), size, "Unexpected maximum size of the queue disc");
+}
+
+void
+TcpFluidModelFifoBacklogTestCase::Enqueue (Ptr<QueueDisc> qdisc, uint32_t nPackets)
+{
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      qdisc->Enqueue (Create<Ipv4QueueDiscItem> (Create<Packet> (1000), m_device->GetBroadcast (),
+                                                  Ipv4L3Protocol::PROT_NUMBER, Ipv4Header ()));
+    }
+}
+
+void
+TcpFluidModelFifoBacklogTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper simple;
+  simple.SetNetDevicePointToPointMode (true);
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("10Mbps")));
+  simple.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  NetDeviceContainer devices = simple.Install (nodes);
+  TrafficControlHelper tch;
+  tch.SetRootQueueDisc ("ns3::FifoQueueDisc", "MaxSize", QueueSizeValue (QueueSize ("1000p")));
+  tch.Install (devices);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  m_device = devices.Get (0);
+
+  Ptr<QueueDisc> qdisc = nodes.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (m_device);
+  Simulator::Schedule (Seconds (0), &TcpFluidModelFifoBacklogTestCase::Enqueue, this, qdisc, 200);
+
+  Ptr<TcpFluidModel> model = CreateObject<TcpFluidModel> ();
+  uint32_t flow = model->AddFlow (nodes.Get (0), interfaces.GetAddress (1), 0, Seconds (0.5));
+  // Without the backlog, the limit would be 1% of 1000 packets
+  Simulator::Schedule (Seconds (1), &TcpFluidModelFifoBacklogTestCase::CheckQueueDiscSize, this,
+                       QueueSize ("200p"));
+  Simulator::Schedule (Seconds (2), &TcpFluidModel::StopFlow, model, flow);
+  Simulator::Schedule (Seconds (3), &TcpFluidModelFifoBacklogTestCase::CheckQueueDiscSize, this,
+                       QueueSize ("1000p"));
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (qdisc->GetNPackets (), 200, "The backlog was dropped");
+
+  Simulator::Destroy ();
+  model->Dispose ();
+  m_device = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the fluid model of TCP flows
+ */
+class TcpFluidModelTestSuite : public TestSuite
+{
+public:
+  TcpFluidModelTestSuite () : TestSuite ("tcp-fluid-model", UNIT)
+  {
+    AddTestCase (new TcpFluidModelMaxMinTestCase, TestCase::QUICK);
+    AddTestCase (new TcpFluidModelDepartureTestCase, TestCase::QUICK);
+    AddTestCase (new TcpFluidModelHybridTestCase, TestCase::QUICK);
+    AddTestCase (new TcpFluidModelFifoBacklogTestCase, TestCase::QUICK);
+  }
+};
+
+static TcpFluidModelTestSuite g_tcpFluidModelTestSuite; //!< Static variable for test initialization
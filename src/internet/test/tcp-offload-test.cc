@@ -0,0 +1,322 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/tcp-socket-factory.h"
+#include "tcp-general-test.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TcpOffloadTestSuite");
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the segmentation (GSO) and receive (GRO) offloads of TCP
+ *
+ * A bulk transfer is done with the given offloads. The test checks that all
+ * the data is delivered, and counts the data segments sent by the sender
+ * socket, the data packets sent by its IP layer, and the data segments
+ * processed by the receiver socket:
+ * - without GSO, the socket and the IP layer send the same segments;
+ * - with GSO split before IP, the socket sends a few super-segments, and
+ *   the IP layer one packet of at most the MTU per segment;
+ * - with GSO not split, the IP layer sends the super-segments as they are;
+ * - with GRO, the receiver processes several segments at once.
+ */
+class TcpOffloadTestCase : public TcpGeneralTest
+{
+public:
+  /**
+   * \brief Constructor
+   * \param gsoMaxSegments value of the GsoMaxSegments attribute of the sender
+   * \param gsoSplit value of the GsoSplit attribute of the sender
+   * \param groMaxSegments value of the GroMaxSegments attribute of the receiver
+   * \param desc test description
+   */
+  TcpOffloadTestCase (uint32_t gsoMaxSegments, bool gsoSplit, uint32_t groMaxSegments,
+                      const std::string &desc);
+
+protected:
+  virtual void ConfigureEnvironment (void);
+  virtual void ConfigureProperties (void);
+  virtual void Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who);
+  virtual void FinalChecks (void);
+
+  /**
+   * \brief Called when the IP layer of the sender sends a packet
+   * \param p the packet, with its IP header
+   * \param ipv4 the IP layer
+   * \param interface the interface index
+   */
+  void IpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface);
+
+private:
+  uint32_t m_gsoMaxSegments;  //!< GsoMaxSegments of the sender
+  bool m_gsoSplit;            //!< GsoSplit of the sender
+  uint32_t m_groMaxSegments;  //!< GroMaxSegments of the receiver
+  uint32_t m_txSegments;      //!< Data segments sent by the sender socket
+  uint32_t m_ipPackets;       //!< Data packets sent by the sender IP layer
+  uint32_t m_ipMaxSize;       //!< Largest packet sent by the sender IP layer
+  uint32_t m_rxSegments;      //!< Data segments processed by the receiver socket
+  uint32_t m_rxBytes;         //!< Data bytes processed by the receiver socket
+};
+
+TcpOffloadTestCase::TcpOffloadTestCase (uint32_t gsoMaxSegments, bool gsoSplit,
+                                        uint32_t groMaxSegments, const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_gsoMaxSegments (gsoMaxSegments),
+    m_gsoSplit (gsoSplit),
+    m_groMaxSegments (groMaxSegments),
+    m_txSegments (0),
+    m_ipPackets (0),
+    m_ipMaxSize (0),
+    m_rxSegments (0),
+    m_rxBytes (0)
+{
+}
+
+void
+TcpOffloadTestCase::ConfigureEnvironment (void)
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktSize (500);
+  SetAppPktCount (200);
+  SetAppPktInterval (NanoSeconds (10));
+  SetTransmitStart (Seconds (0));
+  SetPropagationDelay (MilliSeconds (10));
+  // Super-segments which are not split cross the network as one frame
+  SetMTU (m_gsoSplit ? 1500 : 65535);
+}
+
+void
+TcpOffloadTestCase::ConfigureProperties (void)
+{
+  TcpGeneralTest::ConfigureProperties ();
+  SetInitialCwnd (SENDER, 10);
+  GetSenderSocket ()->SetAttribute ("GsoMaxSegments", UintegerValue (m_gsoMaxSegments));
+  GetSenderSocket ()->SetAttribute ("GsoSplit", BooleanValue (m_gsoSplit));
+  GetReceiverSocket ()->SetAttribute ("GroMaxSegments", UintegerValue (m_groMaxSegments));
+  GetSenderSocket ()->GetNode ()->GetObject<Ipv4L3Protocol> ()->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&TcpOffloadTestCase::IpTx, this));
+}
+
+void
+TcpOffloadTestCase::IpTx (Ptr<const Packet> p, Ptr<Ipv4> ipv4, uint32_t interface)
+{
+  // Pure ACKs and SYNs have no more than 80 bytes of headers
+  if (p->GetSize () > 80)
+    {
+      m_ipPackets++;
+      m_ipMaxSize = std::max (m_ipMaxSize, p->GetSize ());
+    }
+}
+
+void
+TcpOffloadTestCase::Tx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == SENDER && p->GetSize () > 0)
+    {
+      m_txSegments++;
+    }
+}
+
+void
+TcpOffloadTestCase::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  if (who == RECEIVER && p->GetSize () > 0)
+    {
+      m_rxSegments++;
+      m_rxBytes += p->GetSize ();
+    }
+}
+
+void
+TcpOffloadTestCase::FinalChecks (void)
+{
+  NS_LOG_INFO ("Sender segments " << m_txSegments << ", IP packets " << m_ipPackets <<
+               " (largest " << m_ipMaxSize << " bytes), receiver segments " << m_rxSegments);
+  uint32_t segments = 200;
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxBytes, segments * 500, "Not all the data was received");
+  if (m_gsoMaxSegments == 1)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ipPackets, m_txSegments, "The IP layer did not send the segments of the socket");
+      NS_TEST_ASSERT_MSG_EQ (m_ipPackets, segments, "Data was retransmitted");
+    }
+  else if (m_gsoSplit)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ipPackets, segments, "The super-segments were not split in segments");
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (m_ipMaxSize, 1500, "A packet larger than the MTU was sent");
+      NS_TEST_ASSERT_MSG_LT (m_txSegments * 2, segments, "The socket did not send super-segments");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_ipPackets, m_txSegments, "The super-segments were split");
+      NS_TEST_ASSERT_MSG_LT (m_ipPackets * 2, segments, "The socket did not send super-segments");
+    }
+
+  if (m_groMaxSegments > 1)
+    {
+      NS_TEST_ASSERT_MSG_LT (m_rxSegments * 2, m_ipPackets, "The receiver did not coalesce the segments");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxSegments, m_ipPackets, "The receiver coalesced segments");
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the segments held for coalescing are reported as dropped
+ * when the socket is disposed of
+ *
+ * The receiver holds the first segments for a long GroTimeout, and the
+ * simulation ends before they are processed.
+ */
+class TcpGroDropTestCase : public TestCase
+{
+public:
+  TcpGroDropTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Accept a connection and trace its dropped segments
+   * \param socket the accepted socket
+   * \param from the address of the peer
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Record segments dropped by GRO
+   * \param p the segments, with their TCP header
+   */
+  void GroDrop (Ptr<const Packet> p);
+  /**
+   * \brief Send data on a socket
+   * \param socket the socket
+   */
+  static void Send (Ptr<Socket> socket);
+
+  Ptr<Socket> m_accepted;     //!< The accepted socket
+  uint32_t m_dropped;         //!< Number of GroDrop traces
+  uint32_t m_droppedBytes;    //!< Bytes reported by the GroDrop traces
+};
+
+TcpGroDropTestCase::TcpGroDropTestCase ()
+  : TestCase ("GRO segments dropped on dispose"),
+    m_dropped (0),
+    m_droppedBytes (0)
+{
+}
+
+void
+TcpGroDropTestCase::Accept (Ptr<Socket> socket, const Address &from)
+{
+  m_accepted = socket;
+  socket->TraceConnectWithoutContext ("GroDrop", MakeCallback (&TcpGroDropTestCase::GroDrop, this));
+}
+
+void
+TcpGroDropTestCase::GroDrop (Ptr<const Packet> p)
+{
+  m_dropped++;
+  m_droppedBytes += p->GetSize ();
+}
+
+void
+TcpGroDropTestCase::Send (Ptr<Socket> socket)
+{
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      socket->Send (Create<Packet> (500));
+    }
+}
+
+void
+TcpGroDropTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper devicesHelper;
+  NetDeviceContainer devices = devicesHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = addresses.Assign (devices);
+
+  Ptr<Socket> receiver = Socket::CreateSocket (nodes.Get (1), TcpSocketFactory::GetTypeId ());
+  receiver->SetAttribute ("GroMaxSegments", UintegerValue (8));
+  receiver->SetAttribute ("GroTimeout", TimeValue (Seconds (10)));
+  receiver->Bind (InetSocketAddress (Ipv4Address::GetAny (), 4477));
+  receiver->Listen ();
+  receiver->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&TcpGroDropTestCase::Accept, this));
+
+  Ptr<Socket> sender = Socket::CreateSocket (nodes.Get (0), TcpSocketFactory::GetTypeId ());
+  sender->SetAttribute ("SegmentSize", UintegerValue (500));
+  sender->Connect (InetSocketAddress (interfaces.GetAddress (1), 4477));
+  Simulator::Schedule (MilliSeconds (100), &TcpGroDropTestCase::Send, sender);
+
+  Simulator::Stop (MilliSeconds (500));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_NE (m_accepted, 0, "The connection was not accepted");
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 0, "Segments dropped before the end of the simulation");
+
+  // disposing of the nodes releases the end point of the accepted socket
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (m_dropped, 1, "The held segments were not reported");
+  NS_TEST_EXPECT_MSG_GT (m_droppedBytes, 3 * 500, "Not all the held segments were reported");
+  m_accepted = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief TestSuite for the segmentation and receive offloads of TCP
+ */
+class TcpOffloadTestSuite : public TestSuite
+{
+public:
+  TcpOffloadTestSuite () : TestSuite ("tcp-offload", UNIT)
+  {
+    AddTestCase (new TcpOffloadTestCase (1, true, 1, "No offload"), TestCase::QUICK);
+    AddTestCase (new TcpOffloadTestCase (8, true, 1, "GSO split before IP"), TestCase::QUICK);
+    AddTestCase (new TcpOffloadTestCase (8, false, 1, "GSO not split"), TestCase::QUICK);
+    AddTestCase (new TcpOffloadTestCase (1, true, 8, "GRO"), TestCase::QUICK);
+    AddTestCase (new TcpOffloadTestCase (8, true, 8, "GSO split before IP and GRO"), TestCase::QUICK);
+    AddTestCase (new TcpGroDropTestCase (), TestCase::QUICK);
+  }
+};
+
+static TcpOffloadTestSuite g_tcpOffloadTestSuite; //!< Static variable for test initialization
@@ -21,6 +21,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -395,6 +396,308 @@ TcpTxBufferTestCase::DoTeardown ()
 {
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check the scoreboard of TcpTxBuffer against a model
+ *
+ * A window of segments is sent, some of them are lost, and the others are
+ * received in order and sacked; the lost segments are retransmitted as
+ * NextSeg returns them, and an RTO marks the sent list lost when nothing
+ * else can be retransmitted. After each step, the counters, IsLost and
+ * NextSeg are compared with a scan of a model of the scoreboard.
+ */
+class TcpTxBufferScoreboardTestCase : public TestCase
+{
+public:
+  /** \brief Constructor */
+  TcpTxBufferScoreboardTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Scoreboard of a segment, in the model
+  struct Segment
+  {
+    bool received {false};  //!< Received by the other end
+    bool sacked {false};    //!< Sacked
+    bool lost {false};      //!< Lost
+    bool retrans {false};   //!< Retransmitted
+  };
+
+  /**
+   * \param i index of a segment
+   * \return its first sequence number
+   */
+  static SequenceNumber32 GetSeq (uint32_t i);
+
+  /**
+   * \brief Mark lost the segments followed by DupAckThresh sacked segments,
+   * up to the highest sack, as TcpTxBuffer::UpdateLostCount does
+   */
+  void UpdateLost (void);
+
+  /**
+   * \brief Compare the buffer with the model
+   * \param txBuf the buffer
+   */
+  void Check (Ptr<TcpTxBuffer> txBuf);
+
+  /**
+   * \brief Callback to provide a value of receiver window
+   * \returns the receiver window size
+   */
+  uint32_t GetRWnd (void) const;
+
+  std::vector<Segment> m_segments; //!< The segments of the model
+  uint32_t m_una {0};              //!< First segment not acked
+  int32_t m_highestSack {-1};      //!< Highest sacked segment, or -1
+};
+
+static const uint32_t g_scoreboardSegmentSize = 1000; //!< Segment size of the scoreboard test
+static const uint32_t g_scoreboardDupAckThresh = 3;   //!< DupAckThresh of the scoreboard test
+
+TcpTxBufferScoreboardTestCase::TcpTxBufferScoreboardTestCase ()
+  : TestCase ("TcpTxBuffer scoreboard against a model")
+{
+}
+
+uint32_t
+TcpTxBufferScoreboardTestCase::GetRWnd (void) const
+{
+  return std::numeric_limits<uint32_t>::max ();
+}
+
+SequenceNumber32
+TcpTxBufferScoreboardTestCase::GetSeq (uint32_t i)
+{
+  return SequenceNumber32 (1 + i * g_scoreboardSegmentSize);
+}
+
+void
+TcpTxBufferScoreboardTestCase::UpdateLost (void)
+{
+  if (m_highestSack < 0)
+    {
+      return;
+    }
+  // count the sacked segments down from the highest sack, the head excluded
+  uint32_t sacked = 0;
+  for (int32_t i = m_highestSack; i > static_cast<int32_t> (m_una); i--)
+    {
+      Segment &segment = m_segments[i];
+      if (segment.sacked)
+        {
+          sacked++;
+        }
+      else if (sacked >= g_scoreboardDupAckThresh)
+        {
+          segment.lost = true;
+        }
+    }
+  if (sacked >= g_scoreboardDupAckThresh && !m_segments[m_una].sacked)
+    {
+      m_segments[m_una].lost = true;
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::Check (Ptr<TcpTxBuffer> txBuf)
+{
+  uint32_t sacked = 0;
+  uint32_t lost = 0;
+  uint32_t retrans = 0;
+  int32_t toRetrans = -1;
+  int32_t notRetrans = -1;
+  for (uint32_t i = m_una; i < m_segments.size (); i++)
+    {
+      Segment const &segment = m_segments[i];
+      sacked += segment.sacked ? g_scoreboardSegmentSize : 0;
+      lost += segment.lost ? g_scoreboardSegmentSize : 0;
+      retrans += segment.retrans ? g_scoreboardSegmentSize : 0;
+      if (!segment.sacked && !segment.retrans)
+        {
+          if (segment.lost && toRetrans < 0)
+            {
+              toRetrans = i;
+            }
+          if (notRetrans < 0)
+            {
+              notRetrans = i;
+            }
+        }
+
+      // The first segment from i which is either lost or sacked decides
+      bool isLost = false;
+      if (m_highestSack >= 0 && static_cast<int32_t> (i) < m_highestSack)
+        {
+          for (uint32_t j = i; j < m_segments.size (); j++)
+            {
+              if (m_segments[j].lost || m_segments[j].sacked)
+                {
+                  isLost = m_segments[j].lost;
+                  break;
+                }
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (GetSeq (i)), isLost, "Wrong IsLost for segment " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), sacked, "Wrong sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), lost, "Wrong lost bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), retrans, "Wrong retransmitted bytes");
+  uint32_t sent = (m_segments.size () - m_una) * g_scoreboardSegmentSize;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), sent - sacked - lost + retrans, "Wrong bytes in flight");
+
+  SequenceNumber32 seq;
+  SequenceNumber32 seqHigh;
+  int32_t next = toRetrans >= 0 ? toRetrans : notRetrans;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&seq, &seqHigh, true), (next >= 0), "Wrong NextSeg result");
+  if (next >= 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (seq, GetSeq (next), "Wrong NextSeg sequence");
+    }
+}
+
+void
+TcpTxBufferScoreboardTestCase::DoRun (void)
+{
+  const uint32_t segments = 300;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferScoreboardTestCase::GetRWnd, this));
+  txBuf->SetHeadSequence (GetSeq (0));
+  txBuf->SetSegmentSize (g_scoreboardSegmentSize);
+  txBuf->SetDupAckThresh (g_scoreboardDupAckThresh);
+  txBuf->SetMaxBufferSize (segments * g_scoreboardSegmentSize);
+  txBuf->Add (Create<Packet> (segments * g_scoreboardSegmentSize));
+
+  // send the whole window, and lose some segments
+  m_segments.resize (segments);
+  std::list<uint32_t> deliveries;
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      txBuf->CopyFromSequence (g_scoreboardSegmentSize, GetSeq (i));
+      if (rng->GetValue () > 0.1)
+        {
+          deliveries.push_back (i);
+        }
+    }
+  Check (txBuf);
+
+  uint32_t rtos = 0;
+  while (m_una < segments)
+    {
+      if (deliveries.empty ())
+        {
+          // Nothing left to receive nor to retransmit: RTO
+          NS_TEST_ASSERT_MSG_LT (rtos, 100, "Too many RTOs");
+          rtos++;
+          txBuf->SetSentListLost ();
+          for (uint32_t i = m_una; i < segments; i++)
+            {
+              m_segments[i].lost = !m_segments[i].sacked;
+              m_segments[i].retrans = false;
+            }
+        }
+      else
+        {
+          uint32_t i = deliveries.front ();
+          deliveries.pop_front ();
+          m_segments[i].received = true;
+          if (i == m_una)
+            {
+              // cumulative ACK up to the next hole
+              while (m_una < segments && m_segments[m_una].received)
+                {
+                  m_una++;
+                }
+              txBuf->DiscardUpTo (m_una < segments ? GetSeq (m_una) : GetSeq (segments));
+              if (m_highestSack < static_cast<int32_t> (m_una))
+                {
+                  m_highestSack = -1;
+                }
+            }
+          else if (i > m_una)
+            {
+              // SACK the run of received segments containing i, and the one before it
+              TcpOptionSack::SackList list;
+              uint32_t first = i;
+              while (m_segments[first - 1].received)
+                {
+                  first--;
+                }
+              uint32_t last = i;
+              while (last + 1 < segments && m_segments[last + 1].received)
+                {
+                  last++;
+                }
+              list.push_back (TcpOptionSack::SackBlock (GetSeq (first), GetSeq (last + 1)));
+              uint32_t previous = first - 1;
+              while (previous > m_una && !m_segments[previous].received)
+                {
+                  previous--;
+                }
+              if (previous > m_una)
+                {
+                  uint32_t end = previous + 1;
+                  while (m_segments[previous - 1].received)
+                    {
+                      previous--;
+                    }
+                  list.push_back (TcpOptionSack::SackBlock (GetSeq (previous), GetSeq (end)));
+                }
+
+              uint32_t bytesSacked = 0;
+              for (auto block = list.begin (); block != list.end (); ++block)
+                {
+                  for (uint32_t j = 0; j < segments; j++)
+                    {
+                      if (GetSeq (j) >= block->first && GetSeq (j + 1) <= block->second
+                          && !m_segments[j].sacked)
+                        {
+                          m_segments[j].sacked = true;
+                          m_segments[j].lost = false;
+                          bytesSacked += g_scoreboardSegmentSize;
+                          if (m_highestSack < 0 || GetSeq (m_highestSack) <= GetSeq (j + 1))
+                            {
+                              m_highestSack = j;
+                            }
+                        }
+                    }
+                }
+              NS_TEST_ASSERT_MSG_EQ (txBuf->Update (list), bytesSacked, "Wrong bytes sacked");
+              if (bytesSacked > 0)
+                {
+                  UpdateLost ();
+                }
+            }
+        }
+      Check (txBuf);
+
+      // retransmit what NextSeg returns, if it is lost
+      SequenceNumber32 seq;
+      SequenceNumber32 seqHigh;
+      if (m_una < segments && txBuf->NextSeg (&seq, &seqHigh, true))
+        {
+          uint32_t i = (seq - GetSeq (0)) / g_scoreboardSegmentSize;
+          if (m_segments[i].lost)
+            {
+              txBuf->CopyFromSequence (g_scoreboardSegmentSize, seq);
+              m_segments[i].retrans = true;
+              if (rng->GetValue () > 0.2)
+                {
+                  deliveries.push_back (i);
+                }
+              Check (txBuf);
+            }
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->Size (), 0, "Data left in the buffer");
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -408,6 +711,7 @@ public:
     : TestSuite ("tcp-tx-buffer", UNIT)
   {
     AddTestCase (new TcpTxBufferTestCase, TestCase::QUICK);
+    AddTestCase (new TcpTxBufferScoreboardTestCase, TestCase::QUICK);
   }
 };
 
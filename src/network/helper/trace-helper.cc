@@ -56,6 +56,24 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
+
+  Ptr<PcapNgFileWrapper> target = GetPcapNgTarget ();
+  if (target)
+    {
+      //
+      // Declare the device as a new interface of the shared pcapng file,
+      // named after the pcap file it would otherwise have been given.
+      //
+      std::string name = filename.substr (filename.rfind ('/') + 1);
+      std::string::size_type pos = name.rfind (".pcap");
+      if (pos != std::string::npos && pos + 5 == name.size ())
+        {
+          name.erase (pos);
+        }
+      file->Init (target, dataLinkType, snapLen, name);
+      return file;
+    }
+
   file->Open (filename, filemode);
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
@@ -76,6 +94,36 @@ PcapHelper::CreateFile (
   return file;
 }
 
+Ptr<PcapNgFileWrapper>
+PcapHelper::CreatePcapNgFile (std::string filename, PcapNgFile::Compression compression)
+{
+  NS_LOG_FUNCTION (filename << compression);
+
+  Ptr<PcapNgFileWrapper> file = CreateObject<PcapNgFileWrapper> ();
+  file->Open (filename, compression);
+  NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename);
+
+  //
+  // As with CreateFile, the file stays open for as long as a trace sink or
+  // a PcapFileWrapper bound to one of its interfaces holds a reference.
+  //
+  return file;
+}
+
+Ptr<PcapNgFileWrapper> &
+PcapHelper::GetPcapNgTarget (void)
+{
+  static Ptr<PcapNgFileWrapper> target;
+  return target;
+}
+
+void
+PcapHelper::SetPcapNgTarget (Ptr<PcapNgFileWrapper> file)
+{
+  NS_LOG_FUNCTION (file);
+  GetPcapNgTarget () = file;
+}
+
 std::string
 PcapHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -208,6 +256,16 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, BinaryTrace::Detail detail)
+{
+  NS_LOG_FUNCTION (filename << detail);
+
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (filename, std::ios::out | std::ios::binary);
+  stream->SetBinaryTraceWriter (Create<BinaryTraceWriter> (stream->GetStream (), detail));
+  return stream;
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -310,6 +368,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::ENQUEUE, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -317,6 +381,12 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::ENQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -336,6 +406,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::DROP, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -343,6 +419,12 @@ void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::DROP, context, p);
+      return;
+    }
   *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -363,6 +445,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::DEQUEUE, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -370,6 +458,12 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::DEQUEUE, context, p);
+      return;
+    }
   *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -387,6 +481,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::RECEIVE, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
 }
 
@@ -394,6 +494,12 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
+  BinaryTraceWriter *writer = stream->GetBinaryTraceWriter ();
+  if (writer != 0)
+    {
+      writer->Record (BinaryTrace::RECEIVE, context, p);
+      return;
+    }
   *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
 }
 
@@ -441,6 +547,61 @@ PcapHelperForDevice::EnablePcapAll (std::string prefix, bool promiscuous)
   EnablePcap (prefix, NodeContainer::GetGlobal (), promiscuous);
 }
 
+void
+PcapHelperForDevice::EnablePcapAll (std::string prefix, bool promiscuous, DeviceFilter filter)
+{
+  EnablePcap (prefix, GetFilteredDevices (filter), promiscuous);
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelperForDevice::EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous,
+                                   PcapNgFile::Compression compression)
+{
+  PcapHelper pcapHelper;
+  Ptr<PcapNgFileWrapper> file = pcapHelper.CreatePcapNgFile (filename, compression);
+
+  //
+  // Interfaces are named after the per-device pcap files, using the part of
+  // the filename before its first extension as the prefix.
+  //
+  std::string prefix = filename.substr (0, filename.find ('.', filename.rfind ('/') + 1));
+
+  PcapHelper::SetPcapNgTarget (file);
+  for (NetDeviceContainer::Iterator i = d.Begin (); i != d.End (); ++i)
+    {
+      EnablePcapInternal (prefix, *i, promiscuous, false);
+    }
+  PcapHelper::SetPcapNgTarget (0);
+  return file;
+}
+
+Ptr<PcapNgFileWrapper>
+PcapHelperForDevice::EnablePcapNgAll (std::string filename, bool promiscuous,
+                                      PcapNgFile::Compression compression, DeviceFilter filter)
+{
+  return EnablePcapNg (filename, GetFilteredDevices (filter), promiscuous, compression);
+}
+
+NetDeviceContainer
+PcapHelperForDevice::GetFilteredDevices (DeviceFilter filter)
+{
+  NetDeviceContainer devs;
+  NodeContainer n = NodeContainer::GetGlobal ();
+  for (NodeContainer::Iterator i = n.Begin (); i != n.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> dev = node->GetDevice (j);
+          if (filter.IsNull () || filter (dev))
+            {
+              devs.Add (dev);
+            }
+        }
+    }
+  return devs;
+}
+
 void 
 PcapHelperForDevice::EnablePcap (std::string prefix, uint32_t nodeid, uint32_t deviceid, bool promiscuous)
 {
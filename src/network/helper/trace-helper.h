@@ -20,10 +20,12 @@
 #define TRACE_HELPER_H
 
 #include "ns3/assert.h"
+#include "ns3/callback.h"
 #include "ns3/net-device-container.h"
 #include "ns3/node-container.h"
 #include "ns3/simulator.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/pcapng-file-wrapper.h"
 #include "ns3/output-stream-wrapper.h"
 
 namespace ns3 {
@@ -110,6 +112,30 @@ public:
                                    DataLinkType dataLinkType,
                                    uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
                                    int32_t tzCorrection = 0);
+
+  /**
+   * @brief Create a pcapng file that can hold the captures of many devices.
+   *
+   * @param filename file name
+   * @param compression streaming compression applied to the file
+   * @returns a smart pointer to the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> CreatePcapNgFile (std::string filename,
+                                           PcapNgFile::Compression compression = PcapNgFile::COMPRESSION_NONE);
+
+  /**
+   * @brief Redirect the files created by CreateFile to a shared pcapng file.
+   *
+   * While a target is set, every call to CreateFile (on any PcapHelper)
+   * declares a new interface in the target pcapng file, named after the
+   * requested filename, and returns a PcapFileWrapper bound to it instead
+   * of opening a new pcap file.  This is what lets the device helpers, which
+   * each create one file per device, share a single file.
+   *
+   * @param file the pcapng file, or 0 to restore one file per device
+   */
+  static void SetPcapNgTarget (Ptr<PcapNgFileWrapper> file);
+
   /**
    * @brief Hook a trace source to the default trace sink
    * 
@@ -142,6 +168,11 @@ private:
    * @see DefaultSink
    */
   static void SinkWithHeader (Ptr<PcapFileWrapper> file, const Header& header, Ptr<const Packet> p);
+
+  /**
+   * @returns a reference to the pcapng file CreateFile currently redirects to
+   */
+  static Ptr<PcapNgFileWrapper> & GetPcapNgTarget (void);
 };
 
 template <typename T> void
@@ -223,6 +254,27 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create an output stream object on which the default trace sinks
+   * record events in the columnar binary trace format instead of printing
+   * them.
+   *
+   * Pass the stream to the EnableAscii methods taking an OutputStreamWrapper
+   * (for instance EnableAsciiAll, or InternetStackHelper::EnableAsciiIpv4All)
+   * to trace many devices into a single binary file.  Recording an event costs a few column appends instead of a call
+   * to Packet::Print; the file can be converted to the usual ascii trace
+   * afterwards with BinaryTraceReader::ConvertToAscii, or with the
+   * binary-trace-to-ascii program.
+   *
+   * @param filename file name
+   * @param detail per-packet information to store; with
+   *        BinaryTrace::FULL_PACKET the converted trace is identical to the
+   *        ascii trace
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename,
+                                                   BinaryTrace::Detail detail = BinaryTrace::SUMMARY);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -553,6 +605,12 @@ AsciiTraceHelper::HookDefaultReceiveSinkWithContext (
 class PcapHelperForDevice
 {
 public:
+  /**
+   * Callback deciding whether a net device should be traced by
+   * EnablePcapAll and EnablePcapNgAll.
+   */
+  typedef Callback<bool, Ptr<NetDevice> > DeviceFilter;
+
   /**
    * @brief Construct a PcapHelperForDevice
    */
@@ -633,6 +691,54 @@ public:
    * @param promiscuous If true capture all possible packets available at the device.
    */
   void EnablePcapAll (std::string prefix, bool promiscuous = false);
+
+  /**
+   * @brief Enable pcap output on each device (which is of the appropriate type)
+   * in the set of all nodes created in the simulation, for which the filter
+   * returns true.
+   *
+   * @param prefix Filename prefix to use for pcap files.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param filter Callback selecting the devices to trace.
+   */
+  void EnablePcapAll (std::string prefix, bool promiscuous, DeviceFilter filter);
+
+  /**
+   * @brief Capture each device in the container which is of the appropriate
+   * type into a single pcapng file.
+   *
+   * Every device gets its own Interface Description Block, named like the
+   * pcap file that EnablePcap would have created for it.
+   *
+   * @param filename Name of the pcapng file.
+   * @param d container of devices
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param compression Streaming compression applied to the file.
+   * @returns the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> EnablePcapNg (std::string filename, NetDeviceContainer d, bool promiscuous = false,
+                                       PcapNgFile::Compression compression = PcapNgFile::COMPRESSION_NONE);
+
+  /**
+   * @brief Capture each device (which is of the appropriate type) in the set
+   * of all nodes created in the simulation into a single pcapng file.
+   *
+   * @param filename Name of the pcapng file.
+   * @param promiscuous If true capture all possible packets available at the device.
+   * @param compression Streaming compression applied to the file.
+   * @param filter Optional callback selecting the devices to trace.
+   * @returns the pcapng file
+   */
+  Ptr<PcapNgFileWrapper> EnablePcapNgAll (std::string filename, bool promiscuous = false,
+                                          PcapNgFile::Compression compression = PcapNgFile::COMPRESSION_NONE,
+                                          DeviceFilter filter = DeviceFilter ());
+
+private:
+  /**
+   * @param filter device filter, possibly null
+   * @returns the devices of all nodes in the simulation accepted by the filter
+   */
+  static NetDeviceContainer GetFilteredDevices (DeviceFilter filter);
 };
 
 /**
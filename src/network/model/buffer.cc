@@ -17,9 +17,11 @@
  *
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
+#include <algorithm>
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/ip-checksum.h"
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -1142,13 +1144,40 @@ Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
-
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  NS_ASSERT_MSG (m_current >= m_dataStart &&
+                 m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
+  uint64_t sum = initialChecksum;
+
+  // Sum the contiguous regions of data around the zero area separately.
+  // A region starting at an odd offset has its bytes in swapped positions
+  // within the 16-bit words, hence its folded sum must be byte-swapped.
+  uint32_t offset = 0;
+  while (offset < size)
+    {
+      uint32_t length = size - offset;
+      uint16_t partial = 0;
+      if (m_current < m_zeroStart)
+        {
+          length = std::min (length, m_zeroStart - m_current);
+          partial = IpChecksumCalculate (m_data + m_current, length);
+        }
+      else if (m_current < m_zeroEnd)
+        {
+          length = std::min (length, m_zeroEnd - m_current);
+        }
+      else
+        {
+          partial = IpChecksumCalculate (m_data + m_current - (m_zeroEnd - m_zeroStart), length);
+        }
+      if (offset & 1)
+        {
+          partial = (partial << 8) | (partial >> 8);
+        }
+      sum += partial;
+      offset += length;
+      m_current += length;
+    }
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -237,6 +237,18 @@ public:
      * by size bytes.
      */
     void Write (uint8_t const*buffer, uint32_t size);
+    /**
+     * \param image a byte buffer to copy in the internal buffer.
+     * \param size number of bytes to copy.
+     * \returns a pointer to the copied bytes in the internal buffer
+     *
+     * Write the data in buffer and advance the iterator position
+     * by size bytes, like Write. The returned pointer allows the
+     * caller to patch the copied bytes in place; it is valid until
+     * the buffer is modified. This is the fast path of headers with
+     * a fixed layout (see HeaderImage).
+     */
+    inline uint8_t *WriteImage (uint8_t const*image, uint32_t size);
     /**
      * \param start the start of the data to copy
      * \param end the end of the data to copy
@@ -901,6 +913,25 @@ Buffer::Iterator::WriteU8 (uint8_t  data, uint32_t len)
     }
 }
 
+uint8_t *
+Buffer::Iterator::WriteImage (uint8_t const*image, uint32_t size)
+{
+  NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
+                 GetWriteErrorMessage ());
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
+  std::memcpy (to, image, size);
+  m_current += size;
+  return to;
+}
+
 void 
 Buffer::Iterator::WriteHtonU16 (uint16_t data)
 {
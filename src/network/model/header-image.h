@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef HEADER_IMAGE_H
+#define HEADER_IMAGE_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Field accessors for the fast path of fixed-layout headers
+ *
+ * Headers whose serialized layout does not depend on their contents
+ * (e.g., Ipv4Header without options, UdpHeader, TcpHeader without options)
+ * can serialize themselves with a single copy: they keep a constant byte
+ * image of the header, with the constant fields already set, copy it with
+ * Buffer::Iterator::WriteImage, and patch the variable fields in place with
+ * the methods of this class.  This avoids the bounds checks of one
+ * Buffer::Iterator write per field.
+ *
+ * \code
+ *   static const uint8_t image[4] = { 0x45, 0, 0, 0 };
+ *   uint8_t *data = start.WriteImage (image, sizeof (image));
+ *   HeaderImage::WriteHtonU16 (data + 2, m_length);
+ * \endcode
+ */
+class HeaderImage
+{
+public:
+  /**
+   * \param data where to write
+   * \param value the value to write, in host order, in network order
+   */
+  static void WriteHtonU16 (uint8_t *data, uint16_t value);
+  /**
+   * \param data where to write
+   * \param value the value to write, in host order, in network order
+   */
+  static void WriteHtonU32 (uint8_t *data, uint32_t value);
+  /**
+   * \param data where to write
+   * \param value the value to write, as Buffer::Iterator::WriteU16 does
+   */
+  static void WriteU16 (uint8_t *data, uint16_t value);
+};
+
+} // namespace ns3
+
+/****************************************************
+ *  Implementation of inline methods for performance
+ ****************************************************/
+
+namespace ns3 {
+
+inline void
+HeaderImage::WriteHtonU16 (uint8_t *data, uint16_t value)
+{
+  data[0] = (value >> 8) & 0xff;
+  data[1] = value & 0xff;
+}
+
+inline void
+HeaderImage::WriteHtonU32 (uint8_t *data, uint32_t value)
+{
+  data[0] = (value >> 24) & 0xff;
+  data[1] = (value >> 16) & 0xff;
+  data[2] = (value >> 8) & 0xff;
+  data[3] = value & 0xff;
+}
+
+inline void
+HeaderImage::WriteU16 (uint8_t *data, uint16_t value)
+{
+  data[0] = value & 0xff;
+  data[1] = (value >> 8) & 0xff;
+}
+
+} // namespace ns3
+
+#endif /* HEADER_IMAGE_H */
@@ -20,6 +20,7 @@
 
 #include "ns3/log.h"
 #include "net-device.h"
+#include "ns3/queue-item.h"
 
 namespace ns3 {
 
@@ -41,4 +42,21 @@ NetDevice::~NetDevice ()
   NS_LOG_FUNCTION (this);
 }
 
+bool
+NetDevice::SupportsSendBatch (void) const
+{
+  return false;
+}
+
+std::size_t
+NetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+  for (auto& item : items)
+    {
+      Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ());
+    }
+  return items.size ();
+}
+
 } // namespace ns3
@@ -22,6 +22,7 @@
 #define NET_DEVICE_H
 
 #include <stdint.h>
+#include <vector>
 #include "ns3/callback.h"
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -34,6 +35,7 @@ namespace ns3 {
 
 class Node;
 class Channel;
+class QueueDiscItem;
 
 /**
  * \ingroup network
@@ -359,6 +361,32 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface supports SendBatch, false otherwise.
+   *
+   * The traffic control layer hands bursts of packets to the devices
+   * supporting SendBatch. The default implementation returns false.
+   */
+  virtual bool SupportsSendBatch (void) const;
+
+  /**
+   * \param items the packets sent from above down to Network Device, each with
+   *        the mac address of its destination (already resolved) and the
+   *        type of its payload
+   *
+   * Called from the traffic control layer to send a burst of packets, which
+   * have been dequeued at once from a queue disc, into Network Device. As Linux
+   * drivers do when more packets follow (xmit_more), a device supporting
+   * SendBatch stores all the packets of the burst in its transmission queue
+   * before starting the transmission. A device stops accepting packets when its
+   * transmission queue is stopped. The default implementation calls Send for
+   * each packet.
+   *
+   * \return the number of packets consumed (sent or dropped) by the device,
+   *         which are the first packets of the burst
+   */
+  virtual std::size_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+
 };
 
 } // namespace ns3
@@ -79,7 +79,8 @@ Node::GetTypeId (void)
 
 Node::Node()
   : m_id (0),
-    m_sid (0)
+    m_sid (0),
+    m_deviceHandlersValid (false)
 {
   NS_LOG_FUNCTION (this);
   Construct ();
@@ -87,7 +88,8 @@ Node::Node()
 
 Node::Node(uint32_t sid)
   : m_id (0),
-    m_sid (sid)
+    m_sid (sid),
+    m_deviceHandlersValid (false)
 { 
   NS_LOG_FUNCTION (this << sid);
   Construct ();
@@ -135,6 +137,7 @@ Node::AddDevice (Ptr<NetDevice> device)
   device->SetNode (this);
   device->SetIfIndex (index);
   device->SetReceiveCallback (MakeCallback (&Node::NonPromiscReceiveFromDevice, this));
+  m_deviceHandlersValid = false;
   Simulator::ScheduleWithContext (GetId (), Seconds (0.0), 
                                   &NetDevice::Initialize, device);
   NotifyDeviceAdded (device);
@@ -187,6 +190,7 @@ Node::DoDispose ()
   NS_LOG_FUNCTION (this);
   m_deviceAdditionListeners.clear ();
   m_handlers.clear ();
+  m_deviceHandlers.clear ();
   for (std::vector<Ptr<NetDevice> >::iterator i = m_devices.begin ();
        i != m_devices.end (); i++)
     {
@@ -257,6 +261,7 @@ Node::RegisterProtocolHandler (ProtocolHandler handler,
     }
 
   m_handlers.push_back (entry);
+  m_deviceHandlersValid = false;
 }
 
 void
@@ -269,6 +274,7 @@ Node::UnregisterProtocolHandler (ProtocolHandler handler)
       if (i->handler.IsEqual (handler))
         {
           m_handlers.erase (i);
+          m_deviceHandlersValid = false;
           break;
         }
     }
@@ -312,6 +318,28 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
                         << ") Packet UID " << packet->GetUid ());
   bool found = false;
 
+  // The handlers of the device are looked up by interface index, so that
+  // the nodes with many devices (e.g., switches) do not scan all the handlers
+  uint32_t ifIndex = device->GetIfIndex ();
+  if (ifIndex < m_devices.size () && m_devices[ifIndex] == device)
+    {
+      if (!m_deviceHandlersValid)
+        {
+          BuildDeviceHandlers ();
+        }
+      for (uint32_t index : m_deviceHandlers[ifIndex])
+        {
+          ProtocolHandlerEntry &entry = m_handlers[index];
+          if ((entry.protocol == 0 || entry.protocol == protocol)
+              && promiscuous == entry.promiscuous)
+            {
+              entry.handler (device, packet, protocol, from, to, packetType);
+              found = true;
+            }
+        }
+      return found;
+    }
+
   for (ProtocolHandlerList::iterator i = m_handlers.begin ();
        i != m_handlers.end (); i++)
     {
@@ -331,6 +359,33 @@ Node::ReceiveFromDevice (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16
     }
   return found;
 }
+
+void
+Node::BuildDeviceHandlers (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_deviceHandlers.assign (m_devices.size (), std::vector<uint32_t> ());
+  for (uint32_t index = 0; index < m_handlers.size (); index++)
+    {
+      Ptr<NetDevice> device = m_handlers[index].device;
+      if (device == 0)
+        {
+          for (auto& handlers : m_deviceHandlers)
+            {
+              handlers.push_back (index);
+            }
+        }
+      else
+        {
+          uint32_t ifIndex = device->GetIfIndex ();
+          if (ifIndex < m_devices.size () && m_devices[ifIndex] == device)
+            {
+              m_deviceHandlers[ifIndex].push_back (index);
+            }
+        }
+    }
+  m_deviceHandlersValid = true;
+}
 void 
 Node::RegisterDeviceAdditionListener (DeviceAdditionListener listener)
 {
@@ -266,6 +266,11 @@ private:
    */
   void Construct (void);
 
+  /**
+   * \brief Build the lists of the protocol handlers of each device.
+   */
+  void BuildDeviceHandlers (void);
+
   /**
    * \brief Protocol handler entry.
    * This structure is used to demultiplex all the protocols.
@@ -287,6 +292,9 @@ private:
   std::vector<Ptr<NetDevice> > m_devices; //!< Devices associated to this node
   std::vector<Ptr<Application> > m_applications; //!< Applications associated to this node
   ProtocolHandlerList m_handlers; //!< Protocol handlers in the node
+  /// Indexes in m_handlers of the protocol handlers of each device, by interface index
+  std::vector<std::vector<uint32_t> > m_deviceHandlers;
+  bool m_deviceHandlersValid; //!< Whether m_deviceHandlers is up to date
   DeviceAdditionListenerList m_deviceAdditionListeners; //!< Device addition listeners in the node
 };
 
@@ -0,0 +1,252 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/llc-snap-header.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/trace-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a binary trace with full packets converts back to the exact
+ * output of the AsciiTraceHelper default sinks.
+ */
+class BinaryTraceAsciiTestCase : public TestCase
+{
+public:
+  BinaryTraceAsciiTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Fire the default sinks on the ascii and binary streams.
+   * \param i event index
+   */
+  void Trace (uint32_t i);
+
+  Ptr<OutputStreamWrapper> m_ascii;  //!< Text stream
+  Ptr<OutputStreamWrapper> m_binary; //!< Binary stream
+};
+
+BinaryTraceAsciiTestCase::BinaryTraceAsciiTestCase ()
+  : TestCase ("Check conversion of a binary trace to ascii")
+{
+}
+
+void
+BinaryTraceAsciiTestCase::Trace (uint32_t i)
+{
+  Ptr<Packet> p = Create<Packet> (100 + i);
+  LlcSnapHeader llc;
+  llc.SetType (0x0800);
+  p->AddHeader (llc);
+  EthernetHeader eth;
+  eth.SetLengthType (p->GetSize ());
+  p->AddHeader (eth);
+
+  std::ostringstream context;
+  context << "/NodeList/" << i % 3 << "/DeviceList/" << i % 2 << "/$ns3::CsmaNetDevice/TxQueue/Enqueue";
+
+  Ptr<OutputStreamWrapper> streams[2] = { m_ascii, m_binary };
+  for (uint32_t s = 0; s < 2; ++s)
+    {
+      switch (i % 4)
+        {
+        case 0:
+          AsciiTraceHelper::DefaultEnqueueSinkWithContext (streams[s], context.str (), p);
+          break;
+        case 1:
+          AsciiTraceHelper::DefaultDequeueSinkWithContext (streams[s], context.str (), p);
+          break;
+        case 2:
+          AsciiTraceHelper::DefaultDropSinkWithoutContext (streams[s], p);
+          break;
+        default:
+          AsciiTraceHelper::DefaultReceiveSinkWithContext (streams[s], context.str (), p);
+          break;
+        }
+    }
+}
+
+void
+BinaryTraceAsciiTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  std::ostringstream ascii;
+  std::stringstream binary;
+  m_ascii = Create<OutputStreamWrapper> (&ascii);
+  m_binary = Create<OutputStreamWrapper> (&binary);
+  // A small block size to exercise reading across event blocks
+  m_binary->SetBinaryTraceWriter (Create<BinaryTraceWriter> (&binary, BinaryTrace::FULL_PACKET, 5));
+
+  for (uint32_t i = 0; i < 23; ++i)
+    {
+      Simulator::Schedule (MicroSeconds (1234 * i), &BinaryTraceAsciiTestCase::Trace, this, i);
+    }
+  Simulator::Run ();
+  // the pending events are written at Simulator::Destroy
+  Simulator::Destroy ();
+
+  std::ostringstream converted;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceReader::ConvertToAscii (binary, converted), true, "Not a binary trace");
+  NS_TEST_EXPECT_MSG_EQ (converted.str (), ascii.str (), "Converted trace differs from the ascii trace");
+
+  m_ascii = 0;
+  m_binary = 0;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the columns of a binary trace with packet summaries.
+ */
+class BinaryTraceColumnsTestCase : public TestCase
+{
+public:
+  BinaryTraceColumnsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceColumnsTestCase::BinaryTraceColumnsTestCase ()
+  : TestCase ("Check the columns of a binary trace")
+{
+}
+
+void
+BinaryTraceColumnsTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  std::stringstream binary;
+  Ptr<Packet> p = Create<Packet> (64);
+  p->AddHeader (EthernetHeader ());
+  {
+    BinaryTraceWriter writer (&binary, BinaryTrace::SUMMARY, 2);
+    writer.Record (BinaryTrace::RECEIVE, "/NodeList/12/DeviceList/3/$ns3::PointToPointNetDevice/MacRx", p);
+    writer.Record (BinaryTrace::DROP, p);
+    writer.Record (BinaryTrace::ENQUEUE, "/NodeList/7/$ns3::Ipv4L3Protocol/Tx", p);
+    writer.Flush ();
+  }
+
+  BinaryTraceReader reader (&binary);
+  NS_TEST_ASSERT_MSG_EQ (reader.IsValid (), true, "Not a binary trace");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetDetail (), BinaryTrace::SUMMARY, "Wrong detail");
+
+  BinaryTrace::Event event;
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (event), true, "Missing event");
+  NS_TEST_EXPECT_MSG_EQ (event.type, BinaryTrace::RECEIVE, "Wrong event type");
+  NS_TEST_EXPECT_MSG_EQ (event.node, 12, "Wrong node");
+  NS_TEST_EXPECT_MSG_EQ (event.device, 3, "Wrong device");
+  NS_TEST_EXPECT_MSG_EQ (event.uid, p->GetUid (), "Wrong uid");
+  NS_TEST_EXPECT_MSG_EQ (event.size, p->GetSize (), "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (reader.GetContext (event.context),
+                         "/NodeList/12/DeviceList/3/$ns3::PointToPointNetDevice/MacRx", "Wrong context");
+  std::vector<std::string> names = reader.GetTypeNames (event);
+  NS_TEST_ASSERT_MSG_EQ (names.size (), 1, "Wrong header summary");
+  NS_TEST_EXPECT_MSG_EQ (names[0], "ns3::EthernetHeader", "Wrong header summary");
+
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (event), true, "Missing event");
+  NS_TEST_EXPECT_MSG_EQ (event.type, BinaryTrace::DROP, "Wrong event type");
+  NS_TEST_EXPECT_MSG_EQ (event.context, BinaryTrace::NO_CONTEXT, "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (event.node, BinaryTrace::UNKNOWN, "Unexpected node");
+
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (event), true, "Missing event");
+  NS_TEST_EXPECT_MSG_EQ (event.node, 7, "Wrong node");
+  NS_TEST_EXPECT_MSG_EQ (event.device, BinaryTrace::UNKNOWN, "Unexpected device");
+
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (event), false, "Unexpected event");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the pending events are written when the streams are flushed
+ * on a fatal error.
+ */
+class BinaryTraceFatalErrorTestCase : public TestCase
+{
+public:
+  BinaryTraceFatalErrorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTraceFatalErrorTestCase::BinaryTraceFatalErrorTestCase ()
+  : TestCase ("Check that the pending events are written on a fatal error")
+{
+}
+
+void
+BinaryTraceFatalErrorTestCase::DoRun (void)
+{
+  std::stringstream binary;
+  BinaryTraceWriter writer (&binary, BinaryTrace::SUMMARY);
+  writer.Record (BinaryTrace::DROP, Create<Packet> (64));
+  writer.Record (BinaryTrace::DROP, Create<Packet> (128));
+
+  // what NS_FATAL_ERROR does before terminating
+  FatalImpl::FlushStreams ();
+
+  BinaryTraceReader reader (&binary);
+  NS_TEST_ASSERT_MSG_EQ (reader.IsValid (), true, "Not a binary trace");
+  BinaryTrace::Event event;
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (event), true, "Missing event");
+  NS_TEST_EXPECT_MSG_EQ (event.size, 64, "Wrong size");
+  NS_TEST_ASSERT_MSG_EQ (reader.Next (event), true, "Missing event");
+  NS_TEST_EXPECT_MSG_EQ (event.size, 128, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (reader.Next (event), false, "Unexpected event");
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary trace TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceAsciiTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceColumnsTestCase, TestCase::QUICK);
+  AddTestCase (new BinaryTraceFatalErrorTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite binaryTraceTestSuite; //!< Static variable for test initialization
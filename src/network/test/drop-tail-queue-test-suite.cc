@@ -16,8 +16,11 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <list>
+
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/ring-buffer.h"
 #include "ns3/string.h"
 
 using namespace ns3;
@@ -83,6 +86,129 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the drop tail queue stays FIFO while its ring buffer wraps
+ * around and grows.
+ */
+class DropTailQueueWrapTestCase : public TestCase
+{
+public:
+  DropTailQueueWrapTestCase ();
+  virtual void DoRun (void);
+};
+
+DropTailQueueWrapTestCase::DropTailQueueWrapTestCase ()
+  : TestCase ("Check the drop tail queue across ring buffer wrap-around and growth")
+{
+}
+
+void
+DropTailQueueWrapTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("1000p"));
+
+  std::list<Ptr<Packet> > expected;
+  uint32_t dequeued = 0;
+  // Enqueue three packets and dequeue two at each step, so that the queue
+  // slowly grows while its first element moves along the array
+  for (uint32_t step = 0; step < 200; ++step)
+    {
+      for (uint32_t i = 0; i < 3; ++i)
+        {
+          Ptr<Packet> p = Create<Packet> (step % 50 + 1);
+          expected.push_back (p);
+          NS_TEST_ASSERT_MSG_EQ (queue->Enqueue (p), true, "Enqueue failed");
+        }
+      for (uint32_t i = 0; i < 2; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (queue->Peek (), expected.front (), "Wrong head of line packet");
+          Ptr<Packet> p = queue->Dequeue ();
+          NS_TEST_ASSERT_MSG_EQ (p, expected.front (), "Packets dequeued out of order");
+          expected.pop_front ();
+          dequeued++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (queue->GetNPackets (), expected.size (), "Wrong number of packets");
+    }
+  NS_TEST_EXPECT_MSG_EQ (dequeued, 400, "Wrong number of dequeued packets");
+
+  uint32_t removed = 0;
+  Ptr<Packet> p;
+  while ((p = queue->Remove ()) != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (p, expected.front (), "Packets removed out of order");
+      expected.pop_front ();
+      removed++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (removed, 200, "Wrong number of removed packets");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsAfterDequeue (), 200, "Removed packets not counted as dropped");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNBytes (), 0, "The queue should be empty");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * RingBuffer insertions and removals at arbitrary positions.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check insertions and removals in the middle of a ring buffer")
+{
+}
+
+void
+RingBufferTestCase::DoRun (void)
+{
+  RingBuffer<int> ring;
+  std::list<int> ref;
+  // Mix insertions and removals at the front, back and middle, with the
+  // first element away from the start of the array
+  for (int i = 0; i < 100; ++i)
+    {
+      RingBuffer<int>::const_iterator rpos = ring.begin ();
+      std::list<int>::const_iterator lpos = ref.begin ();
+      for (int j = 0; j < i % 7 && rpos != ring.end (); ++j)
+        {
+          ++rpos;
+          ++lpos;
+        }
+      RingBuffer<int>::iterator rit = ring.insert (rpos, i);
+      ref.insert (lpos, i);
+      NS_TEST_ASSERT_MSG_EQ (*rit, i, "Insert returned the wrong position");
+      if (i % 3 == 0)
+        {
+          ring.erase (ring.begin ());
+          ref.erase (ref.begin ());
+        }
+      if (i % 5 == 0 && ring.size () > 2)
+        {
+          rit = ring.erase (++ring.begin ());
+          lpos = ref.erase (++ref.begin ());
+          NS_TEST_ASSERT_MSG_EQ (*rit, *lpos, "Erase returned the wrong position");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.size (), ref.size (), "Wrong number of elements");
+  NS_TEST_EXPECT_MSG_EQ ((ring.capacity () & (ring.capacity () - 1)), 0, "Capacity not a power of two");
+  std::list<int>::const_iterator lit = ref.begin ();
+  for (RingBuffer<int>::const_iterator it = ring.begin (); it != ring.end (); ++it, ++lit)
+    {
+      NS_TEST_EXPECT_MSG_EQ (*it, *lit, "Wrong element order");
+    }
+
+  ring.clear ();
+  NS_TEST_EXPECT_MSG_EQ (ring.empty (), true, "Ring buffer not empty after clear");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +222,8 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailQueueWrapTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
   }
 };
 
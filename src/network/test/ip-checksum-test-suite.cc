@@ -0,0 +1,233 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/buffer.h"
+#include "ns3/crc32.h"
+#include "ns3/ip-checksum.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \param data buffer
+ * \param length the length of the buffer
+ * \returns the one's complement sum of the buffer, computed one word at a time
+ */
+static uint16_t
+ReferenceIpChecksum (const uint8_t *data, uint32_t length)
+{
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i + 1 < length; i += 2)
+    {
+      sum += data[i] | (data[i + 1] << 8);
+    }
+  if (length & 1)
+    {
+      sum += data[length - 1];
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \param data buffer
+ * \param length the length of the buffer
+ * \returns the CRC-32 of the buffer, computed one bit at a time
+ */
+static uint32_t
+ReferenceCrc32 (const uint8_t *data, uint32_t length)
+{
+  uint32_t crc = 0xffffffff;
+  for (uint32_t i = 0; i < length; i++)
+    {
+      crc ^= data[i];
+      for (int bit = 0; bit < 8; bit++)
+        {
+          crc = (crc >> 1) ^ (0xedb88320 & (0 - (crc & 1)));
+        }
+    }
+  return ~crc;
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Cross-check every checksum kernel supported by the CPU against simple
+ * reference implementations, for all lengths and alignments of small
+ * buffers and for a few large ones.
+ */
+class ChecksumKernelTestCase : public TestCase
+{
+public:
+  ChecksumKernelTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ChecksumKernelTestCase::ChecksumKernelTestCase ()
+  : TestCase ("Cross-check the checksum kernels")
+{
+}
+
+void
+ChecksumKernelTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  std::vector<uint8_t> data (70000);
+  for (uint32_t i = 0; i < data.size (); i++)
+    {
+      data[i] = rng->GetInteger (0, 255);
+    }
+  // all ones, the worst case for carries
+  std::vector<uint8_t> ones (70000, 0xff);
+
+  ChecksumKernel original = GetChecksumKernel ();
+  ChecksumKernel kernels[] = { CHECKSUM_KERNEL_SCALAR, CHECKSUM_KERNEL_SSE, CHECKSUM_KERNEL_AVX2 };
+  for (ChecksumKernel kernel : kernels)
+    {
+      if (!IsChecksumKernelSupported (kernel))
+        {
+          continue;
+        }
+      SetChecksumKernel (kernel);
+      for (uint32_t offset = 0; offset < 16; offset++)
+        {
+          for (uint32_t length = 0; length < 300; length++)
+            {
+              const uint8_t *buf = &data[offset];
+              NS_TEST_ASSERT_MSG_EQ (IpChecksumCalculate (buf, length), ReferenceIpChecksum (buf, length),
+                                     "Kernel " << kernel << ", offset " << offset << ", length " << length);
+              NS_TEST_ASSERT_MSG_EQ (CRC32Calculate (buf, length), ReferenceCrc32 (buf, length),
+                                     "Kernel " << kernel << ", offset " << offset << ", length " << length);
+            }
+        }
+      for (uint32_t length : {1500u, 9000u, 65535u, 65536u + 1000u})
+        {
+          NS_TEST_ASSERT_MSG_EQ (IpChecksumCalculate (&data[3], length), ReferenceIpChecksum (&data[3], length),
+                                 "Kernel " << kernel << ", length " << length);
+          NS_TEST_ASSERT_MSG_EQ (IpChecksumCalculate (&ones[0], length), ReferenceIpChecksum (&ones[0], length),
+                                 "Kernel " << kernel << ", length " << length);
+          NS_TEST_ASSERT_MSG_EQ (CRC32Calculate (&data[3], length), ReferenceCrc32 (&data[3], length),
+                                 "Kernel " << kernel << ", length " << length);
+        }
+    }
+  SetChecksumKernel (original);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check Buffer::Iterator::CalculateIpChecksum against word by word reads,
+ * on buffers with a zero area at even and odd offsets.
+ */
+class BufferChecksumTestCase : public TestCase
+{
+public:
+  BufferChecksumTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BufferChecksumTestCase::BufferChecksumTestCase ()
+  : TestCase ("Check the checksum of buffers with a zero area")
+{
+}
+
+void
+BufferChecksumTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (2);
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      uint32_t zeros = rng->GetInteger (0, 100);
+      uint32_t head = rng->GetInteger (0, 67);
+      uint32_t tail = rng->GetInteger (0, 67);
+      Buffer buffer (zeros);
+      buffer.AddAtStart (head);
+      Buffer::Iterator it = buffer.Begin ();
+      for (uint32_t j = 0; j < head; j++)
+        {
+          it.WriteU8 (rng->GetInteger (0, 255));
+        }
+      buffer.AddAtEnd (tail);
+      it = buffer.End ();
+      it.Prev (tail);
+      for (uint32_t j = 0; j < tail; j++)
+        {
+          it.WriteU8 (rng->GetInteger (0, 255));
+        }
+
+      uint32_t start = rng->GetInteger (0, buffer.GetSize ());
+      uint32_t size = rng->GetInteger (0, buffer.GetSize () - start);
+      uint32_t initial = rng->GetInteger (0, 0x2ffff);
+
+      Buffer::Iterator ref = buffer.Begin ();
+      ref.Next (start);
+      uint32_t sum = initial;
+      for (uint32_t j = 0; j < size / 2; j++)
+        {
+          sum += ref.ReadU16 ();
+        }
+      if (size & 1)
+        {
+          sum += ref.ReadU8 ();
+        }
+      while (sum >> 16)
+        {
+          sum = (sum & 0xffff) + (sum >> 16);
+        }
+
+      it = buffer.Begin ();
+      it.Next (start);
+      NS_TEST_ASSERT_MSG_EQ (it.CalculateIpChecksum (size, initial), static_cast<uint16_t> (~sum),
+                             "head " << head << ", zeros " << zeros << ", tail " << tail
+                                     << ", start " << start << ", size " << size);
+      NS_TEST_ASSERT_MSG_EQ (it.GetDistanceFrom (buffer.Begin ()), start + size, "Iterator not advanced");
+    }
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Checksum kernels TestSuite
+ */
+class IpChecksumTestSuite : public TestSuite
+{
+public:
+  IpChecksumTestSuite ();
+};
+
+IpChecksumTestSuite::IpChecksumTestSuite ()
+  : TestSuite ("ip-checksum", UNIT)
+{
+  AddTestCase (new ChecksumKernelTestCase, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTestCase, TestCase::QUICK);
+}
+
+static IpChecksumTestSuite ipChecksumTestSuite; //!< Static variable for test initialization
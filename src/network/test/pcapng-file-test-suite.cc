@@ -0,0 +1,359 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/pcapng-file.h"
+#include "ns3/pcapng-file-wrapper.h"
+#include "ns3/trace-helper.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace ns3;
+
+// ===========================================================================
+// Some utility functions for the tests.
+// ===========================================================================
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * A block parsed back from a pcapng file.
+ */
+struct PcapNgBlock
+{
+  uint32_t type;              //!< Block type
+  std::vector<uint8_t> body;  //!< Block body, without type and lengths
+};
+
+static std::vector<uint8_t>
+ReadFile (std::string filename)
+{
+  std::ifstream f (filename.c_str (), std::ios::binary);
+  return std::vector<uint8_t> ((std::istreambuf_iterator<char> (f)), std::istreambuf_iterator<char> ());
+}
+
+static uint32_t
+GetU32 (std::vector<uint8_t> const &data, uint32_t offset)
+{
+  uint32_t v;
+  std::memcpy (&v, &data[offset], sizeof (v));
+  return v;
+}
+
+static uint16_t
+GetU16 (std::vector<uint8_t> const &data, uint32_t offset)
+{
+  uint16_t v;
+  std::memcpy (&v, &data[offset], sizeof (v));
+  return v;
+}
+
+/**
+ * Split a pcapng byte stream in blocks, checking that the leading and
+ * trailing block lengths agree.
+ *
+ * \param data the file contents
+ * \param [out] blocks the parsed blocks
+ * \returns true if the stream is well formed
+ */
+static bool
+ParseBlocks (std::vector<uint8_t> const &data, std::vector<PcapNgBlock> &blocks)
+{
+  uint32_t offset = 0;
+  while (offset + 12 <= data.size ())
+    {
+      uint32_t type = GetU32 (data, offset);
+      uint32_t len = GetU32 (data, offset + 4);
+      if (len < 12 || (len & 3) || offset + len > data.size ()
+          || GetU32 (data, offset + len - 4) != len)
+        {
+          return false;
+        }
+      PcapNgBlock block;
+      block.type = type;
+      block.body.assign (data.begin () + offset + 8, data.begin () + offset + len - 4);
+      blocks.push_back (block);
+      offset += len;
+    }
+  return offset == data.size ();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check the block structure of a pcapng file with several interfaces.
+ */
+class PcapNgWriteTestCase : public TestCase
+{
+public:
+  PcapNgWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgWriteTestCase::PcapNgWriteTestCase ()
+  : TestCase ("Check the blocks written to a multi-interface pcapng file")
+{
+}
+
+void
+PcapNgWriteTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("write.pcapng");
+  uint8_t data[100];
+  for (uint32_t i = 0; i < sizeof (data); ++i)
+    {
+      data[i] = i;
+    }
+
+  PcapNgFile f;
+  f.Open (filename);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Unable to open " << filename);
+  uint32_t ppp = f.AddInterface (9, 64, "node-0-1");
+  uint32_t eth = f.AddInterface (1, 1500, "node-1-1");
+  NS_TEST_ASSERT_MSG_EQ (ppp, 0, "First interface should have id 0");
+  NS_TEST_ASSERT_MSG_EQ (eth, 1, "Second interface should have id 1");
+  f.Write (ppp, 1000000001ULL, data, 100);
+  f.Write (eth, 0x100000002ULL, data, 7);
+  f.Close ();
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Error writing " << filename);
+
+  std::vector<PcapNgBlock> blocks;
+  NS_TEST_ASSERT_MSG_EQ (ParseBlocks (ReadFile (filename), blocks), true, "Malformed pcapng file");
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 5, "Expected SHB, two IDBs and two EPBs");
+
+  NS_TEST_EXPECT_MSG_EQ (blocks[0].type, 0x0A0D0D0A, "First block should be a SHB");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[0].body, 0), 0x1A2B3C4D, "Wrong byte-order magic");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (blocks[0].body, 4), 1, "Wrong major version");
+
+  NS_TEST_EXPECT_MSG_EQ (blocks[1].type, 1, "Second block should be an IDB");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (blocks[1].body, 0), 9, "Wrong link type");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[1].body, 4), 64, "Wrong snap length");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (blocks[1].body, 8), 2, "Expected if_name option");
+  NS_TEST_EXPECT_MSG_EQ (std::string (blocks[1].body.begin () + 12, blocks[1].body.begin () + 20),
+                         "node-0-1", "Wrong interface name");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (blocks[2].body, 0), 1, "Wrong link type");
+
+  NS_TEST_EXPECT_MSG_EQ (blocks[3].type, 6, "Expected an EPB");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 0), ppp, "Wrong interface id");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 4), 0, "Wrong timestamp (high)");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 8), 1000000001, "Wrong timestamp (low)");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 12), 64, "Captured length not truncated to snap length");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 16), 100, "Wrong original length");
+  NS_TEST_EXPECT_MSG_EQ (std::memcmp (&blocks[3].body[20], data, 64), 0, "Wrong packet data");
+
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 0), eth, "Wrong interface id");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 4), 1, "Wrong timestamp (high)");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 8), 2, "Wrong timestamp (low)");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 12), 7, "Wrong captured length");
+  NS_TEST_EXPECT_MSG_EQ (blocks[4].body.size (), 20 + 8, "Packet data not padded to 32 bits");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that the staged blocks are written when the streams are flushed
+ * on a fatal error.
+ */
+class PcapNgFatalErrorTestCase : public TestCase
+{
+public:
+  PcapNgFatalErrorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgFatalErrorTestCase::PcapNgFatalErrorTestCase ()
+  : TestCase ("Check that the staged blocks are written on a fatal error")
+{
+}
+
+void
+PcapNgFatalErrorTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("fatal.pcapng");
+  uint8_t data[100] = {0};
+
+  PcapNgFile f;
+  f.Open (filename);
+  uint32_t eth = f.AddInterface (1, 1500, "node-0-1");
+  f.Write (eth, 1, data, sizeof (data));
+  NS_TEST_ASSERT_MSG_EQ (ReadFile (filename).size (), 0, "The blocks should still be staged");
+
+  // what NS_FATAL_ERROR does before terminating
+  FatalImpl::FlushStreams ();
+
+  std::vector<PcapNgBlock> blocks;
+  NS_TEST_ASSERT_MSG_EQ (ParseBlocks (ReadFile (filename), blocks), true, "Malformed pcapng file");
+  NS_TEST_EXPECT_MSG_EQ (blocks.size (), 3, "Expected SHB, IDB and EPB");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that PcapHelper multiplexes the files it creates into a pcapng
+ * target, as done by PcapHelperForDevice::EnablePcapNg.
+ */
+class PcapNgRedirectTestCase : public TestCase
+{
+public:
+  PcapNgRedirectTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgRedirectTestCase::PcapNgRedirectTestCase ()
+  : TestCase ("Check that pcap files are multiplexed into a pcapng target")
+{
+}
+
+void
+PcapNgRedirectTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("redirect.pcapng");
+  {
+    PcapHelper helper;
+    Ptr<PcapNgFileWrapper> ng = helper.CreatePcapNgFile (filename);
+    PcapHelper::SetPcapNgTarget (ng);
+    Ptr<PcapFileWrapper> a = helper.CreateFile ("trace-0-1.pcap", std::ios::out, PcapHelper::DLT_PPP);
+    Ptr<PcapFileWrapper> b = helper.CreateFile ("trace-1-1.pcap", std::ios::out, PcapHelper::DLT_EN10MB);
+    PcapHelper::SetPcapNgTarget (0);
+    ng = 0;
+
+    NS_TEST_ASSERT_MSG_EQ (a->Fail (), false, "Bound wrapper should not fail");
+    a->Write (MilliSeconds (1), Create<Packet> (10));
+    b->Write (MilliSeconds (2), Create<Packet> (20));
+    a->Write (MilliSeconds (3), Create<Packet> (30));
+    // The pcapng file is closed once the last bound wrapper goes away
+  }
+
+  std::vector<PcapNgBlock> blocks;
+  NS_TEST_ASSERT_MSG_EQ (ParseBlocks (ReadFile (filename), blocks), true, "Malformed pcapng file");
+  NS_TEST_ASSERT_MSG_EQ (blocks.size (), 6, "Expected SHB, two IDBs and three EPBs");
+  NS_TEST_EXPECT_MSG_EQ (std::string (blocks[1].body.begin () + 12, blocks[1].body.begin () + 21),
+                         "trace-0-1", "Interface not named after the pcap file");
+  NS_TEST_EXPECT_MSG_EQ (GetU16 (blocks[2].body, 0), PcapHelper::DLT_EN10MB, "Wrong link type");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 0), 0, "Wrong interface id");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[3].body, 8), 1000000, "Timestamp not in nanoseconds");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 0), 1, "Wrong interface id");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[4].body, 16), 20, "Wrong original length");
+  NS_TEST_EXPECT_MSG_EQ (GetU32 (blocks[5].body, 0), 0, "Wrong interface id");
+}
+
+#ifdef HAVE_ZLIB
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Check that a gzip-compressed pcapng file decompresses to the same
+ * bytes as the uncompressed one.
+ */
+class PcapNgGzipTestCase : public TestCase
+{
+public:
+  PcapNgGzipTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapNgGzipTestCase::PcapNgGzipTestCase ()
+  : TestCase ("Check gzip compressed pcapng output")
+{
+}
+
+void
+PcapNgGzipTestCase::DoRun (void)
+{
+  std::string plain = CreateTempDirFilename ("plain.pcapng");
+  std::string compressed = CreateTempDirFilename ("compressed.pcapng.gz");
+  uint8_t data[1500];
+  std::memset (data, 0xab, sizeof (data));
+
+  for (uint32_t pass = 0; pass < 2; ++pass)
+    {
+      PcapNgFile f;
+      f.Open (pass == 0 ? plain : compressed,
+              pass == 0 ? PcapNgFile::COMPRESSION_NONE : PcapNgFile::COMPRESSION_GZIP);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Unable to open file");
+      uint32_t id = f.AddInterface (1, 1500, "eth");
+      // Enough data to go through several staging buffer flushes
+      for (uint32_t i = 0; i < 200; ++i)
+        {
+          f.Write (id, i * 1000, data, 1 + i * 7);
+        }
+      f.Close ();
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Error writing file");
+    }
+
+  std::vector<uint8_t> expected = ReadFile (plain);
+  std::vector<uint8_t> actual;
+  gzFile gz = gzopen (compressed.c_str (), "rb");
+  NS_TEST_ASSERT_MSG_NE (gz, 0, "Unable to open " << compressed);
+  uint8_t chunk[4096];
+  int n;
+  while ((n = gzread (gz, chunk, sizeof (chunk))) > 0)
+    {
+      actual.insert (actual.end (), chunk, chunk + n);
+    }
+  gzclose (gz);
+  NS_TEST_EXPECT_MSG_LT (ReadFile (compressed).size (), expected.size (), "File not compressed");
+  NS_TEST_ASSERT_MSG_EQ (actual.size (), expected.size (), "Decompressed size differs");
+  NS_TEST_EXPECT_MSG_EQ ((actual == expected), true, "Decompressed contents differ");
+}
+#endif /* HAVE_ZLIB */
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief pcapng file TestSuite
+ */
+class PcapNgFileTestSuite : public TestSuite
+{
+public:
+  PcapNgFileTestSuite ();
+};
+
+PcapNgFileTestSuite::PcapNgFileTestSuite ()
+  : TestSuite ("pcapng-file", UNIT)
+{
+  AddTestCase (new PcapNgWriteTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgRedirectTestCase, TestCase::QUICK);
+  AddTestCase (new PcapNgFatalErrorTestCase, TestCase::QUICK);
+#ifdef HAVE_ZLIB
+  AddTestCase (new PcapNgGzipTestCase, TestCase::QUICK);
+#endif
+}
+
+static PcapNgFileTestSuite pcapNgFileTestSuite; //!< Static variable for test initialization
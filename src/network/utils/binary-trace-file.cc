@@ -0,0 +1,514 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/packet.h"
+#include "binary-trace-file.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceFile");
+
+static const char MAGIC[8] = { 'n', 's', '3', 'b', 't', 'r', 'c', '\0' }; //!< File magic
+static const uint32_t VERSION = 1;                                        //!< File format version
+
+/**
+ * \brief Append a value to a byte vector.
+ * \param v the vector
+ * \param value the value
+ */
+template <typename T>
+static void
+AppendValue (std::vector<uint8_t> &v, T value)
+{
+  uint8_t const *bytes = reinterpret_cast<uint8_t const *> (&value);
+  v.insert (v.end (), bytes, bytes + sizeof (T));
+}
+
+/**
+ * \brief Append a column to a byte vector.
+ * \param v the vector
+ * \param column the column
+ */
+template <typename T>
+static void
+AppendColumn (std::vector<uint8_t> &v, std::vector<T> const &column)
+{
+  if (!column.empty ())
+    {
+      uint8_t const *bytes = reinterpret_cast<uint8_t const *> (&column[0]);
+      v.insert (v.end (), bytes, bytes + column.size () * sizeof (T));
+    }
+}
+
+/**
+ * \brief Read a value from a byte vector.
+ * \param v the vector
+ * \param offset the offset of the value
+ * \returns the value
+ */
+template <typename T>
+static T
+ReadValue (std::vector<uint8_t> const &v, std::size_t offset)
+{
+  T value;
+  std::memcpy (&value, &v[offset], sizeof (T));
+  return value;
+}
+
+const uint32_t BinaryTrace::NO_CONTEXT;
+const uint32_t BinaryTrace::UNKNOWN;
+
+char
+BinaryTrace::GetEventCharacter (EventType type)
+{
+  switch (type)
+    {
+    case ENQUEUE:
+      return '+';
+    case DEQUEUE:
+      return '-';
+    case DROP:
+      return 'd';
+    case RECEIVE:
+      return 'r';
+    case TRANSMIT:
+      return 't';
+    }
+  return '?';
+}
+
+BinaryTraceWriter::BinaryTraceWriter (std::ostream *os, BinaryTrace::Detail detail, uint32_t blockSize)
+  : m_os (os),
+    m_detail (detail),
+    m_blockSize (blockSize),
+    m_fatalErrorBuf (this),
+    m_fatalErrorStream (&m_fatalErrorBuf)
+{
+  NS_LOG_FUNCTION (this << os << detail << blockSize);
+  NS_ASSERT (blockSize > 0);
+  // flushing m_os alone would lose the pending events
+  FatalImpl::RegisterStream (&m_fatalErrorStream);
+  m_os->write (MAGIC, sizeof (MAGIC));
+  uint32_t header[2] = { VERSION, static_cast<uint32_t> (detail) };
+  m_os->write (reinterpret_cast<const char *> (header), sizeof (header));
+}
+
+BinaryTraceWriter::~BinaryTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  // the stream may already be destroyed: the pending events are written
+  // by Flush, at Simulator::Destroy, or by the owner of the stream
+  FatalImpl::UnregisterStream (&m_fatalErrorStream);
+  Simulator::Cancel (m_destroyEvent);
+}
+
+BinaryTraceWriter::FatalErrorBuf::FatalErrorBuf (BinaryTraceWriter *writer)
+  : m_writer (writer)
+{
+}
+
+int
+BinaryTraceWriter::FatalErrorBuf::sync (void)
+{
+  m_writer->Flush ();
+  return 0;
+}
+
+void
+BinaryTraceWriter::Record (BinaryTrace::EventType type, std::string const &context, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << type << context << p);
+  DoRecord (type, InternContext (context), p);
+}
+
+void
+BinaryTraceWriter::Record (BinaryTrace::EventType type, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << type << p);
+  DoRecord (type, BinaryTrace::NO_CONTEXT, p);
+}
+
+void
+BinaryTraceWriter::DoRecord (BinaryTrace::EventType type, uint32_t context, Ptr<const Packet> p)
+{
+  if (m_time.empty () && m_destroyEvent.IsExpired ())
+    {
+      m_destroyEvent = Simulator::ScheduleDestroy (&BinaryTraceWriter::DestroyFlush, this);
+    }
+  m_time.push_back (Simulator::Now ().GetNanoSeconds ());
+  m_context.push_back (context);
+  if (context == BinaryTrace::NO_CONTEXT)
+    {
+      m_node.push_back (BinaryTrace::UNKNOWN);
+      m_device.push_back (BinaryTrace::UNKNOWN);
+    }
+  else
+    {
+      m_node.push_back (m_contextNodes[context].first);
+      m_device.push_back (m_contextNodes[context].second);
+    }
+  m_uid.push_back (p->GetUid ());
+  m_size.push_back (p->GetSize ());
+  m_type.push_back (static_cast<uint8_t> (type));
+
+  std::size_t start = m_details.size ();
+  if (m_detail == BinaryTrace::FULL_PACKET)
+    {
+      uint32_t size = p->GetSerializedSize ();
+      m_details.resize (start + size);
+      p->Serialize (&m_details[start], size);
+    }
+  else
+    {
+      AppendSummary (p);
+    }
+  m_detailSize.push_back (m_details.size () - start);
+
+  if (m_time.size () >= m_blockSize)
+    {
+      WriteEvents ();
+    }
+}
+
+void
+BinaryTraceWriter::AppendSummary (Ptr<const Packet> p)
+{
+  PacketMetadata::ItemIterator i = p->BeginItem ();
+  while (i.HasNext ())
+    {
+      PacketMetadata::Item item = i.Next ();
+      if (item.type != PacketMetadata::Item::PAYLOAD)
+        {
+          uint16_t uid = item.tid.GetUid ();
+          InternTypeName (uid);
+          AppendValue (m_details, uid);
+        }
+    }
+}
+
+uint32_t
+BinaryTraceWriter::InternContext (std::string const &context)
+{
+  std::unordered_map<std::string, uint32_t>::const_iterator it = m_contexts.find (context);
+  if (it != m_contexts.end ())
+    {
+      return it->second;
+    }
+
+  uint32_t id = m_contextNodes.size ();
+  m_contexts[context] = id;
+
+  //
+  // Device trace contexts look like /NodeList/<node>/DeviceList/<device>/...
+  //
+  std::pair<uint32_t, uint32_t> ids (BinaryTrace::UNKNOWN, BinaryTrace::UNKNOWN);
+  std::string::size_type pos = context.find ("/NodeList/");
+  if (pos != std::string::npos)
+    {
+      char *end;
+      ids.first = std::strtoul (context.c_str () + pos + 10, &end, 10);
+      if (std::strncmp (end, "/DeviceList/", 12) == 0)
+        {
+          ids.second = std::strtoul (end + 12, 0, 10);
+        }
+    }
+  m_contextNodes.push_back (ids);
+
+  std::vector<uint8_t> payload;
+  AppendValue (payload, id);
+  AppendValue (payload, static_cast<uint32_t> (context.size ()));
+  payload.insert (payload.end (), context.begin (), context.end ());
+  WriteBlock (BinaryTrace::BLOCK_CONTEXT, payload);
+  return id;
+}
+
+void
+BinaryTraceWriter::InternTypeName (uint16_t uid)
+{
+  if (uid < m_typeNames.size () && m_typeNames[uid])
+    {
+      return;
+    }
+  if (uid >= m_typeNames.size ())
+    {
+      m_typeNames.resize (uid + 1, false);
+    }
+  m_typeNames[uid] = true;
+
+  TypeId tid;
+  tid.SetUid (uid);
+  std::string name = tid.GetName ();
+  std::vector<uint8_t> payload;
+  AppendValue (payload, uid);
+  AppendValue (payload, static_cast<uint16_t> (name.size ()));
+  payload.insert (payload.end (), name.begin (), name.end ());
+  WriteBlock (BinaryTrace::BLOCK_TYPE_NAME, payload);
+}
+
+void
+BinaryTraceWriter::WriteBlock (BinaryTrace::BlockType type, std::vector<uint8_t> const &payload)
+{
+  uint32_t header[2] = { static_cast<uint32_t> (type), static_cast<uint32_t> (payload.size ()) };
+  m_os->write (reinterpret_cast<const char *> (header), sizeof (header));
+  if (!payload.empty ())
+    {
+      m_os->write (reinterpret_cast<const char *> (&payload[0]), payload.size ());
+    }
+}
+
+void
+BinaryTraceWriter::WriteEvents (void)
+{
+  NS_LOG_FUNCTION (this << m_time.size ());
+  if (m_time.empty ())
+    {
+      return;
+    }
+  uint32_t count = m_time.size ();
+  std::vector<uint8_t> payload;
+  payload.reserve (4 + count * 37 + m_details.size ());
+  AppendValue (payload, count);
+  AppendColumn (payload, m_time);
+  AppendColumn (payload, m_context);
+  AppendColumn (payload, m_node);
+  AppendColumn (payload, m_device);
+  AppendColumn (payload, m_uid);
+  AppendColumn (payload, m_size);
+  AppendColumn (payload, m_detailSize);
+  AppendColumn (payload, m_type);
+  AppendColumn (payload, m_details);
+  WriteBlock (BinaryTrace::BLOCK_EVENTS, payload);
+
+  m_time.clear ();
+  m_context.clear ();
+  m_node.clear ();
+  m_device.clear ();
+  m_uid.clear ();
+  m_size.clear ();
+  m_detailSize.clear ();
+  m_type.clear ();
+  m_details.clear ();
+}
+
+void
+BinaryTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  WriteEvents ();
+  m_os->flush ();
+}
+
+void
+BinaryTraceWriter::DestroyFlush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_destroyEvent = EventId ();
+  Flush ();
+}
+
+BinaryTraceReader::BinaryTraceReader (std::istream *is)
+  : m_is (is),
+    m_valid (false),
+    m_detail (BinaryTrace::SUMMARY),
+    m_count (0),
+    m_next (0),
+    m_detailOffset (0)
+{
+  NS_LOG_FUNCTION (this << is);
+  char magic[sizeof (MAGIC)];
+  uint32_t header[2];
+  m_is->read (magic, sizeof (magic));
+  m_is->read (reinterpret_cast<char *> (header), sizeof (header));
+  m_valid = m_is->good () && std::memcmp (magic, MAGIC, sizeof (MAGIC)) == 0 && header[0] == VERSION;
+  if (m_valid)
+    {
+      m_detail = static_cast<BinaryTrace::Detail> (header[1]);
+    }
+}
+
+bool
+BinaryTraceReader::IsValid (void) const
+{
+  return m_valid;
+}
+
+BinaryTrace::Detail
+BinaryTraceReader::GetDetail (void) const
+{
+  return m_detail;
+}
+
+bool
+BinaryTraceReader::ReadBlock (void)
+{
+  while (m_valid)
+    {
+      uint32_t header[2];
+      m_is->read (reinterpret_cast<char *> (header), sizeof (header));
+      if (!m_is->good ())
+        {
+          return false;
+        }
+      std::vector<uint8_t> payload (header[1]);
+      if (header[1] > 0)
+        {
+          m_is->read (reinterpret_cast<char *> (&payload[0]), header[1]);
+          if (!m_is->good ())
+            {
+              return false;
+            }
+        }
+
+      switch (header[0])
+        {
+        case BinaryTrace::BLOCK_CONTEXT:
+          {
+            uint32_t id = ReadValue<uint32_t> (payload, 0);
+            uint32_t size = ReadValue<uint32_t> (payload, 4);
+            if (id >= m_contexts.size ())
+              {
+                m_contexts.resize (id + 1);
+              }
+            m_contexts[id].assign (payload.begin () + 8, payload.begin () + 8 + size);
+          }
+          break;
+        case BinaryTrace::BLOCK_TYPE_NAME:
+          {
+            uint16_t id = ReadValue<uint16_t> (payload, 0);
+            uint16_t size = ReadValue<uint16_t> (payload, 2);
+            m_typeNames[id].assign (payload.begin () + 4, payload.begin () + 4 + size);
+          }
+          break;
+        case BinaryTrace::BLOCK_EVENTS:
+          m_payload.swap (payload);
+          m_count = ReadValue<uint32_t> (m_payload, 0);
+          m_next = 0;
+          m_detailOffset = 4 + m_count * 37;
+          return true;
+        default:
+          // Unknown blocks are skipped, for forward compatibility
+          break;
+        }
+    }
+  return false;
+}
+
+bool
+BinaryTraceReader::Next (BinaryTrace::Event &event)
+{
+  while (m_next >= m_count)
+    {
+      if (!ReadBlock ())
+        {
+          return false;
+        }
+    }
+
+  std::size_t n = m_count;
+  std::size_t i = m_next++;
+  event.time = ReadValue<int64_t> (m_payload, 4 + i * 8);
+  event.context = ReadValue<uint32_t> (m_payload, 4 + n * 8 + i * 4);
+  event.node = ReadValue<uint32_t> (m_payload, 4 + n * 12 + i * 4);
+  event.device = ReadValue<uint32_t> (m_payload, 4 + n * 16 + i * 4);
+  event.uid = ReadValue<uint64_t> (m_payload, 4 + n * 20 + i * 8);
+  event.size = ReadValue<uint32_t> (m_payload, 4 + n * 28 + i * 4);
+  uint32_t detailSize = ReadValue<uint32_t> (m_payload, 4 + n * 32 + i * 4);
+  event.type = static_cast<BinaryTrace::EventType> (m_payload[4 + n * 36 + i]);
+  event.detail.assign (m_payload.begin () + m_detailOffset,
+                       m_payload.begin () + m_detailOffset + detailSize);
+  m_detailOffset += detailSize;
+  return true;
+}
+
+std::string
+BinaryTraceReader::GetContext (uint32_t id) const
+{
+  if (id < m_contexts.size ())
+    {
+      return m_contexts[id];
+    }
+  return "";
+}
+
+std::vector<std::string>
+BinaryTraceReader::GetTypeNames (BinaryTrace::Event const &event) const
+{
+  std::vector<std::string> names;
+  if (m_detail != BinaryTrace::SUMMARY)
+    {
+      return names;
+    }
+  for (std::size_t offset = 0; offset + 2 <= event.detail.size (); offset += 2)
+    {
+      std::map<uint16_t, std::string>::const_iterator it =
+        m_typeNames.find (ReadValue<uint16_t> (event.detail, offset));
+      names.push_back (it != m_typeNames.end () ? it->second : "?");
+    }
+  return names;
+}
+
+void
+BinaryTraceReader::PrintAscii (BinaryTrace::Event const &event, std::ostream &os) const
+{
+  os << BinaryTrace::GetEventCharacter (event.type) << " "
+     << NanoSeconds (event.time).GetSeconds () << " ";
+  if (event.context != BinaryTrace::NO_CONTEXT)
+    {
+      os << GetContext (event.context) << " ";
+    }
+  if (m_detail == BinaryTrace::FULL_PACKET)
+    {
+      Ptr<Packet> p = event.detail.empty () ? Create<Packet> ()
+        : Create<Packet> (event.detail.data (), event.detail.size (), true);
+      os << *p;
+    }
+  else
+    {
+      std::vector<std::string> names = GetTypeNames (event);
+      for (std::vector<std::string>::const_iterator i = names.begin (); i != names.end (); ++i)
+        {
+          os << *i << " ";
+        }
+      os << "uid=" << event.uid << " size=" << event.size;
+    }
+  os << std::endl;
+}
+
+bool
+BinaryTraceReader::ConvertToAscii (std::istream &in, std::ostream &out)
+{
+  NS_LOG_FUNCTION (&in << &out);
+  BinaryTraceReader reader (&in);
+  if (!reader.IsValid ())
+    {
+      return false;
+    }
+  BinaryTrace::Event event;
+  while (reader.Next (event))
+    {
+      reader.PrintAscii (event, out);
+    }
+  return true;
+}
+
+} // namespace ns3
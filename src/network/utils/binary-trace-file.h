@@ -0,0 +1,329 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_FILE_H
+#define BINARY_TRACE_FILE_H
+
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * \brief Columnar binary encoding of the device trace events written by
+ * AsciiTraceHelper, and of the IP trace events written by InternetStackHelper.
+ *
+ * The ascii trace sinks format every enqueue, dequeue, drop and receive
+ * event with Packet::Print, which dominates the run time of simulations
+ * that trace the whole network.  The binary trace stores the same events
+ * as fixed-width columns (time, node, device, event type, packet uid and
+ * size) plus a per-packet detail record, in blocks of a few thousand
+ * events.  Trace contexts and header type names are dictionary-encoded,
+ * so each distinct string is written once.
+ *
+ * The detail record holds either a summary (the list of headers and
+ * trailers in the packet) or the complete serialized packet.  In the
+ * latter case BinaryTraceReader::ConvertToAscii reproduces the ascii
+ * trace byte for byte, off-line.
+ *
+ * File layout (all integers in host byte order):
+ * \verbatim
+ *   file      := magic(8) version(u32) detail(u32) block*
+ *   block     := type(u32) length(u32) payload(length)
+ *   CONTEXT   := id(u32) size(u32) chars(size)
+ *   TYPE_NAME := id(u16) size(u16) chars(size)
+ *   EVENTS    := count(u32) time(i64)[count] context(u32)[count]
+ *                node(u32)[count] device(u32)[count] uid(u64)[count]
+ *                size(u32)[count] detailSize(u32)[count] type(u8)[count]
+ *                detail bytes
+ * \endverbatim
+ */
+class BinaryTrace
+{
+public:
+  /// Trace event, with the ascii trace character in comments
+  enum EventType
+  {
+    ENQUEUE = 0, //!< '+'
+    DEQUEUE,     //!< '-'
+    DROP,        //!< 'd'
+    RECEIVE,     //!< 'r'
+    TRANSMIT     //!< 't', written by the InternetStackHelper sinks
+  };
+
+  /// Per-packet information stored with each event
+  enum Detail
+  {
+    SUMMARY = 0,  //!< Header and trailer type names
+    FULL_PACKET   //!< Serialized packet, enough to rebuild the ascii trace
+  };
+
+  /// Block types
+  enum BlockType
+  {
+    BLOCK_CONTEXT = 1,   //!< Context dictionary entry
+    BLOCK_TYPE_NAME = 2, //!< Header type name dictionary entry
+    BLOCK_EVENTS = 3     //!< Block of events
+  };
+
+  static const uint32_t NO_CONTEXT = 0xffffffff; //!< Context id of events traced without context
+  static const uint32_t UNKNOWN = 0xffffffff;    //!< Node or device id not found in the context
+
+  /// A decoded trace event
+  struct Event
+  {
+    EventType type;               //!< Event type
+    int64_t time;                 //!< Simulation time, in nanoseconds
+    uint32_t context;             //!< Context id, or NO_CONTEXT
+    uint32_t node;                //!< Node id, or UNKNOWN
+    uint32_t device;              //!< Device index, or UNKNOWN
+    uint64_t uid;                 //!< Packet uid
+    uint32_t size;                //!< Packet size
+    std::vector<uint8_t> detail;  //!< Summary or serialized packet
+  };
+
+  /**
+   * \param type event type
+   * \returns the ascii trace character of the event
+   */
+  static char GetEventCharacter (EventType type);
+};
+
+/**
+ * \brief Writes trace events to a columnar binary trace
+ *
+ * The events are buffered in blocks, which are written to the stream
+ * when they are full, when Flush () is called, at Simulator::Destroy,
+ * and on a fatal error.  The writer does not own the stream, so its
+ * destructor does not write the pending events.
+ *
+ * \see BinaryTrace
+ */
+class BinaryTraceWriter : public SimpleRefCount<BinaryTraceWriter>
+{
+public:
+  /**
+   * \param os the stream to write to; it must outlive the writer.
+   * \param detail per-packet information to store
+   * \param blockSize number of events per block
+   */
+  BinaryTraceWriter (std::ostream *os, BinaryTrace::Detail detail = BinaryTrace::SUMMARY,
+                     uint32_t blockSize = 4096);
+  ~BinaryTraceWriter ();
+
+  /**
+   * \brief Record an event traced with a context
+   *
+   * \param type event type
+   * \param context trace context, such as
+   *        "/NodeList/0/DeviceList/1/$ns3::PointToPointNetDevice/MacRx"
+   * \param p the packet
+   */
+  void Record (BinaryTrace::EventType type, std::string const &context, Ptr<const Packet> p);
+
+  /**
+   * \brief Record an event traced without context
+   *
+   * \param type event type
+   * \param p the packet
+   */
+  void Record (BinaryTrace::EventType type, Ptr<const Packet> p);
+
+  /**
+   * Write the events of the current block and flush the stream.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * \brief A stream buffer which flushes the writer when it is synchronized.
+   *
+   * The stream which uses it is registered with FatalImpl, so that the
+   * pending events are written before the simulation aborts on a fatal
+   * error.
+   */
+  class FatalErrorBuf : public std::streambuf
+  {
+  public:
+    /**
+     * \param writer the writer to flush on a fatal error
+     */
+    FatalErrorBuf (BinaryTraceWriter *writer);
+
+  private:
+    /**
+     * \brief Flush the writer
+     * \return 0
+     */
+    virtual int sync (void);
+
+    BinaryTraceWriter *m_writer; //!< The writer to flush
+  };
+
+  /// Flush the writer at Simulator::Destroy
+  void DestroyFlush (void);
+  /**
+   * \brief Record an event
+   * \param type event type
+   * \param context context id
+   * \param p the packet
+   */
+  void DoRecord (BinaryTrace::EventType type, uint32_t context, Ptr<const Packet> p);
+  /**
+   * \param context a trace context
+   * \returns the context id, writing a dictionary block the first time
+   */
+  uint32_t InternContext (std::string const &context);
+  /**
+   * \brief Write the dictionary block of a type name, the first time it is used.
+   * \param uid a TypeId uid, which is also the type name id in the trace
+   */
+  void InternTypeName (uint16_t uid);
+  /**
+   * \brief Append the summary of a packet to the detail column.
+   * \param p the packet
+   */
+  void AppendSummary (Ptr<const Packet> p);
+  /**
+   * \brief Write a block.
+   * \param type block type
+   * \param payload block payload
+   */
+  void WriteBlock (BinaryTrace::BlockType type, std::vector<uint8_t> const &payload);
+  /// Write the pending events as an event block.
+  void WriteEvents (void);
+
+  std::ostream *m_os;                 //!< Output stream
+  BinaryTrace::Detail m_detail;       //!< Per-packet information to store
+  uint32_t m_blockSize;               //!< Number of events per block
+
+  std::vector<int64_t> m_time;        //!< Time column
+  std::vector<uint32_t> m_context;    //!< Context column
+  std::vector<uint32_t> m_node;       //!< Node column
+  std::vector<uint32_t> m_device;     //!< Device column
+  std::vector<uint64_t> m_uid;        //!< Packet uid column
+  std::vector<uint32_t> m_size;       //!< Packet size column
+  std::vector<uint32_t> m_detailSize; //!< Detail size column
+  std::vector<uint8_t> m_type;        //!< Event type column
+  std::vector<uint8_t> m_details;     //!< Concatenated detail records
+
+  /// Node and device ids parsed from each interned context
+  std::vector<std::pair<uint32_t, uint32_t> > m_contextNodes;
+  std::unordered_map<std::string, uint32_t> m_contexts; //!< Interned contexts
+  std::vector<bool> m_typeNames;                        //!< TypeId uids whose name has been written
+
+  EventId m_destroyEvent;             //!< Flush at Simulator::Destroy
+  FatalErrorBuf m_fatalErrorBuf;      //!< Flushes the writer on a fatal error
+  std::ostream m_fatalErrorStream;    //!< Stream registered with FatalImpl
+};
+
+/**
+ * \brief Reads back a columnar binary trace
+ *
+ * \see BinaryTrace
+ */
+class BinaryTraceReader
+{
+public:
+  /**
+   * \param is the stream to read from; it must outlive the reader.
+   */
+  BinaryTraceReader (std::istream *is);
+
+  /**
+   * \returns true if the stream starts with a valid binary trace header
+   */
+  bool IsValid (void) const;
+
+  /**
+   * \returns the per-packet information stored in the trace
+   */
+  BinaryTrace::Detail GetDetail (void) const;
+
+  /**
+   * \brief Read the next event.
+   * \param [out] event the event
+   * \returns false at the end of the trace
+   */
+  bool Next (BinaryTrace::Event &event);
+
+  /**
+   * \param id a context id
+   * \returns the context string
+   */
+  std::string GetContext (uint32_t id) const;
+
+  /**
+   * \param event an event read from this trace
+   * \returns the names of the headers and trailers of the packet, if the
+   *          trace stores summaries
+   */
+  std::vector<std::string> GetTypeNames (BinaryTrace::Event const &event) const;
+
+  /**
+   * \brief Print an event in the format of the AsciiTraceHelper default sinks.
+   *
+   * With full packets, the output is identical to the ascii trace.  With
+   * summaries, the packet is printed as its header and trailer names
+   * followed by its uid and size.
+   *
+   * \param event an event read from this trace
+   * \param os the output stream
+   */
+  void PrintAscii (BinaryTrace::Event const &event, std::ostream &os) const;
+
+  /**
+   * \brief Convert a whole binary trace to the ascii trace format.
+   *
+   * \param in the binary trace
+   * \param out the ascii output
+   * \returns false if the input is not a binary trace
+   */
+  static bool ConvertToAscii (std::istream &in, std::ostream &out);
+
+private:
+  /**
+   * \brief Read the next block into the event columns.
+   * \returns false at the end of the trace
+   */
+  bool ReadBlock (void);
+
+  std::istream *m_is;                 //!< Input stream
+  bool m_valid;                       //!< Header found
+  BinaryTrace::Detail m_detail;       //!< Per-packet information stored
+
+  uint32_t m_count;                   //!< Events in the current block
+  uint32_t m_next;                    //!< Next event in the current block
+  uint32_t m_detailOffset;            //!< Offset of the next detail record
+  std::vector<uint8_t> m_payload;     //!< Current event block
+
+  std::vector<std::string> m_contexts;           //!< Context dictionary
+  std::map<uint16_t, std::string> m_typeNames;   //!< Type name dictionary
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_FILE_H */
@@ -30,6 +30,8 @@ namespace ns3 {
  * \param length the length of the buffer (bytes)
  * \returns the computed crc-32.
  *
+ * Long buffers are processed with carry-less multiplications, when the
+ * CPU supports them (see ChecksumKernel).
  */
 uint32_t CRC32Calculate (const uint8_t *data, int length);
 
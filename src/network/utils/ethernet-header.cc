@@ -23,6 +23,7 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/header.h"
+#include "ns3/header-image.h"
 #include "ethernet-header.h"
 #include "address-utils.h"
 
@@ -165,10 +166,18 @@ EthernetHeader::Serialize (Buffer::Iterator start) const
   if (m_enPreambleSfd)
     {
       i.WriteU64 (m_preambleSfd);
+      WriteTo (i, m_destination);
+      WriteTo (i, m_source);
+      i.WriteHtonU16 (m_lengthType);
+      return;
     }
-  WriteTo (i, m_destination);
-  WriteTo (i, m_source);
-  i.WriteHtonU16 (m_lengthType);
+
+  // Fast path: the header is two addresses and the length/type field
+  static const uint8_t image[2*MAC_ADDR_SIZE + LENGTH_SIZE] = { 0 };
+  uint8_t *data = i.WriteImage (image, sizeof (image));
+  m_destination.CopyTo (data);
+  m_source.CopyTo (data + MAC_ADDR_SIZE);
+  HeaderImage::WriteHtonU16 (data + 2*MAC_ADDR_SIZE, m_lengthType);
 }
 uint32_t
 EthernetHeader::Deserialize (Buffer::Iterator start)
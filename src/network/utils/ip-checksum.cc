@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ip-checksum.h"
+#include "ns3/abort.h"
+#include "ns3/unused.h"
+
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+#define NS3_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \param data pointer to four bytes
+ * \returns the bytes as a little endian 32-bit word
+ */
+inline uint32_t
+ReadLe32 (const uint8_t *data)
+{
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t> (data[3]) << 24);
+}
+
+/**
+ * \brief Sum a buffer as little endian 32-bit words.
+ *
+ * As 2^16 = 1 modulo 2^16 - 1, summing 32-bit words gives the same one's
+ * complement sum as summing their 16-bit halves.
+ *
+ * \param data buffer to sum
+ * \param length the length of the buffer (bytes)
+ * \returns the unfolded sum
+ */
+uint64_t
+SumScalar (const uint8_t *data, uint32_t length)
+{
+  uint64_t sum = 0;
+  while (length >= 8)
+    {
+      sum += ReadLe32 (data);
+      sum += ReadLe32 (data + 4);
+      data += 8;
+      length -= 8;
+    }
+  while (length >= 2)
+    {
+      sum += data[0] | (data[1] << 8);
+      data += 2;
+      length -= 2;
+    }
+  if (length)
+    {
+      sum += data[0];
+    }
+  return sum;
+}
+
+#ifdef NS3_CHECKSUM_X86
+
+/**
+ * \brief Sum a buffer with SSE2, 32 bytes at a time.
+ * \param data buffer to sum
+ * \param length the length of the buffer (bytes)
+ * \returns the unfolded sum
+ */
+__attribute__ ((target ("sse2"))) uint64_t
+SumSse2 (const uint8_t *data, uint32_t length)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  __m128i acc0 = zero;
+  __m128i acc1 = zero;
+  while (length >= 32)
+    {
+      __m128i x = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+      __m128i y = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data + 16));
+      // zero-extend the 32-bit words to 64 bits, so that the sums cannot overflow
+      acc0 = _mm_add_epi64 (acc0, _mm_unpacklo_epi32 (x, zero));
+      acc1 = _mm_add_epi64 (acc1, _mm_unpackhi_epi32 (x, zero));
+      acc0 = _mm_add_epi64 (acc0, _mm_unpacklo_epi32 (y, zero));
+      acc1 = _mm_add_epi64 (acc1, _mm_unpackhi_epi32 (y, zero));
+      data += 32;
+      length -= 32;
+    }
+  uint64_t lanes[2];
+  _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), _mm_add_epi64 (acc0, acc1));
+  return lanes[0] + lanes[1] + SumScalar (data, length);
+}
+
+/**
+ * \brief Sum a buffer with AVX2, 64 bytes at a time.
+ * \param data buffer to sum
+ * \param length the length of the buffer (bytes)
+ * \returns the unfolded sum
+ */
+__attribute__ ((target ("avx2"))) uint64_t
+SumAvx2 (const uint8_t *data, uint32_t length)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  __m256i acc0 = zero;
+  __m256i acc1 = zero;
+  while (length >= 64)
+    {
+      __m256i x = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data));
+      __m256i y = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data + 32));
+      acc0 = _mm256_add_epi64 (acc0, _mm256_unpacklo_epi32 (x, zero));
+      acc1 = _mm256_add_epi64 (acc1, _mm256_unpackhi_epi32 (x, zero));
+      acc0 = _mm256_add_epi64 (acc0, _mm256_unpacklo_epi32 (y, zero));
+      acc1 = _mm256_add_epi64 (acc1, _mm256_unpackhi_epi32 (y, zero));
+      data += 64;
+      length -= 64;
+    }
+  uint64_t lanes[4];
+  _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), _mm256_add_epi64 (acc0, acc1));
+  // avoid the penalty of SSE instructions following AVX ones in the caller
+  _mm256_zeroupper ();
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + SumScalar (data, length);
+}
+
+#endif /* NS3_CHECKSUM_X86 */
+
+/**
+ * \returns the fastest kernel supported by the CPU
+ */
+ChecksumKernel
+GetBestChecksumKernel (void)
+{
+  if (IsChecksumKernelSupported (CHECKSUM_KERNEL_AVX2))
+    {
+      return CHECKSUM_KERNEL_AVX2;
+    }
+  if (IsChecksumKernelSupported (CHECKSUM_KERNEL_SSE))
+    {
+      return CHECKSUM_KERNEL_SSE;
+    }
+  return CHECKSUM_KERNEL_SCALAR;
+}
+
+/**
+ * \returns the kernel in use
+ */
+ChecksumKernel &
+GetKernel (void)
+{
+  static ChecksumKernel kernel = GetBestChecksumKernel ();
+  return kernel;
+}
+
+} // unnamed namespace
+
+bool
+IsChecksumKernelSupported (ChecksumKernel kernel)
+{
+#ifdef NS3_CHECKSUM_X86
+  // the kernel may be chosen during static initialization, before the
+  // runtime has detected the CPU features
+  static bool cpuInitialized = (__builtin_cpu_init (), true);
+  NS_UNUSED (cpuInitialized);
+#endif
+  switch (kernel)
+    {
+    case CHECKSUM_KERNEL_SCALAR:
+      return true;
+#ifdef NS3_CHECKSUM_X86
+    case CHECKSUM_KERNEL_SSE:
+      return __builtin_cpu_supports ("sse4.2") && __builtin_cpu_supports ("pclmul");
+    case CHECKSUM_KERNEL_AVX2:
+      return __builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("pclmul");
+#endif
+    default:
+      return false;
+    }
+}
+
+ChecksumKernel
+GetChecksumKernel (void)
+{
+  return GetKernel ();
+}
+
+void
+SetChecksumKernel (ChecksumKernel kernel)
+{
+  NS_ABORT_MSG_UNLESS (IsChecksumKernelSupported (kernel),
+                       "Checksum kernel " << kernel << " not supported by this CPU");
+  GetKernel () = kernel;
+}
+
+uint16_t
+IpChecksumCalculate (const uint8_t *data, uint32_t length)
+{
+  uint64_t sum;
+  switch (GetKernel ())
+    {
+#ifdef NS3_CHECKSUM_X86
+    case CHECKSUM_KERNEL_AVX2:
+      sum = SumAvx2 (data, length);
+      break;
+    case CHECKSUM_KERNEL_SSE:
+      sum = SumSse2 (data, length);
+      break;
+#endif
+    default:
+      sum = SumScalar (data, length);
+      break;
+    }
+  // fold with end-around carries
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffffffff) + (sum >> 32);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  sum = (sum & 0xffff) + (sum >> 16);
+  return static_cast<uint16_t> (sum);
+}
+
+} // namespace ns3
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IP_CHECKSUM_H
+#define IP_CHECKSUM_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * Implementations of the Internet checksum (IpChecksumCalculate) and
+ * CRC-32 (CRC32Calculate) kernels.
+ *
+ * The fastest kernel supported by the CPU is selected at run time; all of
+ * them return the same results.  The vector kernels are only available on
+ * x86 processors, with GCC-compatible compilers.
+ */
+enum ChecksumKernel
+{
+  CHECKSUM_KERNEL_SCALAR = 0, //!< Portable C
+  CHECKSUM_KERNEL_SSE,        //!< SSE2 Internet checksum, PCLMULQDQ CRC-32; needs SSE4.2 and PCLMULQDQ
+  CHECKSUM_KERNEL_AVX2        //!< AVX2 Internet checksum, PCLMULQDQ CRC-32; needs AVX2 and PCLMULQDQ
+};
+
+/**
+ * \ingroup packet
+ * \param kernel a checksum kernel
+ * \returns true if the kernel can run on this CPU
+ */
+bool IsChecksumKernelSupported (ChecksumKernel kernel);
+
+/**
+ * \ingroup packet
+ * \returns the checksum kernel in use
+ */
+ChecksumKernel GetChecksumKernel (void);
+
+/**
+ * \ingroup packet
+ * \brief Select the checksum kernel, e.g., to compare their results or speed
+ *
+ * By default, the fastest kernel supported by the CPU is used.
+ *
+ * \param kernel a checksum kernel supported by the CPU
+ */
+void SetChecksumKernel (ChecksumKernel kernel);
+
+/**
+ * \ingroup packet
+ * \brief Calculates the one's complement sum of a buffer (see RFC 1071)
+ *
+ * The buffer is summed as a sequence of 16-bit words, the first byte of each
+ * word being the least significant one; an odd trailing byte is summed as a
+ * word whose most significant byte is zero.  This is the order in which
+ * Buffer::Iterator::CalculateIpChecksum reads the data.
+ *
+ * \param data buffer to sum
+ * \param length the length of the buffer (bytes)
+ * \returns the one's complement sum, not complemented, folded to 16 bits
+ */
+uint16_t IpChecksumCalculate (const uint8_t *data, uint32_t length);
+
+} // namespace ns3
+
+#endif /* IP_CHECKSUM_H */
@@ -49,6 +49,12 @@ OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_destroyable && m_binaryWriter != 0)
+    {
+      // the stream is still open only when the wrapper owns it
+      m_binaryWriter->Flush ();
+    }
+  m_binaryWriter = 0;
   FatalImpl::UnregisterStream (m_ostream);
   if (m_destroyable) delete m_ostream;
   m_ostream = 0;
@@ -61,4 +67,17 @@ OutputStreamWrapper::GetStream (void)
   return m_ostream;
 }
 
+void
+OutputStreamWrapper::SetBinaryTraceWriter (Ptr<BinaryTraceWriter> writer)
+{
+  NS_LOG_FUNCTION (this << writer);
+  m_binaryWriter = writer;
+}
+
+BinaryTraceWriter *
+OutputStreamWrapper::GetBinaryTraceWriter (void) const
+{
+  return PeekPointer (m_binaryWriter);
+}
+
 } // namespace ns3
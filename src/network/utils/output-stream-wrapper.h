@@ -23,6 +23,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/simple-ref-count.h"
+#include "binary-trace-file.h"
 
 namespace ns3 {
 
@@ -92,9 +93,25 @@ public:
    */
   std::ostream *GetStream (void);
 
+  /**
+   * Make the trace sinks that honor it record binary trace events through
+   * the given writer, instead of printing text to the stream.  When the
+   * wrapper owns the stream, the writer is flushed and released before
+   * the stream is closed.
+   *
+   * \param writer a writer on the encapsulated stream, or 0
+   */
+  void SetBinaryTraceWriter (Ptr<BinaryTraceWriter> writer);
+
+  /**
+   * \returns the binary trace writer set on this stream, or 0
+   */
+  BinaryTraceWriter *GetBinaryTraceWriter (void) const;
+
 private:
   std::ostream *m_ostream; //!< The output stream
   bool m_destroyable; //!< Can be destroyed
+  Ptr<BinaryTraceWriter> m_binaryWriter; //!< Binary trace writer, if any
 };
 
 } // namespace ns3
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file-wrapper.h"
 
 namespace ns3 {
 
@@ -109,6 +110,24 @@ public:
              uint32_t snapLen = std::numeric_limits<uint32_t>::max (), 
              int32_t tzCorrection = PcapFile::ZONE_DEFAULT);
 
+  /**
+   * Bind this wrapper to one interface of a shared pcapng file instead of
+   * a pcap file of its own.  Once bound, the Write methods append Enhanced
+   * Packet Blocks to the pcapng file, so that device helpers that create
+   * a PcapFileWrapper per device can transparently be multiplexed into a
+   * single capture file.
+   *
+   * \param file The shared pcapng file.
+   * \param dataLinkType The data link type of the new interface.
+   * \param snapLen An optional maximum size for packets captured on the
+   * interface; if not provided, the "CaptureSize" attribute is used.
+   * \param name The name of the new interface.
+   */
+  void Init (Ptr<PcapNgFileWrapper> file,
+             uint32_t dataLinkType,
+             uint32_t snapLen = std::numeric_limits<uint32_t>::max (),
+             std::string const &name = "");
+
   /**
    * \brief Write the next packet to file
    * 
@@ -224,6 +243,8 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  Ptr<PcapNgFileWrapper> m_ngFile; //!< Shared pcapng file, if bound to one
+  uint32_t m_ngInterface; //!< Interface identifier in the shared pcapng file
 };
 
 } // namespace ns3
@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_WRAPPER_H
+#define PCAPNG_FILE_WRAPPER_H
+
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "pcapng-file.h"
+
+namespace ns3 {
+
+class Header;
+
+/**
+ * A class that wraps a PcapNgFile as an ns3::Object, so that a single
+ * pcapng file can be shared by the trace sinks of many devices.  Each
+ * device is declared as a separate interface with AddInterface, and the
+ * file is closed when the last reference to the wrapper goes away.
+ */
+class PcapNgFileWrapper : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  PcapNgFileWrapper ();
+  ~PcapNgFileWrapper ();
+
+  /**
+   * \return true if the underlying file is in an error state.
+   */
+  bool Fail (void) const;
+
+  /**
+   * Create a new pcapng file.
+   *
+   * \param filename String containing the name of the file.
+   * \param compression Streaming compression applied to the file.
+   */
+  void Open (std::string const &filename,
+             PcapNgFile::Compression compression = PcapNgFile::COMPRESSION_NONE);
+
+  /**
+   * Close the underlying pcapng file.
+   */
+  void Close (void);
+
+  /**
+   * Write all buffered blocks to the underlying file.
+   */
+  void Flush (void);
+
+  /**
+   * \brief Declare a new capture interface in the file.
+   *
+   * \param dataLinkType data link type of the interface
+   * \param snapLen maximum length of packet data stored for the interface;
+   * if larger than the CaptureSize attribute, CaptureSize is used instead
+   * \param name interface name stored in the file
+   * \returns the interface identifier
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name);
+
+  /**
+   * \returns the number of interfaces declared in the file
+   */
+  uint32_t GetNInterfaces (void) const;
+
+  /**
+   * \brief Write the next packet to file
+   *
+   * \param interfaceId Interface identifier returned by AddInterface.
+   * \param t Packet timestamp as ns3::Time.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (uint32_t interfaceId, Time t, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided header along with the packet to the pcapng file.
+   *
+   * \param interfaceId Interface identifier returned by AddInterface.
+   * \param t Packet timestamp as ns3::Time.
+   * \param header The Header to prepend to the packet.
+   * \param p Packet to write to the pcapng file.
+   */
+  void Write (uint32_t interfaceId, Time t, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the provided data buffer to the pcapng file.
+   *
+   * \param interfaceId Interface identifier returned by AddInterface.
+   * \param t Packet timestamp as ns3::Time.
+   * \param buffer The buffer to write.
+   * \param length The size of the buffer.
+   */
+  void Write (uint32_t interfaceId, Time t, uint8_t const *buffer, uint32_t length);
+
+private:
+  PcapNgFile m_file;  //!< Pcapng file
+  uint32_t m_snapLen; //!< max length of saved packets
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_WRAPPER_H */
@@ -0,0 +1,380 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/log.h"
+#include "pcapng-file.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapNgFile");
+
+const uint32_t SHB_TYPE = 0x0A0D0D0A;        /**< Section Header Block type */
+const uint32_t IDB_TYPE = 0x00000001;        /**< Interface Description Block type */
+const uint32_t EPB_TYPE = 0x00000006;        /**< Enhanced Packet Block type */
+const uint32_t BYTE_ORDER_MAGIC = 0x1A2B3C4D; /**< Section byte-order magic */
+const uint16_t VERSION_MAJOR = 1;            /**< Major version of the pcapng format */
+const uint16_t VERSION_MINOR = 0;            /**< Minor version of the pcapng format */
+const uint16_t OPT_ENDOFOPT = 0;             /**< End of options marker */
+const uint16_t OPT_IF_NAME = 2;              /**< if_name option code */
+const uint16_t OPT_IF_TSRESOL = 9;           /**< if_tsresol option code */
+const uint8_t TSRESOL_NANOSECONDS = 9;       /**< if_tsresol value for 10^-9 s */
+
+PcapNgFile::PcapNgFile ()
+  : m_file (),
+    m_gzFile (0),
+    m_zstdStream (0),
+    m_compression (COMPRESSION_NONE),
+    m_fail (false),
+    m_fatalErrorBuf (this),
+    m_fatalErrorStream (&m_fatalErrorBuf)
+{
+  NS_LOG_FUNCTION (this);
+  // flushing m_file alone would lose the staged blocks
+  FatalImpl::RegisterStream (&m_fatalErrorStream);
+  m_buffer.reserve (BUFFER_SIZE);
+}
+
+PcapNgFile::~PcapNgFile ()
+{
+  NS_LOG_FUNCTION (this);
+  FatalImpl::UnregisterStream (&m_fatalErrorStream);
+  Close ();
+}
+
+PcapNgFile::FatalErrorBuf::FatalErrorBuf (PcapNgFile *file)
+  : m_pcapNgFile (file)
+{
+}
+
+int
+PcapNgFile::FatalErrorBuf::sync (void)
+{
+  m_pcapNgFile->Close ();
+  return 0;
+}
+
+bool
+PcapNgFile::IsCompressionSupported (Compression compression)
+{
+  switch (compression)
+    {
+    case COMPRESSION_NONE:
+      return true;
+    case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+      return true;
+#else
+      return false;
+#endif
+    case COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+      return true;
+#else
+      return false;
+#endif
+    }
+  return false;
+}
+
+bool
+PcapNgFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_fail;
+}
+
+void
+PcapNgFile::Open (std::string const &filename, Compression compression)
+{
+  NS_LOG_FUNCTION (this << filename << compression);
+  NS_ABORT_MSG_UNLESS (IsCompressionSupported (compression),
+                       "PcapNgFile::Open(): compression method " << compression <<
+                       " is not supported by this build");
+  Close ();
+
+  m_compression = compression;
+  m_fail = false;
+  m_buffer.clear ();
+  m_interfaces.clear ();
+
+  if (m_compression == COMPRESSION_GZIP)
+    {
+#ifdef HAVE_ZLIB
+      m_gzFile = gzopen (filename.c_str (), "wb");
+      m_fail = (m_gzFile == 0);
+#endif
+    }
+  else
+    {
+      m_file.open (filename.c_str (), std::ios::out | std::ios::trunc | std::ios::binary);
+      m_fail = m_file.fail ();
+#ifdef HAVE_ZSTD
+      if (!m_fail && m_compression == COMPRESSION_ZSTD)
+        {
+          ZSTD_CCtx *cctx = ZSTD_createCCtx ();
+          m_fail = (cctx == 0);
+          m_zstdStream = cctx;
+          m_zstdOut.resize (ZSTD_CStreamOutSize ());
+        }
+#endif
+    }
+  if (m_fail)
+    {
+      return;
+    }
+
+  //
+  // A single section of unspecified length, without options.
+  //
+  const uint32_t shbLen = 28;
+  AppendU32 (SHB_TYPE);
+  AppendU32 (shbLen);
+  AppendU32 (BYTE_ORDER_MAGIC);
+  uint16_t version[2] = { VERSION_MAJOR, VERSION_MINOR };
+  Append (version, sizeof (version));
+  int64_t sectionLength = -1;
+  Append (&sectionLength, sizeof (sectionLength));
+  AppendU32 (shbLen);
+}
+
+void
+PcapNgFile::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzclose (static_cast<gzFile> (m_gzFile));
+      m_gzFile = 0;
+    }
+#endif
+#ifdef HAVE_ZSTD
+  if (m_zstdStream != 0)
+    {
+      ZSTD_CCtx *cctx = static_cast<ZSTD_CCtx *> (m_zstdStream);
+      ZSTD_inBuffer in = { 0, 0, 0 };
+      size_t remaining;
+      do
+        {
+          ZSTD_outBuffer out = { &m_zstdOut[0], m_zstdOut.size (), 0 };
+          remaining = ZSTD_compressStream2 (cctx, &out, &in, ZSTD_e_end);
+          if (ZSTD_isError (remaining))
+            {
+              m_fail = true;
+              break;
+            }
+          m_file.write (reinterpret_cast<const char *> (&m_zstdOut[0]), out.pos);
+        }
+      while (remaining != 0);
+      ZSTD_freeCCtx (cctx);
+      m_zstdStream = 0;
+    }
+#endif
+  if (m_file.is_open ())
+    {
+      m_file.close ();
+    }
+}
+
+void
+PcapNgFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_buffer.empty ())
+    {
+      Emit (&m_buffer[0], m_buffer.size ());
+      m_buffer.clear ();
+    }
+  if (m_file.is_open ())
+    {
+      m_file.flush ();
+    }
+}
+
+void
+PcapNgFile::Emit (uint8_t const *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  switch (m_compression)
+    {
+    case COMPRESSION_NONE:
+      m_file.write (reinterpret_cast<const char *> (data), size);
+      m_fail = m_fail || m_file.fail ();
+      break;
+    case COMPRESSION_GZIP:
+#ifdef HAVE_ZLIB
+      if (m_gzFile == 0 || gzwrite (static_cast<gzFile> (m_gzFile), data, size) != static_cast<int> (size))
+        {
+          m_fail = true;
+        }
+#endif
+      break;
+    case COMPRESSION_ZSTD:
+#ifdef HAVE_ZSTD
+      {
+        ZSTD_CCtx *cctx = static_cast<ZSTD_CCtx *> (m_zstdStream);
+        ZSTD_inBuffer in = { data, size, 0 };
+        while (cctx != 0 && in.pos < in.size)
+          {
+            ZSTD_outBuffer out = { &m_zstdOut[0], m_zstdOut.size (), 0 };
+            size_t ret = ZSTD_compressStream2 (cctx, &out, &in, ZSTD_e_continue);
+            if (ZSTD_isError (ret))
+              {
+                m_fail = true;
+                break;
+              }
+            m_file.write (reinterpret_cast<const char *> (&m_zstdOut[0]), out.pos);
+          }
+      }
+#endif
+      break;
+    }
+}
+
+void
+PcapNgFile::Append (void const *data, uint32_t size)
+{
+  uint8_t const *bytes = static_cast<uint8_t const *> (data);
+  m_buffer.insert (m_buffer.end (), bytes, bytes + size);
+}
+
+void
+PcapNgFile::AppendU32 (uint32_t value)
+{
+  Append (&value, sizeof (value));
+}
+
+void
+PcapNgFile::AppendPadding (uint32_t length)
+{
+  uint32_t padding = (4 - (length & 3)) & 3;
+  m_buffer.insert (m_buffer.end (), padding, 0);
+}
+
+uint32_t
+PcapNgFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name);
+  NS_ASSERT_MSG (dataLinkType <= 0xffff, "PcapNgFile::AddInterface(): link type does not fit in 16 bits");
+
+  uint32_t nameLen = name.size ();
+  uint32_t nameOptLen = nameLen ? 4 + ((nameLen + 3) & ~3U) : 0;
+  // header, link type/reserved, snaplen, if_tsresol, end of options, trailer
+  uint32_t blockLen = 8 + 4 + 4 + nameOptLen + 8 + 4 + 4;
+
+  AppendU32 (IDB_TYPE);
+  AppendU32 (blockLen);
+  uint16_t linkType[2] = { static_cast<uint16_t> (dataLinkType), 0 };
+  Append (linkType, sizeof (linkType));
+  AppendU32 (snapLen);
+  if (nameLen)
+    {
+      uint16_t option[2] = { OPT_IF_NAME, static_cast<uint16_t> (nameLen) };
+      Append (option, sizeof (option));
+      Append (name.data (), nameLen);
+      AppendPadding (nameLen);
+    }
+  uint16_t tsresol[2] = { OPT_IF_TSRESOL, 1 };
+  Append (tsresol, sizeof (tsresol));
+  Append (&TSRESOL_NANOSECONDS, 1);
+  AppendPadding (1);
+  uint16_t endOfOpt[2] = { OPT_ENDOFOPT, 0 };
+  Append (endOfOpt, sizeof (endOfOpt));
+  AppendU32 (blockLen);
+
+  Interface iface;
+  iface.dataLinkType = dataLinkType;
+  iface.snapLen = snapLen;
+  m_interfaces.push_back (iface);
+  return m_interfaces.size () - 1;
+}
+
+uint32_t
+PcapNgFile::GetNInterfaces (void) const
+{
+  return m_interfaces.size ();
+}
+
+uint32_t
+PcapNgFile::GetDataLinkType (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].dataLinkType;
+}
+
+uint32_t
+PcapNgFile::GetSnapLen (uint32_t interfaceId) const
+{
+  NS_ASSERT (interfaceId < m_interfaces.size ());
+  return m_interfaces[interfaceId].snapLen;
+}
+
+uint8_t *
+PcapNgFile::ReservePacket (uint32_t interfaceId, uint64_t timestamp, uint32_t totalLen,
+                           uint32_t &inclLen)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << totalLen);
+  NS_ASSERT_MSG (interfaceId < m_interfaces.size (), "PcapNgFile::ReservePacket(): unknown interface " << interfaceId);
+
+  uint32_t snapLen = m_interfaces[interfaceId].snapLen;
+  inclLen = totalLen > snapLen ? snapLen : totalLen;
+  uint32_t paddedLen = (inclLen + 3) & ~3U;
+  uint32_t blockLen = 32 + paddedLen;
+
+  //
+  // Keep each block contiguous in the staging buffer so that the pointer
+  // handed back to the caller stays valid; oversized blocks simply grow it.
+  //
+  if (m_buffer.size () + blockLen > BUFFER_SIZE)
+    {
+      Flush ();
+    }
+
+  AppendU32 (EPB_TYPE);
+  AppendU32 (blockLen);
+  AppendU32 (interfaceId);
+  AppendU32 (static_cast<uint32_t> (timestamp >> 32));
+  AppendU32 (static_cast<uint32_t> (timestamp & 0xffffffff));
+  AppendU32 (inclLen);
+  AppendU32 (totalLen);
+  std::size_t dataOffset = m_buffer.size ();
+  m_buffer.insert (m_buffer.end (), paddedLen, 0);
+  AppendU32 (blockLen);
+  return &m_buffer[dataOffset];
+}
+
+void
+PcapNgFile::Write (uint32_t interfaceId, uint64_t timestamp, uint8_t const *data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interfaceId << timestamp << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *dest = ReservePacket (interfaceId, timestamp, totalLen, inclLen);
+  std::memcpy (dest, data, inclLen);
+}
+
+} // namespace ns3
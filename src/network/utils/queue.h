@@ -31,6 +31,7 @@
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
 #include "ns3/queue-item.h"
+#include "ns3/ring-buffer.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -222,6 +223,49 @@ private:
   friend class Queue;
 };
 
+/**
+ * \ingroup queue
+ * \brief Container used by Queue to store items of the given type
+ *
+ * By default, items are stored in a std::list, whose iterators stay valid
+ * until the element they point to is removed.  Item types whose queues do
+ * not keep iterators across insertions and removals may specialize this
+ * template to select the contiguous RingBuffer, which does not allocate
+ * memory on each enqueue and dequeue.  Packet and QueueDiscItem, which are
+ * stored by the device and queue disc FIFO queues, do so.
+ *
+ * A specialization must be visible wherever Queue<Item> is used, hence
+ * it has to be declared along with the item type.
+ */
+template <typename Item>
+struct QueueContainer
+{
+  /// Container type
+  typedef std::list<Ptr<Item> > Type;
+};
+
+/**
+ * \ingroup queue
+ * \brief Packets are stored in a RingBuffer
+ */
+template <>
+struct QueueContainer<Packet>
+{
+  /// Container type
+  typedef RingBuffer<Ptr<Packet> > Type;
+};
+
+/**
+ * \ingroup queue
+ * \brief Queue disc items are stored in a RingBuffer
+ */
+template <>
+struct QueueContainer<QueueDiscItem>
+{
+  /// Container type
+  typedef RingBuffer<Ptr<QueueDiscItem> > Type;
+};
+
 
 /**
  * \ingroup queue
@@ -238,6 +282,10 @@ private:
  * methods in doing so, to ensure that appropriate trace sources are called
  * and statistics are maintained.
  *
+ * Items are stored in the container selected by QueueContainer<Item>.
+ * Subclasses must not rely on iterators staying valid across insertions
+ * and removals, unless the container is a std::list.
+ *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
  * of the templates included in this file. Thus, do not include queue.h but add
@@ -302,10 +350,12 @@ public:
 
 protected:
 
+  /// Container storing the items.
+  typedef typename QueueContainer<Item>::Type Container;
   /// Const iterator.
-  typedef typename std::list<Ptr<Item> >::const_iterator ConstIterator;
+  typedef typename Container::const_iterator ConstIterator;
   /// Iterator.
-  typedef typename std::list<Ptr<Item> >::iterator Iterator;
+  typedef typename Container::iterator Iterator;
 
   /**
    * \brief Get a const iterator which refers to the first item in the queue.
@@ -432,7 +482,7 @@ protected:
   void DoDispose (void) override;
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  Container m_packets;                      //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <vector>
+#include <iterator>
+#include <cstddef>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A sequence container stored in a contiguous, growable circular array
+ *
+ * RingBuffer provides the subset of the std::list interface used by the
+ * Queue class (begin, end, insert, erase, clear) on top of a power-of-two
+ * sized array.  Inserting at the back and erasing at the front, which is
+ * what FIFO queues do, take constant time and never allocate once the
+ * array has grown to the peak queue length.  Inserting or erasing elsewhere
+ * shifts the elements that follow the position.
+ *
+ * Unlike std::list, inserting or erasing an element invalidates the
+ * iterators to the elements that follow it.  Vacated slots are reset to a
+ * default-constructed value, so that no reference is kept to removed
+ * elements.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  /// Element type
+  typedef T value_type;
+  /// Size type
+  typedef std::size_t size_type;
+
+  /**
+   * \brief Iterator over a RingBuffer
+   *
+   * An iterator is a position relative to the first element, hence it
+   * stays valid across insertions at the back.
+   */
+  template <typename V, typename B>
+  class IteratorBase
+  {
+public:
+    /// \{ Iterator traits
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef V* pointer;
+    typedef V& reference;
+    /// \}
+
+    IteratorBase ()
+      : m_buffer (0),
+        m_index (0)
+    {
+    }
+    /**
+     * \param buffer the container
+     * \param index position relative to the first element
+     */
+    IteratorBase (B *buffer, size_type index)
+      : m_buffer (buffer),
+        m_index (index)
+    {
+    }
+    /**
+     * Conversion from iterator to const_iterator
+     * \param o the iterator
+     */
+    template <typename V2, typename B2>
+    IteratorBase (IteratorBase<V2, B2> const &o)
+      : m_buffer (o.m_buffer),
+        m_index (o.m_index)
+    {
+    }
+    /** \returns the element */
+    reference operator* (void) const
+    {
+      return m_buffer->At (m_index);
+    }
+    /** \returns a pointer to the element */
+    pointer operator-> (void) const
+    {
+      return &m_buffer->At (m_index);
+    }
+    /** \returns the iterator to the next element */
+    IteratorBase &operator++ (void)
+    {
+      ++m_index;
+      return *this;
+    }
+    /** \returns the iterator before the increment */
+    IteratorBase operator++ (int)
+    {
+      IteratorBase tmp = *this;
+      ++m_index;
+      return tmp;
+    }
+    /** \returns the iterator to the previous element */
+    IteratorBase &operator-- (void)
+    {
+      --m_index;
+      return *this;
+    }
+    /** \returns the iterator before the decrement */
+    IteratorBase operator-- (int)
+    {
+      IteratorBase tmp = *this;
+      --m_index;
+      return tmp;
+    }
+    /**
+     * \param o another iterator
+     * \returns true if both iterators point to the same position
+     */
+    template <typename V2, typename B2>
+    bool operator== (IteratorBase<V2, B2> const &o) const
+    {
+      return m_index == o.m_index;
+    }
+    /**
+     * \param o another iterator
+     * \returns true if the iterators point to different positions
+     */
+    template <typename V2, typename B2>
+    bool operator!= (IteratorBase<V2, B2> const &o) const
+    {
+      return m_index != o.m_index;
+    }
+
+private:
+    template <typename V2, typename B2>
+    friend class IteratorBase;
+    friend class RingBuffer;
+
+    B *m_buffer;       //!< The container
+    size_type m_index; //!< Position relative to the first element
+  };
+
+  /// Iterator
+  typedef IteratorBase<T, RingBuffer> iterator;
+  /// Const iterator
+  typedef IteratorBase<const T, const RingBuffer> const_iterator;
+
+  RingBuffer ()
+    : m_head (0),
+      m_size (0)
+  {
+  }
+
+  /** \returns an iterator to the first element */
+  iterator begin (void)
+  {
+    return iterator (this, 0);
+  }
+  /** \returns an iterator past the last element */
+  iterator end (void)
+  {
+    return iterator (this, m_size);
+  }
+  /** \returns a const iterator to the first element */
+  const_iterator begin (void) const
+  {
+    return const_iterator (this, 0);
+  }
+  /** \returns a const iterator past the last element */
+  const_iterator end (void) const
+  {
+    return const_iterator (this, m_size);
+  }
+  /** \returns a const iterator to the first element */
+  const_iterator cbegin (void) const
+  {
+    return begin ();
+  }
+  /** \returns a const iterator past the last element */
+  const_iterator cend (void) const
+  {
+    return end ();
+  }
+
+  /** \returns the number of elements */
+  size_type size (void) const
+  {
+    return m_size;
+  }
+  /** \returns true if there are no elements */
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+  /** \returns the number of elements that fit without growing the array */
+  size_type capacity (void) const
+  {
+    return m_slots.size ();
+  }
+
+  /**
+   * \brief Insert an element before the given position
+   * \param pos the position
+   * \param value the element
+   * \returns an iterator to the inserted element
+   */
+  iterator insert (const_iterator pos, T const &value)
+  {
+    size_type index = pos.m_index;
+    NS_ASSERT (index <= m_size);
+    if (m_size == m_slots.size ())
+      {
+        Grow ();
+      }
+    if (index == 0 && m_size != 0)
+      {
+        m_head = (m_head - 1) & Mask ();
+      }
+    else
+      {
+        for (size_type i = m_size; i > index; --i)
+          {
+            At (i) = At (i - 1);
+          }
+      }
+    ++m_size;
+    At (index) = value;
+    return iterator (this, index);
+  }
+
+  /**
+   * \brief Erase the element at the given position
+   * \param pos the position
+   * \returns an iterator to the element that followed the erased one
+   */
+  iterator erase (const_iterator pos)
+  {
+    size_type index = pos.m_index;
+    NS_ASSERT (index < m_size);
+    if (index == 0)
+      {
+        At (0) = T ();
+        m_head = (m_head + 1) & Mask ();
+      }
+    else
+      {
+        for (size_type i = index + 1; i < m_size; ++i)
+          {
+            At (i - 1) = At (i);
+          }
+        At (m_size - 1) = T ();
+      }
+    --m_size;
+    return iterator (this, index);
+  }
+
+  /**
+   * \brief Remove all the elements, keeping the array for reuse
+   */
+  void clear (void)
+  {
+    for (size_type i = 0; i < m_size; ++i)
+      {
+        At (i) = T ();
+      }
+    m_head = 0;
+    m_size = 0;
+  }
+
+private:
+  /// Initial number of slots
+  static constexpr size_type INITIAL_CAPACITY = 16;
+
+  /** \returns the mask to wrap slot indices */
+  size_type Mask (void) const
+  {
+    return m_slots.size () - 1;
+  }
+  /**
+   * \param index position relative to the first element
+   * \returns the element at the given position
+   */
+  T &At (size_type index)
+  {
+    return m_slots[(m_head + index) & Mask ()];
+  }
+  /**
+   * \param index position relative to the first element
+   * \returns the element at the given position
+   */
+  T const &At (size_type index) const
+  {
+    return m_slots[(m_head + index) & Mask ()];
+  }
+  /// Double the number of slots, moving the elements to the start of the array
+  void Grow (void)
+  {
+    std::vector<T> slots (m_slots.empty () ? INITIAL_CAPACITY : 2 * m_slots.size ());
+    for (size_type i = 0; i < m_size; ++i)
+      {
+        slots[i] = At (i);
+      }
+    m_slots.swap (slots);
+    m_head = 0;
+  }
+
+  std::vector<T> m_slots; //!< Slots, a power of two of them
+  size_type m_head;       //!< Slot of the first element
+  size_type m_size;       //!< Number of elements
+};
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -30,6 +30,8 @@
 #include "ns3/tag.h"
 #include "ns3/simulator.h"
 #include "ns3/queue.h"
+#include "ns3/queue-item.h"
+#include "ns3/net-device-queue-interface.h"
 
 namespace ns3 {
 
@@ -562,4 +564,48 @@ SimpleNetDevice::SupportsSendFrom (void) const
   return true;
 }
 
+bool
+SimpleNetDevice::SupportsSendBatch (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+std::size_t
+SimpleNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+  std::size_t n;
+  for (n = 0; n < items.size (); n++)
+    {
+      // leave the remaining packets to the queue disc if there is no more room
+      if (ndqi && ndqi->GetTxQueue (0)->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> p = items[n]->GetPacket ();
+      if (p->GetSize () > GetMtu ())
+        {
+          continue;
+        }
+
+      SimpleTag tag;
+      tag.SetSrc (m_address);
+      tag.SetDst (Mac48Address::ConvertFrom (items[n]->GetAddress ()));
+      tag.SetProto (items[n]->GetProtocol ());
+
+      p->AddPacketTag (tag);
+      m_queue->Enqueue (p);
+    }
+
+  // start the transmission once the whole burst is queued
+  if (!FinishTransmissionEvent.IsRunning ())
+    {
+      StartTransmission ();
+    }
+  return n;
+}
+
 } // namespace ns3
@@ -134,6 +134,8 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSendBatch (void) const;
+  virtual std::size_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
 
 protected:
   virtual void DoDispose (void);
@@ -106,6 +106,61 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitPipelined (
+  Ptr<const Packet> p,
+  Ptr<PointToPointNetDevice> src,
+  Time offset,
+  Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src << offset << txTime);
+  NS_LOG_LOGIC ("UID is " << p->GetUid () << ")");
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Link &link = m_link[wire];
+
+  // packets are transmitted back to back, hence they arrive in order
+  Time arrival = Simulator::Now () + offset + txTime + m_delay;
+  NS_ASSERT (link.m_inFlight.empty () || link.m_inFlight.back ().first <= arrival);
+  link.m_inFlight.push_back (std::make_pair (arrival, p->Copy ()));
+
+  // schedule a receive event only if none is pending on this wire
+  if (link.m_inFlight.size () == 1)
+    {
+      Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (),
+                                      arrival - Simulator::Now (),
+                                      &PointToPointChannel::ReceivePipelined, this, wire);
+    }
+
+  // Call the tx anim callback on the net device
+  m_txrxPointToPoint (p, src, link.m_dst, txTime, offset + txTime + m_delay);
+  return true;
+}
+
+void
+PointToPointChannel::ReceivePipelined (uint32_t wire)
+{
+  NS_LOG_FUNCTION (this << wire);
+  Link &link = m_link[wire];
+  NS_ASSERT (!link.m_inFlight.empty () && link.m_inFlight.front ().first == Simulator::Now ());
+
+  Ptr<Packet> p = link.m_inFlight.front ().second;
+  link.m_inFlight.pop_front ();
+
+  // schedule the delivery of the next packet before handing this one to the
+  // device, which may transmit more packets on this channel
+  if (!link.m_inFlight.empty ())
+    {
+      Simulator::ScheduleWithContext (link.m_dst->GetNode ()->GetId (),
+                                      link.m_inFlight.front ().first - Simulator::Now (),
+                                      &PointToPointChannel::ReceivePipelined, this, wire);
+    }
+  link.m_dst->Receive (p);
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -128,6 +183,17 @@ PointToPointChannel::GetDevice (std::size_t i) const
   return GetPointToPointDevice (i);
 }
 
+void
+PointToPointChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::size_t i = 0; i < N_DEVICES; i++)
+    {
+      m_link[i].m_inFlight.clear ();
+    }
+  Channel::DoDispose ();
+}
+
 Time
 PointToPointChannel::GetDelay (void) const
 {
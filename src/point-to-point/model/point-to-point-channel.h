@@ -20,10 +20,13 @@
 #define POINT_TO_POINT_CHANNEL_H
 
 #include <list>
+#include <deque>
+#include <utility>
 #include "ns3/channel.h"
 #include "ns3/ptr.h"
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
+#include "ns3/packet.h"
 #include "ns3/traced-callback.h"
 
 namespace ns3 {
@@ -80,6 +83,24 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a packet of a burst over this channel
+   *
+   * The packet starts being transmitted after the given offset, i.e., after
+   * the previous packets of the burst. The packets in flight on a wire are
+   * kept in arrival order and a single receive event is pending per wire:
+   * each receive event delivers a packet at its arrival time and schedules
+   * the receive event of the next packet.
+   *
+   * \param p Packet to transmit
+   * \param src Source PointToPointNetDevice
+   * \param offset Time from now at which the transmission starts
+   * \param txTime Transmit time to apply
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitPipelined (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                                  Time offset, Time txTime);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -101,6 +122,8 @@ public:
   virtual Ptr<NetDevice> GetDevice (std::size_t i) const;
 
 protected:
+  virtual void DoDispose (void);
+
   /**
    * \brief Get the delay associated with this channel
    * \returns Time delay
@@ -149,6 +172,12 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
+  /**
+   * \brief Deliver the first packet in flight on a wire (pipelined mode)
+   * \param wire the wire
+   */
+  void ReceivePipelined (uint32_t wire);
+
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
 
@@ -199,6 +228,8 @@ public:
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    /// Packets in flight in pipelined mode, with their arrival time
+    std::deque<std::pair<Time, Ptr<Packet> > > m_inFlight;
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
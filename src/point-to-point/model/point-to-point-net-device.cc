@@ -24,7 +24,10 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
+#include "ns3/queue-item.h"
+#include "ns3/net-device-queue-interface.h"
 #include "point-to-point-net-device.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
@@ -67,6 +70,15 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("Pipelined",
+                   "If true, the packets queued back to back are sent in bursts, "
+                   "with analytic departure times and a single transmit complete "
+                   "event per burst. The PhyTxBegin and sniffer traces of the "
+                   "packets of a burst are fired when the burst starts, and the "
+                   "PhyTxEnd traces when the burst ends.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_pipelined),
+                   MakeBooleanChecker ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -177,7 +189,8 @@ PointToPointNetDevice::PointToPointNetDevice ()
     m_txMachineState (READY),
     m_channel (0),
     m_linkUp (false),
-    m_currentPkt (0)
+    m_currentPkt (0),
+    m_pipelined (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -214,6 +227,7 @@ PointToPointNetDevice::DoDispose ()
   m_channel = 0;
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
+  m_burst.clear ();
   m_queue = 0;
   NetDevice::DoDispose ();
 }
@@ -244,6 +258,10 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   // schedule an event that will be executed when the transmission is complete.
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
+  if (m_pipelined)
+    {
+      return TransmitBurst (p);
+    }
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
@@ -262,6 +280,52 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitBurst (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  //
+  // The packets in the queue are transmitted back to back after the first
+  // one, so their departure times are known now. Each packet is handed to the
+  // channel with the time its transmission starts, and a single event is
+  // scheduled for the end of the burst.
+  //
+  m_txMachineState = BUSY;
+  bool result = true;
+  Time offset = Seconds (0);
+
+  while (p != 0)
+    {
+      NS_LOG_LOGIC ("UID is " << p->GetUid () << ", offset " << offset.As (Time::S));
+      m_burst.push_back (p);
+      m_phyTxBeginTrace (p);
+
+      Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+      if (!m_channel->TransmitPipelined (p, this, offset, txTime))
+        {
+          m_phyTxDropTrace (p);
+          if (m_burst.size () == 1)
+            {
+              result = false;
+            }
+        }
+      offset += txTime + m_tInterframeGap;
+
+      p = m_queue->Dequeue ();
+      if (p != 0)
+        {
+          m_snifferTrace (p);
+          m_promiscSnifferTrace (p);
+        }
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent of a burst of " << m_burst.size ()
+                << " packets in " << offset.As (Time::S));
+  Simulator::Schedule (offset, &PointToPointNetDevice::TransmitComplete, this);
+  return result;
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -276,10 +340,21 @@ PointToPointNetDevice::TransmitComplete (void)
   NS_ASSERT_MSG (m_txMachineState == BUSY, "Must be BUSY if transmitting");
   m_txMachineState = READY;
 
-  NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
+  if (!m_burst.empty ())
+    {
+      for (auto& p : m_burst)
+        {
+          m_phyTxEndTrace (p);
+        }
+      m_burst.clear ();
+    }
+  else
+    {
+      NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
-  m_currentPkt = 0;
+      m_phyTxEndTrace (m_currentPkt);
+      m_currentPkt = 0;
+    }
 
   Ptr<Packet> p = m_queue->Dequeue ();
   if (p == 0)
@@ -605,6 +680,58 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSendBatch (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+std::size_t
+PointToPointNetDevice::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  NS_LOG_FUNCTION (this << items.size ());
+
+  if (IsLinkUp () == false)
+    {
+      for (auto& item : items)
+        {
+          m_macTxDropTrace (item->GetPacket ());
+        }
+      return items.size ();
+    }
+
+  Ptr<NetDeviceQueueInterface> ndqi = GetObject<NetDeviceQueueInterface> ();
+  std::size_t n;
+  for (n = 0; n < items.size (); n++)
+    {
+      // leave the remaining packets to the queue disc if there is no more room
+      if (ndqi && ndqi->GetTxQueue (0)->IsStopped ())
+        {
+          break;
+        }
+      Ptr<Packet> packet = items[n]->GetPacket ();
+      AddHeader (packet, items[n]->GetProtocol ());
+      m_macTxTrace (packet);
+      if (!m_queue->Enqueue (packet))
+        {
+          m_macTxDropTrace (packet);
+        }
+    }
+
+  //
+  // Start the transmission once the whole burst is queued
+  //
+  if (m_txMachineState == READY && !m_queue->IsEmpty ())
+    {
+      Ptr<Packet> packet = m_queue->Dequeue ();
+      m_snifferTrace (packet);
+      m_promiscSnifferTrace (packet);
+      TransmitStart (packet);
+    }
+  return n;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
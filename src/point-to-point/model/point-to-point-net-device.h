@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -58,6 +59,13 @@ class ErrorModel;
  * Key parameters or objects that can be specified for this device 
  * include a queue, data rate, and interframe transmission gap (the 
  * propagation delay is set in the PointToPointChannel).
+ *
+ * In pipelined mode (Pipelined attribute), the packets found back to back
+ * in the queue when a transmission starts are sent as a burst: their
+ * departure times are computed analytically, a single TransmitComplete event
+ * is scheduled at the end of the burst and the channel keeps a single
+ * pending receive event per wire. Packets are received at the same times as
+ * in the default mode, but they leave the queue when the burst starts.
  */
 class PointToPointNetDevice : public NetDevice
 {
@@ -189,6 +197,8 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSendBatch (void) const;
+  virtual std::size_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
 
 protected:
   /**
@@ -267,6 +277,20 @@ private:
    */
   bool TransmitStart (Ptr<Packet> p);
 
+  /**
+   * Start Sending a Burst of Packets Down the Wire (pipelined mode).
+   *
+   * The given packet and the packets in the queue are passed to the channel
+   * with their departure times, which are computed analytically. An event is
+   * scheduled for the time at which the bits of the last packet have been
+   * completely transmitted.
+   *
+   * \see PointToPointChannel::TransmitPipelined ()
+   * \param p the first packet of the burst
+   * \returns true if success, false on failure
+   */
+  bool TransmitBurst (Ptr<Packet> p);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
@@ -456,6 +480,8 @@ private:
   uint32_t m_mtu;
 
   Ptr<Packet> m_currentPkt; //!< Current packet processed
+  bool m_pipelined;         //!< Whether back to back packets are sent in bursts
+  std::vector<Ptr<Packet> > m_burst; //!< Packets of the current burst (pipelined mode)
 
   /**
    * \brief PPP to Ethernet protocol number mapping
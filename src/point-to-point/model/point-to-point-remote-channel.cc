@@ -73,4 +73,15 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitPipelined (
+  Ptr<const Packet> p,
+  Ptr<PointToPointNetDevice> src,
+  Time offset,
+  Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src << offset << txTime);
+  return TransmitStart (p, src, offset + txTime);
+}
+
 } // namespace ns3
@@ -68,6 +68,18 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a packet of a burst
+   *
+   * \param p Packet to transmit
+   * \param src Source PointToPointNetDevice
+   * \param offset Time from now at which the transmission starts
+   * \param txTime Transmit time to apply
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitPipelined (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                                  Time offset, Time txTime);
 };
 
 } // namespace ns3
@@ -24,8 +24,11 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/boolean.h"
+#include "ns3/data-rate.h"
 
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -130,6 +133,137 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the pipelined mode of the PointToPoint model
+ *
+ * It sends bursts of packets over a link in the default and in the pipelined
+ * mode, and checks that the packets are received at the same times, with
+ * fewer events in the pipelined mode.
+ */
+class PointToPointPipelinedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPipelinedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets of increasing size to the device specified
+   *
+   * \param device NetDevice to send to.
+   * \param nPackets the number of packets
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t nPackets);
+  /**
+   * \brief Callback function which records the receive time
+   *
+   * \param dev The receiving device.
+   * \param pkt The received packet.
+   * \param mode The protocol mode used.
+   * \param sender The sender address.
+   *
+   * \return A boolean indicating packet handled properly.
+   */
+  bool RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender);
+  /**
+   * \brief Run the simulation
+   *
+   * \param pipelined whether the sending device is in pipelined mode
+   * \return the number of events executed
+   */
+  uint64_t RunLink (bool pipelined);
+
+  std::vector<Time> m_rxTimes;      //!< the receive times
+  std::vector<uint32_t> m_rxSizes;  //!< the sizes of the received packets
+};
+
+PointToPointPipelinedTest::PointToPointPipelinedTest ()
+  : TestCase ("PointToPoint pipelined mode")
+{
+}
+
+void
+PointToPointPipelinedTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t nPackets)
+{
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      device->Send (Create<Packet> (100 + 100 * i), device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointPipelinedTest::RxPacket (Ptr<NetDevice> dev, Ptr<const Packet> pkt, uint16_t mode, const Address &sender)
+{
+  m_rxTimes.push_back (Simulator::Now ());
+  m_rxSizes.push_back (pkt->GetSize ());
+  return true;
+}
+
+uint64_t
+PointToPointPipelinedTest::RunLink (bool pipelined)
+{
+  m_rxTimes.clear ();
+  m_rxSizes.clear ();
+
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devA->SetDataRate (DataRate ("8Mbps"));
+  devA->SetInterframeGap (MicroSeconds (10));
+  devA->SetAttribute ("Pipelined", BooleanValue (pipelined));
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+
+  devB->SetReceiveCallback (MakeCallback (&PointToPointPipelinedTest::RxPacket, this));
+
+  // a burst, more packets while the burst is being transmitted, and a burst
+  // after the link is idle again
+  Simulator::Schedule (Seconds (1.0), &PointToPointPipelinedTest::SendPackets, this, devA, 10);
+  Simulator::Schedule (Seconds (1.001), &PointToPointPipelinedTest::SendPackets, this, devA, 5);
+  Simulator::Schedule (Seconds (2.0), &PointToPointPipelinedTest::SendPackets, this, devA, 10);
+
+  Simulator::Run ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+  return events;
+}
+
+void
+PointToPointPipelinedTest::DoRun (void)
+{
+  uint64_t events = RunLink (false);
+  std::vector<Time> rxTimes = m_rxTimes;
+  std::vector<uint32_t> rxSizes = m_rxSizes;
+  NS_TEST_ASSERT_MSG_EQ (rxTimes.size (), 25, "All the packets must be received");
+
+  uint64_t pipelinedEvents = RunLink (true);
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes.size (), 25, "All the packets must be received in pipelined mode");
+  for (std::size_t i = 0; i < rxTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i], rxTimes[i], "Different receive time of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_rxSizes[i], rxSizes[i], "Different size of packet " << i);
+    }
+  NS_TEST_EXPECT_MSG_LT (pipelinedEvents, events, "The pipelined mode must execute fewer events");
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -146,6 +280,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPipelinedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -312,7 +312,7 @@ FileHelper::GetAggregatorSingle ()
   if (!m_aggregator)
     {
       // Create the aggregator.
-      std::string outputFileName = m_outputFileNameWithoutExtension + ".txt";
+      std::string outputFileName = m_outputFileNameWithoutExtension + GetFileExtension ();
       m_aggregator = CreateObject<FileAggregator> (outputFileName, m_fileType);
 
       // Set all of the format strings for the aggregator.
@@ -447,6 +447,12 @@ FileHelper::Set10dFormat (const std::string &format)
   m_10dFormat = format;
 }
 
+std::string
+FileHelper::GetFileExtension (void) const
+{
+  return m_fileType == FileAggregator::BINARY ? ".bin" : ".txt";
+}
+
 void
 FileHelper::ConnectProbeToAggregator (const std::string &typeId,
                                       const std::string &matchIdentifier,
@@ -557,7 +563,7 @@ FileHelper::ConnectProbeToAggregator (const std::string &typeId,
 
   // Add the aggregator to the map of aggregators, which will keep the
   // aggregator in memory after this function ends.
-  std::string outputFileName = outputFileNameWithoutExtension + ".txt";
+  std::string outputFileName = outputFileNameWithoutExtension + GetFileExtension ();
   AddAggregator (probeContext, outputFileName, onlyOneAggregator);
 
   // Connect the adaptor to the aggregator.
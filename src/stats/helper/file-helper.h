@@ -51,8 +51,9 @@ public:
    *
    * Constructs a file helper that will create a file named
    * outputFileNameWithoutExtension plus possible extra information
-   * from wildcard matches plus ".txt" with values printed as
-   * specified by fileType.  The default file type is space-separated.
+   * from wildcard matches plus ".txt" (".bin" for binary files) with
+   * values printed as specified by fileType.  The default file type is
+   * space-separated.
    */
   FileHelper (const std::string &outputFileNameWithoutExtension,
               enum FileAggregator::FileType fileType = FileAggregator::SPACE_SEPARATED);
@@ -66,9 +67,9 @@ public:
    *
    * Configures file related parameters for this file helper so that
    * it will create a file named outputFileNameWithoutExtension plus
-   * possible extra information from wildcard matches plus ".txt" with
-   * values printed as specified by fileType.  The default file type
-   * is space-separated.
+   * possible extra information from wildcard matches plus ".txt"
+   * (".bin" for binary files) with values printed as specified by
+   * fileType.  The default file type is space-separated.
    */
   void ConfigureFile (const std::string &outputFileNameWithoutExtension,
                       enum FileAggregator::FileType fileType = FileAggregator::SPACE_SEPARATED);
@@ -257,6 +258,12 @@ private:
                  const std::string &probeName,
                  const std::string &path);
 
+  /**
+   * \return the extension of the output files, ".bin" for binary
+   * files and ".txt" otherwise.
+   */
+  std::string GetFileExtension (void) const;
+
   /**
    * \param typeId the type ID for the probe used when it is created.
    * \param matchIdentifier this string is used to make the probe's
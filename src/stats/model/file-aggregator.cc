@@ -76,19 +76,55 @@ FileAggregator::FileAggregator (const std::string &outputFileName,
       break;
     }
 
-  m_file.open (m_outputFileName.c_str ());
+  if (m_fileType == BINARY)
+    {
+      m_file.open (m_outputFileName.c_str (), std::ios::out | std::ios::binary);
+      m_buffer.reserve (BINARY_BUFFER_SIZE);
+    }
+  else
+    {
+      m_file.open (m_outputFileName.c_str ());
+    }
 }
 
 FileAggregator::~FileAggregator ()
 {
   NS_LOG_FUNCTION (this);
+  FlushBinary ();
   m_file.close ();
 }
 
+void
+FileAggregator::WriteBinary (const double *values, uint8_t n)
+{
+  m_buffer.push_back (n);
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *> (values);
+  m_buffer.insert (m_buffer.end (), bytes, bytes + n * sizeof (double));
+  if (m_buffer.size () >= BINARY_BUFFER_SIZE)
+    {
+      FlushBinary ();
+    }
+}
+
+void
+FileAggregator::FlushBinary (void)
+{
+  if (!m_buffer.empty ())
+    {
+      m_file.write (reinterpret_cast<const char *> (&m_buffer[0]), m_buffer.size ());
+      m_buffer.clear ();
+    }
+}
+
 void
 FileAggregator::SetFileType (enum FileType fileType)
 {
   NS_LOG_FUNCTION (this << fileType);
+  // the buffered data points precede the text lines written from now on
+  if (m_fileType == BINARY && fileType != BINARY)
+    {
+      FlushBinary ();
+    }
   m_fileType = fileType;
 }
 
@@ -101,8 +137,11 @@ FileAggregator::SetHeading (const std::string &heading)
       m_heading = heading;
       m_hasHeadingBeenSet = true;
 
-      // Print the heading to the file.
-      m_file << m_heading << std::endl;
+      // Print the heading to the file, except in binary files.
+      if (m_fileType != BINARY)
+        {
+          m_file << m_heading << '\n';
+        }
     }
 }
 
@@ -185,7 +224,12 @@ FileAggregator::Write1d (std::string context,
   if (m_enabled)
     {
       // Write the 1D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[1] = {v1};
+          WriteBinary (values, 1);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -204,12 +248,12 @@ FileAggregator::Write1d (std::string context,
             }
 
           // Write the formatted value.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
           // Write the value.
-          m_file << v1 << std::endl;
+          m_file << v1 << '\n';
         }
     }
 }
@@ -224,7 +268,12 @@ FileAggregator::Write2d (std::string context,
   if (m_enabled)
     {
       // Write the 2D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[2] = {v1, v2};
+          WriteBinary (values, 2);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -244,13 +293,13 @@ FileAggregator::Write2d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
           // Write the values with the proper separator.
           m_file << v1 << m_separator
-                 << v2 << std::endl;
+                 << v2 << '\n';
         }
     }
 }
@@ -266,7 +315,12 @@ FileAggregator::Write3d (std::string context,
   if (m_enabled)
     {
       // Write the 3D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[3] = {v1, v2, v3};
+          WriteBinary (values, 3);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -287,14 +341,14 @@ FileAggregator::Write3d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
           // Write the values with the proper separator.
           m_file << v1 << m_separator
                  << v2 << m_separator
-                 << v3 << std::endl;
+                 << v3 << '\n';
         }
     }
 }
@@ -311,7 +365,12 @@ FileAggregator::Write4d (std::string context,
   if (m_enabled)
     {
       // Write the 4D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[4] = {v1, v2, v3, v4};
+          WriteBinary (values, 4);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -333,7 +392,7 @@ FileAggregator::Write4d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -341,7 +400,7 @@ FileAggregator::Write4d (std::string context,
           m_file << v1 << m_separator
                  << v2 << m_separator
                  << v3 << m_separator
-                 << v4 << std::endl;
+                 << v4 << '\n';
         }
     }
 }
@@ -359,7 +418,12 @@ FileAggregator::Write5d (std::string context,
   if (m_enabled)
     {
       // Write the 5D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[5] = {v1, v2, v3, v4, v5};
+          WriteBinary (values, 5);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -382,7 +446,7 @@ FileAggregator::Write5d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -391,7 +455,7 @@ FileAggregator::Write5d (std::string context,
                  << v2 << m_separator
                  << v3 << m_separator
                  << v4 << m_separator
-                 << v5 << std::endl;
+                 << v5 << '\n';
         }
     }
 }
@@ -410,7 +474,12 @@ FileAggregator::Write6d (std::string context,
   if (m_enabled)
     {
       // Write the 6D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[6] = {v1, v2, v3, v4, v5, v6};
+          WriteBinary (values, 6);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -434,7 +503,7 @@ FileAggregator::Write6d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -444,7 +513,7 @@ FileAggregator::Write6d (std::string context,
                  << v3 << m_separator
                  << v4 << m_separator
                  << v5 << m_separator
-                 << v6 << std::endl;
+                 << v6 << '\n';
         }
     }
 }
@@ -464,7 +533,12 @@ FileAggregator::Write7d (std::string context,
   if (m_enabled)
     {
       // Write the 7D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[7] = {v1, v2, v3, v4, v5, v6, v7};
+          WriteBinary (values, 7);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -489,7 +563,7 @@ FileAggregator::Write7d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -500,7 +574,7 @@ FileAggregator::Write7d (std::string context,
                  << v4 << m_separator
                  << v5 << m_separator
                  << v6 << m_separator
-                 << v7 << std::endl;
+                 << v7 << '\n';
         }
     }
 }
@@ -521,7 +595,12 @@ FileAggregator::Write8d (std::string context,
   if (m_enabled)
     {
       // Write the 8D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[8] = {v1, v2, v3, v4, v5, v6, v7, v8};
+          WriteBinary (values, 8);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -547,7 +626,7 @@ FileAggregator::Write8d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -559,7 +638,7 @@ FileAggregator::Write8d (std::string context,
                  << v5 << m_separator
                  << v6 << m_separator
                  << v7 << m_separator
-                 << v8 << std::endl;
+                 << v8 << '\n';
         }
     }
 }
@@ -580,7 +659,12 @@ FileAggregator::Write9d (std::string context,
   if (m_enabled)
     {
       // Write the 9D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[9] = {v1, v2, v3, v4, v5, v6, v7, v8, v9};
+          WriteBinary (values, 9);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -607,7 +691,7 @@ FileAggregator::Write9d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -620,7 +704,7 @@ FileAggregator::Write9d (std::string context,
                  << v6 << m_separator
                  << v7 << m_separator
                  << v8 << m_separator
-                 << v9 << std::endl;
+                 << v9 << '\n';
         }
     }
 }
@@ -642,7 +726,12 @@ FileAggregator::Write10d (std::string context,
   if (m_enabled)
     {
       // Write the 10D data point to the file.
-      if (m_fileType == FORMATTED)
+      if (m_fileType == BINARY)
+        {
+          double values[10] = {v1, v2, v3, v4, v5, v6, v7, v8, v9, v10};
+          WriteBinary (values, 10);
+        }
+      else if (m_fileType == FORMATTED)
         {
           // Initially, have the C-style string in the buffer, which
           // is terminated by a null character, be of length zero.
@@ -670,7 +759,7 @@ FileAggregator::Write10d (std::string context,
             }
 
           // Write the formatted values.
-          m_file << buffer << std::endl;
+          m_file << buffer << '\n';
         }
       else
         {
@@ -684,7 +773,7 @@ FileAggregator::Write10d (std::string context,
                  << v7 << m_separator
                  << v8 << m_separator
                  << v9 << m_separator
-                 << v10 << std::endl;
+                 << v10 << '\n';
         }
     }
 }
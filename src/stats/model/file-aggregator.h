@@ -27,6 +27,7 @@
 #include <fstream>
 #include <map>
 #include <string>
+#include <vector>
 #include "ns3/data-collection-object.h"
 
 namespace ns3 {
@@ -35,6 +36,13 @@ namespace ns3 {
  * \ingroup aggregator
  *
  * This aggregator sends values it receives to a file.
+ *
+ * The text files are block-buffered, hence the values are only
+ * guaranteed to be in the file once the aggregator is destroyed.
+ * The BINARY file type writes for each data point a byte holding the
+ * number of values, followed by the values as doubles in the host byte
+ * order; it avoids the formatting of the values and writes the file by
+ * blocks of BINARY_BUFFER_SIZE bytes.
  **/
 class FileAggregator : public DataCollectionObject
 {
@@ -45,9 +53,13 @@ public:
     FORMATTED,
     SPACE_SEPARATED,
     COMMA_SEPARATED,
-    TAB_SEPARATED
+    TAB_SEPARATED,
+    BINARY
   };
 
+  /// The size of the blocks written to the binary files.
+  static constexpr uint32_t BINARY_BUFFER_SIZE = 65536;
+
   /**
    * \brief Get the type ID.
    * \return the object TypeId
@@ -72,7 +84,8 @@ public:
    * printing the file.
    *
    * \brief Set the file type to create, which determines the
-   * separator to use when printing values to the file.
+   * separator to use when printing values to the file.  Leaving the
+   * BINARY type writes the buffered data points first.
    */
   void SetFileType (enum FileType fileType);
 
@@ -83,7 +96,8 @@ public:
    * line of the file.
    *
    * Note that the heading string will only be printed if it has been
-   * set by calling this function.
+   * set by calling this function, and that it is not printed in
+   * binary files.
    */
   void SetHeading (const std::string &heading);
 
@@ -352,9 +366,25 @@ public:
                  double v10);
 
 private:
+  /**
+   * \param values the values of the data point.
+   * \param n the number of values.
+   *
+   * \brief Appends a data point to the binary file buffer.
+   */
+  void WriteBinary (const double *values, uint8_t n);
+
+  /**
+   * \brief Writes the binary file buffer to the file.
+   */
+  void FlushBinary (void);
+
   /// The file name.
   std::string m_outputFileName;
 
+  /// The data points not yet written to the binary file.
+  std::vector<uint8_t> m_buffer;
+
   /// Used to write values to the file.
   std::ofstream m_file;
 
@@ -0,0 +1,231 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+
+#include "quantile-calculator.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/double.h"
+#include "ns3/uinteger.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuantileCalculator");
+
+NS_OBJECT_ENSURE_REGISTERED (QuantileCalculator);
+
+TypeId
+QuantileCalculator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuantileCalculator")
+    .SetParent<DataCalculator> ()
+    .SetGroupName ("Stats")
+    .AddConstructor<QuantileCalculator> ()
+    .AddAttribute ("RelativeAccuracy",
+                   "The relative accuracy of the estimated quantiles.",
+                   DoubleValue (0.01),
+                   MakeDoubleAccessor (&QuantileCalculator::SetRelativeAccuracy,
+                                       &QuantileCalculator::GetRelativeAccuracy),
+                   MakeDoubleChecker<double> (1e-6, 0.5))
+    .AddAttribute ("MaxBins",
+                   "The maximum number of bins for each sign of the values; "
+                   "beyond, the lowest bins are collapsed.",
+                   UintegerValue (2048),
+                   MakeUintegerAccessor (&QuantileCalculator::SetMaxBins,
+                                         &QuantileCalculator::GetMaxBins),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QuantileCalculator::QuantileCalculator ()
+  : m_squareTotal (0),
+    m_mean (0),
+    m_s (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+QuantileCalculator::~QuantileCalculator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+QuantileCalculator::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  DataCalculator::DoDispose ();
+}
+
+void
+QuantileCalculator::SetRelativeAccuracy (double relativeAccuracy)
+{
+  NS_LOG_FUNCTION (this << relativeAccuracy);
+  NS_ABORT_MSG_IF (m_sketch.GetCount () > 0, "The relative accuracy can only be set before any update");
+  m_sketch = QuantileSketch (relativeAccuracy, m_sketch.GetMaxBins ());
+}
+
+double
+QuantileCalculator::GetRelativeAccuracy (void) const
+{
+  return m_sketch.GetRelativeAccuracy ();
+}
+
+void
+QuantileCalculator::SetMaxBins (uint32_t maxBins)
+{
+  NS_LOG_FUNCTION (this << maxBins);
+  NS_ABORT_MSG_IF (m_sketch.GetCount () > 0, "The maximum number of bins can only be set before any update");
+  m_sketch = QuantileSketch (m_sketch.GetRelativeAccuracy (), maxBins);
+}
+
+uint32_t
+QuantileCalculator::GetMaxBins (void) const
+{
+  return m_sketch.GetMaxBins ();
+}
+
+void
+QuantileCalculator::Update (const double i)
+{
+  if (m_enabled)
+    {
+      m_sketch.Add (i);
+      m_squareTotal += i * i;
+
+      // Welford's update of the mean and of the sum of squared
+      // differences from the mean, as in MinMaxAvgTotalCalculator
+      double meanPrev = m_mean;
+      m_mean += (i - meanPrev) / m_sketch.GetCount ();
+      m_s += (i - meanPrev) * (i - m_mean);
+    }
+}
+
+void
+QuantileCalculator::TraceSinkDouble (double oldValue, double newValue)
+{
+  Update (newValue);
+}
+
+void
+QuantileCalculator::Merge (Ptr<const QuantileCalculator> other)
+{
+  NS_LOG_FUNCTION (this << other);
+  uint64_t count = m_sketch.GetCount ();
+  uint64_t otherCount = other->m_sketch.GetCount ();
+  if (otherCount == 0)
+    {
+      return;
+    }
+  m_sketch.Merge (other->m_sketch);
+  m_squareTotal += other->m_squareTotal;
+
+  // combine the means and the sums of squared differences of both sets
+  // (Chan, Golub and LeVeque, 1979)
+  double total = count + otherCount;
+  double delta = other->m_mean - m_mean;
+  m_mean += delta * otherCount / total;
+  m_s += other->m_s + delta * delta * count * otherCount / total;
+}
+
+void
+QuantileCalculator::Reset ()
+{
+  NS_LOG_FUNCTION (this);
+  m_sketch.Reset ();
+  m_squareTotal = 0;
+  m_mean = 0;
+  m_s = 0;
+}
+
+double
+QuantileCalculator::GetQuantile (double q) const
+{
+  return m_sketch.GetQuantile (q);
+}
+
+const QuantileSketch &
+QuantileCalculator::GetSketch (void) const
+{
+  return m_sketch;
+}
+
+void
+QuantileCalculator::Output (DataOutputCallback &callback) const
+{
+  callback.OutputStatistic (m_context, m_key, this);
+  callback.OutputSingleton (m_context, m_key + "-p50", GetQuantile (0.5));
+  callback.OutputSingleton (m_context, m_key + "-p90", GetQuantile (0.9));
+  callback.OutputSingleton (m_context, m_key + "-p99", GetQuantile (0.99));
+  callback.OutputSingleton (m_context, m_key + "-p999", GetQuantile (0.999));
+}
+
+long
+QuantileCalculator::getCount () const
+{
+  return m_sketch.GetCount ();
+}
+
+double
+QuantileCalculator::getSum () const
+{
+  return m_sketch.GetSum ();
+}
+
+double
+QuantileCalculator::getMin () const
+{
+  return m_sketch.GetCount () > 0 ? m_sketch.GetMin () : NaN;
+}
+
+double
+QuantileCalculator::getMax () const
+{
+  return m_sketch.GetCount () > 0 ? m_sketch.GetMax () : NaN;
+}
+
+double
+QuantileCalculator::getMean () const
+{
+  return m_sketch.GetCount () > 0 ? m_mean : NaN;
+}
+
+double
+QuantileCalculator::getStddev () const
+{
+  return std::sqrt (getVariance ());
+}
+
+double
+QuantileCalculator::getVariance () const
+{
+  uint64_t count = m_sketch.GetCount ();
+  if (count == 0)
+    {
+      return NaN;
+    }
+  return count > 1 ? m_s / (count - 1) : 0;
+}
+
+double
+QuantileCalculator::getSqrSum () const
+{
+  return m_squareTotal;
+}
+
+} // namespace ns3
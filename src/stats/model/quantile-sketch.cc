@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "quantile-sketch.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("QuantileSketch");
+
+QuantileSketch::Bins::Bins ()
+  : offset (0),
+    total (0)
+{
+}
+
+void
+QuantileSketch::Bins::Add (int32_t index, uint64_t count, uint32_t maxBins)
+{
+  if (counts.empty ())
+    {
+      offset = index;
+      counts.push_back (0);
+    }
+  if (index < offset)
+    {
+      // grow downwards, but values below the lowest bin allowed are
+      // counted in the lowest bin
+      int64_t grow = std::min (static_cast<int64_t> (offset) - index,
+                               static_cast<int64_t> (maxBins) - static_cast<int64_t> (counts.size ()));
+      counts.insert (counts.begin (), grow, 0);
+      offset -= grow;
+      index = std::max (index, offset);
+    }
+  else if (static_cast<int64_t> (index) - offset >= static_cast<int64_t> (counts.size ()))
+    {
+      int64_t size = static_cast<int64_t> (index) - offset + 1;
+      if (size > maxBins)
+        {
+          // collapse the lowest bins to make room for the new one
+          int64_t drop = size - maxBins;
+          int64_t erased = std::min (drop, static_cast<int64_t> (counts.size ()));
+          uint64_t collapsed = 0;
+          for (int64_t i = 0; i < erased; i++)
+            {
+              collapsed += counts[i];
+            }
+          counts.erase (counts.begin (), counts.begin () + erased);
+          offset += drop;
+          if (counts.empty ())
+            {
+              counts.push_back (0);
+            }
+          counts[0] += collapsed;
+        }
+      counts.resize (index - offset + 1, 0);
+    }
+  counts[index - offset] += count;
+  total += count;
+}
+
+int32_t
+QuantileSketch::Bins::FindIndex (uint64_t rank, bool fromLowest) const
+{
+  NS_ASSERT (rank < total);
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < counts.size (); i++)
+    {
+      uint32_t bin = fromLowest ? i : counts.size () - 1 - i;
+      seen += counts[bin];
+      if (seen > rank)
+        {
+          return offset + bin;
+        }
+    }
+  NS_ASSERT_MSG (false, "Inconsistent number of values in the bins");
+  return offset;
+}
+
+QuantileSketch::QuantileSketch (double relativeAccuracy, uint32_t maxBins)
+  : m_relativeAccuracy (relativeAccuracy),
+    m_gamma ((1 + relativeAccuracy) / (1 - relativeAccuracy)),
+    m_logGamma (std::log (m_gamma)),
+    m_maxBins (maxBins),
+    m_zeros (0),
+    m_sum (0),
+    m_min (0),
+    m_max (0)
+{
+  NS_ASSERT_MSG (relativeAccuracy > 0 && relativeAccuracy < 1,
+                 "The relative accuracy must be in (0, 1)");
+  NS_ASSERT_MSG (maxBins > 0, "At least one bin is needed");
+}
+
+int32_t
+QuantileSketch::GetIndex (double value) const
+{
+  return static_cast<int32_t> (std::ceil (std::log (value) / m_logGamma));
+}
+
+double
+QuantileSketch::GetValue (int32_t index) const
+{
+  // the bin holds the values in (gamma^(index-1), gamma^index]; this
+  // value is within the relative accuracy of both boundaries
+  return 2 * std::exp (index * m_logGamma) / (m_gamma + 1);
+}
+
+void
+QuantileSketch::Add (double value)
+{
+  NS_ASSERT_MSG (std::isfinite (value), "Cannot add " << value << " to a QuantileSketch");
+  if (GetCount () == 0)
+    {
+      m_min = value;
+      m_max = value;
+    }
+  else
+    {
+      m_min = std::min (m_min, value);
+      m_max = std::max (m_max, value);
+    }
+  m_sum += value;
+
+  if (value > 0)
+    {
+      m_positive.Add (GetIndex (value), 1, m_maxBins);
+    }
+  else if (value < 0)
+    {
+      m_negative.Add (GetIndex (-value), 1, m_maxBins);
+    }
+  else
+    {
+      m_zeros++;
+    }
+}
+
+void
+QuantileSketch::Merge (const QuantileSketch &other)
+{
+  NS_ASSERT_MSG (other.m_relativeAccuracy == m_relativeAccuracy,
+                 "Cannot merge sketches with a different relative accuracy");
+  if (other.GetCount () == 0)
+    {
+      return;
+    }
+  if (&other == this)
+    {
+      // adding the bins of a sketch to themselves would read them while
+      // they are being resized: double each count instead; the minimum
+      // and the maximum are unchanged
+      for (uint32_t i = 0; i < m_positive.counts.size (); i++)
+        {
+          m_positive.counts[i] *= 2;
+        }
+      for (uint32_t i = 0; i < m_negative.counts.size (); i++)
+        {
+          m_negative.counts[i] *= 2;
+        }
+      m_positive.total *= 2;
+      m_negative.total *= 2;
+      m_zeros *= 2;
+      m_sum *= 2;
+      return;
+    }
+  if (GetCount () == 0)
+    {
+      m_min = other.m_min;
+      m_max = other.m_max;
+    }
+  else
+    {
+      m_min = std::min (m_min, other.m_min);
+      m_max = std::max (m_max, other.m_max);
+    }
+  m_sum += other.m_sum;
+  m_zeros += other.m_zeros;
+
+  for (uint32_t i = 0; i < other.m_positive.counts.size (); i++)
+    {
+      if (other.m_positive.counts[i] > 0)
+        {
+          m_positive.Add (other.m_positive.offset + i, other.m_positive.counts[i], m_maxBins);
+        }
+    }
+  for (uint32_t i = 0; i < other.m_negative.counts.size (); i++)
+    {
+      if (other.m_negative.counts[i] > 0)
+        {
+          m_negative.Add (other.m_negative.offset + i, other.m_negative.counts[i], m_maxBins);
+        }
+    }
+}
+
+void
+QuantileSketch::Reset (void)
+{
+  m_positive = Bins ();
+  m_negative = Bins ();
+  m_zeros = 0;
+  m_sum = 0;
+  m_min = 0;
+  m_max = 0;
+}
+
+double
+QuantileSketch::GetQuantile (double q) const
+{
+  uint64_t count = GetCount ();
+  if (count == 0)
+    {
+      return 0;
+    }
+  if (q <= 0)
+    {
+      return m_min;
+    }
+  if (q >= 1)
+    {
+      return m_max;
+    }
+
+  uint64_t rank = static_cast<uint64_t> (q * (count - 1));
+  double value;
+  if (rank < m_negative.total)
+    {
+      // the most negative values are in the highest bins
+      value = -GetValue (m_negative.FindIndex (rank, false));
+    }
+  else if (rank < m_negative.total + m_zeros)
+    {
+      value = 0;
+    }
+  else
+    {
+      value = GetValue (m_positive.FindIndex (rank - m_negative.total - m_zeros, true));
+    }
+  return std::min (std::max (value, m_min), m_max);
+}
+
+uint64_t
+QuantileSketch::GetCount (void) const
+{
+  return m_negative.total + m_zeros + m_positive.total;
+}
+
+double
+QuantileSketch::GetSum (void) const
+{
+  return m_sum;
+}
+
+double
+QuantileSketch::GetMin (void) const
+{
+  return m_min;
+}
+
+double
+QuantileSketch::GetMax (void) const
+{
+  return m_max;
+}
+
+double
+QuantileSketch::GetRelativeAccuracy (void) const
+{
+  return m_relativeAccuracy;
+}
+
+uint32_t
+QuantileSketch::GetMaxBins (void) const
+{
+  return m_maxBins;
+}
+
+uint32_t
+QuantileSketch::GetNBins (void) const
+{
+  return m_positive.counts.size () + m_negative.counts.size ();
+}
+
+void
+QuantileSketch::SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string elementName) const
+{
+  os << std::string (indent, ' ') << "<" << elementName
+     << " count=\"" << GetCount () << "\""
+     << " p50=\"" << GetQuantile (0.5) << "\""
+     << " p90=\"" << GetQuantile (0.9) << "\""
+     << " p99=\"" << GetQuantile (0.99) << "\""
+     << " p999=\"" << GetQuantile (0.999) << "\""
+     << " />\n";
+}
+
+} // namespace ns3
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <vector>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Streaming estimation of the quantiles of a set of values.
+ *
+ * The values are counted in bins whose boundaries grow geometrically,
+ * as in an HDR histogram: the bin \a i of the positive values holds
+ * the values in (gamma^(i-1), gamma^i], with
+ * gamma = (1 + a) / (1 - a) and \a a the relative accuracy.  Negative
+ * values are counted in a second set of bins, by absolute value, and
+ * zeros in a counter of their own.  Any quantile is then estimated
+ * with a relative error of at most \a a, whatever the distribution of
+ * the values: with the default accuracy of 1%, a p99 delay of 10 ms
+ * is reported between 9.9 ms and 10.1 ms.
+ *
+ * Adding a value takes a constant time.  The bins of each sign are
+ * stored contiguously, from the smallest to the largest bin used so
+ * far, and there are never more than \a maxBins of them: when a new
+ * value would need more, the lowest bins are collapsed into one, which
+ * only degrades the accuracy of the lowest quantiles.  With the
+ * default accuracy, 2048 bins span more than 17 decades, so collapsing
+ * rarely happens in practice.
+ *
+ * Two sketches with the same relative accuracy can be merged, e.g.,
+ * to combine the results of independent simulation runs, or of
+ * several flows.  The count, sum, minimum and maximum of the values
+ * are also kept, exactly.
+ *
+ * Unlike Histogram, this class never needs to be told the range or
+ * the resolution of the values beforehand.
+ */
+class QuantileSketch
+{
+public:
+  /**
+   * \brief Constructor
+   * \param relativeAccuracy the relative accuracy of the quantiles, in (0, 1)
+   * \param maxBins the maximum number of bins for each sign of the values
+   */
+  QuantileSketch (double relativeAccuracy = 0.01, uint32_t maxBins = 2048);
+
+  /**
+   * \brief Add a value to the sketch
+   * \param value the value to add
+   */
+  void Add (double value);
+
+  /**
+   * \brief Add the values of another sketch to this one.
+   *
+   * Both sketches must have the same relative accuracy.  A sketch
+   * merged with itself counts each of its values twice.
+   *
+   * \param other the sketch to merge
+   */
+  void Merge (const QuantileSketch &other);
+
+  /**
+   * \brief Remove all the values.
+   */
+  void Reset (void);
+
+  /**
+   * \brief Estimate a quantile of the values.
+   *
+   * The 0 and 1 quantiles are the exact minimum and maximum.
+   *
+   * \param q the quantile, in [0, 1], e.g., 0.99 for the 99th percentile
+   * \return the estimated quantile, or 0 if no value was added
+   */
+  double GetQuantile (double q) const;
+
+  /**
+   * \return the number of values added
+   */
+  uint64_t GetCount (void) const;
+  /**
+   * \return the sum of the values added
+   */
+  double GetSum (void) const;
+  /**
+   * \return the smallest value added, or 0 if no value was added
+   */
+  double GetMin (void) const;
+  /**
+   * \return the largest value added, or 0 if no value was added
+   */
+  double GetMax (void) const;
+  /**
+   * \return the relative accuracy of the quantiles
+   */
+  double GetRelativeAccuracy (void) const;
+  /**
+   * \return the maximum number of bins for each sign of the values
+   */
+  uint32_t GetMaxBins (void) const;
+  /**
+   * \return the number of bins currently allocated, for both signs
+   */
+  uint32_t GetNBins (void) const;
+
+  /**
+   * \brief Serializes the 50th, 90th, 99th and 99.9th percentiles
+   * to an std::ostream in XML format.
+   * \param os the output stream
+   * \param indent number of spaces to use as base indentation level
+   * \param elementName name of the element to serialize.
+   */
+  void SerializeToXmlStream (std::ostream &os, uint16_t indent, std::string elementName) const;
+
+private:
+  /**
+   * \brief The bins of the values of one sign
+   */
+  struct Bins
+  {
+    Bins ();
+    /**
+     * Count values in a bin
+     * \param index the bin index
+     * \param count the number of values
+     * \param maxBins the maximum number of bins
+     */
+    void Add (int32_t index, uint64_t count, uint32_t maxBins);
+    /**
+     * \param rank a rank, smaller than the number of values in these bins
+     * \param fromLowest whether ranks are counted from the lowest bin
+     * \return the index of the bin holding the value of the given rank
+     */
+    int32_t FindIndex (uint64_t rank, bool fromLowest) const;
+
+    std::vector<uint64_t> counts; //!< the number of values in each bin
+    int32_t offset;               //!< the index of the first bin
+    uint64_t total;               //!< the number of values in all the bins
+  };
+
+  /**
+   * \param value a value strictly greater than zero
+   * \return the index of the bin of the value
+   */
+  int32_t GetIndex (double value) const;
+  /**
+   * \param index a bin index
+   * \return the value reported for the bin, within the relative accuracy
+   *         of all the values of the bin
+   */
+  double GetValue (int32_t index) const;
+
+  double m_relativeAccuracy; //!< the relative accuracy
+  double m_gamma;            //!< the ratio of the boundaries of consecutive bins
+  double m_logGamma;         //!< the logarithm of m_gamma
+  uint32_t m_maxBins;        //!< the maximum number of bins of each sign
+  Bins m_positive;           //!< the bins of the positive values
+  Bins m_negative;           //!< the bins of the negative values, by absolute value
+  uint64_t m_zeros;          //!< the number of values equal to zero
+  double m_sum;              //!< the sum of the values
+  double m_min;              //!< the smallest value
+  double m_max;              //!< the largest value
+};
+
+} // namespace ns3
+
+#endif /* QUANTILE_SKETCH_H */
@@ -66,6 +66,11 @@ SqliteDataOutput::Output (DataCollector &dc)
 
   m_sqliteOut = new SQLiteOutput (m_dbFile, "ns-3-sqlite-data-output-sem");
 
+  // all the rows are inserted in a single transaction, since every
+  // transaction is synced to the disk
+  res = m_sqliteOut->SpinExec ("BEGIN");
+  NS_ASSERT (res);
+
   res = m_sqliteOut->SpinExec ("CREATE TABLE IF NOT EXISTS Experiments (run, experiment, strategy, input, description text)");
   NS_ASSERT (res);
 
@@ -115,13 +120,14 @@ SqliteDataOutput::Output (DataCollector &dc)
 
   m_sqliteOut->SpinFinalize (stmt);
 
-  m_sqliteOut->SpinExec ("BEGIN");
-  SqliteOutputCallback callback (m_sqliteOut, run);
-  for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
-       i != dc.DataCalculatorEnd (); i++)
-    {
-      (*i)->Output (callback);
-    }
+  {
+    SqliteOutputCallback callback (m_sqliteOut, run);
+    for (DataCalculatorList::iterator i = dc.DataCalculatorBegin ();
+         i != dc.DataCalculatorEnd (); i++)
+      {
+        (*i)->Output (callback);
+      }
+  }
   m_sqliteOut->SpinExec ("COMMIT");
   // end SqliteDataOutput::Output
 }
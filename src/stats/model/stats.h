@@ -31,6 +31,7 @@
  * <ul>
  * <li> The core framework and two basic data collectors: A counter, and a min/max/avg/total observer.</li>
  * <li> Extensions of those to easily work with times and packets.</li>
+ * <li> A quantile observer, which estimates percentiles in constant memory.</li>
  * <li> Plaintext output formatted for OMNet++.</li>
  * <li> Database output using SQLite, a standalone, lightweight, high performance SQL engine.</li>
  * <li> Mandatory and open ended metadata for describing and working with runs.</li>
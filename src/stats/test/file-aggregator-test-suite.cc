@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/file-aggregator.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief Check the text files written by the FileAggregator
+ */
+class FileAggregatorTextTestCase : public TestCase
+{
+public:
+  FileAggregatorTextTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FileAggregatorTextTestCase::FileAggregatorTextTestCase ()
+  : TestCase ("Check the text files written by the FileAggregator")
+{
+}
+
+void
+FileAggregatorTextTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("file-aggregator.txt");
+  {
+    Ptr<FileAggregator> aggregator = CreateObject<FileAggregator> (fileName, FileAggregator::COMMA_SEPARATED);
+    aggregator->SetHeading ("time,value");
+    aggregator->Enable ();
+    aggregator->Write2d ("context", 1, 2.5);
+    aggregator->Write3d ("context", 2, 3, 4);
+    aggregator->Disable ();
+    aggregator->Write1d ("context", 5);
+  }
+
+  std::ifstream file (fileName.c_str ());
+  std::ostringstream content;
+  content << file.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (content.str (), "time,value\n1,2.5\n2,3,4\n", "Unexpected file content");
+}
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief Check the binary files written by the FileAggregator
+ */
+class FileAggregatorBinaryTestCase : public TestCase
+{
+public:
+  FileAggregatorBinaryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FileAggregatorBinaryTestCase::FileAggregatorBinaryTestCase ()
+  : TestCase ("Check the binary files written by the FileAggregator")
+{
+}
+
+void
+FileAggregatorBinaryTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("file-aggregator.bin");
+  // more data points than fit in a buffer
+  uint32_t n = 2 * FileAggregator::BINARY_BUFFER_SIZE / (1 + 2 * sizeof (double)) + 10;
+  {
+    Ptr<FileAggregator> aggregator = CreateObject<FileAggregator> (fileName, FileAggregator::BINARY);
+    aggregator->SetHeading ("not written");
+    aggregator->Enable ();
+    for (uint32_t i = 0; i < n; i++)
+      {
+        aggregator->Write2d ("context", i, i * 0.5);
+      }
+    aggregator->Write10d ("context", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+    // the buffered data points are written before the text ones
+    aggregator->SetFileType (FileAggregator::SPACE_SEPARATED);
+    aggregator->Write1d ("context", 11);
+  }
+
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint8_t dimension = 0;
+      double values[2] = {0, 0};
+      file.read (reinterpret_cast<char *> (&dimension), 1);
+      file.read (reinterpret_cast<char *> (values), sizeof (values));
+      NS_TEST_ASSERT_MSG_EQ (file.good (), true, "The file is too short");
+      NS_TEST_ASSERT_MSG_EQ (static_cast<uint32_t> (dimension), 2, "Wrong dimension of data point " << i);
+      NS_TEST_ASSERT_MSG_EQ (values[0], i, "Wrong first value of data point " << i);
+      NS_TEST_ASSERT_MSG_EQ (values[1], i * 0.5, "Wrong second value of data point " << i);
+    }
+  uint8_t dimension = 0;
+  double values[10];
+  file.read (reinterpret_cast<char *> (&dimension), 1);
+  file.read (reinterpret_cast<char *> (values), sizeof (values));
+  NS_TEST_ASSERT_MSG_EQ (file.good (), true, "The file is too short");
+  NS_TEST_EXPECT_MSG_EQ (static_cast<uint32_t> (dimension), 10, "Wrong dimension of the last data point");
+  NS_TEST_EXPECT_MSG_EQ (values[9], 10, "Wrong last binary value");
+  std::ostringstream text;
+  text << file.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (text.str (), "11\n", "Wrong text after the binary data points");
+}
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief FileAggregator TestSuite
+ */
+class FileAggregatorTestSuite : public TestSuite
+{
+public:
+  FileAggregatorTestSuite ();
+};
+
+FileAggregatorTestSuite::FileAggregatorTestSuite ()
+  : TestSuite ("file-aggregator", UNIT)
+{
+  AddTestCase (new FileAggregatorTextTestCase, TestCase::QUICK);
+  AddTestCase (new FileAggregatorBinaryTestCase, TestCase::QUICK);
+}
+
+static FileAggregatorTestSuite g_fileAggregatorTestSuite; //!< Static variable for test initialization
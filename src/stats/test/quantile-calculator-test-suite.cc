@@ -0,0 +1,378 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/quantile-sketch.h"
+#include "ns3/quantile-calculator.h"
+#include "ns3/double-probe.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief Check the quantiles estimated by the QuantileSketch against the exact ones
+ */
+class QuantileSketchAccuracyTestCase : public TestCase
+{
+public:
+  QuantileSketchAccuracyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Add the values to a sketch and check its quantiles
+   * \param values the values
+   * \param name the name of the distribution, for the messages
+   */
+  void CheckQuantiles (std::vector<double> values, std::string name);
+};
+
+QuantileSketchAccuracyTestCase::QuantileSketchAccuracyTestCase ()
+  : TestCase ("Check the quantiles estimated by the QuantileSketch against the exact ones")
+{
+}
+
+void
+QuantileSketchAccuracyTestCase::CheckQuantiles (std::vector<double> values, std::string name)
+{
+  QuantileSketch sketch (0.01);
+  double sum = 0;
+  for (uint32_t i = 0; i < values.size (); i++)
+    {
+      sketch.Add (values[i]);
+      sum += values[i];
+    }
+  std::sort (values.begin (), values.end ());
+
+  NS_TEST_ASSERT_MSG_EQ (sketch.GetCount (), values.size (), "Wrong count for " << name);
+  NS_TEST_EXPECT_MSG_EQ_TOL (sketch.GetSum (), sum, 1e-9 * std::fabs (sum), "Wrong sum for " << name);
+  NS_TEST_EXPECT_MSG_EQ (sketch.GetMin (), values.front (), "Wrong minimum for " << name);
+  NS_TEST_EXPECT_MSG_EQ (sketch.GetMax (), values.back (), "Wrong maximum for " << name);
+  NS_TEST_EXPECT_MSG_EQ (sketch.GetQuantile (0), values.front (), "Wrong 0 quantile for " << name);
+  NS_TEST_EXPECT_MSG_EQ (sketch.GetQuantile (1), values.back (), "Wrong 1 quantile for " << name);
+
+  double quantiles[] = {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999};
+  for (uint32_t i = 0; i < sizeof (quantiles) / sizeof (quantiles[0]); i++)
+    {
+      double q = quantiles[i];
+      double exact = values[static_cast<uint32_t> (q * (values.size () - 1))];
+      NS_TEST_EXPECT_MSG_EQ_TOL (sketch.GetQuantile (q), exact, 0.01 * std::fabs (exact) + 1e-15,
+                                 "Quantile " << q << " out of the relative accuracy for " << name);
+    }
+}
+
+void
+QuantileSketchAccuracyTestCase::DoRun (void)
+{
+  uint32_t n = 100000;
+  Ptr<ExponentialRandomVariable> exponential = CreateObject<ExponentialRandomVariable> ();
+  exponential->SetAttribute ("Mean", DoubleValue (0.01));
+  exponential->SetAttribute ("Bound", DoubleValue (0));
+  Ptr<ParetoRandomVariable> pareto = CreateObject<ParetoRandomVariable> ();
+  pareto->SetAttribute ("Scale", DoubleValue (1e-3));
+  pareto->SetAttribute ("Shape", DoubleValue (1.2));
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetAttribute ("Min", DoubleValue (-1));
+  uniform->SetAttribute ("Max", DoubleValue (1));
+
+  std::vector<double> values;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values.push_back (exponential->GetValue ());
+    }
+  CheckQuantiles (values, "exponential");
+
+  values.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values.push_back (pareto->GetValue ());
+    }
+  CheckQuantiles (values, "pareto");
+
+  // negative values, and zeros
+  values.clear ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values.push_back (i % 10 == 0 ? 0 : uniform->GetValue ());
+    }
+  CheckQuantiles (values, "uniform");
+
+  QuantileSketch empty;
+  NS_TEST_EXPECT_MSG_EQ (empty.GetQuantile (0.5), 0, "An empty sketch should report 0");
+}
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief Check the merging of QuantileSketches, and their bounded size
+ */
+class QuantileSketchMergeTestCase : public TestCase
+{
+public:
+  QuantileSketchMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuantileSketchMergeTestCase::QuantileSketchMergeTestCase ()
+  : TestCase ("Check the merging of QuantileSketches, and their bounded size")
+{
+}
+
+void
+QuantileSketchMergeTestCase::DoRun (void)
+{
+  Ptr<LogNormalRandomVariable> logNormal = CreateObject<LogNormalRandomVariable> ();
+  logNormal->SetAttribute ("Mu", DoubleValue (-5));
+  logNormal->SetAttribute ("Sigma", DoubleValue (2));
+
+  QuantileSketch all;
+  QuantileSketch first;
+  QuantileSketch second;
+  for (uint32_t i = 0; i < 10000; i++)
+    {
+      double value = logNormal->GetValue ();
+      all.Add (value);
+      // interleave both halves, to exercise the merging of bins
+      // allocated in a different order
+      if (i % 3 == 0)
+        {
+          first.Add (-value);
+        }
+      else
+        {
+          second.Add (value);
+        }
+    }
+  QuantileSketch merged;
+  merged.Add (0);
+  first.Merge (second);
+  merged.Merge (first);
+  NS_TEST_ASSERT_MSG_EQ (merged.GetCount (), all.GetCount () + 1, "Wrong count after merging");
+  NS_TEST_EXPECT_MSG_EQ (merged.GetMax (), second.GetMax (), "Wrong maximum after merging");
+
+  // the positive values of the merged sketch are counted in the same
+  // bins as those of the second sketch
+  uint64_t below = merged.GetCount () - second.GetCount ();
+  uint64_t ranks[] = {10, 1000, 5000, second.GetCount () - 2};
+  for (uint32_t i = 0; i < sizeof (ranks) / sizeof (ranks[0]); i++)
+    {
+      double q = (ranks[i] + 0.5) / (second.GetCount () - 1);
+      double mergedQ = (below + ranks[i] + 0.5) / (merged.GetCount () - 1);
+      NS_TEST_EXPECT_MSG_EQ (merged.GetQuantile (mergedQ), second.GetQuantile (q),
+                             "Merged sketch differs for rank " << ranks[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (merged.GetQuantile (0), first.GetMin (), "Wrong minimum after merging");
+
+  // merging disjoint parts gives the same bins as adding all the values
+  QuantileSketch low;
+  QuantileSketch high;
+  QuantileSketch both;
+  for (uint32_t i = 1; i <= 1000; i++)
+    {
+      (i % 2 ? low : high).Add (i * 1e-3);
+      both.Add (i * 1e-3);
+    }
+  low.Merge (high);
+  for (uint32_t i = 1; i < 100; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (low.GetQuantile (i / 100.0), both.GetQuantile (i / 100.0),
+                             "Merged sketch differs for quantile " << i / 100.0);
+    }
+
+  // a sketch merged with itself counts each value twice
+  QuantileSketch twice;
+  for (uint32_t i = 1; i <= 1000; i++)
+    {
+      twice.Add (i * 1e-3);
+      twice.Add (i * 1e-3);
+    }
+  twice.Add (0);
+  twice.Add (0);
+  twice.Add (-1);
+  twice.Add (-1);
+  both.Add (0);
+  both.Add (-1);
+  both.Merge (both);
+  NS_TEST_ASSERT_MSG_EQ (both.GetCount (), twice.GetCount (), "Wrong count after merging a sketch with itself");
+  NS_TEST_EXPECT_MSG_EQ_TOL (both.GetSum (), twice.GetSum (), 1e-9, "Wrong sum after merging a sketch with itself");
+  NS_TEST_EXPECT_MSG_EQ (both.GetMin (), -1, "Wrong minimum after merging a sketch with itself");
+  NS_TEST_EXPECT_MSG_EQ (both.GetMax (), 1, "Wrong maximum after merging a sketch with itself");
+  NS_TEST_EXPECT_MSG_EQ (both.GetNBins (), twice.GetNBins (), "Wrong bins after merging a sketch with itself");
+  for (uint32_t i = 1; i < 100; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (both.GetQuantile (i / 100.0), twice.GetQuantile (i / 100.0),
+                             "Self-merged sketch differs for quantile " << i / 100.0);
+    }
+
+  // values spanning 18 decades do not need more than the maximum number
+  // of bins, and the high quantiles are still accurate
+  QuantileSketch bounded (0.01, 64);
+  for (uint32_t i = 0; i < 18000; i++)
+    {
+      bounded.Add (std::pow (10, -9 + i / 1000.0));
+    }
+  NS_TEST_EXPECT_MSG_EQ ((bounded.GetNBins () <= 64), true, "Too many bins: " << bounded.GetNBins ());
+  double p999 = std::pow (10, -9 + 17981 / 1000.0);
+  NS_TEST_EXPECT_MSG_EQ_TOL (bounded.GetQuantile (0.999), p999, 0.01 * p999, "Wrong high quantile");
+  NS_TEST_EXPECT_MSG_EQ_TOL (bounded.GetQuantile (0), 1e-9, 1e-20, "Wrong minimum");
+}
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief A DataOutputCallback which records the values it is given
+ */
+class QuantileTestOutputCallback : public DataOutputCallback
+{
+public:
+  virtual void OutputStatistic (std::string key, std::string variable, const StatisticalSummary *statSum)
+  {
+    m_statistics[variable] = statSum;
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, int val)
+  {
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, uint32_t val)
+  {
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, double val)
+  {
+    m_values[variable] = val;
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, std::string val)
+  {
+  }
+  virtual void OutputSingleton (std::string key, std::string variable, Time val)
+  {
+  }
+
+  std::map<std::string, const StatisticalSummary *> m_statistics; //!< the statistics output
+  std::map<std::string, double> m_values;                         //!< the double singletons output
+};
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief Check the QuantileCalculator
+ */
+class QuantileCalculatorTestCase : public TestCase
+{
+public:
+  QuantileCalculatorTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+QuantileCalculatorTestCase::QuantileCalculatorTestCase ()
+  : TestCase ("Check the QuantileCalculator")
+{
+}
+
+void
+QuantileCalculatorTestCase::DoRun (void)
+{
+  Ptr<QuantileCalculator> calculator = CreateObject<QuantileCalculator> ();
+  calculator->SetKey ("delay");
+  calculator->SetAttribute ("RelativeAccuracy", DoubleValue (0.001));
+
+  // values given through a probe
+  Ptr<DoubleProbe> probe = CreateObject<DoubleProbe> ();
+  probe->TraceConnectWithoutContext ("Output", MakeCallback (&QuantileCalculator::TraceSinkDouble, calculator));
+  for (uint32_t i = 1; i <= 1000; i++)
+    {
+      probe->SetValue (i);
+    }
+  calculator->Disable ();
+  calculator->Update (1e6);
+  calculator->Enable ();
+
+  NS_TEST_ASSERT_MSG_EQ (calculator->getCount (), 1000, "Wrong count");
+  NS_TEST_EXPECT_MSG_EQ (calculator->getMin (), 1, "Wrong minimum");
+  NS_TEST_EXPECT_MSG_EQ (calculator->getMax (), 1000, "Wrong maximum");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getMean (), 500.5, 1e-9, "Wrong mean");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getVariance (), 83416.666666, 1e-3, "Wrong variance");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getSqrSum (), 333833500, 1e-3, "Wrong sum of squares");
+
+  QuantileTestOutputCallback callback;
+  calculator->Output (callback);
+  NS_TEST_EXPECT_MSG_EQ ((callback.m_statistics["delay"] == PeekPointer (calculator)), true, "Missing statistic");
+  NS_TEST_EXPECT_MSG_EQ_TOL (callback.m_values["delay-p50"], 500, 0.5, "Wrong p50");
+  NS_TEST_EXPECT_MSG_EQ_TOL (callback.m_values["delay-p90"], 900, 0.9, "Wrong p90");
+  NS_TEST_EXPECT_MSG_EQ_TOL (callback.m_values["delay-p99"], 990, 0.99, "Wrong p99");
+  NS_TEST_EXPECT_MSG_EQ_TOL (callback.m_values["delay-p999"], 999, 0.999, "Wrong p999");
+
+  // merging the calculator of another run
+  Ptr<QuantileCalculator> other = CreateObject<QuantileCalculator> ();
+  other->SetAttribute ("RelativeAccuracy", DoubleValue (0.001));
+  for (uint32_t i = 1001; i <= 2000; i++)
+    {
+      other->Update (i);
+    }
+  calculator->Merge (other);
+  NS_TEST_ASSERT_MSG_EQ (calculator->getCount (), 2000, "Wrong count after merging");
+  NS_TEST_EXPECT_MSG_EQ (calculator->getMax (), 2000, "Wrong maximum after merging");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getMean (), 1000.5, 1e-9, "Wrong mean after merging");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getVariance (), 333500, 1e-3, "Wrong variance after merging");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->GetQuantile (0.99), 1980, 1.98, "Wrong p99 after merging");
+
+  // merging a calculator with itself counts each value twice
+  calculator->Merge (calculator);
+  NS_TEST_ASSERT_MSG_EQ (calculator->getCount (), 4000, "Wrong count after merging with itself");
+  NS_TEST_EXPECT_MSG_EQ (calculator->getMax (), 2000, "Wrong maximum after merging with itself");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getMean (), 1000.5, 1e-9, "Wrong mean after merging with itself");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->getVariance (), 333416.604151, 1e-3, "Wrong variance after merging with itself");
+  NS_TEST_EXPECT_MSG_EQ_TOL (calculator->GetQuantile (0.99), 1980, 1.98, "Wrong p99 after merging with itself");
+
+  calculator->Reset ();
+  NS_TEST_EXPECT_MSG_EQ (calculator->getCount (), 0, "Wrong count after reset");
+  NS_TEST_EXPECT_MSG_EQ (isNaN (calculator->getMean ()), true, "The mean of no value should be NaN");
+}
+
+/**
+ * \ingroup stats-test
+ * \ingroup tests
+ *
+ * \brief QuantileCalculator TestSuite
+ */
+class QuantileCalculatorTestSuite : public TestSuite
+{
+public:
+  QuantileCalculatorTestSuite ();
+};
+
+QuantileCalculatorTestSuite::QuantileCalculatorTestSuite ()
+  : TestSuite ("quantile-calculator", UNIT)
+{
+  AddTestCase (new QuantileSketchAccuracyTestCase, TestCase::QUICK);
+  AddTestCase (new QuantileSketchMergeTestCase, TestCase::QUICK);
+  AddTestCase (new QuantileCalculatorTestCase, TestCase::QUICK);
+}
+
+static QuantileCalculatorTestSuite g_quantileCalculatorTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "fq-flow-table.h"
+
+namespace ns3 {
+
+constexpr uint32_t FqFlowTable::NO_FLOW;
+
+FqFlowTable::FqFlowTable ()
+{
+  m_lists[NEW_FLOWS].head = m_lists[NEW_FLOWS].tail = NO_FLOW;
+  m_lists[OLD_FLOWS].head = m_lists[OLD_FLOWS].tail = NO_FLOW;
+}
+
+void
+FqFlowTable::SetNBuckets (uint32_t buckets)
+{
+  m_buckets.assign (buckets, NO_FLOW);
+  m_tags.assign (buckets, 0);
+  m_links.clear ();
+  m_lists[NEW_FLOWS].head = m_lists[NEW_FLOWS].tail = NO_FLOW;
+  m_lists[OLD_FLOWS].head = m_lists[OLD_FLOWS].tail = NO_FLOW;
+}
+
+uint32_t
+FqFlowTable::GetNBuckets (void) const
+{
+  return m_buckets.size ();
+}
+
+uint32_t
+FqFlowTable::GetFlow (uint32_t bucket) const
+{
+  NS_ASSERT (bucket < m_buckets.size ());
+  return m_buckets[bucket];
+}
+
+void
+FqFlowTable::SetFlow (uint32_t bucket, uint32_t flow)
+{
+  NS_ASSERT (bucket < m_buckets.size () && flow != NO_FLOW);
+  m_buckets[bucket] = flow;
+  if (flow >= m_links.size ())
+    {
+      Link link = {NO_FLOW, NO_LIST};
+      m_links.resize (flow + 1, link);
+    }
+}
+
+uint32_t
+FqFlowTable::SetAssociativeHash (uint32_t flowHash, uint32_t setWays)
+{
+  uint32_t h = (flowHash % m_buckets.size ());
+  uint32_t innerHash = h % setWays;
+  uint32_t outerHash = h - innerHash;
+
+  for (uint32_t i = outerHash; i < outerHash + setWays && i < m_buckets.size (); i++)
+    {
+      // the buckets holding a flow have been tagged when chosen
+      if (m_buckets[i] == NO_FLOW
+          || m_tags[i] == flowHash
+          || m_links[m_buckets[i]].list == NO_LIST)
+        {
+          // this queue has not been created yet or is associated with this flow
+          // or is inactive, hence we can use it
+          m_tags[i] = flowHash;
+          return i;
+        }
+    }
+
+  // all the queues of the set are used. Use the first queue of the set
+  m_tags[outerHash] = flowHash;
+  return outerHash;
+}
+
+bool
+FqFlowTable::IsEmpty (FlowList list) const
+{
+  NS_ASSERT (list != NO_LIST);
+  return m_lists[list].head == NO_FLOW;
+}
+
+uint32_t
+FqFlowTable::Front (FlowList list) const
+{
+  NS_ASSERT (list != NO_LIST);
+  return m_lists[list].head;
+}
+
+void
+FqFlowTable::PushBack (FlowList list, uint32_t flow)
+{
+  NS_ASSERT (list != NO_LIST && flow < m_links.size ());
+  NS_ASSERT_MSG (m_links[flow].list == NO_LIST, "Flow " << flow << " is already in a list");
+  Ends &ends = m_lists[list];
+  m_links[flow].next = NO_FLOW;
+  m_links[flow].list = list;
+  if (ends.tail == NO_FLOW)
+    {
+      ends.head = flow;
+    }
+  else
+    {
+      m_links[ends.tail].next = flow;
+    }
+  ends.tail = flow;
+}
+
+uint32_t
+FqFlowTable::PopFront (FlowList list)
+{
+  NS_ASSERT (list != NO_LIST);
+  Ends &ends = m_lists[list];
+  uint32_t flow = ends.head;
+  NS_ASSERT_MSG (flow != NO_FLOW, "The list is empty");
+  ends.head = m_links[flow].next;
+  if (ends.head == NO_FLOW)
+    {
+      ends.tail = NO_FLOW;
+    }
+  m_links[flow].next = NO_FLOW;
+  m_links[flow].list = NO_LIST;
+  return flow;
+}
+
+FqFlowTable::FlowList
+FqFlowTable::GetList (uint32_t flow) const
+{
+  NS_ASSERT (flow < m_links.size ());
+  return m_links[flow].list;
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_FLOW_TABLE_H
+#define FQ_FLOW_TABLE_H
+
+#include <stdint.h>
+#include <limits>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief Flow table of the flow queueing discs (FqCoDel, FqCobalt, FqPie)
+ *
+ * The table maps the hash buckets of the flow queueing discs to the index of
+ * the class of their flow, and keeps the lists of new and old flows of the
+ * DRR scheduler. The buckets are stored in flat arrays, and the lists are
+ * intrusive singly linked lists of flow indices, so that neither classifying
+ * nor scheduling a packet looks up a map or allocates a list node.
+ *
+ * The table does not hold the packets: each flow is still a QueueDiscClass
+ * whose child queue disc queues the packets and runs the AQM of the flow.
+ */
+class FqFlowTable
+{
+public:
+  /// The index of a missing flow
+  static constexpr uint32_t NO_FLOW = std::numeric_limits<uint32_t>::max ();
+
+  /// The lists of the DRR scheduler
+  enum FlowList
+  {
+    NEW_FLOWS = 0,  //!< The list of new flows
+    OLD_FLOWS = 1,  //!< The list of old flows
+    NO_LIST = 2     //!< The flow is in no list (inactive)
+  };
+
+  FqFlowTable ();
+
+  /**
+   * \brief Set the number of buckets, and empty the table
+   * \param buckets the number of buckets
+   */
+  void SetNBuckets (uint32_t buckets);
+  /**
+   * \return the number of buckets
+   */
+  uint32_t GetNBuckets (void) const;
+
+  /**
+   * \param bucket the bucket
+   * \return the index of the flow of the bucket, or NO_FLOW
+   */
+  uint32_t GetFlow (uint32_t bucket) const;
+  /**
+   * \brief Set the flow of a bucket
+   * \param bucket the bucket
+   * \param flow the index of the flow
+   */
+  void SetFlow (uint32_t bucket, uint32_t flow);
+
+  /**
+   * Compute the bucket of the flow having the given flowHash, according to
+   * the set associative hash approach: the first bucket of the set that has no
+   * flow, is tagged with the flowHash or whose flow is inactive, or else the
+   * first bucket of the set.
+   *
+   * \param flowHash the hash of the flow 5-tuple
+   * \param setWays the number of buckets of a set
+   * \return the bucket for the given flow
+   */
+  uint32_t SetAssociativeHash (uint32_t flowHash, uint32_t setWays);
+
+  /**
+   * \param list the list
+   * \return true if the list is empty
+   */
+  bool IsEmpty (FlowList list) const;
+  /**
+   * \param list the list
+   * \return the index of the first flow of the list, or NO_FLOW
+   */
+  uint32_t Front (FlowList list) const;
+  /**
+   * \brief Append a flow which is in no list to a list
+   * \param list the list
+   * \param flow the index of the flow
+   */
+  void PushBack (FlowList list, uint32_t flow);
+  /**
+   * \brief Remove the first flow of a list
+   * \param list the list
+   * \return the index of the removed flow
+   */
+  uint32_t PopFront (FlowList list);
+  /**
+   * \param flow the index of the flow
+   * \return the list of the flow
+   */
+  FlowList GetList (uint32_t flow) const;
+
+private:
+  /// The link of a flow in the DRR lists
+  struct Link
+  {
+    uint32_t next;     //!< The index of the next flow of the list, or NO_FLOW
+    FlowList list;     //!< The list of the flow
+  };
+
+  /// The first and last flows of a list
+  struct Ends
+  {
+    uint32_t head;     //!< The index of the first flow, or NO_FLOW
+    uint32_t tail;     //!< The index of the last flow, or NO_FLOW
+  };
+
+  std::vector<uint32_t> m_buckets;   //!< The index of the flow of each bucket
+  std::vector<uint32_t> m_tags;      //!< Tags used by set associative hash
+  std::vector<Link> m_links;         //!< The link of each flow
+  Ends m_lists[2];                   //!< The lists of new and old flows
+};
+
+} // namespace ns3
+
+#endif /* FQ_FLOW_TABLE_H */
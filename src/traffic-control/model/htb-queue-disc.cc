@@ -0,0 +1,663 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * HTB, the Hierarchical Token Bucket queueing discipline
+ *
+ * This implementation is based on the linux kernel code by
+ * Martin Devera, <devik@cdi.cz>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/object-factory.h"
+#include "htb-queue-disc.h"
+#include <algorithm>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HtbQueueDisc");
+
+NS_OBJECT_ENSURE_REGISTERED (HtbClass);
+
+TypeId HtbClass::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbClass")
+    .SetParent<QueueDiscClass> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbClass> ()
+    .AddAttribute ("Rate",
+                   "The rate guaranteed to this class",
+                   DataRateValue (DataRate ("1Mbps")),
+                   MakeDataRateAccessor (&HtbClass::m_rate),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Ceil",
+                   "The maximum rate of this class, which may borrow from its parent "
+                   "above its rate. If null, the ceil rate is the rate",
+                   DataRateValue (DataRate ("0bps")),
+                   MakeDataRateAccessor (&HtbClass::m_ceil),
+                   MakeDataRateChecker ())
+    .AddAttribute ("Burst",
+                   "The size of the bucket of the rate, in bytes",
+                   UintegerValue (1600),
+                   MakeUintegerAccessor (&HtbClass::m_burst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Cburst",
+                   "The size of the bucket of the ceil rate, in bytes",
+                   UintegerValue (1600),
+                   MakeUintegerAccessor (&HtbClass::m_cburst),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Quantum",
+                   "The number of bytes a leaf class sends in a round. If null, it is "
+                   "the rate in bytes per second divided by 10, within 1000 and 200000",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbClass::m_quantum),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+HtbClass::HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbClass::~HtbClass ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HtbClass::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_parent = 0;
+  QueueDiscClass::DoDispose ();
+}
+
+void
+HtbClass::SetParent (Ptr<HtbClass> parent)
+{
+  NS_LOG_FUNCTION (this << parent);
+  m_parent = parent;
+}
+
+Ptr<HtbClass>
+HtbClass::GetParent (void) const
+{
+  return m_parent;
+}
+
+DataRate
+HtbClass::GetRate (void) const
+{
+  return m_rate;
+}
+
+DataRate
+HtbClass::GetCeil (void) const
+{
+  if (m_ceil.GetBitRate () == 0)
+    {
+      return m_rate;
+    }
+  return m_ceil;
+}
+
+uint32_t
+HtbClass::GetBurst (void) const
+{
+  return m_burst;
+}
+
+uint32_t
+HtbClass::GetCburst (void) const
+{
+  return m_cburst;
+}
+
+uint32_t
+HtbClass::GetQuantum (void) const
+{
+  if (m_quantum == 0)
+    {
+      uint64_t quantum = m_rate.GetBitRate () / 80;
+      return std::min<uint64_t> (std::max<uint64_t> (quantum, 1000), 200000);
+    }
+  return m_quantum;
+}
+
+
+NS_OBJECT_ENSURE_REGISTERED (HtbQueueDisc);
+
+constexpr uint32_t HtbQueueDisc::NO_NODE;
+
+TypeId HtbQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HtbQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<HtbQueueDisc> ()
+    .AddAttribute ("DefaultClass",
+                   "The index of the leaf class of the packets which are not "
+                   "classified by the packet filters",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&HtbQueueDisc::m_defaultClass),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+HtbQueueDisc::HtbQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::NO_LIMITS)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HtbQueueDisc::~HtbQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HtbQueueDisc::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_id.Cancel ();
+  for (auto& c : m_innerClasses)
+    {
+      c->Dispose ();
+    }
+  m_innerClasses.clear ();
+  m_nodes.clear ();
+  m_rows.clear ();
+  m_waitQueue = WaitQueue ();
+  QueueDisc::DoDispose ();
+}
+
+void
+HtbQueueDisc::AddInnerClass (Ptr<HtbClass> htbClass)
+{
+  NS_LOG_FUNCTION (this << htbClass);
+  NS_ABORT_MSG_IF (htbClass->GetQueueDisc () != 0, "An inner class cannot have a queue disc");
+  m_innerClasses.push_back (htbClass);
+}
+
+Ptr<HtbClass>
+HtbQueueDisc::GetInnerClass (std::size_t i) const
+{
+  NS_ASSERT (i < m_innerClasses.size ());
+  return m_innerClasses[i];
+}
+
+std::size_t
+HtbQueueDisc::GetNInnerClasses (void) const
+{
+  return m_innerClasses.size ();
+}
+
+HtbQueueDisc::ClassMode
+HtbQueueDisc::GetLeafClassMode (std::size_t i) const
+{
+  NS_ASSERT (i < GetNQueueDiscClasses () && i < m_nodes.size ());
+  return m_nodes[i].mode;
+}
+
+void
+HtbQueueDisc::Link (NodeList &list, uint32_t node)
+{
+  m_nodes[node].prev = list.tail;
+  m_nodes[node].next = NO_NODE;
+  if (list.tail == NO_NODE)
+    {
+      list.head = node;
+    }
+  else
+    {
+      m_nodes[list.tail].next = node;
+    }
+  list.tail = node;
+}
+
+void
+HtbQueueDisc::Unlink (NodeList &list, uint32_t node)
+{
+  Node &n = m_nodes[node];
+  if (n.prev == NO_NODE)
+    {
+      list.head = n.next;
+    }
+  else
+    {
+      m_nodes[n.prev].next = n.next;
+    }
+  if (n.next == NO_NODE)
+    {
+      list.tail = n.prev;
+    }
+  else
+    {
+      m_nodes[n.next].prev = n.prev;
+    }
+  n.prev = n.next = NO_NODE;
+}
+
+HtbQueueDisc::NodeList &
+HtbQueueDisc::GetList (uint32_t node)
+{
+  NS_ASSERT (m_nodes[node].position != NO_POSITION);
+  if (m_nodes[node].position == ROW)
+    {
+      return m_rows[m_nodes[node].level];
+    }
+  return m_nodes[m_nodes[node].parent].feed;
+}
+
+void
+HtbQueueDisc::UpdatePosition (uint32_t node)
+{
+  while (node != NO_NODE)
+    {
+      Node &n = m_nodes[node];
+      bool backlogged = (node < GetNQueueDiscClasses ()
+                         ? !n.stalled && GetQueueDiscClass (node)->GetQueueDisc ()->GetNPackets () > 0
+                         : n.feed.head != NO_NODE);
+      NodePosition position = NO_POSITION;
+      if (backlogged && n.mode == CAN_SEND)
+        {
+          position = ROW;
+        }
+      else if (backlogged && n.mode == MAY_BORROW)
+        {
+          position = FEED;
+        }
+
+      if (position == n.position)
+        {
+          return;
+        }
+
+      bool feedChanged = (n.position == FEED || position == FEED);
+      if (n.position != NO_POSITION)
+        {
+          Unlink (GetList (node), node);
+        }
+      n.position = position;
+      if (position != NO_POSITION)
+        {
+          Link (GetList (node), node);
+        }
+
+      // the parent may have started or stopped borrowing for its feed
+      if (!feedChanged)
+        {
+          return;
+        }
+      node = n.parent;
+    }
+}
+
+HtbQueueDisc::ClassMode
+HtbQueueDisc::ComputeMode (uint32_t node, int64_t now, int64_t &wait) const
+{
+  const Node &n = m_nodes[node];
+  int64_t diff = std::min (now - n.checkpoint, m_maxBuffer);
+
+  int64_t toks = n.ctokens + diff;
+  if (toks < 0)
+    {
+      wait = -toks;
+      return CANT_SEND;
+    }
+  toks = n.tokens + diff;
+  if (toks >= 0)
+    {
+      return CAN_SEND;
+    }
+  wait = -toks;
+  return MAY_BORROW;
+}
+
+void
+HtbQueueDisc::UpdateMode (uint32_t node, int64_t now)
+{
+  int64_t wait = 0;
+  ClassMode mode = ComputeMode (node, now, wait);
+  Node &n = m_nodes[node];
+
+  if (mode != CAN_SEND)
+    {
+      // a previous wait queue entry of the node, if any, becomes stale
+      n.waitTime = now + wait;
+      m_waitQueue.push (std::make_pair (n.waitTime, node));
+    }
+  else
+    {
+      n.waitTime = -1;
+    }
+
+  if (mode != n.mode)
+    {
+      NS_LOG_LOGIC ("Class " << node << " changes mode from " << n.mode << " to " << mode);
+      n.mode = mode;
+      UpdatePosition (node);
+    }
+}
+
+void
+HtbQueueDisc::Charge (uint32_t leaf, uint32_t lender, uint32_t bytes, int64_t now)
+{
+  NS_LOG_FUNCTION (this << leaf << lender << bytes);
+
+  uint32_t lenderLevel = m_nodes[lender].level;
+  for (uint32_t node = leaf; node != NO_NODE; node = m_nodes[node].parent)
+    {
+      Node &n = m_nodes[node];
+      int64_t diff = std::min (now - n.checkpoint, m_maxBuffer);
+
+      // the classes below the lender borrowed the packet from it, hence only
+      // their ceil tokens are charged
+      int64_t toks = n.tokens + diff;
+      if (n.level >= lenderLevel)
+        {
+          toks -= n.rate.CalculateBytesTxTime (bytes).GetTimeStep ();
+        }
+      n.tokens = std::max (std::min (toks, n.buffer), 1 - m_maxBuffer);
+
+      toks = n.ctokens + diff - n.ceil.CalculateBytesTxTime (bytes).GetTimeStep ();
+      n.ctokens = std::max (std::min (toks, n.cbuffer), 1 - m_maxBuffer);
+
+      n.checkpoint = now;
+      UpdateMode (node, now);
+    }
+}
+
+bool
+HtbQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t leaf = m_defaultClass;
+
+  int32_t ret = Classify (item);
+
+  if (ret == PacketFilter::PF_NO_MATCH)
+    {
+      NS_LOG_DEBUG ("No filter has been able to classify this packet, using the default class.");
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Packet filters returned " << ret);
+
+      if (ret >= 0 && static_cast<uint32_t>(ret) < GetNQueueDiscClasses ())
+        {
+          leaf = ret;
+        }
+    }
+
+  bool retval = GetQueueDiscClass (leaf)->GetQueueDisc ()->Enqueue (item);
+
+  // If Queue::Enqueue fails, QueueDisc::Drop is called by the child queue disc
+  // because QueueDisc::AddQueueDiscClass sets the drop callback
+
+  if (retval)
+    {
+      UpdatePosition (leaf);
+    }
+
+  NS_LOG_LOGIC ("Number packets class " << leaf << ": " << GetQueueDiscClass (leaf)->GetQueueDisc ()->GetNPackets ());
+
+  return retval;
+}
+
+Ptr<QueueDiscItem>
+HtbQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  int64_t now = Simulator::Now ().GetTimeStep ();
+
+  // update the mode of the nodes whose waiting time has elapsed
+  while (!m_waitQueue.empty () && m_waitQueue.top ().first <= now)
+    {
+      uint32_t node = m_waitQueue.top ().second;
+      bool stale = (m_nodes[node].waitTime != m_waitQueue.top ().first);
+      m_waitQueue.pop ();
+      if (!stale)
+        {
+          // a stalled leaf is linked again if it is still backlogged
+          m_nodes[node].stalled = false;
+          UpdateMode (node, now);
+          UpdatePosition (node);
+        }
+    }
+
+  // serve the nodes which can send at their rate, the leaves first
+  for (uint32_t level = 0; level < m_rows.size (); level++)
+    {
+      while (m_rows[level].head != NO_NODE)
+        {
+          uint32_t lender = m_rows[level].head;
+          uint32_t leaf = lender;
+          while (leaf >= GetNQueueDiscClasses ())
+            {
+              leaf = m_nodes[leaf].feed.head;
+              NS_ASSERT_MSG (leaf != NO_NODE, "Linked inner class with an empty feed");
+            }
+
+          Ptr<QueueDiscItem> item = GetQueueDiscClass (leaf)->GetQueueDisc ()->Dequeue ();
+
+          if (item == 0)
+            {
+              Node &n = m_nodes[leaf];
+              if (GetQueueDiscClass (leaf)->GetQueueDisc ()->GetNPackets () > 0)
+                {
+                  // as in Linux, the class isn't work conserving: skip it
+                  // until the wait queue brings it back, after the time it
+                  // takes to send its quantum at its rate
+                  NS_LOG_WARN ("Class " << leaf << " isn't work conserving");
+                  n.stalled = true;
+                  n.waitTime = now + std::max<int64_t> (n.rate.CalculateBytesTxTime (n.quantum).GetTimeStep (), 1);
+                  m_waitQueue.push (std::make_pair (n.waitTime, leaf));
+                }
+              // otherwise, the child queue disc dropped all of its packets
+              UpdatePosition (leaf);
+              continue;
+            }
+
+          NS_LOG_LOGIC ("Popped from class " << leaf << " at level " << level << ": " << item);
+
+          Node &n = m_nodes[leaf];
+          n.deficit -= item->GetSize ();
+          if (n.deficit < 0)
+            {
+              n.deficit += n.quantum;
+              // move the nodes on the path to the end of their lists
+              for (uint32_t node = leaf; ; node = m_nodes[node].parent)
+                {
+                  NodeList &list = GetList (node);
+                  Unlink (list, node);
+                  Link (list, node);
+                  if (node == lender)
+                    {
+                      break;
+                    }
+                }
+            }
+
+          Charge (leaf, lender, item->GetSize (), now);
+          UpdatePosition (leaf);
+          return item;
+        }
+    }
+
+  // the watchdog timer setup: wake the queue disc up when the first class
+  // changes its mode
+  while (!m_waitQueue.empty ()
+         && m_nodes[m_waitQueue.top ().second].waitTime != m_waitQueue.top ().first)
+    {
+      m_waitQueue.pop ();
+    }
+
+  if (GetNPackets () > 0 && !m_waitQueue.empty ())
+    {
+      int64_t wakeTime = m_waitQueue.top ().first;
+      if (m_id.IsExpired () || m_id.GetTs () != static_cast<uint64_t> (wakeTime))
+        {
+          m_id.Cancel ();
+          m_id = Simulator::Schedule (TimeStep (wakeTime - now), &QueueDisc::Run, this);
+          NS_LOG_LOGIC ("Waking Event Scheduled in " << TimeStep (wakeTime - now).As (Time::S));
+        }
+    }
+
+  NS_LOG_LOGIC ("No class can send");
+  return 0;
+}
+
+bool
+HtbQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("HtbQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  if (GetNQueueDiscClasses () == 0)
+    {
+      // create a leaf class with a fifo queue disc
+      ObjectFactory factory;
+      factory.SetTypeId ("ns3::FifoQueueDisc");
+      Ptr<QueueDisc> qd = factory.Create<QueueDisc> ();
+      qd->Initialize ();
+      Ptr<HtbClass> c = CreateObject<HtbClass> ();
+      c->SetQueueDisc (qd);
+      AddQueueDiscClass (c);
+    }
+
+  if (m_defaultClass >= GetNQueueDiscClasses ())
+    {
+      NS_LOG_ERROR ("The default class of HtbQueueDisc is not a leaf class");
+      return false;
+    }
+
+  std::map<Ptr<HtbClass>, uint32_t> innerIndex;
+  for (uint32_t i = 0; i < m_innerClasses.size (); i++)
+    {
+      innerIndex[m_innerClasses[i]] = i;
+    }
+
+  for (uint32_t i = 0; i < GetNQueueDiscClasses () + m_innerClasses.size (); i++)
+    {
+      Ptr<HtbClass> c = (i < GetNQueueDiscClasses ()
+                         ? DynamicCast<HtbClass> (GetQueueDiscClass (i))
+                         : m_innerClasses[i - GetNQueueDiscClasses ()]);
+      if (c == 0)
+        {
+          NS_LOG_ERROR ("The classes of HtbQueueDisc must be HtbClass objects");
+          return false;
+        }
+      if (c->GetRate ().GetBitRate () == 0)
+        {
+          NS_LOG_ERROR ("The rate of the classes of HtbQueueDisc must be positive");
+          return false;
+        }
+
+      // the ancestors of a class must be inner classes, and cannot include it
+      uint32_t depth = 0;
+      for (Ptr<HtbClass> p = c->GetParent (); p != 0; p = p->GetParent ())
+        {
+          if (innerIndex.find (p) == innerIndex.end ())
+            {
+              NS_LOG_ERROR ("The parent of a class is not an inner class of HtbQueueDisc");
+              return false;
+            }
+          if (++depth > m_innerClasses.size ())
+            {
+              NS_LOG_ERROR ("The classes of HtbQueueDisc have a cycle");
+              return false;
+            }
+        }
+    }
+
+  return true;
+}
+
+void
+HtbQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Time has its resolution set by now
+  m_maxBuffer = Seconds (60).GetTimeStep ();
+  int64_t now = Simulator::Now ().GetTimeStep ();
+  uint32_t nLeaves = GetNQueueDiscClasses ();
+
+  std::map<Ptr<HtbClass>, uint32_t> index;
+  for (uint32_t i = 0; i < m_innerClasses.size (); i++)
+    {
+      index[m_innerClasses[i]] = nLeaves + i;
+    }
+
+  m_nodes.resize (nLeaves + m_innerClasses.size ());
+  for (uint32_t i = 0; i < m_nodes.size (); i++)
+    {
+      Ptr<HtbClass> c = (i < nLeaves
+                         ? StaticCast<HtbClass> (GetQueueDiscClass (i))
+                         : m_innerClasses[i - nLeaves]);
+      Node &n = m_nodes[i];
+      n.parent = (c->GetParent () == 0 ? NO_NODE : index[c->GetParent ()]);
+      n.level = 0;
+      n.rate = c->GetRate ();
+      // a root class cannot borrow
+      n.ceil = (n.parent == NO_NODE ? c->GetRate () : c->GetCeil ());
+      n.buffer = n.rate.CalculateBytesTxTime (c->GetBurst ()).GetTimeStep ();
+      n.cbuffer = (n.parent == NO_NODE
+                   ? n.buffer
+                   : n.ceil.CalculateBytesTxTime (c->GetCburst ()).GetTimeStep ());
+      n.tokens = n.buffer;
+      n.ctokens = n.cbuffer;
+      n.checkpoint = now;
+      n.waitTime = -1;
+      n.quantum = c->GetQuantum ();
+      n.deficit = n.quantum;
+      n.mode = CAN_SEND;
+      n.stalled = false;
+      n.position = NO_POSITION;
+      n.prev = n.next = NO_NODE;
+      n.feed.head = n.feed.tail = NO_NODE;
+    }
+
+  // the level of a node is its height in the tree
+  uint32_t maxLevel = 0;
+  for (uint32_t i = 0; i < nLeaves; i++)
+    {
+      for (uint32_t node = i; m_nodes[node].parent != NO_NODE; node = m_nodes[node].parent)
+        {
+          Node &parent = m_nodes[m_nodes[node].parent];
+          parent.level = std::max (parent.level, m_nodes[node].level + 1);
+          maxLevel = std::max (maxLevel, parent.level);
+        }
+    }
+
+  NodeList empty = {NO_NODE, NO_NODE};
+  m_rows.assign (maxLevel + 1, empty);
+  m_waitQueue = WaitQueue ();
+  m_id = EventId ();
+}
+
+} // namespace ns3
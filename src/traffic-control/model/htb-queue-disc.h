@@ -0,0 +1,294 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * HTB, the Hierarchical Token Bucket queueing discipline
+ *
+ * This implementation is based on the linux kernel code by
+ * Martin Devera, <devik@cdi.cz>
+ */
+#ifndef HTB_QUEUE_DISC_H
+#define HTB_QUEUE_DISC_H
+
+#include "ns3/queue-disc.h"
+#include "ns3/data-rate.h"
+#include "ns3/event-id.h"
+#include <limits>
+#include <queue>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A class of the HtbQueueDisc
+ *
+ * A class is guaranteed its rate and may borrow the unused rate of its parent
+ * class, up to its ceil rate. The leaf classes, which have a child queue disc,
+ * are added to the HtbQueueDisc by means of AddQueueDiscClass, while the inner
+ * classes, which have no child queue disc, are added by means of AddInnerClass.
+ */
+class HtbClass : public QueueDiscClass {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief HtbClass constructor
+   */
+  HtbClass ();
+
+  virtual ~HtbClass ();
+
+  /**
+   * \brief Set the parent of this class
+   * \param parent the parent class, which must be an inner class of the same
+   *        queue disc, or null if this class is a root class
+   */
+  void SetParent (Ptr<HtbClass> parent);
+  /**
+   * \brief Get the parent of this class
+   * \return the parent class, or null if this class is a root class
+   */
+  Ptr<HtbClass> GetParent (void) const;
+
+  /**
+   * \return the rate guaranteed to this class
+   */
+  DataRate GetRate (void) const;
+  /**
+   * \return the maximum rate of this class (the rate if the Ceil attribute is null)
+   */
+  DataRate GetCeil (void) const;
+  /**
+   * \return the size of the bucket of the rate, in bytes
+   */
+  uint32_t GetBurst (void) const;
+  /**
+   * \return the size of the bucket of the ceil rate, in bytes
+   */
+  uint32_t GetCburst (void) const;
+  /**
+   * \return the number of bytes a leaf class sends in a round
+   */
+  uint32_t GetQuantum (void) const;
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  Ptr<HtbClass> m_parent;    //!< The parent class
+  DataRate m_rate;           //!< The rate guaranteed to this class
+  DataRate m_ceil;           //!< The maximum rate of this class
+  uint32_t m_burst;          //!< The size of the bucket of the rate
+  uint32_t m_cburst;         //!< The size of the bucket of the ceil rate
+  uint32_t m_quantum;        //!< The quantum of a leaf class
+};
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief The Hierarchical Token Bucket queue disc
+ *
+ * The classes of an HTB queue disc form a tree, where each class is limited
+ * by the token buckets of its rate and of its ceil rate. A class whose rate
+ * tokens are exhausted may borrow from its parent until its ceil tokens are
+ * exhausted too. Packets are only stored in the child queue discs of the leaf
+ * classes. The packet filters return the index of the leaf class of a packet;
+ * packets that are not classified are assigned to the leaf class given by the
+ * DefaultClass attribute.
+ *
+ * The leaf classes that can send at their own rate are served first, in
+ * round robin with a quantum of bytes per class. Then, the leaf classes
+ * borrowing from a class of height one, two, and so on are served. As in
+ * Linux, a class that may borrow is linked to the list (feed) of its parent,
+ * and a class that can send is linked to the row of its height, so that a
+ * packet is selected by walking down a path of the tree. Finding the next
+ * class to serve does not depend on the number of classes.
+ *
+ * The classes that cannot send at their rate or ceil rate are stored in a
+ * single wait queue (a binary heap ordered by the time their mode changes), and
+ * a single timer wakes the queue disc up when the first class becomes able to
+ * send, instead of a timer per class. A leaf class whose child queue disc
+ * returns no packet while it is backlogged (e.g., a TBF) is not work
+ * conserving: it is skipped, and stored in the wait queue until it could have
+ * sent its quantum at its rate.
+ */
+class HtbQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief HtbQueueDisc constructor
+   */
+  HtbQueueDisc ();
+
+  virtual ~HtbQueueDisc ();
+
+  /**
+   * \brief Add an inner class, which has no child queue disc
+   * \param htbClass the inner class
+   */
+  void AddInnerClass (Ptr<HtbClass> htbClass);
+  /**
+   * \brief Get the i-th inner class
+   * \param i the index of the inner class
+   * \return the i-th inner class
+   */
+  Ptr<HtbClass> GetInnerClass (std::size_t i) const;
+  /**
+   * \return the number of inner classes
+   */
+  std::size_t GetNInnerClasses (void) const;
+
+  /// The mode of a class
+  enum ClassMode
+  {
+    CAN_SEND = 0,      //!< The class can send at its rate
+    MAY_BORROW = 1,    //!< The class may borrow from its parent, within its ceil rate
+    CANT_SEND = 2      //!< The class exceeded its ceil rate
+  };
+
+  /**
+   * \brief Get the mode of a leaf class, as of the last packet dequeued
+   * \param i the index of the leaf class
+   * \return the mode of the leaf class
+   */
+  ClassMode GetLeafClassMode (std::size_t i) const;
+
+protected:
+  /**
+   * \brief Dispose of the object
+   */
+  virtual void DoDispose (void);
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /// The index of a missing node
+  static constexpr uint32_t NO_NODE = std::numeric_limits<uint32_t>::max ();
+
+  /// Where a node is linked
+  enum NodePosition
+  {
+    NO_POSITION,       //!< The node is not linked
+    ROW,               //!< The node is linked to the row of its level
+    FEED               //!< The node is linked to the feed of its parent
+  };
+
+  /// A list of nodes
+  struct NodeList
+  {
+    uint32_t head;     //!< The first node, or NO_NODE
+    uint32_t tail;     //!< The last node, or NO_NODE
+  };
+
+  /// The state of a class. The leaf classes come first, then the inner classes
+  struct Node
+  {
+    uint32_t parent;         //!< The index of the parent node, or NO_NODE
+    uint32_t level;          //!< The height of the node (0 for leaves)
+    DataRate rate;           //!< The rate of the class
+    DataRate ceil;           //!< The ceil rate of the class
+    int64_t buffer;          //!< The burst, in time steps at rate
+    int64_t cbuffer;         //!< The cburst, in time steps at ceil rate
+    int64_t tokens;          //!< The rate tokens, in time steps
+    int64_t ctokens;         //!< The ceil rate tokens, in time steps
+    int64_t checkpoint;      //!< The time of the last update of the tokens
+    int64_t waitTime;        //!< The time the mode changes, if it is not CAN_SEND
+    int32_t deficit;         //!< The deficit of a leaf
+    uint32_t quantum;        //!< The quantum of a leaf
+    ClassMode mode;          //!< The mode of the class
+    bool stalled;            //!< Whether the child queue disc of a leaf returned no packet
+    NodePosition position;   //!< Where the node is linked
+    uint32_t prev;           //!< The previous node of its list
+    uint32_t next;           //!< The next node of its list
+    NodeList feed;           //!< The children borrowing from this node
+  };
+
+  /**
+   * \brief Append a node to a list
+   * \param list the list
+   * \param node the node
+   */
+  void Link (NodeList &list, uint32_t node);
+  /**
+   * \brief Remove a node from a list
+   * \param list the list
+   * \param node the node
+   */
+  void Unlink (NodeList &list, uint32_t node);
+  /**
+   * \brief Get the list a node is linked to
+   * \param node the node
+   * \return the list of the node
+   */
+  NodeList & GetList (uint32_t node);
+  /**
+   * \brief Link a node (and its ancestors, if needed) where its mode and
+   * backlog require
+   * \param node the node
+   */
+  void UpdatePosition (uint32_t node);
+  /**
+   * \brief Compute the mode of a node at the given time
+   * \param node the node
+   * \param now the current time, in time steps
+   * \param wait the time until the mode changes, if it is not CAN_SEND
+   * \return the mode of the node
+   */
+  ClassMode ComputeMode (uint32_t node, int64_t now, int64_t &wait) const;
+  /**
+   * \brief Update the mode of a node at the given time
+   * \param node the node
+   * \param now the current time, in time steps
+   */
+  void UpdateMode (uint32_t node, int64_t now);
+  /**
+   * \brief Charge the nodes from a leaf up to the root for a dequeued packet
+   * \param leaf the leaf node
+   * \param lender the node which sent the packet at its rate
+   * \param bytes the size of the packet
+   * \param now the current time, in time steps
+   */
+  void Charge (uint32_t leaf, uint32_t lender, uint32_t bytes, int64_t now);
+
+  /// The wait queue, whose top is the first mode change
+  typedef std::priority_queue<std::pair<int64_t, uint32_t>, std::vector<std::pair<int64_t, uint32_t> >,
+                              std::greater<std::pair<int64_t, uint32_t> > > WaitQueue;
+
+  uint32_t m_defaultClass;                       //!< The leaf class of unclassified packets
+  std::vector<Ptr<HtbClass> > m_innerClasses;   //!< The inner classes
+  std::vector<Node> m_nodes;                     //!< The state of the classes
+  std::vector<NodeList> m_rows;                  //!< The nodes which can send, per level
+  WaitQueue m_waitQueue;                         //!< The nodes which cannot send at their rate
+  int64_t m_maxBuffer;                           //!< Maximum time to refill the buckets, in time steps
+  EventId m_id;                                  //!< EventId of the scheduled queue waking event
+};
+
+} // namespace ns3
+
+#endif /* HTB_QUEUE_DISC_H */
@@ -28,7 +28,11 @@
 #include "ns3/simulator.h"
 #include "queue-disc.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-limits.h"
 #include "ns3/queue.h"
+#include <deque>
+#include <limits>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -106,6 +110,119 @@ QueueDisc::Stats::Stats ()
 {
 }
 
+/// The reasons to drop or mark packets, interned by QueueDisc::Stats::GetReasonId
+struct QueueDiscReasonTable
+{
+  /// The reasons, indexed by identifier. A deque does not move its elements.
+  std::deque<std::string> names;
+  /// The identifier of each reason
+  std::unordered_map<std::string, uint32_t> ids;
+  /// The number of entries of the cache of the addresses of the reasons
+  static const uint32_t CACHE_SIZE = 256;
+  /// The address of a reason and its identifier
+  struct CachedAddress
+  {
+    const char* address;  //!< The address of the reason
+    uint32_t id;          //!< The identifier of the reason last given at this address
+  };
+  /// The identifiers of the reasons last given, by hash of their address.
+  /// The cache has a fixed size, however many reasons are built at run time.
+  CachedAddress addresses[CACHE_SIZE] = {};
+  /// The identifier of the reason of a packet dropped by a child queue disc,
+  /// indexed by the identifier of the reason given by the child
+  std::vector<uint32_t> childDrops;
+  /// The identifier of the reason of a packet marked by a child queue disc,
+  /// indexed by the identifier of the reason given by the child
+  std::vector<uint32_t> childMarks;
+};
+
+/**
+ * \return the table of the reasons to drop or mark packets
+ */
+static QueueDiscReasonTable &
+GetReasonTable (void)
+{
+  static QueueDiscReasonTable table;
+  return table;
+}
+
+/**
+ * \brief Look up a reason to drop or mark packets, without interning it
+ * \param reason the reason
+ * \param id the identifier of the reason, if found
+ * \return true if the reason was found
+ */
+static bool
+FindReasonId (const std::string &reason, uint32_t &id)
+{
+  const QueueDiscReasonTable &table = GetReasonTable ();
+  auto it = table.ids.find (reason);
+  if (it == table.ids.end ())
+    {
+      return false;
+    }
+  id = it->second;
+  return true;
+}
+
+/**
+ * \brief Get the identifier of the reason of a packet dropped or marked by a
+ * child queue disc, i.e., the prefix followed by the reason given by the child
+ * \param cache the identifiers for each identifier of a reason of the child
+ * \param prefix the prefix
+ * \param childReason the reason given by the child
+ * \return the identifier of the reason
+ */
+static uint32_t
+GetChildReasonId (std::vector<uint32_t> &cache, const char* prefix, const char* childReason)
+{
+  uint32_t childId = QueueDisc::Stats::GetReasonId (childReason);
+  if (childId >= cache.size ())
+    {
+      cache.resize (childId + 1, std::numeric_limits<uint32_t>::max ());
+    }
+  if (cache[childId] == std::numeric_limits<uint32_t>::max ())
+    {
+      std::string reason (prefix);
+      reason.append (QueueDisc::Stats::GetReasonName (childId));
+      cache[childId] = QueueDisc::Stats::GetReasonId (reason.c_str ());
+    }
+  return cache[childId];
+}
+
+uint32_t
+QueueDisc::Stats::GetReasonId (const char* reason)
+{
+  QueueDiscReasonTable &table = GetReasonTable ();
+  // the reasons are mostly constant strings: check the reason last given at
+  // this address first
+  QueueDiscReasonTable::CachedAddress &cached =
+    table.addresses[reinterpret_cast<uintptr_t> (reason) % QueueDiscReasonTable::CACHE_SIZE];
+  if (cached.address == reason && table.names[cached.id].compare (reason) == 0)
+    {
+      return cached.id;
+    }
+
+  uint32_t id;
+  if (!FindReasonId (reason, id))
+    {
+      id = table.names.size ();
+      table.names.push_back (reason);
+      table.ids[reason] = id;
+    }
+  cached.address = reason;
+  cached.id = id;
+  return id;
+}
+
+const std::string &
+QueueDisc::Stats::GetReasonName (uint32_t id)
+{
+  const QueueDiscReasonTable &table = GetReasonTable ();
+  NS_ASSERT_MSG (id < table.names.size (), "Unknown reason " << id);
+  return table.names[id];
+}
+
 uint32_t
 QueueDisc::Stats::GetNDroppedPackets (std::string reason) const
 {
@@ -344,26 +461,28 @@ QueueDisc::QueueDisc (QueueDiscSizePolicy policy)
       return DropAfterDequeue (item, INTERNAL_QUEUE_DROP);
     };
 
-  // These lambdas call the DropBeforeEnqueue or DropAfterDequeue methods of this
-  // QueueDisc object. Given that a callback to the operator() of these lambdas
-  // is connected to the DropBeforeEnqueue and DropAfterDequeue traces of the
-  // child queue discs, the concatenation of the CHILD_QUEUE_DISC_DROP constant
-  // and the second argument provided by such traces is passed as the reason why
-  // the packet is dropped.
+  // These lambdas call the DoDropBeforeEnqueue, DoDropAfterDequeue or DoMark
+  // methods of this QueueDisc object. Given that a callback to the operator() of
+  // these lambdas is connected to the DropBeforeEnqueue, DropAfterDequeue and
+  // Mark traces of the child queue discs, the concatenation of the
+  // CHILD_QUEUE_DISC_DROP (or CHILD_QUEUE_DISC_MARK) constant and the second
+  // argument provided by such traces is passed as the reason why the packet is
+  // dropped (or marked). The concatenation is interned once for each reason.
   m_childQueueDiscDbeFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropBeforeEnqueue (item,
-                                m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (GetReasonTable ().childDrops, CHILD_QUEUE_DISC_DROP, r);
+      return DoDropBeforeEnqueue (item, id, Stats::GetReasonName (id).c_str ());
     };
   m_childQueueDiscDadFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return DropAfterDequeue (item,
-                               m_childQueueDiscDropMsg.assign (CHILD_QUEUE_DISC_DROP).append (r).data ());
+      uint32_t id = GetChildReasonId (GetReasonTable ().childDrops, CHILD_QUEUE_DISC_DROP, r);
+      return DoDropAfterDequeue (item, id, Stats::GetReasonName (id).c_str ());
     };
   m_childQueueDiscMarkFunctor = [this] (Ptr<const QueueDiscItem> item, const char* r)
     {
-      return Mark (const_cast<QueueDiscItem *> (PeekPointer (item)),
-                   m_childQueueDiscMarkMsg.assign (CHILD_QUEUE_DISC_MARK).append (r).data ());
+      uint32_t id = GetChildReasonId (GetReasonTable ().childMarks, CHILD_QUEUE_DISC_MARK, r);
+      return DoMark (const_cast<QueueDiscItem *> (PeekPointer (item)), id,
+                     Stats::GetReasonName (id).c_str ());
     };
 }
 
@@ -388,7 +507,9 @@ QueueDisc::DoDispose (void)
   m_classes.clear ();
   m_devQueueIface = 0;
   m_send = nullptr;
-  m_requeued = 0;
+  m_sendBatch = nullptr;
+  m_batch.clear ();
+  m_requeued.clear ();
   m_internalQueueDbeFunctor = nullptr;
   m_internalQueueDadFunctor = nullptr;
   m_childQueueDiscDbeFunctor = nullptr;
@@ -428,9 +549,14 @@ QueueDisc::GetStats (void)
   // the total number of sent packets is only updated here to avoid to increase it
   // after a dequeue and then having to decrease it if the packet is dropped after
   // dequeue or requeued
-  m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - (m_requeued ? 1 : 0)
+  uint64_t requeuedBytes = 0;
+  for (const auto& item : m_requeued)
+    {
+      requeuedBytes += item->GetSize ();
+    }
+  m_stats.nTotalSentPackets = m_stats.nTotalDequeuedPackets - m_requeued.size ()
                               - m_stats.nTotalDroppedPacketsAfterDequeue;
-  m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - (m_requeued ? m_requeued->GetSize () : 0)
+  m_stats.nTotalSentBytes = m_stats.nTotalDequeuedBytes - requeuedBytes
                             - m_stats.nTotalDroppedBytesAfterDequeue;
 
   return m_stats;
@@ -563,6 +689,20 @@ QueueDisc::GetSendCallback (void) const
   return m_send;
 }
 
+void
+QueueDisc::SetSendBatchCallback (SendBatchCallback func)
+{
+  NS_LOG_FUNCTION (this);
+  m_sendBatch = func;
+}
+
+QueueDisc::SendBatchCallback
+QueueDisc::GetSendBatchCallback (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_sendBatch;
+}
+
 void
 QueueDisc::SetQuota (const uint32_t quota)
 {
@@ -725,36 +865,47 @@ QueueDisc::PacketDequeued (Ptr<const QueueDiscItem> item)
     }
 }
 
+void
+QueueDisc::CountReason (std::vector<ReasonCounters> &counters, uint32_t id,
+                        std::map<std::string, uint32_t> &packets,
+                        std::map<std::string, uint64_t> &bytes, uint32_t size)
+{
+  if (id >= counters.size ())
+    {
+      ReasonCounters none = {0, 0};
+      counters.resize (id + 1, none);
+    }
+  if (counters[id].packets == 0)
+    {
+      // the elements of a map are never moved
+      const std::string &reason = Stats::GetReasonName (id);
+      counters[id].packets = &packets[reason];
+      counters[id].bytes = &bytes[reason];
+    }
+  (*counters[id].packets)++;
+  *counters[id].bytes += size;
+}
+
 void
 QueueDisc::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
 {
   NS_LOG_FUNCTION (this << item << reason);
+  DoDropBeforeEnqueue (item, Stats::GetReasonId (reason), reason);
+}
+
+void
+QueueDisc::DoDropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << id << reason);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsBeforeEnqueue++;
   m_stats.nTotalDroppedBytesBeforeEnqueue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsBeforeEnqueue.find (reason);
-  if (itp != m_stats.nDroppedPacketsBeforeEnqueue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsBeforeEnqueue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesBeforeEnqueue.find (reason);
-  if (itb != m_stats.nDroppedBytesBeforeEnqueue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesBeforeEnqueue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  CountReason (m_droppedBeforeEnqueue, id, m_stats.nDroppedPacketsBeforeEnqueue,
+               m_stats.nDroppedBytesBeforeEnqueue, item->GetSize ());
 
   NS_LOG_DEBUG ("Total packets/bytes dropped before enqueue: "
                 << m_stats.nTotalDroppedPacketsBeforeEnqueue << " / "
@@ -768,32 +919,22 @@ void
 QueueDisc::DropAfterDequeue (Ptr<const QueueDiscItem> item, const char* reason)
 {
   NS_LOG_FUNCTION (this << item << reason);
+  DoDropAfterDequeue (item, Stats::GetReasonId (reason), reason);
+}
+
+void
+QueueDisc::DoDropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << id << reason);
 
   m_stats.nTotalDroppedPackets++;
   m_stats.nTotalDroppedBytes += item->GetSize ();
   m_stats.nTotalDroppedPacketsAfterDequeue++;
   m_stats.nTotalDroppedBytesAfterDequeue += item->GetSize ();
 
-  // update the number of packets dropped for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nDroppedPacketsAfterDequeue.find (reason);
-  if (itp != m_stats.nDroppedPacketsAfterDequeue.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nDroppedPacketsAfterDequeue[reason] = 1;
-    }
-  // update the amount of bytes dropped for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nDroppedBytesAfterDequeue.find (reason);
-  if (itb != m_stats.nDroppedBytesAfterDequeue.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nDroppedBytesAfterDequeue[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes dropped for the given reason
+  CountReason (m_droppedAfterDequeue, id, m_stats.nDroppedPacketsAfterDequeue,
+               m_stats.nDroppedBytesAfterDequeue, item->GetSize ());
 
   // if in the context of a peek request a dequeued packet is dropped, we need
   // to update the statistics and fire the dequeue trace before firing the drop
@@ -818,6 +959,13 @@ bool
 QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
 {
   NS_LOG_FUNCTION (this << item << reason);
+  return DoMark (item, Stats::GetReasonId (reason), reason);
+}
+
+bool
+QueueDisc::DoMark (Ptr<QueueDiscItem> item, uint32_t id, const char* reason)
+{
+  NS_LOG_FUNCTION (this << item << id << reason);
 
   bool retval = item->Mark ();
 
@@ -829,26 +977,8 @@ QueueDisc::Mark (Ptr<QueueDiscItem> item, const char* reason)
   m_stats.nTotalMarkedPackets++;
   m_stats.nTotalMarkedBytes += item->GetSize ();
 
-  // update the number of packets marked for the given reason
-  std::map<std::string, uint32_t>::iterator itp = m_stats.nMarkedPackets.find (reason);
-  if (itp != m_stats.nMarkedPackets.end ())
-    {
-      itp->second++;
-    }
-  else
-    {
-      m_stats.nMarkedPackets[reason] = 1;
-    }
-  // update the amount of bytes marked for the given reason
-  std::map<std::string, uint64_t>::iterator itb = m_stats.nMarkedBytes.find (reason);
-  if (itb != m_stats.nMarkedBytes.end ())
-    {
-      itb->second += item->GetSize ();
-    }
-  else
-    {
-      m_stats.nMarkedBytes[reason] = item->GetSize ();
-    }
+  // update the number of packets and bytes marked for the given reason
+  CountReason (m_marked, id, m_stats.nMarkedPackets, m_stats.nMarkedBytes, item->GetSize ());
 
   NS_LOG_DEBUG ("Total packets/bytes marked: "
                 << m_stats.nTotalMarkedPackets << " / "
@@ -900,16 +1030,17 @@ QueueDisc::Dequeue (void)
   // The QueueDisc::DoPeek method dequeues a packet and keeps it as a requeued
   // packet. Thus, first check whether a peeked packet exists. Otherwise, call
   // the private DoDequeue method.
-  Ptr<QueueDiscItem> item = m_requeued;
+  Ptr<QueueDiscItem> item;
 
-  if (item)
+  if (!m_requeued.empty ())
     {
-      m_requeued = 0;
+      item = m_requeued.front ();
+      m_requeued.pop_front ();
       if (m_peeked)
         {
           // If the packet was requeued because a peek operation was requested
           // (which is the case here because DequeuePacket calls Dequeue only
-          // when m_requeued is null), we need to explicitly call PacketDequeued
+          // when m_requeued is empty), we need to explicitly call PacketDequeued
           // to update statistics about dequeued packets and fire the dequeue trace.
           m_peeked = false;
           PacketDequeued (item);
@@ -938,17 +1069,19 @@ QueueDisc::DoPeek (void)
 {
   NS_LOG_FUNCTION (this);
 
-  if (!m_requeued)
+  if (m_requeued.empty ())
     {
       m_peeked = true;
-      m_requeued = Dequeue ();
+      Ptr<QueueDiscItem> item = Dequeue ();
       // if no packet is returned, reset the m_peeked flag
-      if (!m_requeued)
+      if (!item)
         {
           m_peeked = false;
+          return 0;
         }
+      m_requeued.push_back (item);
     }
-  return m_requeued;
+  return m_requeued.front ();
 }
 
 void
@@ -959,10 +1092,9 @@ QueueDisc::Run (void)
   if (RunBegin ())
     {
       uint32_t quota = m_quota;
-      while (Restart ())
+      while (Restart (quota))
         {
-          quota -= 1;
-          if (quota <= 0)
+          if (quota == 0)
             {
               /// \todo netif_schedule (q);
               break;
@@ -993,9 +1125,9 @@ QueueDisc::RunEnd (void)
 }
 
 bool
-QueueDisc::Restart (void)
+QueueDisc::Restart (uint32_t &quota)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << quota);
   Ptr<QueueDiscItem> item = DequeuePacket();
   if (item == 0)
     {
@@ -1003,6 +1135,18 @@ QueueDisc::Restart (void)
       return false;
     }
 
+  // As in Linux, packets are dequeued in batches only if the device has a
+  // single queue limited by BQL, which bounds the size of a batch
+  if (m_sendBatch && m_devQueueIface && m_devQueueIface->GetNTxQueues () == 1
+      && m_devQueueIface->GetTxQueue (0)->GetQueueLimits ())
+    {
+      m_batch.push_back (item);
+      DequeueBatch (quota);
+      quota -= std::min<uint32_t> (quota, m_batch.size ());
+      return TransmitBatch ();
+    }
+
+  quota -= 1;
   return Transmit (item);
 }
 
@@ -1014,15 +1158,16 @@ QueueDisc::DequeuePacket ()
   Ptr<QueueDiscItem> item;
 
   // First check if there is a requeued packet
-  if (m_requeued != 0)
+  if (!m_requeued.empty ())
     {
         // If the queue where the requeued packet is destined to is not stopped, return
         // the requeued packet; otherwise, return an empty packet.
         // If the device does not support flow control, the device queue is never stopped
-        if (!m_devQueueIface || !m_devQueueIface->GetTxQueue (m_requeued->GetTxQueueIndex ())->IsStopped ())
+        if (!m_devQueueIface
+            || !m_devQueueIface->GetTxQueue (m_requeued.front ()->GetTxQueueIndex ())->IsStopped ())
           {
-            item = m_requeued;
-            m_requeued = 0;
+            item = m_requeued.front ();
+            m_requeued.pop_front ();
             if (m_peeked)
               {
                 // If the packet was requeued because a peek operation was requested
@@ -1049,17 +1194,52 @@ QueueDisc::DequeuePacket ()
             {
               item->AddHeader ();
             }
-          // Here, Linux tries bulk dequeues
+          // Bulk dequeues, if any, are performed by DequeueBatch
         }
     }
   return item;
 }
 
+void
+QueueDisc::DequeueBatch (uint32_t quota)
+{
+  NS_LOG_FUNCTION (this << quota);
+  NS_ASSERT (m_batch.size () == 1);
+
+  // As in Linux, the first packet is always sent and the following ones are
+  // added to the batch while the device queue can accept more bytes
+  int64_t bytelimit = static_cast<int64_t> (m_devQueueIface->GetTxQueue (0)->GetQueueLimits ()->Available ())
+                      - m_batch.front ()->GetSize ();
+
+  while (bytelimit > 0 && m_batch.size () < quota)
+    {
+      Ptr<QueueDiscItem> item;
+      // requeued packets come first and already have their header
+      if (!m_requeued.empty ())
+        {
+          item = m_requeued.front ();
+          m_requeued.pop_front ();
+        }
+      else
+        {
+          item = Dequeue ();
+          if (item == 0)
+            {
+              break;
+            }
+          item->AddHeader ();
+        }
+      bytelimit -= item->GetSize ();
+      m_batch.push_back (item);
+    }
+  NS_LOG_LOGIC ("Dequeued a batch of " << m_batch.size () << " packets");
+}
+
 void
 QueueDisc::Requeue (Ptr<QueueDiscItem> item)
 {
   NS_LOG_FUNCTION (this << item);
-  m_requeued = item;
+  m_requeued.push_front (item);
   /// \todo netif_schedule (q);
 
   m_stats.nTotalRequeuedPackets++;
@@ -1069,6 +1249,22 @@ QueueDisc::Requeue (Ptr<QueueDiscItem> item)
   m_traceRequeue (item);
 }
 
+void
+QueueDisc::RequeueBatch (std::size_t first)
+{
+  NS_LOG_FUNCTION (this << first);
+  m_requeued.insert (m_requeued.begin (), m_batch.begin () + first, m_batch.end ());
+
+  for (std::size_t i = first; i < m_batch.size (); i++)
+    {
+      m_stats.nTotalRequeuedPackets++;
+      m_stats.nTotalRequeuedBytes += m_batch[i]->GetSize ();
+
+      NS_LOG_LOGIC ("m_traceRequeue (p)");
+      m_traceRequeue (m_batch[i]);
+    }
+}
+
 bool
 QueueDisc::Transmit (Ptr<QueueDiscItem> item)
 {
@@ -1118,4 +1314,42 @@ QueueDisc::Transmit (Ptr<QueueDiscItem> item)
   return true;
 }
 
+bool
+QueueDisc::TransmitBatch (void)
+{
+  NS_LOG_FUNCTION (this << m_batch.size ());
+
+  Ptr<NetDeviceQueue> txq = m_devQueueIface->GetTxQueue (0);
+  std::size_t sent = 0;
+
+  // if the device queue is stopped, requeue the whole batch and return false
+  if (!txq->IsStopped ())
+    {
+      // a single queue device makes no use of the priority tag
+      SocketPriorityTag priorityTag;
+      for (auto& item : m_batch)
+        {
+          item->GetPacket ()->RemovePacketTag (priorityTag);
+        }
+
+      // unlike Send, the device returns the number of packets it consumed,
+      // which are the first ones of the batch. The device stops consuming
+      // packets when its queue is stopped, so the remaining ones are requeued
+      sent = m_sendBatch (m_batch);
+      NS_ASSERT (sent <= m_batch.size ());
+    }
+
+  RequeueBatch (sent);
+  m_batch.clear ();
+
+  // if the queue disc is empty or the device queue is now stopped, return false so
+  // that the Run method does not attempt to dequeue other packets and exits
+  if ((GetNPackets () == 0 && m_requeued.empty ()) || txq->IsStopped ())
+    {
+      return false;
+    }
+
+  return true;
+}
+
 } // namespace ns3
@@ -26,6 +26,7 @@
 #include "ns3/queue-item.h"
 #include "ns3/queue-size.h"
 #include <vector>
+#include <deque>
 #include <map>
 #include <functional>
 #include <string>
@@ -265,6 +266,25 @@ public:
      * \param os output stream in which the data should be printed.
      */
     void Print (std::ostream &os) const;
+    /**
+     * \brief Get the identifier of a reason to drop or mark packets
+     *
+     * The reasons are interned in a table shared by all the queue discs, so
+     * that the queue discs find the counters of a reason in an array. The
+     * identifier of a reason is cached for its address, in a cache of fixed
+     * size, hence the reasons are best given as constant strings, such as the
+     * static constants of the queue discs.
+     *
+     * \param reason the reason
+     * \return the identifier of the reason
+     */
+    static uint32_t GetReasonId (const char* reason);
+    /**
+     * \brief Get a reason to drop or mark packets from its identifier
+     * \param id the identifier of the reason
+     * \return the reason, which is never moved nor freed
+     */
+    static const std::string & GetReasonName (uint32_t id);
   };
 
   /**
@@ -372,6 +392,29 @@ public:
    */
   SendCallback GetSendCallback (void) const;
 
+  /**
+   * Callback invoked to send a batch of packets to the receiving object when
+   * Run is called. It returns the number of packets consumed by the receiving
+   * object, which are the first ones of the batch.
+   */
+  typedef std::function<std::size_t (const std::vector<Ptr<QueueDiscItem> > &)> SendBatchCallback;
+
+  /**
+   * \param func the callback to send a batch of packets to the receiving object.
+   *
+   * Set the callback used by the Run method to send a batch of packets to the
+   * receiving object. Packets are dequeued in batches (as Linux does when the
+   * device driver supports xmit_more) only if this callback is set and the
+   * receiving object has a single transmission queue whose size is limited by
+   * a QueueLimits object, which bounds the number of bytes of a batch.
+   */
+  void SetSendBatchCallback (SendBatchCallback func);
+
+  /**
+   * \return the callback to send a batch of packets to the receiving object.
+   */
+  SendBatchCallback GetSendBatchCallback (void) const;
+
   /**
    * \brief Set the maximum number of dequeue operations following a packet enqueue
    * \param quota the maximum number of dequeue operations following a packet enqueue.
@@ -651,9 +694,13 @@ private:
   /**
    * Modelled after the Linux function qdisc_restart (net/sched/sch_generic.c)
    * Dequeue a packet (by calling DequeuePacket) and send it to the device (by calling Transmit).
-   * \return true if a packet is successfully sent to the device.
+   * If the device supports batches, dequeue more packets (by calling DequeueBatch)
+   * and send them all to the device (by calling TransmitBatch).
+   * \param quota the number of packets that can still be dequeued in this run,
+   *        which is decreased by the number of packets dequeued
+   * \return true if packets are successfully sent to the device.
    */
-  bool Restart (void);
+  bool Restart (uint32_t &quota);
 
   /**
    * Modelled after the Linux function dequeue_skb (net/sched/sch_generic.c)
@@ -661,6 +708,14 @@ private:
    */
   Ptr<QueueDiscItem> DequeuePacket (void);
 
+  /**
+   * Modelled after the Linux function try_bulk_dequeue_skb (net/sched/sch_generic.c)
+   * Append to the batch the packets dequeued after the first one, until the
+   * number of bytes the device queue can accept or the quota is exhausted.
+   * \param quota the maximum number of packets in the batch
+   */
+  void DequeueBatch (uint32_t quota);
+
   /**
    * Modelled after the Linux function dev_requeue_skb (net/sched/sch_generic.c)
    * Requeues a packet whose transmission failed.
@@ -668,6 +723,13 @@ private:
    */
   void Requeue (Ptr<QueueDiscItem> item);
 
+  /**
+   * Requeues the packets of the batch that were not consumed by the device,
+   * before the packets that were already requeued.
+   * \param first the index of the first packet of the batch to requeue
+   */
+  void RequeueBatch (std::size_t first);
+
   /**
    * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c)
    * Sends a packet to the device if the device queue is not stopped, and requeues
@@ -677,6 +739,15 @@ private:
    */
   bool Transmit (Ptr<QueueDiscItem> item);
 
+  /**
+   * Modelled after the Linux function sch_direct_xmit (net/sched/sch_generic.c),
+   * when the device driver is passed a list of packets.
+   * Sends the batch to the device if the device queue is not stopped, and requeues
+   * the packets that were not consumed by the device.
+   * \return true if the device queue is not stopped and the queue disc is not empty
+   */
+  bool TransmitBatch (void);
+
   /**
    *  \brief Perform the actions required when the queue disc is notified of
    *         a packet enqueue
@@ -691,6 +762,50 @@ private:
    */
   void PacketDequeued (Ptr<const QueueDiscItem> item);
 
+  /**
+   *  \brief Record a packet dropped before enqueue
+   *  \param item item that was dropped
+   *  \param id the identifier of the reason why the item was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void DoDropBeforeEnqueue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
+  /**
+   *  \brief Record a packet dropped after dequeue
+   *  \param item item that was dropped
+   *  \param id the identifier of the reason why the item was dropped
+   *  \param reason the reason why the item was dropped
+   */
+  void DoDropAfterDequeue (Ptr<const QueueDiscItem> item, uint32_t id, const char* reason);
+
+  /**
+   *  \brief Mark a packet and, if successful, record it
+   *  \param item item that has to be marked
+   *  \param id the identifier of the reason why the item has to be marked
+   *  \param reason the reason why the item has to be marked
+   *  \return true if the item was successfully marked, false otherwise
+   */
+  bool DoMark (Ptr<QueueDiscItem> item, uint32_t id, const char* reason);
+
+  /// The counters of a reason to drop or mark packets, in the maps of m_stats
+  struct ReasonCounters
+  {
+    uint32_t *packets;  //!< Number of packets
+    uint64_t *bytes;    //!< Number of bytes
+  };
+
+  /**
+   *  \brief Count a packet dropped or marked for a reason
+   *  \param counters the counters, indexed by reason identifier
+   *  \param id the identifier of the reason
+   *  \param packets the map of the number of packets for each reason
+   *  \param bytes the map of the number of bytes for each reason
+   *  \param size the size of the packet
+   */
+  static void CountReason (std::vector<ReasonCounters> &counters, uint32_t id,
+                           std::map<std::string, uint32_t> &packets,
+                           std::map<std::string, uint64_t> &bytes, uint32_t size);
+
   static const uint32_t DEFAULT_QUOTA = 64; //!< Default quota (as in /proc/sys/net/core/dev_weight)
 
   std::vector<Ptr<InternalQueue> > m_queues;    //!< Internal queues
@@ -703,14 +818,17 @@ private:
   QueueSize m_maxSize;              //!< max queue size
 
   Stats m_stats;                    //!< The collected statistics
+  std::vector<ReasonCounters> m_droppedBeforeEnqueue;  //!< Counters of the drops before enqueue, by reason identifier
+  std::vector<ReasonCounters> m_droppedAfterDequeue;   //!< Counters of the drops after dequeue, by reason identifier
+  std::vector<ReasonCounters> m_marked;                //!< Counters of the marks, by reason identifier
   uint32_t m_quota;                 //!< Maximum number of packets dequeued in a qdisc run
   Ptr<NetDeviceQueueInterface> m_devQueueIface;   //!< NetDevice queue interface
   SendCallback m_send;              //!< Callback used to send a packet to the receiving object
+  SendBatchCallback m_sendBatch;    //!< Callback used to send a batch of packets to the receiving object
+  std::vector<Ptr<QueueDiscItem> > m_batch;       //!< The batch of packets being transmitted
   bool m_running;                   //!< The queue disc is performing multiple dequeue operations
-  Ptr<QueueDiscItem> m_requeued;    //!< The last packet that failed to be transmitted
+  std::deque<Ptr<QueueDiscItem> > m_requeued;     //!< The packets that failed to be transmitted
   bool m_peeked;                    //!< A packet was dequeued because Peek was called
-  std::string m_childQueueDiscDropMsg;  //!< Reason why a packet was dropped by a child queue disc
-  std::string m_childQueueDiscMarkMsg;  //!< Reason why a packet was marked by a child queue disc
   QueueDiscSizePolicy m_sizePolicy;     //!< The queue disc size policy
   bool m_prohibitChangeMode;            //!< True if changing mode is prohibited
 
@@ -193,6 +193,13 @@ TrafficControlLayer::ScanDevices (void)
               q->SetNetDeviceQueueInterface (ndqi);
               q->SetSendCallback ([dev] (Ptr<QueueDiscItem> item)
                                   { dev->Send (item->GetPacket (), item->GetAddress (), item->GetProtocol ()); });
+              // devices that support batches are passed all the packets
+              // dequeued in a qdisc run at once (xmit_more)
+              if (dev->SupportsSendBatch ())
+                {
+                  q->SetSendBatchCallback ([dev] (const std::vector<Ptr<QueueDiscItem> >& items)
+                                           { return dev->SendBatch (items); });
+                }
             }
         }
     }
@@ -257,6 +264,7 @@ TrafficControlLayer::DeleteRootQueueDiscOnDevice (Ptr<NetDevice> device)
     {
       q->SetNetDeviceQueueInterface (nullptr);
       q->SetSendCallback (nullptr);
+      q->SetSendBatchCallback (nullptr);
     }
   ndi->second.m_queueDiscsToWake.clear ();
 
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/fq-flow-table.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the buckets and the DRR lists of the flow table
+ */
+class FqFlowTableListsTestCase : public TestCase
+{
+public:
+  FqFlowTableListsTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqFlowTableListsTestCase::FqFlowTableListsTestCase ()
+  : TestCase ("Check the buckets and the lists of new and old flows")
+{
+}
+
+void
+FqFlowTableListsTestCase::DoRun (void)
+{
+  FqFlowTable table;
+  table.SetNBuckets (16);
+  NS_TEST_EXPECT_MSG_EQ (table.GetNBuckets (), 16, "Number of buckets");
+  NS_TEST_EXPECT_MSG_EQ (table.GetFlow (5), FqFlowTable::NO_FLOW, "No flow in a new table");
+
+  table.SetFlow (5, 0);
+  table.SetFlow (9, 1);
+  table.SetFlow (12, 2);
+  NS_TEST_EXPECT_MSG_EQ (table.GetFlow (9), 1, "Flow of a bucket");
+  NS_TEST_EXPECT_MSG_EQ (table.GetList (1), FqFlowTable::NO_LIST, "A new flow is in no list");
+
+  NS_TEST_EXPECT_MSG_EQ (table.IsEmpty (FqFlowTable::NEW_FLOWS), true, "Empty list");
+  table.PushBack (FqFlowTable::NEW_FLOWS, 2);
+  table.PushBack (FqFlowTable::NEW_FLOWS, 0);
+  table.PushBack (FqFlowTable::NEW_FLOWS, 1);
+  NS_TEST_EXPECT_MSG_EQ (table.Front (FqFlowTable::NEW_FLOWS), 2, "First flow of the list");
+  NS_TEST_EXPECT_MSG_EQ (table.GetList (0), FqFlowTable::NEW_FLOWS, "List of a flow");
+
+  // move the flows to the list of old flows, then rotate it
+  table.PushBack (FqFlowTable::OLD_FLOWS, table.PopFront (FqFlowTable::NEW_FLOWS));
+  table.PushBack (FqFlowTable::OLD_FLOWS, table.PopFront (FqFlowTable::NEW_FLOWS));
+  NS_TEST_EXPECT_MSG_EQ (table.Front (FqFlowTable::NEW_FLOWS), 1, "Remaining new flow");
+  NS_TEST_EXPECT_MSG_EQ (table.GetList (2), FqFlowTable::OLD_FLOWS, "List of a flow");
+  table.PushBack (FqFlowTable::OLD_FLOWS, table.PopFront (FqFlowTable::OLD_FLOWS));
+  NS_TEST_EXPECT_MSG_EQ (table.PopFront (FqFlowTable::OLD_FLOWS), 0, "Rotated list");
+  NS_TEST_EXPECT_MSG_EQ (table.PopFront (FqFlowTable::OLD_FLOWS), 2, "Rotated list");
+  NS_TEST_EXPECT_MSG_EQ (table.IsEmpty (FqFlowTable::OLD_FLOWS), true, "Empty list");
+  NS_TEST_EXPECT_MSG_EQ (table.GetList (2), FqFlowTable::NO_LIST, "A removed flow is in no list");
+
+  // a removed flow can be appended again
+  table.PushBack (FqFlowTable::OLD_FLOWS, 2);
+  NS_TEST_EXPECT_MSG_EQ (table.Front (FqFlowTable::OLD_FLOWS), 2, "Appended flow");
+
+  table.SetNBuckets (8);
+  NS_TEST_EXPECT_MSG_EQ (table.GetFlow (5), FqFlowTable::NO_FLOW, "Emptied table");
+  NS_TEST_EXPECT_MSG_EQ (table.IsEmpty (FqFlowTable::NEW_FLOWS), true, "Emptied list");
+  NS_TEST_EXPECT_MSG_EQ (table.IsEmpty (FqFlowTable::OLD_FLOWS), true, "Emptied list");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the set associative hash of the flow table
+ */
+class FqFlowTableSetAssociativeHashTestCase : public TestCase
+{
+public:
+  FqFlowTableSetAssociativeHashTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+FqFlowTableSetAssociativeHashTestCase::FqFlowTableSetAssociativeHashTestCase ()
+  : TestCase ("Check the set associative hash")
+{
+}
+
+void
+FqFlowTableSetAssociativeHashTestCase::DoRun (void)
+{
+  FqFlowTable table;
+  table.SetNBuckets (16);
+
+  // the flows of hash 17, 33 and 49 belong to the set of buckets 0-7
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (17, 8), 0, "First free bucket of the set");
+  table.SetFlow (0, 0);
+  table.PushBack (FqFlowTable::NEW_FLOWS, 0);
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (33, 8), 1, "Next free bucket of the set");
+  table.SetFlow (1, 1);
+  table.PushBack (FqFlowTable::NEW_FLOWS, 1);
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (17, 8), 0, "Bucket tagged with the flow");
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (33, 8), 1, "Bucket tagged with the flow");
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (25, 8), 8, "Bucket of the other set");
+
+  // the bucket of an inactive flow can be used by another flow
+  table.PopFront (FqFlowTable::NEW_FLOWS);
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (49, 8), 0, "Bucket of an inactive flow");
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (17, 8), 0, "Bucket of an inactive flow");
+
+  // all the buckets of the set are used
+  table.PushBack (FqFlowTable::NEW_FLOWS, 0);
+  for (uint32_t i = 2; i < 8; i++)
+    {
+      table.SetFlow (i, i);
+      table.PushBack (FqFlowTable::NEW_FLOWS, i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (table.SetAssociativeHash (65, 8), 0, "First bucket of a full set");
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Flow table of the flow queueing discs Test Suite
+ */
+static class FqFlowTableTestSuite : public TestSuite
+{
+public:
+  FqFlowTableTestSuite ()
+    : TestSuite ("fq-flow-table", UNIT)
+  {
+    AddTestCase (new FqFlowTableListsTestCase (), TestCase::QUICK);
+    AddTestCase (new FqFlowTableSetAssociativeHashTestCase (), TestCase::QUICK);
+  }
+} g_fqFlowTableTestSuite; ///< the test suite
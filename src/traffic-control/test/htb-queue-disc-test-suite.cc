@@ -0,0 +1,468 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/htb-queue-disc.h"
+#include "ns3/fifo-queue-disc.h"
+#include "ns3/tbf-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Item, which knows its leaf class
+ */
+class HtbQueueDiscTestItem : public QueueDiscItem {
+public:
+  /**
+   * Constructor
+   *
+   * \param p the packet
+   * \param cls the index of the leaf class, or -1 if the packet is not classified
+   */
+  HtbQueueDiscTestItem (Ptr<Packet> p, int32_t cls);
+  virtual ~HtbQueueDiscTestItem ();
+  virtual void AddHeader (void);
+  virtual bool Mark (void);
+  /**
+   * \return the index of the leaf class
+   */
+  int32_t GetClass (void) const;
+
+private:
+  int32_t m_cls;  //!< the index of the leaf class
+};
+
+HtbQueueDiscTestItem::HtbQueueDiscTestItem (Ptr<Packet> p, int32_t cls)
+  : QueueDiscItem (p, Address (), 0),
+    m_cls (cls)
+{
+}
+
+HtbQueueDiscTestItem::~HtbQueueDiscTestItem ()
+{
+}
+
+void
+HtbQueueDiscTestItem::AddHeader (void)
+{
+}
+
+bool
+HtbQueueDiscTestItem::Mark (void)
+{
+  return false;
+}
+
+int32_t
+HtbQueueDiscTestItem::GetClass (void) const
+{
+  return m_cls;
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Packet Filter, returning the class of the test items
+ */
+class HtbQueueDiscTestFilter : public PacketFilter
+{
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+bool
+HtbQueueDiscTestFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return DynamicCast<HtbQueueDiscTestItem> (item)->GetClass () >= 0;
+}
+
+int32_t
+HtbQueueDiscTestFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return DynamicCast<HtbQueueDiscTestItem> (item)->GetClass ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Base class of the Htb Queue Disc test cases, which builds the queue
+ * disc and records the packets it sends
+ */
+class HtbQueueDiscTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param name the name of the test case
+   */
+  HtbQueueDiscTestCase (std::string name);
+
+protected:
+  /**
+   * Create an inner class
+   * \param rate the rate of the class
+   * \param parent the parent of the class
+   * \return the inner class
+   */
+  Ptr<HtbClass> AddInner (std::string rate, Ptr<HtbClass> parent);
+  /**
+   * Create a leaf class
+   * \param rate the rate of the class
+   * \param ceil the ceil rate of the class
+   * \param parent the parent of the class
+   * \param qd the initialized child queue disc, or 0 for a Fifo queue disc
+   * \return the leaf class
+   */
+  Ptr<HtbClass> AddLeaf (std::string rate, std::string ceil, Ptr<HtbClass> parent,
+                         Ptr<QueueDisc> qd = 0);
+  /**
+   * Enqueue packets of 1000 bytes
+   * \param n the number of packets
+   * \param cls the leaf class of the packets
+   */
+  void Enqueue (uint32_t n, int32_t cls);
+  /**
+   * Record a packet sent by the queue disc
+   * \param item the packet
+   */
+  void Send (Ptr<QueueDiscItem> item);
+
+  Ptr<HtbQueueDisc> m_qd;             //!< the queue disc
+  std::vector<Time> m_sendTimes;      //!< the times the packets are sent
+  std::vector<uint32_t> m_sent;       //!< the number of packets sent per leaf class
+};
+
+HtbQueueDiscTestCase::HtbQueueDiscTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+Ptr<HtbClass>
+HtbQueueDiscTestCase::AddInner (std::string rate, Ptr<HtbClass> parent)
+{
+  if (m_qd == 0)
+    {
+      m_qd = CreateObject<HtbQueueDisc> ();
+    }
+  Ptr<HtbClass> c = CreateObjectWithAttributes<HtbClass> ("Rate", DataRateValue (DataRate (rate)));
+  c->SetParent (parent);
+  m_qd->AddInnerClass (c);
+  return c;
+}
+
+Ptr<HtbClass>
+HtbQueueDiscTestCase::AddLeaf (std::string rate, std::string ceil, Ptr<HtbClass> parent,
+                               Ptr<QueueDisc> qd)
+{
+  if (m_qd == 0)
+    {
+      m_qd = CreateObject<HtbQueueDisc> ();
+    }
+  Ptr<HtbClass> c = CreateObjectWithAttributes<HtbClass> ("Rate", DataRateValue (DataRate (rate)),
+                                                          "Ceil", DataRateValue (DataRate (ceil)),
+                                                          "Quantum", UintegerValue (1000));
+  c->SetParent (parent);
+  if (qd == 0)
+    {
+      qd = CreateObject<FifoQueueDisc> ();
+      qd->Initialize ();
+    }
+  c->SetQueueDisc (qd);
+  m_qd->AddQueueDiscClass (c);
+  m_sent.push_back (0);
+  return c;
+}
+
+void
+HtbQueueDiscTestCase::Enqueue (uint32_t n, int32_t cls)
+{
+  if (m_qd->GetNPacketFilters () == 0)
+    {
+      m_qd->AddPacketFilter (CreateObject<HtbQueueDiscTestFilter> ());
+      m_qd->SetSendCallback (MakeCallback (&HtbQueueDiscTestCase::Send, this));
+      m_qd->SetQuota (std::numeric_limits<uint32_t>::max () / 2);
+      m_qd->Initialize ();
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      m_qd->Enqueue (Create<HtbQueueDiscTestItem> (Create<Packet> (1000), cls));
+    }
+}
+
+void
+HtbQueueDiscTestCase::Send (Ptr<QueueDiscItem> item)
+{
+  int32_t cls = DynamicCast<HtbQueueDiscTestItem> (item)->GetClass ();
+  if (cls < 0)
+    {
+      UintegerValue defaultClass;
+      m_qd->GetAttribute ("DefaultClass", defaultClass);
+      cls = defaultClass.Get ();
+    }
+  m_sent[cls]++;
+  m_sendTimes.push_back (Simulator::Now ());
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that a class is shaped by its token bucket
+ */
+class HtbQueueDiscShapingTestCase : public HtbQueueDiscTestCase
+{
+public:
+  HtbQueueDiscShapingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HtbQueueDiscShapingTestCase::HtbQueueDiscShapingTestCase ()
+  : HtbQueueDiscTestCase ("Check the rate of a single class")
+{
+}
+
+void
+HtbQueueDiscShapingTestCase::DoRun (void)
+{
+  // 8Mbps, a packet of 1000 bytes is sent every ms
+  Ptr<HtbClass> c = AddLeaf ("8Mbps", "0bps", 0);
+  c->SetAttribute ("Burst", UintegerValue (1000));
+  Enqueue (10, 0);
+
+  Simulator::Schedule (Seconds (0), &QueueDisc::Run, m_qd);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sendTimes.size (), 10, "All the packets are sent");
+  // the full bucket allows to send two packets at once
+  NS_TEST_EXPECT_MSG_EQ (m_sendTimes[0], Seconds (0), "First packet sent at once");
+  NS_TEST_EXPECT_MSG_EQ (m_sendTimes[1], Seconds (0), "Second packet sent at once");
+  for (uint32_t i = 2; i < m_sendTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_sendTimes[i], MilliSeconds (i - 1), MicroSeconds (1), "Packet " << i << " shaped");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_qd->GetLeafClassMode (0), HtbQueueDisc::CANT_SEND, "Class in debt");
+
+  m_qd->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the classes borrow the unused rate of their parent,
+ * within their ceil rate
+ */
+class HtbQueueDiscBorrowTestCase : public HtbQueueDiscTestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param ceil the ceil rate of the first leaf class
+   * \param sent0 the packets expected from the first leaf class in 100ms
+   * \param sent1 the packets expected from the second leaf class in 100ms
+   */
+  HtbQueueDiscBorrowTestCase (std::string ceil, uint32_t sent0, uint32_t sent1);
+
+private:
+  virtual void DoRun (void);
+
+  std::string m_ceil;     //!< the ceil rate of the first leaf class
+  uint32_t m_expected[2]; //!< the packets expected from each leaf class
+};
+
+HtbQueueDiscBorrowTestCase::HtbQueueDiscBorrowTestCase (std::string ceil, uint32_t sent0, uint32_t sent1)
+  : HtbQueueDiscTestCase ("Check borrowing with a ceil rate of " + ceil),
+    m_ceil (ceil)
+{
+  m_expected[0] = sent0;
+  m_expected[1] = sent1;
+}
+
+void
+HtbQueueDiscBorrowTestCase::DoRun (void)
+{
+  // two classes of 4Mbps share the 16Mbps of their parent, a packet of 1000
+  // bytes being sent every 0.5ms
+  Ptr<HtbClass> root = AddInner ("16Mbps", 0);
+  AddLeaf ("4Mbps", m_ceil, root);
+  AddLeaf ("4Mbps", "16Mbps", root);
+  // packets not classified are enqueued in the default class
+  m_qd->SetAttribute ("DefaultClass", UintegerValue (1));
+  Enqueue (500, 0);
+  Enqueue (500, -1);
+
+  Simulator::Schedule (Seconds (0), &QueueDisc::Run, m_qd);
+  Simulator::Stop (MilliSeconds (100));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (m_sent[i], m_expected[i], 2, "Packets sent by class " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_sent[0] + m_sent[1], 200, 3, "Rate of the parent class");
+
+  m_qd->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that many classes share the rate of their parent in round robin
+ */
+class HtbQueueDiscManyClassesTestCase : public HtbQueueDiscTestCase
+{
+public:
+  HtbQueueDiscManyClassesTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HtbQueueDiscManyClassesTestCase::HtbQueueDiscManyClassesTestCase ()
+  : HtbQueueDiscTestCase ("Check 1000 classes sharing the rate of their parent")
+{
+}
+
+void
+HtbQueueDiscManyClassesTestCase::DoRun (void)
+{
+  // 1000 subscribers of 8kbps under an aggregate of 80Mbps, which sends a
+  // packet of 1000 bytes every 0.1ms
+  Ptr<HtbClass> root = AddInner ("80Mbps", 0);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      AddLeaf ("8kbps", "80Mbps", root)->SetAttribute ("Burst", UintegerValue (0));
+    }
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Enqueue (20, i);
+    }
+
+  Simulator::Schedule (Seconds (0), &QueueDisc::Run, m_qd);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  uint32_t total = 0;
+  uint32_t min = m_sent[0];
+  uint32_t max = m_sent[0];
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      total += m_sent[i];
+      min = std::min (min, m_sent[i]);
+      max = std::max (max, m_sent[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ_TOL (total, 10000, 100, "Rate of the parent class");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (max - min, 1, "Round robin among the classes");
+
+  m_qd->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that a leaf class whose child queue disc holds back its packets
+ * is skipped
+ */
+class HtbQueueDiscNonWorkConservingTestCase : public HtbQueueDiscTestCase
+{
+public:
+  HtbQueueDiscNonWorkConservingTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HtbQueueDiscNonWorkConservingTestCase::HtbQueueDiscNonWorkConservingTestCase ()
+  : HtbQueueDiscTestCase ("Check a leaf class with a TBF child queue disc")
+{
+}
+
+void
+HtbQueueDiscNonWorkConservingTestCase::DoRun (void)
+{
+  // the TBF lets a single packet through, then holds the other ones back
+  Ptr<QueueDisc> tbf = CreateObjectWithAttributes<TbfQueueDisc> ("Rate", DataRateValue (DataRate ("8Mbps")),
+                                                                 "Burst", UintegerValue (1000));
+  tbf->Initialize ();
+  Ptr<HtbClass> shaped = AddLeaf ("1Gbps", "0bps", 0, tbf);
+  Ptr<HtbClass> other = AddLeaf ("1Gbps", "0bps", 0);
+  shaped->SetAttribute ("Burst", UintegerValue (100000));
+  other->SetAttribute ("Burst", UintegerValue (100000));
+  Enqueue (3, 0);
+  Enqueue (3, 1);
+
+  // the queue disc is not run, as the TBF would then transmit the packets it
+  // holds back by itself
+  std::vector<int32_t> classes;
+  Ptr<QueueDiscItem> item;
+  while ((item = m_qd->Dequeue ()) != 0)
+    {
+      classes.push_back (DynamicCast<HtbQueueDiscTestItem> (item)->GetClass ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (classes.size (), 4, "The other class is served, and dequeue returns");
+  NS_TEST_EXPECT_MSG_EQ (classes[0], 0, "The TBF lets its first packet through");
+  for (uint32_t i = 1; i < classes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (classes[i], 1, "Packet " << i << " from the other class");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_qd->GetNPackets (), 2, "The TBF holds back two packets");
+
+  m_qd->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Htb Queue Disc Test Suite
+ */
+static class HtbQueueDiscTestSuite : public TestSuite
+{
+public:
+  HtbQueueDiscTestSuite ()
+    : TestSuite ("htb-queue-disc", UNIT)
+  {
+    AddTestCase (new HtbQueueDiscShapingTestCase (), TestCase::QUICK);
+    // each class gets its rate and half of the unused rate of the parent
+    AddTestCase (new HtbQueueDiscBorrowTestCase ("16Mbps", 100, 100), TestCase::QUICK);
+    // the first class is limited by its ceil rate
+    AddTestCase (new HtbQueueDiscBorrowTestCase ("6Mbps", 75, 125), TestCase::QUICK);
+    AddTestCase (new HtbQueueDiscManyClassesTestCase (), TestCase::QUICK);
+    AddTestCase (new HtbQueueDiscNonWorkConservingTestCase (), TestCase::QUICK);
+  }
+} g_htbQueueDiscTestSuite; ///< the test suite
@@ -559,6 +559,114 @@ QueueDiscTracesTestCase::DoRun (void)
 }
 
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check the counters and the traces of the reasons to drop packets,
+ * including the reasons of the packets dropped by a child queue disc.
+ */
+class QueueDiscReasonsTestCase : public TestCase
+{
+public:
+  QueueDiscReasonsTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record the reason of a packet dropped before enqueue
+   * \param item the dropped item
+   * \param reason the reason why the item was dropped
+   */
+  void DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason);
+
+  std::string m_reason;  //!< The reason of the last packet dropped by the root queue disc
+};
+
+QueueDiscReasonsTestCase::QueueDiscReasonsTestCase ()
+  : TestCase ("Check the counters of the reasons to drop packets")
+{
+}
+
+void
+QueueDiscReasonsTestCase::DropBeforeEnqueue (Ptr<const QueueDiscItem> item, const char* reason)
+{
+  m_reason = reason;
+}
+
+void
+QueueDiscReasonsTestCase::DoRun (void)
+{
+  // the identifier of a reason does not depend on where the reason is stored
+  std::string buffer ("Test reason");
+  uint32_t id = QueueDisc::Stats::GetReasonId (buffer.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (QueueDisc::Stats::GetReasonId ("Test reason"), id, "Same reason, same identifier");
+  NS_TEST_EXPECT_MSG_EQ (QueueDisc::Stats::GetReasonName (id), "Test reason", "Name of the reason");
+  buffer.replace (0, 4, "Next");
+  NS_TEST_EXPECT_MSG_NE (QueueDisc::Stats::GetReasonId (buffer.c_str ()), id, "New reason at the same address");
+  // many reasons built at run time, more than the addresses cached
+  std::vector<std::string> reasons;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      reasons.push_back ("Reason " + std::to_string (i));
+    }
+  for (uint32_t k = 0; k < 2; k++)
+    {
+      for (const auto &r : reasons)
+        {
+          NS_TEST_EXPECT_MSG_EQ (QueueDisc::Stats::GetReasonName (QueueDisc::Stats::GetReasonId (r.c_str ())), r,
+                                 "Name of a reason built at run time");
+        }
+    }
+
+  Address dest;
+  Ptr<QueueDisc> root = CreateObject<TestParentQueueDisc> ();
+  root->Initialize ();
+  Ptr<QueueDisc> child = root->GetQueueDiscClass (0)->GetQueueDisc ();
+  root->TraceConnectWithoutContext ("DropBeforeEnqueue",
+                                    MakeCallback (&QueueDiscReasonsTestCase::DropBeforeEnqueue, this));
+
+  // The child queue disc drops the fifth and sixth packets before enqueue
+  for (uint32_t i = 1; i <= 6; i++)
+    {
+      root->Enqueue (Create<qdTestItem> (Create<Packet> (100), dest));
+    }
+  std::string reason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::BEFORE_ENQUEUE;
+  NS_TEST_EXPECT_MSG_EQ (m_reason, reason, "Reason traced by the root queue disc");
+
+  const QueueDisc::Stats &childStats = child->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 2,
+                         "Packets dropped by the child queue disc");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedBytes (TestChildQueueDisc::BEFORE_ENQUEUE), 200,
+                         "Bytes dropped by the child queue disc");
+  NS_TEST_EXPECT_MSG_EQ (childStats.GetNDroppedPackets (reason), 0, "Reason of the root queue disc only");
+
+  // The child queue disc drops two packets after dequeue
+  root->Dequeue ();
+  const QueueDisc::Stats &stats = root->GetStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (reason), 2, "Packets dropped before enqueue by the child");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (TestChildQueueDisc::BEFORE_ENQUEUE), 0,
+                         "Reason of the child queue disc only");
+  reason = std::string (QueueDisc::CHILD_QUEUE_DISC_DROP) + TestChildQueueDisc::AFTER_DEQUEUE;
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets (reason), 2, "Packets dropped after dequeue by the child");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNDroppedPackets ("Never used"), 0, "Unknown reason");
+  NS_TEST_EXPECT_MSG_EQ (stats.GetNMarkedPackets (reason), 0, "No marked packet");
+
+  // The maps of the counters are kept up to date, as the child dropped
+  // packets since its statistics were returned
+  NS_TEST_EXPECT_MSG_EQ (childStats.nDroppedPacketsAfterDequeue.at (TestChildQueueDisc::AFTER_DEQUEUE), 2,
+                         "Packets dropped after dequeue by the child queue disc");
+  NS_TEST_EXPECT_MSG_EQ (childStats.nDroppedBytesBeforeEnqueue.at (TestChildQueueDisc::BEFORE_ENQUEUE), 200,
+                         "Bytes dropped before enqueue by the child queue disc");
+  NS_TEST_EXPECT_MSG_EQ (stats.nDroppedPacketsBeforeEnqueue.size (), 1, "Reasons to drop before enqueue");
+  NS_TEST_EXPECT_MSG_EQ (stats.nDroppedPacketsAfterDequeue.at (reason), 2, "Packets dropped after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (stats.nDroppedBytesAfterDequeue.at (reason), 200, "Bytes dropped after dequeue");
+  NS_TEST_EXPECT_MSG_EQ (stats.nMarkedPackets.size (), 0, "No reason to mark");
+
+  Simulator::Destroy ();
+}
+
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -572,5 +680,6 @@ public:
     : TestSuite ("queue-disc-traces", UNIT)
   {
     AddTestCase (new QueueDiscTracesTestCase (), TestCase::QUICK);
+    AddTestCase (new QueueDiscReasonsTestCase (), TestCase::QUICK);
   }
 } g_queueDiscTracesTestSuite; ///< the test suite
@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <string>
+#include <functional>
+#include <vector>
 
 #include "ns3/test.h"
 #include "ns3/uinteger.h"
@@ -364,6 +366,151 @@ TcFlowControlTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets dequeued in a qdisc run are passed to a device
+ * limited by BQL in batches, and that the packets the device does not accept
+ * are requeued
+ */
+class TcSendBatchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param deviceQueueLength the size of the device queue, in packets
+   * \param batches the expected sizes of the batches
+   * \param requeued the expected number of requeued packets
+   */
+  TcSendBatchTestCase (uint32_t deviceQueueLength, std::vector<std::size_t> batches, uint32_t requeued);
+  virtual ~TcSendBatchTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Wrap the batch send callback of the queue disc, stop the device queue
+   * and send packets, which are then stored in the queue disc
+   * \param n the node
+   * \param nPackets the number of packets to send
+   */
+  void SendPackets (Ptr<Node> n, uint16_t nPackets);
+  /**
+   * Record the size of a batch and pass it to the device
+   * \param items the batch
+   * \return the number of packets consumed by the device
+   */
+  std::size_t SendBatch (const std::vector<Ptr<QueueDiscItem> > &items);
+  /**
+   * Record a requeued packet
+   * \param item the requeued packet
+   */
+  void Requeue (Ptr<const QueueDiscItem> item);
+
+  uint32_t m_deviceQueueLength;               //!< the size of the device queue
+  std::vector<std::size_t> m_expectedBatches; //!< the expected sizes of the batches
+  uint32_t m_expectedRequeued;                //!< the expected number of requeued packets
+  QueueDisc::SendBatchCallback m_sendBatch;   //!< the batch send callback of the queue disc
+  std::vector<std::size_t> m_batches;         //!< the sizes of the batches
+  std::size_t m_consumed;                     //!< the number of packets consumed by the device
+  uint32_t m_requeued;                        //!< the number of requeued packets
+};
+
+TcSendBatchTestCase::TcSendBatchTestCase (uint32_t deviceQueueLength, std::vector<std::size_t> batches,
+                                          uint32_t requeued)
+  : TestCase ("Test the batched dequeue of packets to a device limited by BQL"),
+    m_deviceQueueLength (deviceQueueLength),
+    m_expectedBatches (batches),
+    m_expectedRequeued (requeued),
+    m_consumed (0),
+    m_requeued (0)
+{
+}
+
+TcSendBatchTestCase::~TcSendBatchTestCase ()
+{
+}
+
+void
+TcSendBatchTestCase::SendPackets (Ptr<Node> n, uint16_t nPackets)
+{
+  Ptr<TrafficControlLayer> tc = n->GetObject<TrafficControlLayer> ();
+  Ptr<QueueDisc> qdisc = tc->GetRootQueueDiscOnDevice (n->GetDevice (0));
+  m_sendBatch = qdisc->GetSendBatchCallback ();
+  NS_TEST_ASSERT_MSG_EQ ((m_sendBatch != nullptr), true, "The device supports batches");
+  qdisc->SetSendBatchCallback (std::bind (&TcSendBatchTestCase::SendBatch, this, std::placeholders::_1));
+  qdisc->TraceConnectWithoutContext ("Requeue", MakeCallback (&TcSendBatchTestCase::Requeue, this));
+
+  n->GetDevice (0)->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0)->Stop ();
+  for (uint16_t i = 0; i < nPackets; i++)
+    {
+      tc->Send (n->GetDevice (0), Create<QueueDiscTestItem> (Create<Packet> (1000)));
+    }
+}
+
+std::size_t
+TcSendBatchTestCase::SendBatch (const std::vector<Ptr<QueueDiscItem> > &items)
+{
+  m_batches.push_back (items.size ());
+  std::size_t n = m_sendBatch (items);
+  m_consumed += n;
+  return n;
+}
+
+void
+TcSendBatchTestCase::Requeue (Ptr<const QueueDiscItem> item)
+{
+  m_requeued++;
+}
+
+void
+TcSendBatchTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  n.Get (0)->AggregateObject (CreateObject<TrafficControlLayer> ());
+  n.Get (1)->AggregateObject (CreateObject<TrafficControlLayer> ());
+
+  SimpleNetDeviceHelper simple;
+
+  NetDeviceContainer rxDevC = simple.Install (n.Get (1));
+
+  simple.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Mb/s")));
+  simple.SetQueue ("ns3::DropTailQueue", "MaxSize",
+                   StringValue (std::to_string (m_deviceQueueLength) + "p"));
+
+  Ptr<NetDevice> txDev;
+  txDev = simple.Install (n.Get (0), DynamicCast<SimpleChannel> (rxDevC.Get (0)->GetChannel ())).Get (0);
+  txDev->SetMtu (2500);
+
+  // a fixed limit of 3500 bytes
+  TrafficControlHelper tch = TrafficControlHelper::Default ();
+  tch.SetQueueLimits ("ns3::DynamicQueueLimits", "MinLimit", UintegerValue (3500),
+                      "MaxLimit", UintegerValue (3500));
+  tch.Install (txDev);
+
+  // store 10 packets in the queue disc at time 0, then wake the device queue
+  Simulator::Schedule (Time (Seconds (0)), &TcSendBatchTestCase::SendPackets,
+                      this, n.Get (0), 10);
+  Simulator::Schedule (Time (MilliSeconds (1)), &NetDeviceQueue::Wake,
+                       txDev->GetObject<NetDeviceQueueInterface> ()->GetTxQueue (0));
+
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_consumed, 10, "All the packets must be consumed by the device");
+  NS_TEST_EXPECT_MSG_EQ (m_requeued, m_expectedRequeued, "Unexpected number of requeued packets");
+  NS_TEST_ASSERT_MSG_EQ (m_batches.size (), m_expectedBatches.size (), "Unexpected number of batches");
+  for (std::size_t i = 0; i < m_batches.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_batches[i], m_expectedBatches[i], "Unexpected size of batch " << i);
+    }
+  Ptr<QueueDisc> qdisc = n.Get (0)->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (txDev);
+  NS_TEST_EXPECT_MSG_EQ (qdisc->GetStats ().nTotalSentPackets, 10, "All the packets must be sent");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup traffic-control-test
  * \ingroup tests
@@ -389,5 +536,11 @@ public:
     // TODO: Right now, this test only works for 5000B and 10 packets (it's hard coded). Should
     // also be made parametric.
     AddTestCase (new TcFlowControlTestCase (QueueSizeUnit::BYTES, 5000, 10), TestCase::QUICK);
+    // the BQL limit is null before the first completion, then it is 3500B: the
+    // device accepts all the packets of a batch
+    AddTestCase (new TcSendBatchTestCase (100, {1, 4, 1, 1, 1, 1, 1}, 0), TestCase::QUICK);
+    // the device queue (2 packets) is stopped before BQL: the device accepts
+    // as many packets as it has room for and the others are requeued
+    AddTestCase (new TcSendBatchTestCase (2, {1, 4, 3, 3, 3, 3, 3, 2, 1}, 13), TestCase::QUICK);
   }
 } g_tcFlowControlTestSuite; ///< the test suite
@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the Internet checksum and CRC-32
+// kernels, for each kernel supported by the CPU.
+// Sample usage:  ./waf --run 'bench-checksum --n=100000 --size=1500'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/buffer.h"
+#include "ns3/crc32.h"
+#include "ns3/ip-checksum.h"
+#include <iostream>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Result of the checksums, printed so that they are not optimized away
+static uint32_t g_result = 0;
+
+/**
+ * Checksum a raw buffer n times.
+ * \param n number of iterations
+ * \param data the buffer
+ */
+static void
+benchIpChecksum (uint32_t n, std::vector<uint8_t> const &data)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_result += IpChecksumCalculate (&data[0], data.size ());
+    }
+}
+
+/**
+ * Compute the CRC-32 of a raw buffer n times.
+ * \param n number of iterations
+ * \param data the buffer
+ */
+static void
+benchCrc32 (uint32_t n, std::vector<uint8_t> const &data)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_result += CRC32Calculate (&data[0], data.size ());
+    }
+}
+
+/**
+ * Checksum a Buffer n times, as the Ipv4, UDP and TCP headers do.
+ * \param n number of iterations
+ * \param data the buffer contents
+ */
+static void
+benchBufferChecksum (uint32_t n, std::vector<uint8_t> const &data)
+{
+  Buffer buffer;
+  buffer.AddAtStart (data.size ());
+  buffer.Begin ().Write (&data[0], data.size ());
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_result += buffer.Begin ().CalculateIpChecksum (data.size ());
+    }
+}
+
+/**
+ * Run a benchmark and print its throughput.
+ * \param bench the benchmark
+ * \param n number of iterations
+ * \param minIterations number of runs to minimize the run time over
+ * \param data the buffer
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (uint32_t, std::vector<uint8_t> const &), uint32_t n,
+          uint32_t minIterations, std::vector<uint8_t> const &data, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n, data);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double mbps = static_cast<double> (n) * data.size () / minDelay / 1000;
+  double nsPerBuffer = 1e6 * minDelay / n;
+  std::cout << mbps << " MB/s, " << nsPerBuffer << " ns per buffer"
+            << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t size = 1500;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the checksum kernels");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("size", "buffer size (bytes)", size);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || size == 0)
+    {
+      std::cerr << "Error-- number of iterations and buffer size must be specified " <<
+        "by command-line arguments --n and --size" << std::endl;
+      return 1;
+    }
+
+  std::vector<uint8_t> data (size);
+  for (uint32_t i = 0; i < size; i++)
+    {
+      data[i] = static_cast<uint8_t> (i * 7 + 3);
+    }
+
+  std::cout << "Running bench-checksum with n=" << n << " size=" << size << std::endl;
+  const char *names[] = { "scalar", "sse", "avx2" };
+  ChecksumKernel kernels[] = { CHECKSUM_KERNEL_SCALAR, CHECKSUM_KERNEL_SSE, CHECKSUM_KERNEL_AVX2 };
+  for (uint32_t k = 0; k < 3; k++)
+    {
+      if (!IsChecksumKernelSupported (kernels[k]))
+        {
+          std::cout << "Kernel " << names[k] << " not supported" << std::endl;
+          continue;
+        }
+      SetChecksumKernel (kernels[k]);
+      std::cout << "Kernel " << names[k] << std::endl;
+      runBench (&benchIpChecksum, n, minIterations, data, "IpChecksumCalculate");
+      runBench (&benchBufferChecksum, n, minIterations, data, "Buffer::Iterator::CalculateIpChecksum");
+      runBench (&benchCrc32, n, minIterations, data, "CRC32Calculate");
+    }
+  std::cout << "(" << g_result << ")" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the demultiplexing of packets to
+// the end points of a server with 'endpoints' connections accepted on
+// the same port, as TCP servers such as PacketSink have.
+// Sample usage:  ./waf --run 'bench-demux --n=1000000 --endpoints=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Result of the lookups, printed so that they are not optimized away
+static uint64_t g_result = 0;
+
+/// Local address of the server
+static const Ipv4Address g_server ("10.0.0.1");
+
+/// Port of the server
+static const uint16_t g_port = 80;
+
+/**
+ * \param i the index of a connection
+ * \returns the address of the client of the connection
+ */
+static Ipv4Address
+GetClient (uint32_t i)
+{
+  return Ipv4Address (0x0b000000 + i / 16);
+}
+
+/**
+ * \param i the index of a connection
+ * \returns the port of the client of the connection
+ */
+static uint16_t
+GetClientPort (uint32_t i)
+{
+  return 49152 + i % 16;
+}
+
+/**
+ * Look up the end points of the established connections n times.
+ * \param n number of iterations
+ * \param demux the demux
+ * \param endpoints number of connections
+ * \param interface the incoming interface
+ */
+static void
+benchConnected (uint32_t n, Ipv4EndPointDemux &demux, uint32_t endpoints, Ptr<Ipv4Interface> interface)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t c = (i * 7919) % endpoints;
+      g_result += demux.Lookup (g_server, g_port, GetClient (c), GetClientPort (c), interface).size ();
+    }
+}
+
+/**
+ * Look up the listening end point for new connections n times.
+ * \param n number of iterations
+ * \param demux the demux
+ * \param endpoints number of connections
+ * \param interface the incoming interface
+ */
+static void
+benchListener (uint32_t n, Ipv4EndPointDemux &demux, uint32_t endpoints, Ptr<Ipv4Interface> interface)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t c = endpoints + i % 1000;
+      g_result += demux.Lookup (g_server, g_port, GetClient (c), GetClientPort (c), interface).size ();
+    }
+}
+
+/**
+ * Allocate and deallocate an ephemeral end point n times.
+ * \param n number of iterations
+ * \param demux the demux
+ * \param endpoints number of connections
+ * \param interface the incoming interface
+ */
+static void
+benchAllocate (uint32_t n, Ipv4EndPointDemux &demux, uint32_t endpoints, Ptr<Ipv4Interface> interface)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ipv4EndPoint *endPoint = demux.Allocate ();
+      g_result += endPoint->GetLocalPort ();
+      demux.DeAllocate (endPoint);
+    }
+}
+
+/**
+ * Run a benchmark and print its speed.
+ * \param bench the benchmark
+ * \param n number of iterations
+ * \param minIterations number of runs to minimize the run time over
+ * \param demux the demux
+ * \param endpoints number of connections
+ * \param interface the incoming interface
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (uint32_t, Ipv4EndPointDemux &, uint32_t, Ptr<Ipv4Interface>), uint32_t n,
+          uint32_t minIterations, Ipv4EndPointDemux &demux, uint32_t endpoints,
+          Ptr<Ipv4Interface> interface, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n, demux, endpoints, interface);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double nsPerOp = 1e6 * minDelay / n;
+  std::cout << nsPerOp << " ns per operation"
+            << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t endpoints = 100000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the end point demux of a server");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("endpoints", "number of connections of the server", endpoints);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+
+  Ipv4EndPointDemux demux;
+  demux.Allocate (0, Ipv4Address::GetAny (), g_port);
+  for (uint32_t i = 0; i < endpoints; i++)
+    {
+      demux.Allocate (0, g_server, g_port, GetClient (i), GetClientPort (i));
+    }
+  Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface> ();
+
+  std::cout << "Running bench-demux with n=" << n << " endpoints=" << endpoints << std::endl;
+  runBench (&benchConnected, n, minIterations, demux, endpoints, interface, "Lookup (connected)");
+  runBench (&benchListener, n, minIterations, demux, endpoints, interface, "Lookup (listener)");
+  runBench (&benchAllocate, n, minIterations, demux, endpoints, interface, "Allocate/DeAllocate (ephemeral)");
+  std::cout << "(" << g_result << ")" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the writing of 2D data points, as
+// produced by the TimeSeriesAdaptor, by the FileAggregator with each file type.
+// Sample usage:  ./waf --run 'bench-file-aggregator --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/file-aggregator.h"
+#include <iostream>
+#include <cstdio>
+
+using namespace ns3;
+
+/**
+ * Run the benchmark with a file type and print its speed.
+ * \param n the number of data points
+ * \param fileType the file type
+ * \param name the benchmark name
+ */
+static void
+runBench (uint32_t n, FileAggregator::FileType fileType, char const *name)
+{
+  std::string fileName = "bench-file-aggregator.out";
+  SystemWallClockMs time;
+  time.Start ();
+  {
+    Ptr<FileAggregator> aggregator = CreateObject<FileAggregator> (fileName, fileType);
+    aggregator->Enable ();
+    for (uint32_t i = 0; i < n; i++)
+      {
+        aggregator->Write2d ("context", i * 1e-6, i * 0.5);
+      }
+  }
+  uint64_t delay = std::max (static_cast<uint64_t> (time.End ()), static_cast<uint64_t> (1));
+  std::remove (fileName.c_str ());
+
+  double nsPerOp = 1e6 * delay / n;
+  std::cout << nsPerOp << " ns per data point"
+            << " (" << delay << " ms elapsed)\t" << name << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the writing of data points by the FileAggregator");
+  cmd.AddValue ("n", "number of data points", n);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of data points must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Running bench-file-aggregator with n=" << n << std::endl;
+
+  runBench (n, FileAggregator::SPACE_SEPARATED, "SPACE_SEPARATED");
+  runBench (n, FileAggregator::FORMATTED, "FORMATTED");
+  runBench (n, FileAggregator::BINARY, "BINARY");
+
+  return 0;
+}
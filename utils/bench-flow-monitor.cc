@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the per packet cost of the
+// FlowMonitor with many concurrent flows. Every 10 microseconds a UDP packet
+// of one of the flows is classified and reported as transmitted and
+// forwarded, and a window of packets is kept in transit before they are
+// reported as received. One packet out of 100 is never received, and it is
+// accounted as lost after one second.
+// Sample usage:  ./waf --run 'bench-flow-monitor --n=1000000 --flows=100000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/udp-header.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include <iostream>
+#include <deque>
+
+using namespace ns3;
+
+/**
+ * A FlowProbe which is driven directly by the benchmark
+ */
+class BenchProbe : public FlowProbe
+{
+public:
+  /**
+   * Constructor
+   * \param monitor the FlowMonitor the probe reports to
+   */
+  BenchProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * The packets of many flows reported to a FlowMonitor
+ */
+class BenchFlows
+{
+public:
+  /**
+   * Constructor
+   * \param flows the number of flows
+   * \param window the number of packets in transit
+   */
+  BenchFlows (uint32_t flows, uint32_t window);
+  /**
+   * Send n packets, one every 10 microseconds
+   * \param n the number of packets to send
+   */
+  void SendPackets (uint32_t n);
+  /**
+   * \return the FlowMonitor
+   */
+  Ptr<FlowMonitor> GetMonitor (void) const;
+
+private:
+  Ptr<FlowMonitor> m_monitor;           //!< The FlowMonitor
+  Ptr<Ipv4FlowClassifier> m_classifier; //!< The flow classifier
+  Ptr<FlowProbe> m_probe;               //!< The probe
+  Ptr<Packet> m_payload;                //!< The UDP payload
+  uint32_t m_flows;                     //!< The number of flows
+  uint32_t m_window;                    //!< The number of packets in transit
+  /// The (flow, packet) identifiers of the packets in transit
+  std::deque<std::pair<FlowId, FlowPacketId> > m_inTransit;
+};
+
+BenchFlows::BenchFlows (uint32_t flows, uint32_t window)
+  : m_flows (flows),
+    m_window (window)
+{
+  m_monitor = CreateObject<FlowMonitor> ();
+  m_monitor->SetAttribute ("MaxPerHopDelay", TimeValue (Seconds (1)));
+  m_classifier = Create<Ipv4FlowClassifier> ();
+  m_monitor->AddFlowClassifier (m_classifier);
+  m_probe = CreateObject<BenchProbe> (m_monitor);
+  UdpHeader udpHeader;
+  udpHeader.SetDestinationPort (9);
+  m_payload = Create<Packet> (1000);
+  m_payload->AddHeader (udpHeader);
+}
+
+void
+BenchFlows::SendPackets (uint32_t n)
+{
+  if (n == 0)
+    {
+      return;
+    }
+  // a simple pseudo random sequence of flows
+  uint32_t flow = (n * 2654435761u) % m_flows;
+  Ipv4Header ipHeader;
+  ipHeader.SetSource (Ipv4Address (0x0a000000 + flow / 1000));
+  ipHeader.SetDestination (Ipv4Address (0x0b000000 + flow % 1000));
+  ipHeader.SetProtocol (17);
+
+  FlowId flowId;
+  FlowPacketId packetId;
+  uint32_t size = m_payload->GetSize () + ipHeader.GetSerializedSize ();
+  if (m_classifier->Classify (ipHeader, m_payload, &flowId, &packetId))
+    {
+      m_monitor->ReportFirstTx (m_probe, flowId, packetId, size);
+      m_monitor->ReportForwarding (m_probe, flowId, packetId, size);
+      if (n % 100 != 0)
+        {
+          m_inTransit.push_back (std::make_pair (flowId, packetId));
+        }
+    }
+  if (m_inTransit.size () > m_window)
+    {
+      m_monitor->ReportLastRx (m_probe, m_inTransit.front ().first, m_inTransit.front ().second, size);
+      m_inTransit.pop_front ();
+    }
+  Simulator::Schedule (MicroSeconds (10), &BenchFlows::SendPackets, this, n - 1);
+}
+
+Ptr<FlowMonitor>
+BenchFlows::GetMonitor (void) const
+{
+  return m_monitor;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t flows = 100000;
+  uint32_t window = 10000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the per packet cost of the FlowMonitor");
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.AddValue ("flows", "number of flows", flows);
+  cmd.AddValue ("window", "number of packets in transit", window);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || flows == 0)
+    {
+      std::cerr << "Error-- number of packets must be specified " <<
+        "by command-line argument --n, and at least one flow is needed" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Running bench-flow-monitor with n=" << n << " flows=" << flows
+            << " window=" << window << std::endl;
+
+  BenchFlows bench (flows, window);
+  Simulator::Schedule (Seconds (0), &BenchFlows::SendPackets, &bench, n);
+  Simulator::Stop (MicroSeconds (10) * n);
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  bench.GetMonitor ()->CheckForLostPackets ();
+  uint64_t delay = std::max (static_cast<uint64_t> (time.End ()), static_cast<uint64_t> (1));
+
+  uint64_t lost = 0;
+  const FlowMonitor::FlowStatsContainer &stats = bench.GetMonitor ()->GetFlowStats ();
+  for (FlowMonitor::FlowStatsContainerCI it = stats.begin (); it != stats.end (); it++)
+    {
+      lost += it->second.lostPackets;
+    }
+
+  double nsPerOp = 1e6 * delay / n;
+  std::cout << nsPerOp << " ns per packet"
+            << " (" << delay << " ms elapsed, " << stats.size () << " flows, "
+            << lost << " packets lost)" << std::endl;
+
+  bench.GetMonitor ()->Dispose ();
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the per-packet cost of the flow
+// queueing discs (FqCoDel, FqCobalt, FqPie) with 'flows' active flows and a
+// backlog of 'backlog' packets: each iteration dequeues a packet and enqueues
+// it again.
+// Sample usage:  ./waf --run 'bench-fq-queue-disc --n=1000000 --flows=1024'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/packet.h"
+#include "ns3/queue-item.h"
+#include "ns3/fq-codel-queue-disc.h"
+#include "ns3/fq-cobalt-queue-disc.h"
+#include "ns3/fq-pie-queue-disc.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Result of the dequeues, printed so that they are not optimized away
+static uint64_t g_result = 0;
+
+/**
+ * A queue disc item of a given flow
+ */
+class BenchQueueDiscItem : public QueueDiscItem
+{
+public:
+  /**
+   * Constructor.
+   * \param p the packet
+   * \param flow the hash of the flow
+   */
+  BenchQueueDiscItem (Ptr<Packet> p, uint32_t flow)
+    : QueueDiscItem (p, Address (), 0),
+      m_flow (flow)
+  {
+  }
+
+  virtual void AddHeader (void)
+  {
+  }
+
+  virtual bool Mark (void)
+  {
+    return false;
+  }
+
+  virtual uint32_t Hash (uint32_t perturbation) const
+  {
+    return m_flow;
+  }
+
+private:
+  uint32_t m_flow; //!< The hash of the flow
+};
+
+/**
+ * Dequeue a packet and enqueue it again n times.
+ * \param n number of iterations
+ * \param qd the queue disc
+ */
+static void
+benchDequeueEnqueue (uint32_t n, Ptr<QueueDisc> qd)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<QueueDiscItem> item = qd->Dequeue ();
+      g_result += item->GetSize ();
+      qd->Enqueue (item);
+    }
+}
+
+/**
+ * Fill a queue disc, then run the benchmark on it and print its speed.
+ * \param qd the queue disc, whose quantum is set
+ * \param n number of iterations
+ * \param minIterations number of runs to minimize the run time over
+ * \param flows number of flows
+ * \param backlog number of packets in the queue disc
+ * \param name the benchmark name
+ */
+static void
+runBench (Ptr<QueueDisc> qd, uint32_t n, uint32_t minIterations,
+          uint32_t flows, uint32_t backlog, char const *name)
+{
+  qd->SetAttribute ("MaxSize", QueueSizeValue (QueueSize (QueueSizeUnit::PACKETS, backlog + 1)));
+  qd->Initialize ();
+  for (uint32_t i = 0; i < backlog; i++)
+    {
+      qd->Enqueue (Create<BenchQueueDiscItem> (Create<Packet> (1000), (i * 7919) % flows));
+    }
+
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      benchDequeueEnqueue (n, qd);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double nsPerOp = 1e6 * minDelay / n;
+  std::cout << nsPerOp << " ns per packet"
+            << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+  qd->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t flows = 1024;
+  uint32_t backlog = 4096;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the per-packet cost of the flow queueing discs");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("flows", "number of active flows (and of flow queues)", flows);
+  cmd.AddValue ("backlog", "number of packets in the queue disc", backlog);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+  if (flows == 0 || backlog == 0)
+    {
+      std::cerr << "Error-- the number of flows and the backlog must be positive" << std::endl;
+      return 1;
+    }
+
+  // Freeze the time resolution as a simulation does, so that the Time
+  // objects of the queue discs are not recorded
+  Simulator::Run ();
+
+  std::cout << "Running bench-fq-queue-disc with n=" << n << " flows=" << flows
+            << " backlog=" << backlog << std::endl;
+
+  Ptr<FqCoDelQueueDisc> fqCoDel = CreateObject<FqCoDelQueueDisc> ();
+  fqCoDel->SetAttribute ("Flows", UintegerValue (flows));
+  fqCoDel->SetQuantum (1500);
+  runBench (fqCoDel, n, minIterations, flows, backlog, "FqCoDelQueueDisc");
+
+  Ptr<FqCobaltQueueDisc> fqCobalt = CreateObject<FqCobaltQueueDisc> ();
+  fqCobalt->SetAttribute ("Flows", UintegerValue (flows));
+  fqCobalt->SetQuantum (1500);
+  runBench (fqCobalt, n, minIterations, flows, backlog, "FqCobaltQueueDisc");
+
+  Ptr<FqPieQueueDisc> fqPie = CreateObject<FqPieQueueDisc> ();
+  fqPie->SetAttribute ("Flows", UintegerValue (flows));
+  fqPie->SetQuantum (1500);
+  runBench (fqPie, n, minIterations, flows, backlog, "FqPieQueueDisc");
+
+  std::cout << "(" << g_result << ")" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,211 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the ARP and NDISC caches of a host
+// with 'entries' neighbors, as in large L2 topologies. The inverse lookup is
+// done by IPv4 and IPv6 for each packet received from a router.
+// Sample usage:  ./waf --run 'bench-neighbor-cache --n=100000 --entries=10000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/mac48-address.h"
+#include "ns3/arp-cache.h"
+#include "ns3/ndisc-cache.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Result of the lookups, printed so that they are not optimized away
+static uint64_t g_result = 0;
+
+/**
+ * \param i the index of a neighbor
+ * \returns the MAC address of the neighbor
+ */
+static Address
+GetMac (uint32_t i)
+{
+  uint8_t buffer[6] = {0x02, 0, static_cast<uint8_t> (i >> 24), static_cast<uint8_t> (i >> 16),
+                       static_cast<uint8_t> (i >> 8), static_cast<uint8_t> (i)};
+  Mac48Address mac;
+  mac.CopyFrom (buffer);
+  return mac;
+}
+
+/**
+ * \param i the index of a neighbor
+ * \returns the IPv4 address of the neighbor
+ */
+static Ipv4Address
+GetIpv4 (uint32_t i)
+{
+  return Ipv4Address (0x0a000000 + i);
+}
+
+/**
+ * \param i the index of a neighbor
+ * \returns the IPv6 address of the neighbor
+ */
+static Ipv6Address
+GetIpv6 (uint32_t i)
+{
+  uint8_t buffer[16] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0,
+                        static_cast<uint8_t> (i >> 24), static_cast<uint8_t> (i >> 16),
+                        static_cast<uint8_t> (i >> 8), static_cast<uint8_t> (i)};
+  return Ipv6Address (buffer);
+}
+
+/// The caches under test
+struct Caches
+{
+  Ptr<ArpCache> arp;      //!< The ARP cache
+  Ptr<NdiscCache> ndisc;  //!< The NDISC cache
+  uint32_t entries;       //!< Number of neighbors
+};
+
+/**
+ * Look up the ARP entries of a neighbor from its MAC address n times.
+ * \param n number of iterations
+ * \param caches the caches
+ */
+static void
+benchArpInverse (uint32_t n, Caches &caches)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_result += caches.arp->LookupInverse (GetMac ((i * 7919) % caches.entries)).size ();
+    }
+}
+
+/**
+ * Remove and add an ARP entry n times.
+ * \param n number of iterations
+ * \param caches the caches
+ */
+static void
+benchArpRemove (uint32_t n, Caches &caches)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t neighbor = (i * 7919) % caches.entries;
+      caches.arp->Remove (caches.arp->Lookup (GetIpv4 (neighbor)));
+      ArpCache::Entry *entry = caches.arp->Add (GetIpv4 (neighbor));
+      entry->SetMacAddress (GetMac (neighbor));
+      g_result++;
+    }
+}
+
+/**
+ * Look up the NDISC entries of a neighbor from its MAC address n times.
+ * \param n number of iterations
+ * \param caches the caches
+ */
+static void
+benchNdiscInverse (uint32_t n, Caches &caches)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_result += caches.ndisc->LookupInverse (GetMac ((i * 7919) % caches.entries)).size ();
+    }
+}
+
+/**
+ * Remove and add an NDISC entry n times.
+ * \param n number of iterations
+ * \param caches the caches
+ */
+static void
+benchNdiscRemove (uint32_t n, Caches &caches)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t neighbor = (i * 7919) % caches.entries;
+      caches.ndisc->Remove (caches.ndisc->Lookup (GetIpv6 (neighbor)));
+      NdiscCache::Entry *entry = caches.ndisc->Add (GetIpv6 (neighbor));
+      entry->SetMacAddress (GetMac (neighbor));
+      g_result++;
+    }
+}
+
+/**
+ * Run a benchmark and print its speed.
+ * \param bench the benchmark
+ * \param n number of iterations
+ * \param minIterations number of runs to minimize the run time over
+ * \param caches the caches
+ * \param name the benchmark name
+ */
+static void
+runBench (void (*bench) (uint32_t, Caches &), uint32_t n, uint32_t minIterations,
+          Caches &caches, char const *name)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      SystemWallClockMs time;
+      time.Start ();
+      (*bench) (n, caches);
+      minDelay = std::min (minDelay, static_cast<uint64_t> (time.End ()));
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double nsPerOp = 1e6 * minDelay / n;
+  std::cout << nsPerOp << " ns per operation"
+            << " (" << minDelay << " ms elapsed)\t" << name << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t entries = 10000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the ARP and NDISC caches of a host with many neighbors");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("entries", "number of neighbors in the caches", entries);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+
+  Caches caches;
+  caches.arp = CreateObject<ArpCache> ();
+  caches.ndisc = CreateObject<NdiscCache> ();
+  caches.entries = entries;
+  for (uint32_t i = 0; i < entries; i++)
+    {
+      caches.arp->Add (GetIpv4 (i))->SetMacAddress (GetMac (i));
+      caches.ndisc->Add (GetIpv6 (i))->SetMacAddress (GetMac (i));
+    }
+
+  std::cout << "Running bench-neighbor-cache with n=" << n << " entries=" << entries << std::endl;
+  runBench (&benchArpInverse, n, minIterations, caches, "ArpCache::LookupInverse");
+  runBench (&benchArpRemove, n, minIterations, caches, "ArpCache::Remove/Add");
+  runBench (&benchNdiscInverse, n, minIterations, caches, "NdiscCache::LookupInverse");
+  runBench (&benchNdiscRemove, n, minIterations, caches, "NdiscCache::Remove/Add");
+  std::cout << "(" << g_result << ")" << std::endl;
+
+  caches.arp->Dispose ();
+  caches.ndisc->Dispose ();
+  return 0;
+}
@@ -26,6 +26,13 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/ethernet-header.h"
+#ifdef NS3_BENCH_PROTOCOL_HEADERS
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/tcp-header.h"
+#include "ns3/ppp-header.h"
+#endif
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -328,6 +335,79 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchEthernet (uint32_t n)
+{
+  EthernetHeader eth;
+  eth.SetSource (Mac48Address ("00:00:00:00:00:01"));
+  eth.SetDestination (Mac48Address ("00:00:00:00:00:02"));
+  eth.SetLengthType (0x0800);
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (eth);
+      p->RemoveHeader (eth);
+    }
+}
+
+#ifdef NS3_BENCH_PROTOCOL_HEADERS
+static void
+benchUdpIpv4Ppp (uint32_t n)
+{
+  UdpHeader udp;
+  udp.SetSourcePort (1000);
+  udp.SetDestinationPort (2000);
+  Ipv4Header ipv4;
+  ipv4.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipv4.SetProtocol (17);
+  ipv4.SetPayloadSize (1008);
+  ipv4.SetTtl (64);
+  ipv4.EnableChecksum ();
+  PppHeader ppp;
+  ppp.SetProtocol (0x0021);
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddHeader (udp);
+      ipv4.SetIdentification (i);
+      p->AddHeader (ipv4);
+      p->AddHeader (ppp);
+      p->RemoveHeader (ppp);
+      p->RemoveHeader (ipv4);
+      p->RemoveHeader (udp);
+    }
+}
+
+static void
+benchTcpIpv4 (uint32_t n)
+{
+  TcpHeader tcp;
+  tcp.SetSourcePort (1000);
+  tcp.SetDestinationPort (2000);
+  tcp.SetFlags (TcpHeader::ACK);
+  tcp.SetWindowSize (65535);
+  Ipv4Header ipv4;
+  ipv4.SetSource (Ipv4Address ("10.0.0.1"));
+  ipv4.SetDestination (Ipv4Address ("10.0.0.2"));
+  ipv4.SetProtocol (6);
+  ipv4.SetPayloadSize (1020);
+  ipv4.EnableChecksum ();
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      tcp.SetSequenceNumber (SequenceNumber32 (i * 1000));
+      p->AddHeader (tcp);
+      p->AddHeader (ipv4);
+      p->RemoveHeader (ipv4);
+      p->RemoveHeader (tcp);
+    }
+}
+#endif /* NS3_BENCH_PROTOCOL_HEADERS */
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +465,11 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchEthernet, n, minIterations, "Add and remove an Ethernet header");
+#ifdef NS3_BENCH_PROTOCOL_HEADERS
+  runBench (&benchUdpIpv4Ppp, n, minIterations, "Add and remove UDP, IPv4 and PPP headers");
+  runBench (&benchTcpIpv4, n, minIterations, "Add and remove TCP and IPv4 headers");
+#endif
 
   return 0;
 }
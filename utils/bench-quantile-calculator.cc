@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+// This program can be used to benchmark the update of the calculators of
+// the stats module with exponentially distributed delays, and the memory
+// they use, to compare the QuantileCalculator with the moments of the
+// MinMaxAvgTotalCalculator and with a fixed-width Histogram.
+// Sample usage:  ./waf --run 'bench-quantile-calculator --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/basic-data-calculators.h"
+#include "ns3/quantile-calculator.h"
+#include "ns3/histogram.h"
+#include <iostream>
+#include <cmath>
+
+using namespace ns3;
+
+/**
+ * Print the speed of a benchmark.
+ * \param n the number of values
+ * \param delay the elapsed time, in milliseconds
+ * \param name the benchmark name
+ * \param details what to print after the elapsed time
+ */
+static void
+printResult (uint32_t n, uint64_t delay, char const *name, std::string details)
+{
+  delay = std::max (delay, static_cast<uint64_t> (1));
+  double nsPerOp = 1e6 * delay / n;
+  std::cout << nsPerOp << " ns per value"
+            << " (" << delay << " ms elapsed, " << details << ")\t" << name << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the update of the MinMaxAvgTotalCalculator, Histogram and QuantileCalculator");
+  cmd.AddValue ("n", "number of values", n);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of values must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Running bench-quantile-calculator with n=" << n << std::endl;
+
+  // exponentially distributed delays with a mean of 10 ms, computed
+  // beforehand with a simple linear congruential generator
+  std::vector<double> values (1 << 16);
+  uint32_t state = 1;
+  for (uint32_t i = 0; i < values.size (); i++)
+    {
+      state = state * 1664525u + 1013904223u;
+      values[i] = -0.01 * std::log ((state + 1.0) / 4294967297.0);
+    }
+  uint32_t mask = values.size () - 1;
+
+  SystemWallClockMs time;
+
+  Ptr<MinMaxAvgTotalCalculator<double> > moments = CreateObject<MinMaxAvgTotalCalculator<double> > ();
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      moments->Update (values[i & mask]);
+    }
+  printResult (n, time.End (), "MinMaxAvgTotalCalculator", "no percentile");
+
+  Histogram histogram (1e-5);
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      histogram.AddValue (values[i & mask]);
+    }
+  printResult (n, time.End (), "Histogram",
+               std::to_string (histogram.GetNBins ()) + " bins of 10 us");
+
+  Ptr<QuantileCalculator> quantiles = CreateObject<QuantileCalculator> ();
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      quantiles->Update (values[i & mask]);
+    }
+  printResult (n, time.End (), "QuantileCalculator",
+               std::to_string (quantiles->GetSketch ().GetNBins ()) + " bins, p99="
+               + std::to_string (quantiles->GetQuantile (0.99)) + " s");
+
+  return 0;
+}
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the forwarding of unicast frames by
+// the BridgeNetDevice and the SwitchNetDevice, with a host connected to each
+// port. After every host has been learned, n frames are sent between pseudo
+// random pairs of hosts.
+// Sample usage:  ./waf --run 'bench-switch --n=1000000 --ports=1000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/bridge-helper.h"
+#include "ns3/switch-helper.h"
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * A set of hosts connected to a bridge or a switch, which send frames
+ */
+class BenchHosts
+{
+public:
+  /**
+   * Connect the hosts to the ports of a new bridge or switch
+   * \param ports the number of ports
+   * \param useSwitch whether a SwitchNetDevice or a BridgeNetDevice is used
+   */
+  BenchHosts (uint32_t ports, bool useSwitch);
+  /**
+   * Let the host i send a frame to host 0, for each host i
+   */
+  void Learn (void);
+  /**
+   * Send n frames, one every microsecond
+   * \param n the number of frames to send
+   */
+  void SendFrames (uint32_t n);
+  /**
+   * \return the number of frames received by the hosts
+   */
+  uint64_t GetReceived (void) const;
+
+private:
+  /**
+   * Receive a frame at a host
+   * \param device the host device
+   * \param p the frame
+   * \param protocol the protocol number
+   * \param from the source address
+   * \return true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::vector<Ptr<NetDevice> > m_hosts;   //!< The host devices
+  Ptr<Packet> m_packet;                   //!< The frame payload
+  uint64_t m_received;                    //!< The number of frames received
+};
+
+BenchHosts::BenchHosts (uint32_t ports, bool useSwitch)
+  : m_packet (Create<Packet> (1000)),
+    m_received (0)
+{
+  Ptr<Node> sw = CreateObject<Node> ();
+  SimpleNetDeviceHelper helper;
+  NetDeviceContainer switchPorts;
+  for (uint32_t i = 0; i < ports; i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      Ptr<NetDevice> host = helper.Install (CreateObject<Node> (), channel).Get (0);
+      host->SetReceiveCallback (MakeCallback (&BenchHosts::Receive, this));
+      m_hosts.push_back (host);
+      switchPorts.Add (helper.Install (sw, channel));
+    }
+  if (useSwitch)
+    {
+      SwitchHelper ().Install (sw, switchPorts);
+    }
+  else
+    {
+      BridgeHelper ().Install (sw, switchPorts);
+    }
+}
+
+bool
+BenchHosts::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+{
+  m_received++;
+  return true;
+}
+
+void
+BenchHosts::Learn (void)
+{
+  for (uint32_t i = 0; i < m_hosts.size (); i++)
+    {
+      m_hosts[i]->Send (m_packet->Copy (), m_hosts[0]->GetAddress (), 0x0800);
+    }
+}
+
+void
+BenchHosts::SendFrames (uint32_t n)
+{
+  if (n == 0)
+    {
+      return;
+    }
+  // a simple pseudo random sequence of pairs of distinct hosts
+  uint32_t nHosts = m_hosts.size ();
+  uint32_t from = (n * 2654435761u) % nHosts;
+  uint32_t to = (from + 1 + n % (nHosts - 1)) % nHosts;
+  m_hosts[from]->Send (m_packet->Copy (), m_hosts[to]->GetAddress (), 0x0800);
+  Simulator::Schedule (MicroSeconds (1), &BenchHosts::SendFrames, this, n - 1);
+}
+
+uint64_t
+BenchHosts::GetReceived (void) const
+{
+  return m_received;
+}
+
+/**
+ * Run the benchmark with a bridge or a switch and print its speed.
+ * \param n the number of frames
+ * \param ports the number of ports
+ * \param useSwitch whether a SwitchNetDevice or a BridgeNetDevice is used
+ * \param name the benchmark name
+ */
+static void
+runBench (uint32_t n, uint32_t ports, bool useSwitch, char const *name)
+{
+  BenchHosts hosts (ports, useSwitch);
+  Simulator::Schedule (Seconds (0), &BenchHosts::Learn, &hosts);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  Simulator::Schedule (Seconds (0), &BenchHosts::SendFrames, &hosts, n);
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  uint64_t delay = std::max (static_cast<uint64_t> (time.End ()), static_cast<uint64_t> (1));
+
+  double nsPerOp = 1e6 * delay / n;
+  std::cout << nsPerOp << " ns per frame"
+            << " (" << delay << " ms elapsed, " << hosts.GetReceived () << " frames received)\t"
+            << name << std::endl;
+  Simulator::Destroy ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t ports = 1000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the forwarding of unicast frames by the bridge and switch devices");
+  cmd.AddValue ("n", "number of frames", n);
+  cmd.AddValue ("ports", "number of ports", ports);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || ports < 2)
+    {
+      std::cerr << "Error-- number of frames must be specified " <<
+        "by command-line argument --n, and at least two ports are needed" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Running bench-switch with n=" << n << " ports=" << ports << std::endl;
+
+  runBench (n, ports, false, "BridgeNetDevice");
+  runBench (n, ports, true, "SwitchNetDevice");
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the SACK scoreboard of TcpTxBuffer
+// on a long fat pipe: a full window is sent, one segment every 'loss-interval'
+// is lost, and the sender processes the SACKs of the other segments while it
+// retransmits the lost ones, as in the recovery of a 10 Gbps x 100 ms path
+// (the default window). Only the processing of the ACKs is timed.
+// Sample usage:  ./waf --run 'bench-tcp-scoreboard --n=1 --window=86000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-tx-buffer.h"
+#include <iostream>
+#include <limits>
+#include <algorithm>
+
+using namespace ns3;
+
+/// Result of the queries, printed so that they are not optimized away
+static uint64_t g_result = 0;
+
+/// Segment size
+static const uint32_t g_segmentSize = 1448;
+
+/**
+ * \returns an unlimited receiver window
+ */
+static uint32_t
+GetRWnd (void)
+{
+  return std::numeric_limits<uint32_t>::max ();
+}
+
+/**
+ * \param i the index of a segment
+ * \returns its first sequence number
+ */
+static SequenceNumber32
+GetSeq (uint32_t i)
+{
+  return SequenceNumber32 (1 + i * g_segmentSize);
+}
+
+/**
+ * Send a window, and process the SACKs of its segments.
+ * \param window number of segments of the window
+ * \param lossInterval one segment every lossInterval is lost
+ * \param elapsed incremented by the time taken by the ACKs (ms)
+ * \returns the number of ACKs processed
+ */
+static uint32_t
+benchRecovery (uint32_t window, uint32_t lossInterval, uint64_t &elapsed)
+{
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&GetRWnd));
+  txBuf->SetHeadSequence (GetSeq (0));
+  txBuf->SetSegmentSize (g_segmentSize);
+  txBuf->SetDupAckThresh (3);
+  txBuf->SetMaxBufferSize (window * g_segmentSize);
+  txBuf->Add (Create<Packet> (window * g_segmentSize));
+  for (uint32_t i = 0; i < window; i++)
+    {
+      txBuf->CopyFromSequence (g_segmentSize, GetSeq (i));
+    }
+
+  // The receiver reports the run of segments received since the last hole,
+  // and the run before it
+  SystemWallClockMs time;
+  time.Start ();
+  uint32_t acks = 0;
+  uint32_t runStart = 0;
+  uint32_t previousStart = 0;
+  uint32_t previousEnd = 0;
+  for (uint32_t i = 0; i < window; i++)
+    {
+      if (i % lossInterval == lossInterval / 2)
+        {
+          previousStart = runStart;
+          previousEnd = i;
+          runStart = i + 1;
+          continue;
+        }
+      if (previousEnd == 0)
+        {
+          txBuf->DiscardUpTo (GetSeq (i + 1));
+          runStart = i + 1;
+        }
+      else
+        {
+          TcpOptionSack::SackList list;
+          list.push_back (TcpOptionSack::SackBlock (GetSeq (runStart), GetSeq (i + 1)));
+          if (previousStart < previousEnd)
+            {
+              list.push_back (TcpOptionSack::SackBlock (GetSeq (previousStart), GetSeq (previousEnd)));
+            }
+          g_result += txBuf->Update (list);
+        }
+      acks++;
+
+      SequenceNumber32 seq;
+      SequenceNumber32 seqHigh;
+      if (txBuf->NextSeg (&seq, &seqHigh, true) && txBuf->IsLost (seq))
+        {
+          g_result += txBuf->CopyFromSequence (g_segmentSize, seq)->GetSeqSize ();
+        }
+      g_result += txBuf->BytesInFlight ();
+    }
+  elapsed += time.End ();
+  txBuf->DiscardUpTo (GetSeq (window));
+  return acks;
+}
+
+/**
+ * Run a benchmark and print its speed.
+ * \param n number of iterations
+ * \param minIterations number of runs to minimize the run time over
+ * \param window number of segments of the window
+ * \param lossInterval one segment every lossInterval is lost
+ */
+static void
+runBench (uint32_t n, uint32_t minIterations, uint32_t window, uint32_t lossInterval)
+{
+  uint64_t minDelay = std::numeric_limits<uint64_t>::max ();
+  uint64_t acks = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      uint64_t elapsed = 0;
+      acks = 0;
+      for (uint32_t j = 0; j < n; j++)
+        {
+          acks += benchRecovery (window, lossInterval, elapsed);
+        }
+      minDelay = std::min (minDelay, elapsed);
+    }
+  minDelay = std::max (minDelay, static_cast<uint64_t> (1));
+  double nsPerAck = 1e6 * minDelay / acks;
+  std::cout << nsPerAck << " ns per ACK"
+            << " (" << minDelay << " ms elapsed)\tRecovery of a window of "
+            << window << " segments" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 0;
+  uint32_t window = 86000;
+  uint32_t lossInterval = 100;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the SACK scoreboard of TcpTxBuffer");
+  cmd.AddValue ("n", "number of iterations", n);
+  cmd.AddValue ("window", "number of segments of the window", window);
+  cmd.AddValue ("loss-interval", "one segment every loss-interval is lost", lossInterval);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- number of iterations must be specified " <<
+        "by command-line argument --n" << std::endl;
+      return 1;
+    }
+  if (lossInterval < 2)
+    {
+      std::cerr << "Error-- loss-interval must be at least 2" << std::endl;
+      return 1;
+    }
+
+  std::cout << "Running bench-tcp-scoreboard with n=" << n << " window=" << window
+            << " loss-interval=" << lossInterval << std::endl;
+  runBench (n, minIterations, window, lossInterval);
+  std::cout << "(" << g_result << ")" << std::endl;
+
+  return 0;
+}
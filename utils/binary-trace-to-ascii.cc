@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program converts a binary trace, written by the trace sinks of
+// AsciiTraceHelper on a stream created with CreateBinaryFileStream, to the
+// ascii trace format.  It is linked with all the enabled modules so that
+// the headers of packets stored with BinaryTrace::FULL_PACKET can be printed.
+// Sample usage:  ./waf --run 'binary-trace-to-ascii --input=trace.bin --output=trace.tr'
+
+#include "ns3/command-line.h"
+#include "ns3/binary-trace-file.h"
+#include "ns3/packet.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <stdlib.h> // for exit ()
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Convert a binary device trace to the ascii trace format");
+  cmd.AddValue ("input", "binary trace file", input);
+  cmd.AddValue ("output", "ascii trace file (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "Error-- the binary trace must be specified " <<
+        "by command-line argument --input=(file name)" << std::endl;
+      exit (1);
+    }
+
+  // The ascii trace prints packets with their metadata
+  Packet::EnablePrinting ();
+
+  std::ifstream in (input.c_str (), std::ios::in | std::ios::binary);
+  if (!in.is_open ())
+    {
+      std::cerr << "Error-- unable to open " << input << std::endl;
+      exit (1);
+    }
+
+  bool ok;
+  if (output.empty ())
+    {
+      ok = BinaryTraceReader::ConvertToAscii (in, std::cout);
+    }
+  else
+    {
+      std::ofstream out (output.c_str ());
+      ok = BinaryTraceReader::ConvertToAscii (in, out);
+    }
+  if (!ok)
+    {
+      std::cerr << "Error-- " << input << " is not a binary trace" << std::endl;
+      exit (1);
+    }
+  return 0;
+}